@@ -206,6 +206,9 @@ static void bt_uart_isr(struct device *unused)
 
 static int h4_send(struct net_buf *buf)
 {
+	struct net_buf *frag;
+	int i;
+
 	BT_DBG("buf %p type %u len %u", buf, bt_buf_get_type(buf), buf->len);
 
 	switch (bt_buf_get_type(buf)) {
@@ -219,8 +222,13 @@ static int h4_send(struct net_buf *buf)
 		return -EINVAL;
 	}
 
-	while (buf->len) {
-		uart_poll_out(h4_dev, net_buf_pull_u8(buf));
+	/* The payload of ACL data may be in fragments, which may be shared
+	 * with other packets so they are only read.
+	 */
+	for (frag = buf; frag; frag = frag->frags) {
+		for (i = 0; i < frag->len; i++) {
+			uart_poll_out(h4_dev, frag->data[i]);
+		}
 	}
 
 	net_buf_unref(buf);
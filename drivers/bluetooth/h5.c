@@ -304,8 +304,11 @@ static uint8_t h5_slip_byte(uint8_t byte)
 	}
 }
 
-static void h5_send(const uint8_t *payload, uint8_t type, int len)
+/* Send a packet, whose payload may continue in the given fragments */
+static void h5_send_frags(const uint8_t *payload, uint8_t type, int len,
+			  struct net_buf *frags)
 {
+	struct net_buf *frag;
 	uint8_t hdr[4];
 	int i;
 
@@ -328,7 +331,7 @@ static void h5_send(const uint8_t *payload, uint8_t type, int len)
 	}
 
 	H5_SET_TYPE(hdr, type);
-	H5_SET_LEN(hdr, len);
+	H5_SET_LEN(hdr, len + net_buf_frags_len(frags));
 
 	/* Calculate CRC */
 	hdr[3] = ~((hdr[0] + hdr[1] + hdr[2]) & 0xff);
@@ -345,9 +348,22 @@ static void h5_send(const uint8_t *payload, uint8_t type, int len)
 		h5_slip_byte(payload[i]);
 	}
 
+	for (frag = frags; frag; frag = frag->frags) {
+		hexdump("<= ", frag->data, frag->len);
+
+		for (i = 0; i < frag->len; i++) {
+			h5_slip_byte(frag->data[i]);
+		}
+	}
+
 	uart_poll_out(h5_dev, SLIP_DELIMITER);
 }
 
+static void h5_send(const uint8_t *payload, uint8_t type, int len)
+{
+	h5_send_frags(payload, type, len, NULL);
+}
+
 /* Delayed fiber taking care about retransmitting packets */
 static void retx_fiber(int arg1, int arg2)
 {
@@ -640,7 +656,7 @@ static void tx_fiber(void)
 			buf = nano_fifo_get(&h5.tx_queue, TICKS_UNLIMITED);
 			type = h5_get_type(buf);
 
-			h5_send(buf->data, type, buf->len);
+			h5_send_frags(buf->data, type, buf->len, buf->frags);
 
 			/* buf is dequeued from tx_queue and queued to unack
 			 * queue.
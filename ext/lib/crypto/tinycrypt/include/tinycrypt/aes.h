@@ -95,6 +95,26 @@ int32_t tc_aes_encrypt(uint8_t *out,
 		       const uint8_t *in,
 		       const TCAesKeySched_t s);
 
+/**
+ *  @brief AES-128 Encryption of several blocks
+ *  Encrypts nblocks consecutive blocks of in buffer into out buffer under
+ *              key schedule s, as tc_aes_encrypt would one after the other
+ *  @note Assumes s was initialized by aes_set_encrypt_key;
+ *              out and in point to nblocks*16 byte buffers, which may be
+ *              the same. Implementations able to encrypt several blocks at
+ *              once do so here
+ *  @return  returns TC_SUCCESS (1)
+ *           returns TC_FAIL (0) if: out == NULL or in == NULL or s == NULL
+ *  @param out IN/OUT -- buffer to receive the ciphertext blocks
+ *  @param in IN -- plaintext blocks to encrypt
+ *  @param nblocks IN -- number of blocks
+ *  @param s IN -- initialized AES key schedule
+ */
+int32_t tc_aes_encrypt_blocks(uint8_t *out,
+			      const uint8_t *in,
+			      uint32_t nblocks,
+			      const TCAesKeySched_t s);
+
 /**
  *  @brief Set the AES-128 decryption key
  *  Uses key k to initialize s
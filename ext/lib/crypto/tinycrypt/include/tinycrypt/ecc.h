@@ -271,10 +271,27 @@ void EccPoint_add(EccPointJacobi *P1, EccPointJacobi *P2);
  * @param p_result OUT -- Product of p_point by p_scalar.
  * @param p_point IN -- Elliptic curve point
  * @param p_scalar IN -- Scalar integer
+ *
+ * @note p_point must be a point of the curve other than the point at infinity.
+ * @note Side-channel countermeasure: algorithm strengthened against timing
+ * attack.
  */
 void EccPoint_mult(EccPointJacobi *p_result, EccPoint *p_point,
 		uint32_t *p_scalar);
 
+/*
+ * @brief Elliptic curve scalar multiplication of the curve generator with
+ * result in Jacobi coordinates. Faster than EccPoint_mult() with curve_G,
+ * using a precomputed table of multiples of the generator.
+ *
+ * @param p_result OUT -- Product of the generator by p_scalar.
+ * @param p_scalar IN -- Scalar integer
+ *
+ * @note Side-channel countermeasure: algorithm strengthened against timing
+ * attack.
+ */
+void EccPoint_mult_base(EccPointJacobi *p_result, uint32_t *p_scalar);
+
 /*
  * @brief Convert an integer in standard octet representation to native format.
  * @return returns TC_SUCCESS (1)
@@ -189,3 +189,18 @@ int32_t tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
 
 	return TC_SUCCESS;
 }
+
+int32_t tc_aes_encrypt_blocks(uint8_t *out, const uint8_t *in,
+			      uint32_t nblocks, const TCAesKeySched_t s)
+{
+	uint32_t i;
+
+	for (i = 0; i < nblocks; ++i) {
+		if (tc_aes_encrypt(out + i*TC_AES_BLOCK_SIZE,
+				   in + i*TC_AES_BLOCK_SIZE, s) == TC_FAIL) {
+			return TC_FAIL;
+		}
+	}
+
+	return TC_SUCCESS;
+}
@@ -0,0 +1,444 @@
+/* aes_encrypt_bitsliced.c - TinyCrypt constant-time AES encryption procedure */
+
+/*
+ *  Copyright (C) 2016 by Intel Corporation, All Rights Reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *    - Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *    - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ *    - Neither the name of Intel Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This implementation encrypts two blocks at once, in bitsliced form: each of
+ * the eight 32-bit words of the state holds one bit of all the 32 bytes of the
+ * two blocks. The S-box is computed with logic operations rather than looked
+ * up, so neither the time taken nor the memory accessed depend on the key or
+ * the data.
+ *
+ * The key schedule keeps the layout of the other implementations. Round keys
+ * are converted to the bitsliced form as they are used, which keeps the stack
+ * usage low.
+ */
+
+#include <tinycrypt/aes.h>
+#include <tinycrypt/utils.h>
+#include <tinycrypt/constants.h>
+
+/*
+ * Converts between the byte and the bitsliced representations of the state,
+ * this transformation being its own inverse. In byte representation, q[2*i]
+ * holds column i of the first block as a little endian word, and q[2*i+1] the
+ * same column of the second block.
+ */
+#define swap_bits(cl, ch, n, x, y) do { \
+		uint32_t a = (x); \
+		uint32_t b = (y); \
+		(x) = (a & (cl)) | ((b & (cl)) << (n)); \
+		(y) = ((a & (ch)) >> (n)) | (b & (ch)); \
+	} while (0)
+
+static void ortho(uint32_t *q)
+{
+	swap_bits(0x55555555, 0xaaaaaaaa, 1, q[0], q[1]);
+	swap_bits(0x55555555, 0xaaaaaaaa, 1, q[2], q[3]);
+	swap_bits(0x55555555, 0xaaaaaaaa, 1, q[4], q[5]);
+	swap_bits(0x55555555, 0xaaaaaaaa, 1, q[6], q[7]);
+
+	swap_bits(0x33333333, 0xcccccccc, 2, q[0], q[2]);
+	swap_bits(0x33333333, 0xcccccccc, 2, q[1], q[3]);
+	swap_bits(0x33333333, 0xcccccccc, 2, q[4], q[6]);
+	swap_bits(0x33333333, 0xcccccccc, 2, q[5], q[7]);
+
+	swap_bits(0x0f0f0f0f, 0xf0f0f0f0, 4, q[0], q[4]);
+	swap_bits(0x0f0f0f0f, 0xf0f0f0f0, 4, q[1], q[5]);
+	swap_bits(0x0f0f0f0f, 0xf0f0f0f0, 4, q[2], q[6]);
+	swap_bits(0x0f0f0f0f, 0xf0f0f0f0, 4, q[3], q[7]);
+}
+
+/*
+ * S-box circuit of Boyar and Peralta, "A new combinational logic minimization
+ * technique with applications to cryptology", 2009. Input bit x0 and output
+ * bit s0 are the most significant bits of the bytes, held by q[7].
+ */
+static void sub_bytes(uint32_t *q)
+{
+	uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+	uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+	uint32_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+	uint32_t y20, y21;
+	uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+	uint32_t z10, z11, z12, z13, z14, z15, z16, z17;
+	uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+	uint32_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+	uint32_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+	uint32_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+	uint32_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+	uint32_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+	uint32_t t60, t61, t62, t63, t64, t65, t66, t67;
+	uint32_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+	x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+	/* top linear transformation */
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	/* non-linear section */
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	/* bottom linear transformation */
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	s0 = t59 ^ t63;
+	s6 = t56 ^ ~t62;
+	s7 = t48 ^ ~t60;
+	t67 = t64 ^ t65;
+	s3 = t53 ^ t66;
+	s4 = t51 ^ t66;
+	s5 = t47 ^ t65;
+	s1 = t64 ^ ~s3;
+	s2 = t55 ^ ~t67;
+
+	q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+	q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+static inline void shift_rows(uint32_t *q)
+{
+	uint32_t i;
+	uint32_t x;
+
+	for (i = 0; i < 8; ++i) {
+		x = q[i];
+		q[i] = (x & 0x000000ff) |
+		       ((x & 0x0000fc00) >> 2) | ((x & 0x00000300) << 6) |
+		       ((x & 0x00f00000) >> 4) | ((x & 0x000f0000) << 4) |
+		       ((x & 0xc0000000) >> 6) | ((x & 0x3f000000) << 2);
+	}
+}
+
+static inline uint32_t rotr16(uint32_t x)
+{
+	return ((x << 16) | (x >> 16));
+}
+
+static inline void mix_columns(uint32_t *q)
+{
+	uint32_t q0, q1, q2, q3, q4, q5, q6, q7;
+	uint32_t r0, r1, r2, r3, r4, r5, r6, r7;
+
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3];
+	q4 = q[4]; q5 = q[5]; q6 = q[6]; q7 = q[7];
+	r0 = (q0 >> 8) | (q0 << 24);
+	r1 = (q1 >> 8) | (q1 << 24);
+	r2 = (q2 >> 8) | (q2 << 24);
+	r3 = (q3 >> 8) | (q3 << 24);
+	r4 = (q4 >> 8) | (q4 << 24);
+	r5 = (q5 >> 8) | (q5 << 24);
+	r6 = (q6 >> 8) | (q6 << 24);
+	r7 = (q7 >> 8) | (q7 << 24);
+
+	q[0] = q7 ^ r7 ^ r0 ^ rotr16(q0 ^ r0);
+	q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotr16(q1 ^ r1);
+	q[2] = q1 ^ r1 ^ r2 ^ rotr16(q2 ^ r2);
+	q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotr16(q3 ^ r3);
+	q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotr16(q4 ^ r4);
+	q[5] = q4 ^ r4 ^ r5 ^ rotr16(q5 ^ r5);
+	q[6] = q5 ^ r5 ^ r6 ^ rotr16(q6 ^ r6);
+	q[7] = q6 ^ r6 ^ r7 ^ rotr16(q7 ^ r7);
+}
+
+static inline uint32_t swap_word(uint32_t a)
+{
+	return ((a >> 24) | ((a >> 8) & 0x0000ff00) |
+		((a << 8) & 0x00ff0000) | (a << 24));
+}
+
+/* Key schedule words are big endian, the columns of the state little endian */
+static inline void add_round_key(uint32_t *q, const uint32_t *k)
+{
+	uint32_t sk[8];
+	uint32_t i;
+
+	for (i = 0; i < Nb; ++i) {
+		sk[2*i] = sk[2*i+1] = swap_word(k[i]);
+	}
+	ortho(sk);
+
+	for (i = 0; i < 8; ++i) {
+		q[i] ^= sk[i];
+	}
+}
+
+static void encrypt_bitsliced(uint32_t *q, const uint32_t *k)
+{
+	uint32_t i;
+
+	add_round_key(q, k);
+
+	for (i = 0; i < (Nr-1); ++i) {
+		sub_bytes(q);
+		shift_rows(q);
+		mix_columns(q);
+		add_round_key(q, k + Nb*(i+1));
+	}
+
+	sub_bytes(q);
+	shift_rows(q);
+	add_round_key(q, k + Nb*(i+1));
+}
+
+static inline uint32_t get_column(const uint8_t *in)
+{
+	return (in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) |
+		((uint32_t)in[3] << 24));
+}
+
+static inline void put_column(uint8_t *out, uint32_t c)
+{
+	out[0] = (uint8_t)(c); out[1] = (uint8_t)(c >> 8);
+	out[2] = (uint8_t)(c >> 16); out[3] = (uint8_t)(c >> 24);
+}
+
+/* Encrypts one or two blocks, the second one being in[16..31] */
+static void encrypt_pair(uint8_t *out, const uint8_t *in, uint32_t nblocks,
+			 const uint32_t *k)
+{
+	uint32_t q[8];
+	uint32_t i;
+
+	for (i = 0; i < Nb; ++i) {
+		q[2*i] = get_column(in + Nb*i);
+		q[2*i+1] = (nblocks > 1) ?
+			get_column(in + TC_AES_BLOCK_SIZE + Nb*i) : 0;
+	}
+
+	ortho(q);
+	encrypt_bitsliced(q, k);
+	ortho(q);
+
+	for (i = 0; i < Nb; ++i) {
+		put_column(out + Nb*i, q[2*i]);
+		if (nblocks > 1) {
+			put_column(out + TC_AES_BLOCK_SIZE + Nb*i, q[2*i+1]);
+		}
+	}
+
+	/* zeroing out the state */
+	_set(q, TC_ZERO_BYTE, sizeof(q));
+}
+
+/* S-box of each byte of a word, for the key schedule */
+static uint32_t subword(uint32_t a)
+{
+	uint32_t q[8];
+
+	_set(q, TC_ZERO_BYTE, sizeof(q));
+	q[0] = a;
+	ortho(q);
+	sub_bytes(q);
+	ortho(q);
+
+	return q[0];
+}
+
+static inline uint32_t rotword(uint32_t a)
+{
+	return (((a) >> 24)|((a) << 8));
+}
+
+int32_t tc_aes128_set_encrypt_key(TCAesKeySched_t s, const uint8_t *k)
+{
+	const uint32_t rconst[11] = {
+	0x00000000, 0x01000000, 0x02000000, 0x04000000, 0x08000000, 0x10000000,
+	0x20000000, 0x40000000, 0x80000000, 0x1b000000, 0x36000000
+	};
+	uint32_t i;
+	uint32_t t;
+
+	if (s == (TCAesKeySched_t) 0) {
+		return TC_FAIL;
+	} else if (k == (const uint8_t *) 0) {
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < Nk; ++i) {
+		s->words[i] = ((uint32_t)k[Nb*i]<<24) | (k[Nb*i+1]<<16) |
+			      (k[Nb*i+2]<<8) | (k[Nb*i+3]);
+	}
+
+	for (; i < (Nb*(Nr+1)); ++i) {
+		t = s->words[i-1];
+		if ((i % Nk) == 0) {
+			t = subword(rotword(t)) ^ rconst[i/Nk];
+		}
+		s->words[i] = s->words[i-Nk] ^ t;
+	}
+
+	return TC_SUCCESS;
+}
+
+int32_t tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
+{
+	if (out == (uint8_t *) 0) {
+		return TC_FAIL;
+	} else if (in == (const uint8_t *) 0) {
+		return TC_FAIL;
+	} else if (s == (TCAesKeySched_t) 0) {
+		return TC_FAIL;
+	}
+
+	encrypt_pair(out, in, 1, s->words);
+
+	return TC_SUCCESS;
+}
+
+int32_t tc_aes_encrypt_blocks(uint8_t *out, const uint8_t *in,
+			      uint32_t nblocks, const TCAesKeySched_t s)
+{
+	uint32_t n;
+
+	if (out == (uint8_t *) 0) {
+		return TC_FAIL;
+	} else if (in == (const uint8_t *) 0) {
+		return TC_FAIL;
+	} else if (s == (TCAesKeySched_t) 0) {
+		return TC_FAIL;
+	}
+
+	while (nblocks) {
+		n = (nblocks > 1) ? 2 : 1;
+		encrypt_pair(out, in, n, s->words);
+		out += n*TC_AES_BLOCK_SIZE;
+		in += n*TC_AES_BLOCK_SIZE;
+		nblocks -= n;
+	}
+
+	return TC_SUCCESS;
+}
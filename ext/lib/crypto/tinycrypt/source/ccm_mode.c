@@ -83,21 +83,27 @@ static void ccm_cbc_mac(uint8_t *T, const uint8_t *data, uint32_t dlen,
 	}
 }
 
+/* Number of blocks of key stream computed at once */
+#define CCM_CTR_BLOCKS (4)
+
 /**
  * Variation of CTR mode used in CCM.
  * The CTR mode used by CCM is slightly different than the conventional CTR
  * mode (the counter is increased before encryption, instead of after
  * encryption). Besides, it is assumed that the counter is stored in the last
- * 2 bytes of the nonce.
+ * 2 bytes of the nonce. The key stream of several blocks is computed at once.
  */
 static int32_t ccm_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 			     uint32_t inlen, uint8_t *ctr, const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
-	uint8_t nonce[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[CCM_CTR_BLOCKS*TC_AES_BLOCK_SIZE];
+	uint8_t nonce[CCM_CTR_BLOCKS*TC_AES_BLOCK_SIZE];
+	uint8_t *counter;
 	uint16_t block_num;
+	uint32_t nblocks;
 	uint32_t i;
+	uint32_t j;
 
 	/* input sanity check: */
 	if (out == (uint8_t *) 0 ||
@@ -110,26 +116,36 @@ static int32_t ccm_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		return TC_FAIL;
 	}
 
-	/* copy the counter to the nonce */
-	(void) _copy(nonce, sizeof(nonce), ctr, sizeof(nonce));
-
-	/* select the last 2 bytes of the nonce to be incremented */
-	block_num = (uint16_t) ((nonce[14] << 8)|(nonce[15]));
+	/* select the last 2 bytes of the counter to be incremented */
+	block_num = (uint16_t) ((ctr[14] << 8)|(ctr[15]));
 	for (i = 0; i < inlen; ++i) {
-		if ((i % (TC_AES_BLOCK_SIZE)) == 0) {
-			block_num++;
-			nonce[14] = (uint8_t)(block_num >> 8);
-			nonce[15] = (uint8_t)(block_num);
-			if (!tc_aes_encrypt(buffer, nonce, sched)) {
+		if ((i % sizeof(buffer)) == 0) {
+			/* encrypt the nonces of the next blocks at once */
+			nblocks = (inlen - i + TC_AES_BLOCK_SIZE - 1) /
+				  TC_AES_BLOCK_SIZE;
+			if (nblocks > CCM_CTR_BLOCKS) {
+				nblocks = CCM_CTR_BLOCKS;
+			}
+
+			for (j = 0; j < nblocks; ++j) {
+				block_num++;
+				counter = &nonce[j*TC_AES_BLOCK_SIZE];
+				(void) _copy(counter, 14, ctr, 14);
+				counter[14] = (uint8_t)(block_num >> 8);
+				counter[15] = (uint8_t)(block_num);
+			}
+
+			if (!tc_aes_encrypt_blocks(buffer, nonce, nblocks,
+						   sched)) {
 				return TC_FAIL;
 			}
 		}
 		/* update the output */
-		*out++ = buffer[i % (TC_AES_BLOCK_SIZE)] ^ *in++;
+		*out++ = buffer[i % sizeof(buffer)] ^ *in++;
 	}
 
 	/* update the counter */
-	ctr[14] = nonce[14]; ctr[15] = nonce[15];
+	ctr[14] = (uint8_t)(block_num >> 8); ctr[15] = (uint8_t)(block_num);
 
 	return TC_SUCCESS;
 }
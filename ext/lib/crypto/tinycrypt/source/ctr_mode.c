@@ -34,14 +34,20 @@
 #include <tinycrypt/ctr_mode.h>
 #include <tinycrypt/utils.h>
 
+/* Number of blocks of key stream computed at once */
+#define CTR_BLOCKS (4)
+
 int32_t tc_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		    uint32_t inlen, uint8_t *ctr, const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
-	uint8_t nonce[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[CTR_BLOCKS*TC_AES_BLOCK_SIZE];
+	uint8_t nonce[CTR_BLOCKS*TC_AES_BLOCK_SIZE];
+	uint8_t *counter;
 	uint32_t block_num;
+	uint32_t nblocks;
 	uint32_t i;
+	uint32_t j;
 
 	/* input sanity check: */
 	if (out == (uint8_t *) 0 ||
@@ -54,32 +60,42 @@ int32_t tc_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		return TC_FAIL;
 	}
 
-	/* copy the ctr to the nonce */
-	(void)_copy(nonce, sizeof(nonce), ctr, sizeof(nonce));
-
-	/* select the last 4 bytes of the nonce to be incremented */
-	block_num = (nonce[12] << 24) | (nonce[13] << 16) |
-		    (nonce[14] << 8) | (nonce[15]);
+	/* select the last 4 bytes of the ctr to be incremented */
+	block_num = (ctr[12] << 24) | (ctr[13] << 16) |
+		    (ctr[14] << 8) | (ctr[15]);
 	for (i = 0; i < inlen; ++i) {
-		if ((i % (TC_AES_BLOCK_SIZE)) == 0) {
-			/* encrypt data using the current nonce */
-			if (tc_aes_encrypt(buffer, nonce, sched)) {
+		if ((i % sizeof(buffer)) == 0) {
+			/* encrypt the nonces of the next blocks at once */
+			nblocks = (inlen - i + TC_AES_BLOCK_SIZE - 1) /
+				  TC_AES_BLOCK_SIZE;
+			if (nblocks > CTR_BLOCKS) {
+				nblocks = CTR_BLOCKS;
+			}
+
+			for (j = 0; j < nblocks; ++j) {
+				counter = &nonce[j*TC_AES_BLOCK_SIZE];
+				(void)_copy(counter, 12, ctr, 12);
+				counter[12] = (uint8_t)(block_num >> 24);
+				counter[13] = (uint8_t)(block_num >> 16);
+				counter[14] = (uint8_t)(block_num >> 8);
+				counter[15] = (uint8_t)(block_num);
 				block_num++;
-				nonce[12] = (uint8_t)(block_num >> 24);
-				nonce[13] = (uint8_t)(block_num >> 16);
-				nonce[14] = (uint8_t)(block_num >> 8);
-				nonce[15] = (uint8_t)(block_num);
-			} else {
+			}
+
+			if (!tc_aes_encrypt_blocks(buffer, nonce, nblocks,
+						   sched)) {
 				return TC_FAIL;
 			}
 		}
 		/* update the output */
-		*out++ = buffer[i%(TC_AES_BLOCK_SIZE)] ^ *in++;
+		*out++ = buffer[i%sizeof(buffer)] ^ *in++;
 	}
 
 	/* update the counter */
-	ctr[12] = nonce[12]; ctr[13] = nonce[13];
-	ctr[14] = nonce[14]; ctr[15] = nonce[15];
+	ctr[12] = (uint8_t)(block_num >> 24);
+	ctr[13] = (uint8_t)(block_num >> 16);
+	ctr[14] = (uint8_t)(block_num >> 8);
+	ctr[15] = (uint8_t)(block_num);
 
 	return TC_SUCCESS;
 }
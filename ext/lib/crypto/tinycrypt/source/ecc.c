@@ -85,6 +85,85 @@ uint32_t curve_n[NUM_ECC_DIGITS] = Curve_N;
 uint32_t curve_pb[NUM_ECC_DIGITS + 1] = Curve_P_Barrett;
 uint32_t curve_nb[NUM_ECC_DIGITS + 1] = Curve_N_Barrett;
 
+/*
+ * Width of the windows of the scalar multiplications: the fixed-base comb
+ * uses ECC_COMB_TEETH bits spaced ECC_COMB_SPACING apart, the variable-base
+ * multiplication signed digits of ECC_WINDOW_BITS bits.
+ */
+#define ECC_COMB_TEETH 4
+#define ECC_COMB_SPACING (NUM_ECC_DIGITS * 32 / ECC_COMB_TEETH)
+#define ECC_COMB_POINTS ((1 << ECC_COMB_TEETH) - 1)
+#define ECC_WINDOW_BITS 4
+#define ECC_WINDOW_POINTS (1 << (ECC_WINDOW_BITS - 1))
+#define ECC_WINDOWS (NUM_ECC_DIGITS * 32 / ECC_WINDOW_BITS)
+
+/*
+ * Comb table of the generator: entry j - 1 holds the sum of the points
+ * 2^(i * ECC_COMB_SPACING) * G for each bit i set in j.
+ */
+static const EccPoint curve_G_comb[ECC_COMB_POINTS] = {
+	{{0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81,
+	  0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2},
+	 {0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357,
+	  0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2} },
+	{{0x8E14DB63, 0x90E75CB4, 0xAD651F7E, 0x29493BAA,
+	  0x326E25DE, 0x8492592E, 0x2811AAA5, 0x0FA822BC},
+	 {0x5F462EE7, 0xE4112454, 0x50FE82F5, 0x34B1A650,
+	  0xB3DF188B, 0x6F4AD4BC, 0xF5DBA80D, 0xBFF44AE8} },
+	{{0x097992AF, 0x93391CE2, 0x0D35F1FA, 0xE96C98FD,
+	  0x95E02789, 0xB257C0DE, 0x89D6726F, 0x300A4BBC},
+	 {0xC08127A0, 0xAA54A291, 0xA9D806A5, 0x5BB1EEAD,
+	  0xFF1E3C6F, 0x7F1DDB25, 0xD09B4644, 0x72AAC7E0} },
+	{{0xD789BD85, 0x57C84FC9, 0xC297EAC3, 0xFC35FF7D,
+	  0x88C6766E, 0xFB982FD5, 0xEEDB5E67, 0x447D739B},
+	 {0x72E25B32, 0x0C7E33C9, 0xA7FAE500, 0x3D349B95,
+	  0x3A4AAFF7, 0xE12E9D95, 0x834131EE, 0x2D4825AB} },
+	{{0x2A1D367F, 0x13949C93, 0x1A0A11B7, 0xEF7FBD2B,
+	  0xB91DFC60, 0xDDC6068B, 0x8A9C72FF, 0xEF951932},
+	 {0x7376D8A8, 0x196035A7, 0x95CA1740, 0x23183B08,
+	  0x022C219C, 0xC1EE9807, 0x7DBB2C9B, 0x611E9FC3} },
+	{{0x0B57F4BC, 0xCAE2B192, 0xC6C9BC36, 0x2936DF5E,
+	  0xE11238BF, 0x7DEA6482, 0x7B51F5D8, 0x55066379},
+	 {0x348A964C, 0x44FFE216, 0xDBDEFBE1, 0x9FB3D576,
+	  0x8D9D50E5, 0x0AFA4001, 0x8AECB851, 0x15716484} },
+	{{0xFC5CDE01, 0xE48ECAFF, 0x0D715F26, 0x7CCD84E7,
+	  0xF43E4391, 0xA2E8F483, 0xB21141EA, 0xEB5D7745},
+	 {0x731A3479, 0xCAC917E2, 0x2844B645, 0x85F22CFE,
+	  0x58006CEE, 0x0990E6A1, 0xDBECC17B, 0xEAFD72EB} },
+	{{0x313728BE, 0x6CF20FFB, 0xA3C6B94A, 0x96439591,
+	  0x44315FC5, 0x2736FF83, 0xA7849276, 0xA6D39677},
+	 {0xC357F5F4, 0xF2BAB833, 0x2284059B, 0x824A920C,
+	  0x2D27ECDF, 0x66B8BABD, 0x9B0B8816, 0x674F8474} },
+	{{0x677C8A3E, 0x2DF48C04, 0x0203A56B, 0x74E02F08,
+	  0xB8C7FEDB, 0x31855F7D, 0x72C9DDAD, 0x4E769E76},
+	 {0xB824BBB0, 0xA4C36165, 0x3B9122A5, 0xFB9AE16F,
+	  0x06947281, 0x1EC00572, 0xDE830663, 0x42B99082} },
+	{{0xDDA868B9, 0x6EF95150, 0x9C0CE131, 0xD1F89E79,
+	  0x08A1C478, 0x7FDC1CA0, 0x1C6CE04D, 0x78878EF6},
+	 {0x1FE0D976, 0x9C62B912, 0xBDE08D4F, 0x6ACE570E,
+	  0x12309DEF, 0xDE53142C, 0x7B72C321, 0xB6CB3F5D} },
+	{{0xC31A3573, 0x7F991ED2, 0xD54FB496, 0x5B82DD5B,
+	  0x812FFCAE, 0x595C5220, 0x716B1287, 0x0C88BC4D},
+	 {0x5F48ACA8, 0x3A57BF63, 0xDF2564F3, 0x7C8181F4,
+	  0x9C04E6AA, 0x18D1B5B3, 0xF3901DC6, 0xDD5DDEA3} },
+	{{0x3E72AD0C, 0xE96A79FB, 0x42BA792F, 0x43A0A28C,
+	  0x083E49F3, 0xEFE0A423, 0x6B317466, 0x68F344AF},
+	 {0x3FB24D4A, 0xCDFE17DB, 0x71F5C626, 0x668BFC22,
+	  0x24D67FF3, 0x604ED93C, 0xF8540A20, 0x31B9C405} },
+	{{0xA2582E7F, 0xD36B4789, 0x4EC39C28, 0x0D1A1014,
+	  0xEDBAD7A0, 0x663C62C3, 0x6F461DB9, 0x4052BF4B},
+	 {0x188D25EB, 0x235A27C3, 0x99BFCC5B, 0xE724F339,
+	  0x71D70CC8, 0x862BE6BD, 0x90B0FC61, 0xFECF4D51} },
+	{{0xA1D4CFAC, 0x74346C10, 0x8526A7A4, 0xAFDF5CC0,
+	  0xF62BFF7A, 0x123202A8, 0xC802E41A, 0x1EDDBAE2},
+	 {0xD603F844, 0x8FA0AF2D, 0x4C701917, 0x36E06B7E,
+	  0x73DB33A0, 0x0C45F452, 0x560EBCFC, 0x43104D86} },
+	{{0x0D1D78E5, 0x9615B511, 0x25C4744B, 0x66B0DE32,
+	  0x6AAF363A, 0x0A4A46FB, 0x84F7A21C, 0xB48E26B4},
+	 {0x21A01B2D, 0x06EBB0F6, 0x8B7B0F98, 0xC004E404,
+	  0xFED6F668, 0x64131BCD, 0x4D4D3DAB, 0xFAC01540} }
+};
+
 /* ------ Static functions: ------ */
 
 /* Zeroing out p_vli. */
@@ -114,44 +193,6 @@ uint32_t vli_isZero(uint32_t *p_vli)
 	return (!acc);
 }
 
-/*
- * Find the right-most nonzero 32-bit "digits" in p_vli.
- *
- * Side-channel countermeasure: algorithm strengthened against timing attack.
- */
-static uint32_t vli_numDigits(uint32_t *p_vli)
-{
-	int32_t i;
-	uint32_t digits = 0;
-
-	for (i = NUM_ECC_DIGITS - 1; i >= 0 ; --i) {
-		digits += p_vli[i] || digits;
-	}
-
-	return digits;
-}
-
-/*
- * Find the left-most non-zero bit in p_vli.
- *
- * Side-channel countermeasure: algorithm strengthened against timing attack.
- */
-static uint32_t vli_numBits(uint32_t *p_vli)
-{
-	uint32_t l_digit;
-	uint32_t i, acc = 32;
-	uint32_t l_numDigits = vli_numDigits(p_vli);
-
-	l_digit = p_vli[l_numDigits - 1];
-
-	for (i = 0; i < 32; ++i) {
-		acc -= !l_digit;
-		l_digit >>= 1;
-	}
-
-	return ((l_numDigits - 1) * 32 + acc);
-}
-
 /*
  * Computes p_result = p_left + p_right, returns carry.
  *
@@ -361,6 +402,129 @@ static void EccPointJacobi_set(EccPointJacobi *target, EccPointJacobi *input)
 	vli_set(target->Z, input->Z);
 }
 
+/*
+ * Elliptic curve point addition of a point in Jacobi coordinates and a point
+ * in Affine coordinates: P1 = P1 + P2.
+ *
+ * Requires 3 squares and 8 multiplications.
+ */
+static void EccPoint_addAffine(EccPointJacobi *P1, EccPoint *P2)
+{
+
+	uint32_t z[NUM_ECC_DIGITS], h[NUM_ECC_DIGITS], r[NUM_ECC_DIGITS];
+	uint32_t t[NUM_ECC_DIGITS];
+
+	vli_modSquare_fast(z, P1->Z);
+	vli_modMult_fast(h, P2->x, z);
+	vli_modMult_fast(r, P2->y, z);
+	vli_modMult_fast(r, r, P1->Z);
+	vli_modSub(h, h, P1->X, curve_p); /* h = X2 Z1^2 - X1 */
+	vli_modSub(r, r, P1->Y, curve_p); /* r = Y2 Z1^3 - Y1 */
+
+	if (vli_isZero(h)) {
+		if (vli_isZero(r)) {
+			/* P1 = P2 */
+			EccPoint_double(P1);
+			return;
+		}
+		/* point at infinity */
+		vli_clear(P1->Z);
+		return;
+	}
+
+	vli_modMult_fast(P1->Z, P1->Z, h); /* Z3 = h Z1 */
+	vli_modSquare_fast(z, h);
+	vli_modMult_fast(h, z, h);
+	vli_modMult_fast(z, P1->X, z); /* z = X1 h^2 */
+	vli_modSquare_fast(P1->X, r);
+	vli_modSub(P1->X, P1->X, h, curve_p);
+	vli_modSub(P1->X, P1->X, z, curve_p);
+	vli_modSub(P1->X, P1->X, z, curve_p); /* X3 = r^2 - h^3 - 2 X1 h^2 */
+	vli_modMult_fast(t, P1->Y, h);
+	vli_modSub(P1->Y, z, P1->X, curve_p);
+	vli_modMult_fast(P1->Y, P1->Y, r);
+	vli_modSub(P1->Y, P1->Y, t, curve_p); /* Y3 = r(X1 h^2 - X3) - Y1 h^3 */
+}
+
+/*
+ * Constant time lookup of entry p_index of the comb table, or of the point
+ * (0, 0) if p_index is 0. All the entries are read whatever p_index is.
+ */
+static void EccPoint_combSelect(EccPoint *p_point, uint32_t p_index)
+{
+	uint32_t i, j, mask;
+
+	vli_clear(p_point->x);
+	vli_clear(p_point->y);
+
+	for (j = 0; j < ECC_COMB_POINTS; j++) {
+		mask = 0 - (uint32_t)(j + 1 == p_index);
+		for (i = 0; i < NUM_ECC_DIGITS; i++) {
+			p_point->x[i] |= curve_G_comb[j].x[i] & mask;
+			p_point->y[i] |= curve_G_comb[j].y[i] & mask;
+		}
+	}
+}
+
+/*
+ * Constant time lookup of p_index * 2 + 1 times a point in a table of its odd
+ * multiples, negated if p_negate is set.
+ */
+static void EccPoint_windowSelect(EccPointJacobi *p_point,
+				  EccPointJacobi *p_table, uint32_t p_index,
+				  uint32_t p_negate)
+{
+	uint32_t j, match;
+	uint32_t l_neg[NUM_ECC_DIGITS];
+
+	EccPointJacobi_set(p_point, &p_table[0]);
+
+	for (j = 1; j < ECC_WINDOW_POINTS; j++) {
+		match = (j == p_index);
+		vli_cond_set(p_point->X, p_table[j].X, p_point->X, match);
+		vli_cond_set(p_point->Y, p_table[j].Y, p_point->Y, match);
+		vli_cond_set(p_point->Z, p_table[j].Z, p_point->Z, match);
+	}
+
+	vli_sub(l_neg, curve_p, p_point->Y, NUM_ECC_DIGITS);
+	vli_cond_set(p_point->Y, l_neg, p_point->Y, p_negate);
+}
+
+/*
+ * Recode the odd scalar p_scalar into ECC_WINDOWS odd signed digits of
+ * ECC_WINDOW_BITS bits, p_scalar = sum(p_digits[i] 2^(i ECC_WINDOW_BITS)).
+ * None of the digits is zero, so the multiplication does the same operations
+ * for every scalar. p_scalar is modified.
+ *
+ * Side-channel countermeasure: algorithm strengthened against timing attack.
+ */
+static void vli_recodeWindows(int8_t *p_digits, uint32_t *p_scalar)
+{
+	uint32_t l_digit[NUM_ECC_DIGITS];
+	uint32_t i, j;
+	int32_t d;
+
+	for (i = 0; i < ECC_WINDOWS - 1; i++) {
+		d = (int32_t)(p_scalar[0] & ((2 << ECC_WINDOW_BITS) - 1)) -
+			(1 << ECC_WINDOW_BITS);
+		p_digits[i] = (int8_t)d;
+
+		/* p_scalar = (p_scalar - d) >> ECC_WINDOW_BITS, d sign extended */
+		l_digit[0] = (uint32_t)d;
+		for (j = 1; j < NUM_ECC_DIGITS; j++) {
+			l_digit[j] = 0 - (uint32_t)(d < 0);
+		}
+		vli_sub(p_scalar, p_scalar, l_digit, NUM_ECC_DIGITS);
+		for (j = 0; j < NUM_ECC_DIGITS - 1; j++) {
+			p_scalar[j] = (p_scalar[j] >> ECC_WINDOW_BITS) |
+				(p_scalar[j + 1] << (32 - ECC_WINDOW_BITS));
+		}
+		p_scalar[NUM_ECC_DIGITS - 1] >>= ECC_WINDOW_BITS;
+	}
+
+	p_digits[ECC_WINDOWS - 1] = (int8_t)p_scalar[0];
+}
+
 /* ------ Externally visible functions (see header file for comments): ------ */
 
 void vli_set(uint32_t *p_dest, uint32_t *p_src)
@@ -546,25 +710,102 @@ void EccPoint_add(EccPointJacobi *P1, EccPointJacobi *P2)
  * Elliptic curve scalar multiplication with result in Jacobi coordinates:
  *
  * p_result = p_scalar * p_point.
+ *
+ * Uses a regular signed window recoding of the scalar, made odd by replacing
+ * it by curve_n - p_scalar and negating the result when it is even.
  */
 void EccPoint_mult(EccPointJacobi *p_result, EccPoint *p_point, uint32_t *p_scalar)
 {
 
-	int32_t i;
-	uint32_t bit;
-	EccPointJacobi p_point_jacobi, p_tmp;
+	EccPointJacobi l_table[ECC_WINDOW_POINTS], l_point;
+	uint32_t l_scalar[NUM_ECC_DIGITS], l_tmp[NUM_ECC_DIGITS];
+	int8_t l_digits[ECC_WINDOWS];
+	uint32_t borrow, even, neg, idx;
+	int32_t i, j;
+
+	/* odd multiples P, 3P, 5P, ... of the point, 2P in p_result */
+	EccPoint_fromAffine(&l_table[0], p_point);
+	EccPointJacobi_set(p_result, &l_table[0]);
+	EccPoint_double(p_result);
+	for (i = 1; i < ECC_WINDOW_POINTS; i++) {
+		EccPointJacobi_set(&l_table[i], &l_table[i - 1]);
+		EccPoint_add(&l_table[i], p_result);
+	}
+
+	/* reduce the scalar modulo curve_n, and make it odd */
+	vli_set(l_scalar, p_scalar);
+	borrow = vli_sub(l_tmp, l_scalar, curve_n, NUM_ECC_DIGITS);
+	vli_cond_set(l_scalar, l_scalar, l_tmp, borrow);
+	even = !(l_scalar[0] & 1);
+	vli_sub(l_tmp, curve_n, l_scalar, NUM_ECC_DIGITS);
+	vli_cond_set(l_scalar, l_tmp, l_scalar, even);
+
+	vli_recodeWindows(l_digits, l_scalar);
+
+	/* the top digit is positive */
+	EccPoint_windowSelect(p_result, l_table,
+			      l_digits[ECC_WINDOWS - 1] >> 1, 0);
+
+	for (i = ECC_WINDOWS - 2; i >= 0; i--) {
+		for (j = 0; j < ECC_WINDOW_BITS; j++) {
+			EccPoint_double(p_result);
+		}
+		neg = (l_digits[i] < 0);
+		idx = ((uint32_t)l_digits[i] ^ (0 - neg)) + neg;
+		EccPoint_windowSelect(&l_point, l_table, idx >> 1, neg);
+		EccPoint_add(p_result, &l_point);
+	}
+
+	vli_sub(l_tmp, curve_p, p_result->Y, NUM_ECC_DIGITS);
+	vli_cond_set(p_result->Y, l_tmp, p_result->Y, even);
+}
+
+/*
+ * Elliptic curve scalar multiplication of the generator with result in Jacobi
+ * coordinates:
+ *
+ * p_result = p_scalar * G.
+ *
+ * Uses the comb table of G, so only needs ECC_COMB_SPACING doublings and
+ * additions. The point at infinity is tracked with a flag rather than
+ * branches, until the first non-zero comb digit is found.
+ */
+void EccPoint_mult_base(EccPointJacobi *p_result, uint32_t *p_scalar)
+{
 
-	EccPoint_fromAffine(p_result, p_point);
-	EccPoint_fromAffine(&p_point_jacobi, p_point);
+	EccPointJacobi l_sum;
+	EccPoint l_point;
+	uint32_t l_one[NUM_ECC_DIGITS] = {1};
+	uint32_t infinity = 1, digit, load;
+	int32_t i, j;
 
-	for (i = vli_numBits(p_scalar) - 2; i >= 0; i--) {
+	/* any point with Z = 0, doubled into itself */
+	vli_set(p_result->X, l_one);
+	vli_set(p_result->Y, l_one);
+	vli_clear(p_result->Z);
+
+	for (i = ECC_COMB_SPACING - 1; i >= 0; i--) {
 		EccPoint_double(p_result);
-		EccPointJacobi_set(&p_tmp, p_result);
-		EccPoint_add(&p_tmp, &p_point_jacobi);
-		bit = vli_testBit(p_scalar, i);
-		vli_cond_set(p_result->X, p_tmp.X, p_result->X, bit);
-		vli_cond_set(p_result->Y, p_tmp.Y, p_result->Y, bit);
-		vli_cond_set(p_result->Z, p_tmp.Z, p_result->Z, bit);
+
+		digit = 0;
+		for (j = 0; j < ECC_COMB_TEETH; j++) {
+			digit |= !!vli_testBit(p_scalar,
+					       j * ECC_COMB_SPACING + i) << j;
+		}
+
+		EccPoint_combSelect(&l_point, digit);
+		EccPointJacobi_set(&l_sum, p_result);
+		EccPoint_addAffine(&l_sum, &l_point);
+
+		load = infinity & (digit != 0);
+		infinity &= (digit == 0);
+
+		vli_cond_set(p_result->X, l_sum.X, p_result->X, digit);
+		vli_cond_set(p_result->Y, l_sum.Y, p_result->Y, digit);
+		vli_cond_set(p_result->Z, l_sum.Z, p_result->Z, digit);
+		vli_cond_set(p_result->X, l_point.x, p_result->X, load);
+		vli_cond_set(p_result->Y, l_point.y, p_result->Y, load);
+		vli_cond_set(p_result->Z, l_one, p_result->Z, load);
 	}
 }
 
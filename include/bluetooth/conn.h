@@ -176,6 +176,21 @@ int bt_conn_get_info(const struct bt_conn *conn, struct bt_conn_info *info);
 int bt_conn_le_param_update(struct bt_conn *conn,
 			    const struct bt_le_conn_param *param);
 
+/** @brief Set the transmit weight of a connection.
+ *
+ *  Outgoing data of all connections is sent by a single scheduler, which
+ *  serves the connections round-robin. In each round a connection may send
+ *  up to weight packets, so a connection with weight 2 gets twice the
+ *  controller buffers of a connection with weight 1 when both have data
+ *  pending. New connections have weight 1.
+ *
+ *  @param conn Connection object.
+ *  @param weight Packets per round, at least 1.
+ *
+ *  @return Zero on success or (negative) error code on failure.
+ */
+int bt_conn_set_tx_weight(struct bt_conn *conn, uint8_t weight);
+
 /** @brief Disconnect from a remote device or cancel pending connection.
  *
  *  Disconnect an active connection with the specified reason code or cancel
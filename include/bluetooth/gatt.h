@@ -501,6 +501,10 @@ struct bt_gatt_ccc_cfg {
 	uint16_t		value;
 	/** Config valid flag. */
 	uint8_t			valid;
+	/** Reference to the connection of the peer while it is connected,
+	 *  internal use only.
+	 */
+	struct bt_conn		*_conn;
 };
 
 /* Internal representation of CCC value */
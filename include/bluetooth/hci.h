@@ -28,6 +28,9 @@ extern "C" {
 
 #define BT_ADDR_LE_PUBLIC  0x00
 #define BT_ADDR_LE_RANDOM  0x01
+/* Identity address types of peers resolved by the controller */
+#define BT_ADDR_LE_PUBLIC_ID  0x02
+#define BT_ADDR_LE_RANDOM_ID  0x03
 
 typedef struct {
 	uint8_t  val[6];
@@ -129,6 +132,7 @@ struct bt_hci_cmd_hdr {
 #define BT_HCI_LE_ENCRYPTION			0x01
 #define BT_HCI_LE_CONN_PARAM_REQ_PROC		0x02
 #define BT_HCI_LE_SLAVE_FEATURES		0x08
+#define BT_HCI_LE_PRIVACY			0x40
 
 /* Bonding/authentication types */
 #define BT_HCI_NO_BONDING			0x00
@@ -588,6 +592,31 @@ struct bt_hci_cp_le_generate_dhkey {
 	uint8_t key[64];
 } __packed;
 
+#define BT_HCI_OP_LE_ADD_DEV_TO_RL		BT_OP(BT_OGF_LE, 0x0027)
+struct bt_hci_cp_le_add_dev_to_rl {
+	bt_addr_le_t peer_id_addr;
+	uint8_t      peer_irk[16];
+	uint8_t      local_irk[16];
+} __packed;
+
+#define BT_HCI_OP_LE_REM_DEV_FROM_RL		BT_OP(BT_OGF_LE, 0x0028)
+struct bt_hci_cp_le_rem_dev_from_rl {
+	bt_addr_le_t peer_id_addr;
+} __packed;
+
+#define BT_HCI_OP_LE_CLEAR_RL			BT_OP(BT_OGF_LE, 0x0029)
+
+#define BT_HCI_OP_LE_READ_RL_SIZE		BT_OP(BT_OGF_LE, 0x002a)
+struct bt_hci_rp_le_read_rl_size {
+	uint8_t  status;
+	uint8_t  rl_size;
+} __packed;
+
+#define BT_HCI_OP_LE_SET_ADDR_RES_ENABLE	BT_OP(BT_OGF_LE, 0x002d)
+struct bt_hci_cp_le_set_addr_res_enable {
+	uint8_t  enable;
+} __packed;
+
 /* Event definitions */
 
 #define BT_HCI_EVT_VENDOR			0xff
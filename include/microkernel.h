@@ -56,6 +56,7 @@ extern "C" {
 #include <microkernel/memory_pool.h>
 #include <microkernel/pipe.h>
 #include <microkernel/task_irq.h>
+#include <microkernel/cmd_batch.h>
 
 /**
  * @}
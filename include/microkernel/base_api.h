@@ -180,6 +180,7 @@ struct _k_pipe_marker_list {
 	int first_marker;
 	int last_marker;
 	int post_wrap_around_marker; /* -1 means no post wrap around markers */
+	uint32_t used_markers; /* bit N set == markers[N] is in use */
 	struct _k_pipe_marker markers[MAXNBR_PIPE_MARKERS];
 };
 
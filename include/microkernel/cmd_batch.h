@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Microkernel command batch header file.
+ */
+
+#ifndef _CMD_BATCH_H
+#define _CMD_BATCH_H
+
+/**
+ * @brief Microkernel Command Batches
+ * @defgroup microkernel_cmd_batch Microkernel Command Batches
+ * @ingroup microkernel_services
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <microkernel/base_api.h>
+
+/**
+ * @brief Command batch.
+ *
+ * A command batch collects semaphore gives and event signals so that a task
+ * can submit them to the microkernel server as a single request. The fields
+ * are managed by the task_cmd_batch_*() routines.
+ */
+struct k_cmd_batch {
+	uint32_t *cmds;
+	int size;
+	int count;
+};
+
+/**
+ *
+ * @brief Start a command batch.
+ *
+ * This routine prepares a command batch for collecting commands. The buffer
+ * must remain valid until the batch is committed.
+ *
+ * @param batch Command batch.
+ * @param buffer Buffer receiving the commands, one word per command.
+ * @param size Number of commands the buffer can hold.
+ *
+ * @return N/A
+ */
+extern void task_cmd_batch_begin(struct k_cmd_batch *batch, uint32_t *buffer,
+				 int size);
+
+/**
+ *
+ * @brief Add a semaphore give to a command batch.
+ *
+ * @param batch Command batch.
+ * @param sema Semaphore to give when the batch is committed.
+ *
+ * @return RC_OK if the command was added, RC_FAIL if the batch is full.
+ */
+extern int task_cmd_batch_sem_give(struct k_cmd_batch *batch, ksem_t sema);
+
+/**
+ *
+ * @brief Add an event signal to a command batch.
+ *
+ * This routine does @em not validate the specified event number.
+ *
+ * @param batch Command batch.
+ * @param event Event to signal when the batch is committed.
+ *
+ * @return RC_OK if the command was added, RC_FAIL if the batch is full.
+ */
+extern int task_cmd_batch_event_send(struct k_cmd_batch *batch,
+				     kevent_t event);
+
+/**
+ *
+ * @brief Submit a command batch.
+ *
+ * This routine sends all the commands of a batch to the microkernel server
+ * as a single request. The server executes them in the order they were
+ * added, then selects the next task to run once. The batch is empty again
+ * when this routine returns, and can be reused.
+ *
+ * @param batch Command batch.
+ *
+ * @return N/A
+ */
+extern void task_cmd_batch_commit(struct k_cmd_batch *batch);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CMD_BATCH_H */
@@ -154,6 +154,68 @@ extern int task_mbox_get(kmbox_t mbox, struct k_msg *M, int32_t timeout);
 extern int task_mbox_data_block_get(struct k_msg *M, struct k_block *block,
 					kmemory_pool_t pool_id, int32_t timeout);
 
+/**
+ * @brief Hand a memory pool block over to a receiver through a mailbox.
+ *
+ * This routine sends a message whose data is held in the memory pool block
+ * @a M->tx_block, and waits until a matching receiver accepts it. Ownership
+ * of the block passes to the receiver: when it is received with
+ * @a task_mbox_handoff_get(), the receiver gets the block itself and no data
+ * is copied. A receiver using any other mailbox receive routine gets a copy
+ * of the data, after which the block is released to its pool.
+ *
+ * The block must not be accessed by the sender once it has been delivered.
+ * If delivery fails, the block still belongs to the sender.
+ *
+ * @param mbox Mailbox.
+ * @param prio Priority of data transfer.
+ * @param M Pointer to message to send; @a M->size is the size of the data
+ * in the block.
+ * @param timeout Determines the action to take when there is no waiting receiver.
+ * For TICKS_NONE, return immediately.
+ * For TICKS_UNLIMITED, wait as long as necessary.
+ * Otherwise, wait up to the specified number of ticks before timing out.
+ *
+ * @return RC_OK Successfully delivered message.
+ * @return RC_TIME Timed out while waiting to deliver message.
+ * @return RC_FAIL Failed to immediately deliver message when
+ * @a timeout = TICKS_NONE.
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern int task_mbox_handoff_put(kmbox_t mbox, kpriority_t prio,
+				 struct k_msg *M, int32_t timeout);
+
+/**
+ * @brief Receive a message and take over the block holding its data.
+ *
+ * This routine receives a message from a mailbox and returns its data in
+ * a memory pool block, which then belongs to the caller. If the sender
+ * provided a block, using @a task_mbox_handoff_put() or
+ * @a task_mbox_block_put(), that same block is returned and no data is
+ * copied. Otherwise, a block is allocated from @a pool_id and the data is
+ * copied into it.
+ *
+ * For a message without data, @a block->pool_id is set to -1.
+ *
+ * @param mbox Mailbox.
+ * @param M Pointer to message.
+ * @param block Block receiving the message data.
+ * @param pool_id Memory pool used when the sender provided no block.
+ * @param timeout Determines the action to take when there is no waiting sender.
+ * For TICKS_NONE, return immediately.
+ * For TICKS_UNLIMITED, wait as long as necessary.
+ * Otherwise, wait up to the specified number of ticks before timing out.
+ *
+ * @return RC_OK Successfully received message.
+ * @return RC_TIME Timed out while waiting to receive message.
+ * @return RC_FAIL Failed to immediately receive message when
+ * @a timeout = TICKS_NONE.
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern int task_mbox_handoff_get(kmbox_t mbox, struct k_msg *M,
+				 struct k_block *block, kmemory_pool_t pool_id,
+				 int32_t timeout);
+
 /**
  * @brief Define a private microkernel mailbox.
  *
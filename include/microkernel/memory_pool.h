@@ -50,9 +50,8 @@ extern void task_mem_pool_free(struct k_block *b);
  * This routine concatenates unused blocks that can be merged in memory pool
  * @a p.
  *
- * Doing a full defragmentation of a memory pool before allocating a set
- * of blocks may be more efficient than having the pool do an implicit
- * partial defragmentation each time a block is allocated.
+ * Free blocks are merged as soon as they are released, so this routine only
+ * gives the tasks waiting on the pool another chance to get a block.
  *
  * @param p Memory pool name.
  *
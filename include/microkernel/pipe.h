@@ -132,6 +132,139 @@ extern int _task_pipe_block_put(kpipe_t id,
 #define task_pipe_block_put(id, block, size, sema) \
 			_task_pipe_block_put(id, block, size, sema)
 
+/**
+ * @brief Segment of data for a scatter-gather pipe request.
+ */
+struct k_pipe_iov {
+	/** Start of the segment. */
+	void *data;
+	/** Size of the segment, in bytes. */
+	int size;
+};
+
+/**
+ * @brief Area of a pipe buffer accessed in place.
+ */
+struct k_pipe_span {
+	/** Start of the area in the pipe buffer. */
+	void *data;
+	/** Size of the area, in bytes. */
+	int size;
+	/** @internal ID of the buffer transfer. @endinternal */
+	int id;
+};
+
+/**
+ * @brief Pipe scatter-gather write request.
+ *
+ * Attempt to write data gathered from a number of memory-buffer areas to
+ * the specified pipe with a timeout option. The segments are written in
+ * order, as a single stream of data.
+ *
+ * The segments are copied straight into the pipe buffer by a single kernel
+ * request, so the data that fits in the buffer is never interleaved with
+ * the data of other writers. With @a timeout = TICKS_NONE, an _ALL_N request
+ * writes either all of the data or none of it.
+ *
+ * When the call has to wait for room, the remainder of the current segment
+ * is written as by @a task_pipe_put(), and @a timeout applies to each such
+ * wait. The write is then not atomic: data from other writers may be
+ * interleaved with the data written before and after each wait.
+ *
+ * @param id Pipe ID.
+ * @param iov Array of segments to write.
+ * @param iovcnt Number of segments.
+ * @param bytes_written Pointer to number of bytes written.
+ * @param options Pipe options.
+ * @param timeout Determines the action to take when the pipe is already full.
+ *  For TICKS_NONE, return immediately.
+ *  For TICKS_UNLIMITED, wait as long as necessary.
+ *  Otherwise, wait up to the specified number of ticks before timing out.
+ *
+ * @retval RC_OK Successfully wrote data to pipe.
+ * @retval RC_ALIGNMENT Data is improperly aligned.
+ * @retval RC_INCOMPLETE Only some of the data was written to the pipe when
+ * @a options = _ALL_N and the call had to wait.
+ * @retval RC_TIME Timed out while waiting to write to pipe.
+ * @retval RC_FAIL Failed to immediately write to pipe when
+ * @a timeout = TICKS_NONE
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern int task_pipe_put_iov(kpipe_t id, const struct k_pipe_iov *iov,
+			     int iovcnt, int *bytes_written,
+			     K_PIPE_OPTION options, int32_t timeout);
+
+/**
+ * @brief Reserve free space in a pipe buffer for writing in place.
+ *
+ * This routine reserves up to @a size bytes of contiguous free space at the
+ * write end of the pipe buffer, so the caller can produce its data straight
+ * into the pipe. Readers do not get past the reserved area until it is
+ * committed with @a task_pipe_put_commit(). The routine does not wait.
+ *
+ * Less space than requested is reserved when the free space is not
+ * contiguous, i.e. wraps around the end of the buffer. No space is reserved
+ * while writers are waiting for the pipe.
+ *
+ * @param id Pipe ID.
+ * @param span Pointer to area descriptor, filled in with the reserved area.
+ * @param size Maximum number of bytes to reserve.
+ *
+ * @retval RC_OK Reserved @a span->size bytes.
+ * @retval RC_FAIL No space could be reserved.
+ */
+extern int task_pipe_put_reserve(kpipe_t id, struct k_pipe_span *span,
+				 int size);
+
+/**
+ * @brief Commit data written in place into a pipe buffer.
+ *
+ * This routine makes the data written into an area reserved by
+ * @a task_pipe_put_reserve() available to readers. The whole area is
+ * committed.
+ *
+ * @param id Pipe ID.
+ * @param span Area descriptor returned by @a task_pipe_put_reserve().
+ *
+ * @return N/A
+ */
+extern void task_pipe_put_commit(kpipe_t id, struct k_pipe_span *span);
+
+/**
+ * @brief Access data in a pipe buffer in place.
+ *
+ * This routine returns up to @a size bytes of contiguous data at the read
+ * end of the pipe buffer, so the caller can parse it without copying it out
+ * of the pipe. Writers do not overwrite the area until it is released with
+ * @a task_pipe_get_consume(). The routine does not wait.
+ *
+ * Less data than requested is returned when the data is not contiguous,
+ * i.e. wraps around the end of the buffer. No data is returned while
+ * readers are waiting for the pipe.
+ *
+ * @param id Pipe ID.
+ * @param span Pointer to area descriptor, filled in with the data area.
+ * @param size Maximum number of bytes to access.
+ *
+ * @retval RC_OK Returned @a span->size bytes.
+ * @retval RC_FAIL No data is available.
+ */
+extern int task_pipe_get_peek(kpipe_t id, struct k_pipe_span *span,
+			      int size);
+
+/**
+ * @brief Remove data accessed in place from a pipe buffer.
+ *
+ * This routine releases the area returned by @a task_pipe_get_peek(), and
+ * the data it holds, to writers. The whole area is released.
+ *
+ * @param id Pipe ID.
+ * @param span Area descriptor returned by @a task_pipe_get_peek().
+ *
+ * @return N/A
+ */
+extern void task_pipe_get_consume(kpipe_t id, struct k_pipe_span *span);
+
 
 /**
  * @brief Define a private microkernel pipe.
@@ -28,15 +28,44 @@ extern "C" {
 
 #define EVENT_HEADER_SIZE        1
 
+/*
+ * Events are stored, and drained, as a header word followed by the event
+ * data words. The header holds the event ID in bits 0-15, the number of
+ * data words in bits 16-23 and the number of events dropped before this one
+ * in bits 24-30; bit 31 is always set.
+ */
+#define EVENT_HEADER_VALID       0x80000000
+#define EVENT_HEADER_DROPPED_MAX 0x7f
+
+#define EVENT_HEADER_ID(header)      ((header) & 0xffff)
+#define EVENT_HEADER_LENGTH(header)  (((header) >> 16) & 0xff)
+#define EVENT_HEADER_DROPPED(header) \
+	(((header) >> 24) & EVENT_HEADER_DROPPED_MAX)
+
 #ifndef _ASMLANGUAGE
 
 #include <nanokernel.h>
+#include <atomic.h>
 #include <errno.h>
-#include <misc/ring_buffer.h>
+#include <misc/util.h>
 
+/*
+ * Producers reserve room for an event by advancing the reserve index with a
+ * compare and swap, fill it, and publish it by writing its header last, so
+ * events are logged without locking interrupts. The consumer clears the
+ * words of the events it retrieves, a zero header meaning the event at the
+ * head has not been published yet.
+ *
+ * The reserve word also counts the events dropped since the last
+ * reservation, in its top bits, so that a producer takes and clears the
+ * count with the same compare and swap that reserves its event.
+ */
 struct event_logger {
 	struct nano_sem sync_sema;
-	struct ring_buf ring_buf;
+	uint32_t *buf;		/* Storage, a power of 2 number of words */
+	uint32_t mask;		/* Number of words in buf, minus 1 */
+	atomic_t reserve;	/* Index of the first free word, drop count */
+	volatile uint32_t head;	/* Free-running index of the oldest event */
 };
 
 /**
@@ -48,11 +77,12 @@ struct event_logger {
 /**
  * @brief Initialize the event logger.
  *
- * @details This routine initializes the ring buffer.
+ * @details This routine initializes the ring buffer. Only the largest power
+ * of 2 number of words that fits in the buffer, up to 2^23 words, is used.
  *
  * @param logger        Logger to be initialized.
  * @param logger_buffer Pointer to the buffer to be used by the logger.
- * @param buffer_size   Size of the buffer in 32-bit words.
+ * @param buffer_size   Size of the buffer in 32-bit words, at least one.
  *
  * @return N/A
  */
@@ -64,7 +94,10 @@ void sys_event_logger_init(struct event_logger *logger,
  * @brief Send an event message to the logger.
  *
  * @details This routine adds an event message to the ring buffer and signals
- * the sync semaphore to indicate that event messages are available.
+ * the sync semaphore to indicate that event messages are available. It can
+ * be called from any context, and does not lock interrupts unless a fiber
+ * waits for event messages. If the ring buffer is full, the event is dropped
+ * and counted in the next event logged.
  *
  * @param logger     Pointer to the event logger used.
  * @param event_id   The profiler event's ID.
@@ -158,11 +191,52 @@ int sys_event_logger_get_wait_timeout(struct event_logger *logger,
 				      uint8_t *dropped_event_count,
 				      uint32_t *buffer, uint8_t *buffer_size,
 				      uint32_t timeout);
+#endif /* CONFIG_NANO_TIMEOUTS */
+
 /**
- * @}
+ * @brief Retrieve all the event messages that fit in a buffer.
+ *
+ * @details This routine copies the event messages from the ring buffer to
+ * the provided buffer, in FIFO order, in their binary format: a header word
+ * followed by the data words of the event. Use EVENT_HEADER_ID(),
+ * EVENT_HEADER_LENGTH() and EVENT_HEADER_DROPPED() to decode the header.
+ * Only whole event messages are copied, with a single copy from the ring
+ * buffer, so the provided buffer can be streamed out as is. If there is no
+ * message in the ring buffer the function returns immediately. Only one
+ * thread at a time may retrieve event messages from a logger.
+ *
+ * @param logger       Pointer to the event logger used.
+ * @param buffer       Pointer to the buffer for the copied messages.
+ * @param buffer_size  Size of the buffer in 32-bit words.
+ *
+ * @retval EMSGSIZE If the buffer is smaller than the first message.
+ * @retval Number of 32-bit words copied.
+ * @retval 0 If no message was available.
  */
+int sys_event_logger_drain(struct event_logger *logger, uint32_t *buffer,
+			   int buffer_size);
 
-#endif /* CONFIG_NANO_TIMEOUTS */
+/**
+ * @brief Retrieve all the event messages that fit in a buffer, wait if
+ * empty.
+ *
+ * @details This routine is like sys_event_logger_drain(), but the caller
+ * pends if there is no message available in the ring buffer. It can only be
+ * called from a fiber.
+ *
+ * @param logger       Pointer to the event logger used.
+ * @param buffer       Pointer to the buffer for the copied messages.
+ * @param buffer_size  Size of the buffer in 32-bit words.
+ *
+ * @retval EMSGSIZE If the buffer is smaller than the first message.
+ * @retval Number of 32-bit words copied.
+ */
+int sys_event_logger_drain_wait(struct event_logger *logger, uint32_t *buffer,
+				int buffer_size);
+
+/**
+ * @}
+ */
 
 #endif /* _ASMLANGUAGE */
 
@@ -329,6 +329,42 @@ void sys_k_event_logger_put_timed(uint16_t event_id);
 #endif /* CONFIG_NANO_TIMEOUTS */
 
 
+/**
+ * @brief Retrieves all the kernel event messages that fit in a buffer.
+ *
+ * @details Copies the kernel event messages to the provided buffer in their
+ * binary format, a header word followed by the data words of each event, so
+ * that they can be streamed out as is. The function retrieves messages in
+ * FIFO order.
+ *
+ * @param buffer       Pointer to the buffer where the messages will be copied.
+ * @param buffer_size  Size of the buffer in 32-bit words.
+ *
+ * @return -EMSGSIZE if the buffer size is smaller than the first message
+ * size, the amount of 32-bit words copied or zero if there are no kernel
+ * event messages available.
+ */
+#define sys_k_event_logger_drain(buffer, buffer_size) \
+	sys_event_logger_drain(&sys_k_event_logger, buffer, buffer_size)
+
+
+/**
+ * @brief Retrieves all the kernel event messages that fit in a buffer, wait
+ * if there is no message available.
+ *
+ * @details Like sys_k_event_logger_drain(), but if there is no kernel event
+ * message available the caller pends until a new message is logged.
+ *
+ * @param buffer       Pointer to the buffer where the messages will be copied.
+ * @param buffer_size  Size of the buffer in 32-bit words.
+ *
+ * @return -EMSGSIZE if the buffer size is smaller than the first message
+ * size, or the amount of 32-bit words copied.
+ */
+#define sys_k_event_logger_drain_wait(buffer, buffer_size) \
+	sys_event_logger_drain_wait(&sys_k_event_logger, buffer, buffer_size)
+
+
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
 
 /**
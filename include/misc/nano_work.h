@@ -27,6 +27,7 @@
 #include <nanokernel.h>
 #include <atomic.h>
 #include <misc/__assert.h>
+#include <misc/slist.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,15 +37,34 @@ struct nano_work;
 
 typedef void (*work_handler_t)(struct nano_work *);
 
+#ifdef CONFIG_NANO_WORKQUEUE_PRIORITIES
+#define NANO_WORK_PRIORITIES CONFIG_NANO_WORKQUEUE_PRIORITIES
+#else
+#define NANO_WORK_PRIORITIES 1
+#endif
+
+/** Highest work item priority */
+#define NANO_WORK_PRIO_HIGHEST 0
+/** Lowest work item priority, given to work items when initialized */
+#define NANO_WORK_PRIO_LOWEST (NANO_WORK_PRIORITIES - 1)
+
 /**
- * A workqueue is a fiber that executes @ref nano_work items that are
- * queued to it.  This is useful for drivers which need to schedule
+ * A workqueue is one or more fibers that execute @ref nano_work items that
+ * are queued to it.  This is useful for drivers which need to schedule
  * execution of code which might sleep from ISR context.  The actual
- * fiber identifier is not stored in the structure in order to save
+ * fiber identifiers are not stored in the structure in order to save
  * space.
+ *
+ * Work items are executed in order of priority, and in submission order
+ * within a priority.  When all of its work items have been taken, an idle
+ * worker fiber takes work items from the sibling workqueues, if any.
  */
 struct nano_workqueue {
-	struct nano_fifo fifo;
+	struct nano_sem sem;
+	sys_slist_t queue[NANO_WORK_PRIORITIES];
+	uint32_t pending;		/* Bitmap of non-empty queues */
+	int idle;			/* Number of waiting worker fibers */
+	struct nano_workqueue *sibling;	/* Next workqueue to take work from */
 };
 
 /**
@@ -58,21 +78,46 @@ enum {
  * @brief An item which can be scheduled on a @ref nano_workqueue.
  */
 struct nano_work {
-	void *_reserved;		/* Used by nano_fifo implementation. */
+	sys_snode_t node;		/* Used by workqueue implementation. */
 	work_handler_t handler;
 	atomic_t flags[1];
+	uint8_t prio;
 };
 
 /**
  * @brief Initialize work item
+ *
+ * The work item gets the lowest priority, NANO_WORK_PRIO_LOWEST.
  */
 static inline void nano_work_init(struct nano_work *work,
 				  work_handler_t handler)
 {
 	atomic_set_bit(work->flags, NANO_WORK_STATE_IDLE);
 	work->handler = handler;
+	work->prio = NANO_WORK_PRIO_LOWEST;
+}
+
+/**
+ * @brief Set the priority of a work item
+ *
+ * Pending work items of higher priority are executed first; 0 is the
+ * highest priority.  The priority of a work item that has been submitted
+ * can only be changed after its handler has started.
+ *
+ * @param work Work item
+ * @param prio Priority, from NANO_WORK_PRIO_HIGHEST to NANO_WORK_PRIO_LOWEST
+ */
+static inline void nano_work_priority_set(struct nano_work *work, int prio)
+{
+	__ASSERT(prio >= NANO_WORK_PRIO_HIGHEST &&
+		 prio <= NANO_WORK_PRIO_LOWEST,
+		 "invalid work priority %d\n", prio);
+	work->prio = prio;
 }
 
+extern void _nano_work_queue_put(struct nano_workqueue *wq,
+				 struct nano_work *work);
+
 /**
  * @brief Submit a work item to a workqueue.
  */
@@ -82,7 +127,7 @@ static inline void nano_work_submit_to_queue(struct nano_workqueue *wq,
 	if (!atomic_test_and_clear_bit(work->flags, NANO_WORK_STATE_IDLE)) {
 		__ASSERT_NO_MSG(0);
 	} else {
-		nano_fifo_put(&wq->fifo, work);
+		_nano_work_queue_put(wq, work);
 	}
 }
 
@@ -105,6 +150,35 @@ extern void nano_task_workqueue_start(struct nano_workqueue *wq,
 extern void nano_workqueue_start(struct nano_workqueue *wq,
 				 const struct fiber_config *config);
 
+/**
+ * @brief Add a worker fiber to a started workqueue.
+ *
+ * Work items of a workqueue with several worker fibers are executed
+ * concurrently, so a work item whose handler sleeps does not hold back the
+ * work items submitted after it.  The worker fibers can have different
+ * priorities.  This routine can be called from either fiber or task context.
+ *
+ * @param wq Workqueue, started by one of the nano_workqueue_start routines
+ * @param config Configuration of the new worker fiber
+ */
+extern void nano_workqueue_worker_add(struct nano_workqueue *wq,
+				      const struct fiber_config *config);
+
+/**
+ * @brief Let the idle workers of two workqueues take each other's work.
+ *
+ * Workqueues that are added as siblings form a group: when a worker fiber
+ * finds its own workqueue empty, it takes the pending work items of the
+ * other workqueues of its group.  Adding a workqueue to a group also adds
+ * the other members of its own group.  Both workqueues must have been
+ * started and must not already be in the same group.
+ *
+ * @param wq Workqueue
+ * @param sibling Workqueue to add to the group of @a wq
+ */
+extern void nano_workqueue_sibling_add(struct nano_workqueue *wq,
+				       struct nano_workqueue *sibling);
+
 #if defined(CONFIG_NANO_TIMEOUTS)
 
  /*
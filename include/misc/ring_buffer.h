@@ -36,8 +36,6 @@ extern "C" {
  * @{
  */
 
-#define SIZE32_OF(x) (sizeof((x))/sizeof(uint32_t))
-
 /**
  * @brief A structure to represent a ring buffer
  */
@@ -39,6 +39,7 @@ extern "C" {
 #define INT_TO_POINTER(x)  ((void *) (x))
 
 #define ARRAY_SIZE(array) ((unsigned long)(sizeof(array) / sizeof((array)[0])))
+#define SIZE32_OF(x) (sizeof((x))/sizeof(uint32_t))
 #define CONTAINER_OF(ptr, type, field) \
 	((type *)(((char *)(ptr)) - offsetof(type, field)))
 
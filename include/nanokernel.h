@@ -69,6 +69,10 @@ struct _nano_timeout {
 	struct _nano_queue *wait_q;
 	int32_t delta_ticks_from_prev;
 	_nano_timeout_func_t func;
+#ifdef CONFIG_NANO_TIMEOUT_QUEUE_WHEEL
+	uint32_t expiry;
+	uint8_t slot;
+#endif
 };
 /**
  * @endcond
@@ -1229,6 +1233,207 @@ extern void nano_task_stack_push(struct nano_stack *stack, uint32_t data);
  */
 extern int nano_task_stack_pop(struct nano_stack *stack, uint32_t *data, int32_t timeout_in_ticks);
 
+/**
+ * @}
+ * @brief Nanokernel SPSC Rings
+ * @defgroup nanokernel_spsc Nanokernel SPSC Rings
+ * @ingroup nanokernel_services
+ * @{
+ */
+struct nano_spsc {
+	struct _nano_queue wait_q;          /* waiting fiber */
+#ifdef CONFIG_MICROKERNEL
+	struct _nano_queue task_q;          /* waiting task */
+#endif
+	void **buf;
+	uint32_t mask;
+	volatile uint32_t head;             /* written by the producer only */
+	volatile uint32_t tail;             /* written by the consumer only */
+#ifdef CONFIG_DEBUG_TRACING_KERNEL_OBJECTS
+	struct nano_spsc *__next;
+#endif
+};
+
+/**
+ *
+ * @brief Initialize a nanokernel single-producer single-consumer ring.
+ *
+ * This function initializes a nanokernel SPSC ring object structure. The
+ * ring holds up to @a size pointers in the array @a buf.
+ *
+ * Items are passed through the ring without locking interrupts, provided
+ * that a single context (ISR, fiber or task) puts items into it and a single
+ * context gets items from it.
+ *
+ * It can be called from either a fiber or task.
+ *
+ * @param spsc Ring to initialize.
+ * @param buf Array holding the items.
+ * @param size Number of elements of @a buf; must be a power of 2.
+ *
+ * @return N/A
+ */
+extern void nano_spsc_init(struct nano_spsc *spsc, void **buf,
+			   unsigned int size);
+
+/* execution context-independent methods (when context is not known) */
+
+/**
+ *
+ * @brief Add an element to the end of an SPSC ring.
+ *
+ * This routine is a convenience wrapper for the execution of context-specific
+ * APIs. It is helpful when the exact execution context is not known. However,
+ * it should be avoided when the context is known up-front to avoid unnecessary
+ * overhead.
+ *
+ * Unlike a FIFO, the ring does not use any part of the element.
+ *
+ * @param spsc Ring on which to interact.
+ * @param data Data to send; must not be NULL.
+ *
+ * @retval 1 When the element is added to the ring.
+ * @retval 0 When the ring is full.
+ */
+extern int nano_spsc_put(struct nano_spsc *spsc, void *data);
+
+/**
+ *
+ * @brief Get an element from the head of an SPSC ring.
+ *
+ * This routine is a convenience wrapper for the execution of context-specific
+ * APIs. It is helpful when the exact execution context is not known. However,
+ * it should be avoided when the context is known up-front to avoid unnecessary
+ * overhead.
+ *
+ * @param spsc Ring on which to interact.
+ * @param timeout_in_ticks Affects the action taken should the ring be empty.
+ * If TICKS_NONE, then return immediately. If TICKS_UNLIMITED, then wait as
+ * long as necessary. Otherwise, wait up to the specified number of ticks
+ * before timing out.
+ *
+ * @warning If it is to be called from the context of an ISR, then @a
+ * timeout_in_ticks must be set to TICKS_NONE.
+ *
+ * @return Pointer to head element in the ring when available.
+ *         NULL Otherwise.
+ *
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern void *nano_spsc_get(struct nano_spsc *spsc, int32_t timeout_in_ticks);
+
+/*
+ * methods for ISRs
+ */
+
+/**
+ *
+ * @brief Add an element to the end of an SPSC ring from an ISR context.
+ *
+ * This is an alias for the execution context-specific API. This is
+ * helpful whenever the exact execution context is known. Its use
+ * avoids unnecessary overhead.
+ *
+ * @param spsc Ring on which to interact.
+ * @param data Data to send; must not be NULL.
+ *
+ * @retval 1 When the element is added to the ring.
+ * @retval 0 When the ring is full.
+ */
+extern int nano_isr_spsc_put(struct nano_spsc *spsc, void *data);
+
+/**
+ * @brief Get an element from the head of an SPSC ring from an ISR context.
+ *
+ * Remove the head element from the specified nanokernel SPSC ring.
+ * It can only be called from an ISR context.
+ *
+ * @param spsc Ring on which to interact.
+ * @param timeout_in_ticks Always use TICKS_NONE.
+ *
+ * @return Pointer to head element in the ring when available.
+ *         NULL Otherwise.
+ */
+extern void *nano_isr_spsc_get(struct nano_spsc *spsc,
+			int32_t timeout_in_ticks);
+
+/* methods for fibers */
+
+/**
+ *
+ * @brief Add an element to the end of an SPSC ring from a fiber.
+ *
+ * This is an alias for the execution context-specific API. This is
+ * helpful whenever the exact execution context is known. Its use
+ * avoids unnecessary overhead.
+ *
+ * @param spsc Ring on which to interact.
+ * @param data Data to send; must not be NULL.
+ *
+ * @retval 1 When the element is added to the ring.
+ * @retval 0 When the ring is full.
+ */
+extern int nano_fiber_spsc_put(struct nano_spsc *spsc, void *data);
+
+/**
+ * @brief Get an element from the head of an SPSC ring from a fiber.
+ *
+ * Remove the head element from the specified nanokernel SPSC ring.
+ * It can only be called from a fiber.
+ *
+ * @param spsc Ring on which to interact.
+ * @param timeout_in_ticks Affects the action taken should the ring be empty.
+ * If TICKS_NONE, then return immediately. If TICKS_UNLIMITED, then wait as
+ * long as necessary. Otherwise, wait up to the specified number of ticks
+ * before timing out.
+ *
+ * @return Pointer to head element in the ring when available.
+ *         NULL Otherwise.
+ *
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern void *nano_fiber_spsc_get(struct nano_spsc *spsc,
+			int32_t timeout_in_ticks);
+
+/* Methods for tasks */
+
+/**
+ *
+ * @brief Add an element to the end of an SPSC ring.
+ *
+ * This routine adds an element to the end of an SPSC ring object. It can
+ * only be called from a task. If a fiber is pending on the ring object, it
+ * becomes ready and will preempt the running task immediately.
+ *
+ * @param spsc Ring on which to interact.
+ * @param data Data to send; must not be NULL.
+ *
+ * @retval 1 When the element is added to the ring.
+ * @retval 0 When the ring is full.
+ */
+extern int nano_task_spsc_put(struct nano_spsc *spsc, void *data);
+
+/**
+ * @brief Get an element from the head of an SPSC ring from a task, poll if
+ * empty.
+ *
+ * Removes the head element from the specified nanokernel SPSC ring.
+ * It can only be called from a task.
+ *
+ * @param spsc Ring on which to interact.
+ * @param timeout_in_ticks Affects the action taken should the ring be empty.
+ * If TICKS_NONE, then return immediately. If TICKS_UNLIMITED, then poll as
+ * long as necessary. Otherwise poll up to the specified number of ticks have
+ * elapsed before timing out.
+ *
+ * @return Pointer to head element in the ring when available.
+ *         NULL Otherwise.
+ *
+ * @sa TICKS_NONE, TICKS_UNLIMITED
+ */
+extern void *nano_task_spsc_get(struct nano_spsc *spsc,
+			int32_t timeout_in_ticks);
+
 /* thread custom data APIs */
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 extern void sys_thread_custom_data_set(void *value);
@@ -37,6 +37,14 @@ struct net_buf {
 	/** FIFO uses first 4 bytes itself, reserve space */
 	int _unused;
 
+	/** Fragments associated with this buffer. A fragment may be
+	 *  referenced by several chains at once, so whoever consumes a
+	 *  chain, e.g. a driver sending it, must only read the data of the
+	 *  fragments and never modify them (no net_buf_pull() and the
+	 *  like).
+	 */
+	struct net_buf *frags;
+
 	/** Size of the user data associated with this buffer. */
 	const uint16_t user_data_size;
 
@@ -115,6 +123,21 @@ struct net_buf {
 		}							\
 	} while (0)
 
+/** @def NET_BUF_SLICE_POOL
+ *  @brief Define a pool of buffer slices.
+ *
+ *  Define a pool of buffers without data storage of their own, to be used
+ *  with net_buf_slice(). The pool must be initialized with
+ *  net_buf_pool_init() before use.
+ *
+ *  @param _name Name of the pool.
+ *  @param _count Number of slices in the pool.
+ *  @param _fifo FIFO for the slices which are available.
+ */
+#define NET_BUF_SLICE_POOL(_name, _count, _fifo)			\
+	NET_BUF_POOL(_name, _count, 0, _fifo, net_buf_slice_destroy,	\
+		     sizeof(struct net_buf *))
+
 /** @brief Get a new buffer from the pool.
  *
  *  Get buffer from the available buffers pool with specified type and
@@ -152,7 +175,8 @@ struct net_buf *net_buf_get_timeout(struct nano_fifo *fifo,
 /** @brief Decrements the reference count of a buffer.
  *
  *  Decrements the reference count of a buffer and puts it back into the
- *  pool if the count reaches zero.
+ *  pool if the count reaches zero, along with the references it holds on
+ *  its fragments.
  *
  *  @param buf Buffer.
  */
@@ -166,6 +190,101 @@ void net_buf_unref(struct net_buf *buf);
  */
 struct net_buf *net_buf_ref(struct net_buf *buf);
 
+/** @brief Slice the beginning of a buffer
+ *
+ *  Get a buffer from a pool defined with NET_BUF_SLICE_POOL() and make it
+ *  reference the first len bytes of the given buffer, which are pulled
+ *  from it. The data is not copied: the slice holds a reference to the
+ *  buffer until it is freed itself. A slice has no headroom nor tailroom,
+ *  so its data may be read or pulled but not pushed or added to.
+ *
+ *  @param fifo Which FIFO to take the slice from.
+ *  @param buf Buffer to slice.
+ *  @param len Number of bytes to slice.
+ *
+ *  @return New slice or NULL if out of slices.
+ */
+struct net_buf *net_buf_slice(struct nano_fifo *fifo, struct net_buf *buf,
+			      size_t len);
+
+/** @brief Slice part of a buffer
+ *
+ *  Like net_buf_slice(), but reference the len bytes found at the given
+ *  offset of the buffer data, leaving the buffer itself untouched. This is
+ *  meant for buffers which may be shared, e.g. a fragment referenced by
+ *  several chains.
+ *
+ *  @param fifo Which FIFO to take the slice from.
+ *  @param buf Buffer to slice.
+ *  @param offset Offset of the bytes to slice in the buffer data.
+ *  @param len Number of bytes to slice.
+ *
+ *  @return New slice or NULL if out of slices.
+ */
+struct net_buf *net_buf_slice_at(struct nano_fifo *fifo, struct net_buf *buf,
+				 size_t offset, size_t len);
+
+/** @brief Destroy callback of buffer slices
+ *
+ *  Releases the buffer referenced by a slice. Only meant to be used by
+ *  NET_BUF_SLICE_POOL().
+ *
+ *  @param buf Slice.
+ */
+void net_buf_slice_destroy(struct net_buf *buf);
+
+/** @brief Find the last fragment in the fragment list.
+ *
+ *  @param frags Head of the fragment list.
+ *
+ *  @return Pointer to last fragment in the list.
+ */
+struct net_buf *net_buf_frag_last(struct net_buf *frags);
+
+/** @brief Insert a new fragment to a chain of bufs.
+ *
+ *  Insert a new fragment, which may itself be a chain of fragments, into
+ *  the buffer fragments list after the parent. The reference held by the
+ *  caller on the fragment is given to the parent.
+ *
+ *  @param parent Parent buffer/fragment.
+ *  @param frag Fragment to insert.
+ */
+void net_buf_frag_insert(struct net_buf *parent, struct net_buf *frag);
+
+/** @brief Add a new fragment to the end of a chain of bufs.
+ *
+ *  Append a new fragment into the buffer fragments list. The reference
+ *  held by the caller on the fragment is given to the chain. Taking an
+ *  extra reference with net_buf_ref() lets the same fragment be added to
+ *  several chains, which is why the fragments of a chain are read-only.
+ *
+ *  @param head Head of the fragment chain.
+ *  @param frag Fragment to add.
+ */
+void net_buf_frag_add(struct net_buf *head, struct net_buf *frag);
+
+/** @brief Calculate amount of bytes stored in fragments.
+ *
+ *  Calculates the total amount of data stored in the given buffer and the
+ *  fragments linked to it.
+ *
+ *  @param buf Buffer to start off with.
+ *
+ *  @return Number of bytes in the buffer and its fragments.
+ */
+static inline size_t net_buf_frags_len(struct net_buf *buf)
+{
+	size_t bytes = 0;
+
+	while (buf) {
+		bytes += buf->len;
+		buf = buf->frags;
+	}
+
+	return bytes;
+}
+
 /** @brief Duplicate buffer
  *
  *  Duplicate given buffer including any data and headers currently stored.
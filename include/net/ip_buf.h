@@ -73,6 +73,25 @@ enum ip_buf_type {
 };
 /** @endcond */
 
+/**
+ * @brief Queueing classes of network packets.
+ *
+ * @details Packets waiting for the IP stack are queued by class.
+ * Control traffic is always handled first, the bulk classes share the
+ * rest by weight (see CONFIG_NET_QUEUE_BULK_HIGH_WEIGHT).
+ */
+enum net_queue_class {
+	/** Network control traffic, such as ND or RPL messages */
+	NET_QUEUE_CONTROL = 0,
+	/** Bulk data handled more often than the default class */
+	NET_QUEUE_BULK_HIGH,
+	/** Default class of the packets */
+	NET_QUEUE_BULK,
+	/** @cond ignore */
+	NET_QUEUE_CLASSES,
+	/** @endcond */
+};
+
 /** The default MTU is 1280 (minimum IPv6 packet size) + LL header
  * In Contiki terms this is UIP_LINK_MTU + UIP_LLH_LEN = UIP_BUFSIZE
  *
@@ -90,6 +109,9 @@ struct ip_buf {
 	/** Network connection context */
 	struct net_context *context;
 
+	/** Queueing class, see enum net_queue_class */
+	uint8_t queue_class;
+
 	/** @cond ignore */
 	/* uIP stack specific data */
 	uint16_t len; /* Contiki will set this to 0 if packet is discarded */
@@ -221,6 +243,8 @@ struct ip_buf {
 #define ip_buf_ll_dest(buf) (((struct ip_buf *)net_buf_user_data((buf)))->dest)
 #define ip_buf_context(buf) (((struct ip_buf *)net_buf_user_data((buf)))->context)
 #define ip_buf_type(ptr) (((struct ip_buf *)net_buf_user_data((ptr)))->type)
+#define ip_buf_queue_class(buf) \
+	(((struct ip_buf *)net_buf_user_data((buf)))->queue_class)
 #define ip_buf_sent_status(ptr) (((struct ip_buf *)net_buf_user_data((ptr)))->sent_status)
 #define ip_buf_tcp_retry_count(ptr) (((struct ip_buf *)net_buf_user_data((ptr)))->tcp_retry_count)
 /* @endcond */
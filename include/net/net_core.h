@@ -141,6 +141,21 @@ int net_reply(struct net_context *context, struct net_buf *buf);
 /* Called by driver when an IP packet has been received */
 int net_recv(struct net_buf *buf);
 
+/**
+ * @brief Pass several received IP packets to the IP stack at once.
+ *
+ * @details Same as calling net_recv() for each buffer, but the RX
+ * fiber is only woken up once. Drivers receiving bursts of packets
+ * can use this to hand them over in one go.
+ *
+ * @param bufs Network buffers containing the received packets.
+ * @param count Number of buffers.
+ *
+ * @return Number of packets queued. Queueing stops at the first empty
+ * buffer, which and the following ones are still owned by the caller.
+ */
+int net_recv_burst(struct net_buf **bufs, int count);
+
 void net_context_init(void);
 
 /**
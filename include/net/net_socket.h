@@ -48,6 +48,10 @@ extern "C" {
  * @param local_port Local UDP/TCP port. If the local port is 0,
  * then a random port will be allocated.
  *
+ * Several contexts may share a local address and port as long as their
+ * remote endpoints differ. Only one of them may have a wildcard remote
+ * (unspecified address or port 0).
+ *
  * @return Network context if successful, NULL otherwise.
  */
 struct net_context *net_context_get(enum ip_protocol ip_proto,
@@ -79,6 +79,13 @@ do {                                                                    \
 #define likely(x)   __builtin_expect((long)!!(x), 1L)
 #define unlikely(x) __builtin_expect((long)!!(x), 0L)
 
+/*
+ * Keep the compiler from moving memory accesses across this point. Threads
+ * and ISRs running on the same CPU see its memory accesses in program order,
+ * so this is enough to order the accesses they share without locking.
+ */
+#define compiler_barrier() __asm__ __volatile__ ("" ::: "memory")
+
 #define __weak __attribute__((__weak__))
 
 /* These macros allow having ARM asm functions callable from thumb */
@@ -48,6 +48,7 @@ typedef void (*kernelfunc)(struct k_args *);
 /* Jumptable entrypoints */
 
 extern void _k_nop(struct k_args *);
+extern void _k_cmd_batch(struct k_args *);
 extern void _k_offload_to_fiber(struct k_args *);
 extern void _k_workload_get(struct k_args *);
 
@@ -278,6 +279,11 @@ extern void _k_pipe_get_timeout(struct k_args *Reader);
 extern void _k_pipe_get_reply(struct k_args *Reader);
 extern void _k_pipe_get_ack(struct k_args *Reader);
 extern void _k_pipe_movedata_ack(struct k_args *pEOXfer);
+extern void _k_pipe_put_reserve(struct k_args *A);
+extern void _k_pipe_put_iov(struct k_args *A);
+extern void _k_pipe_put_commit(struct k_args *A);
+extern void _k_pipe_get_peek(struct k_args *A);
+extern void _k_pipe_get_consume(struct k_args *A);
 extern void _k_event_test_timeout(struct k_args *A);
 
 #ifdef __cplusplus
@@ -66,9 +66,6 @@ extern const kmemory_pool_t _heap_mem_pool_id;
 extern struct k_task *_k_current_task;
 extern uint32_t _k_task_priority_bitmap[];
 
-extern struct k_timer *_k_timer_list_head;
-extern struct k_timer *_k_timer_list_tail;
-
 extern struct nano_stack _k_command_stack;
 extern struct nano_lifo _k_server_command_packet_free;
 extern struct nano_lifo _k_timer_free;
@@ -81,6 +78,7 @@ extern void _k_timeout_free(struct k_timer *T);
 extern void _k_timeout_cancel(struct k_args *A);
 
 extern void _k_timer_list_update(int ticks);
+extern int32_t _k_timer_next_expiry(void);
 
 extern void _k_do_event_signal(kevent_t event);
 
@@ -37,6 +37,10 @@ struct k_timer {
 	int32_t duration;
 	int32_t period;
 	struct k_args *args;
+#ifdef CONFIG_MICROKERNEL_TIMER_WHEEL
+	uint32_t expiry; /* absolute tick at which the timer expires */
+	uint8_t slot;    /* timer wheel slot holding the timer */
+#endif
 #ifdef CONFIG_DEBUG_TRACING_KERNEL_OBJECTS
 	/*List all user allocated timers*/
 	struct k_timer *__next;
@@ -49,6 +53,7 @@ struct k_timer {
 #define _K_SVC_UNDEFINED				(NULL)
 
 #define _K_SVC_BLOCK_WAITERS_GET			_k_block_waiters_get
+#define _K_SVC_CMD_BATCH				_k_cmd_batch
 #define _K_SVC_DEFRAG					_k_defrag
 #define _K_SVC_MOVEDATA_REQ				_k_movedata_request
 #define _K_SVC_NOP					_k_nop
@@ -127,6 +132,11 @@ struct k_timer {
 #define _K_SVC_PIPE_GET_REPLY				_k_pipe_get_reply
 #define _K_SVC_PIPE_GET_ACK				_k_pipe_get_ack
 #define _K_SVC_PIPE_MOVEDATA_ACK			_k_pipe_movedata_ack
+#define _K_SVC_PIPE_PUT_RESERVE				_k_pipe_put_reserve
+#define _K_SVC_PIPE_PUT_IOV				_k_pipe_put_iov
+#define _K_SVC_PIPE_PUT_COMMIT				_k_pipe_put_commit
+#define _K_SVC_PIPE_GET_PEEK				_k_pipe_get_peek
+#define _K_SVC_PIPE_GET_CONSUME				_k_pipe_get_consume
 
 /* Task queue header */
 
@@ -212,6 +222,22 @@ struct _pipe_xfer_ack_arg {
 	int size; /* amount of data Xferred	    */
 };
 
+struct _pipe_iov_arg {
+	struct req_info req_info;
+	const struct k_pipe_iov *iov; /* segment holding the first byte */
+	int offset;          /* offset of the first byte in the segment */
+	int size;            /* amount of data to write */
+	int min_size;        /* write nothing unless this much fits */
+	int xferred_size;    /* amount of data written */
+};
+
+struct _pipe_span_arg {
+	struct req_info req_info;
+	unsigned char *data; /* start of the area in the pipe buffer */
+	int size;            /* requested, then actual size of the area */
+	int id;              /* ID of the registered buffer Xfer */
+};
+
 /* COMMAND PACKET STRUCTURES */
 
 typedef union {
@@ -225,6 +251,11 @@ struct _a1arg {
 	void **mptr;
 };
 
+struct _b1arg {
+	uint32_t *cmds;
+	int count;
+};
+
 struct _c1arg {
 	int64_t time1;
 	int64_t time2;
@@ -325,6 +356,7 @@ struct _u1arg {
 
 union k_args_args {
 	struct _a1arg a1;
+	struct _b1arg b1;
 	struct _c1arg c1;
 	struct moved_req moved_req;
 	struct _e1arg e1;
@@ -340,6 +372,8 @@ union k_args_args {
 	struct _pipe_xfer_ack_arg pipe_xfer_ack;
 	struct _pipe_req_arg pipe_req;
 	struct _pipe_ack_arg pipe_ack;
+	struct _pipe_span_arg pipe_span;
+	struct _pipe_iov_arg pipe_iov;
 };
 
 /*
@@ -377,9 +411,13 @@ struct k_args {
 /* ---------------------------------------------------------------------- */
 /* KERNEL OBJECT STRUCTURES */
 
+/*
+ * Status of a group of 4 sibling blocks: bit N is set while block N of the
+ * group is unavailable (allocated, split into smaller blocks, or not part
+ * of the pool).
+ */
 struct block_stat {
-	char *mem_blocks;
-	uint32_t mem_status;
+	uint8_t mem_status;
 };
 
 struct pool_block {
@@ -387,6 +425,7 @@ struct pool_block {
 	int nr_of_entries;
 	struct block_stat *blocktable;
 	int count;
+	uint32_t *free_map; /* bit set for each group with a free block */
 };
 
 struct pool_struct {
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Command batch kernel services
+ *
+ * The commands of a batch use the same encoding as the ones placed on the
+ * microkernel server's command stack by ISRs and fibers: the object pointer
+ * with the command type in its 2 least significant bits. The whole batch is
+ * then sent to the server in a single command packet.
+ */
+
+#include <microkernel.h>
+#include <toolchain.h>
+#include <sections.h>
+
+#include <micro_private.h>
+
+void task_cmd_batch_begin(struct k_cmd_batch *batch, uint32_t *buffer,
+			  int size)
+{
+	batch->cmds = buffer;
+	batch->size = size;
+	batch->count = 0;
+}
+
+/**
+ *
+ * @brief Append a command to a command batch
+ *
+ * @param batch Command batch
+ * @param cmd Encoded command
+ *
+ * @return RC_OK if the command was added, RC_FAIL if the batch is full
+ */
+static int _k_cmd_batch_add(struct k_cmd_batch *batch, uint32_t cmd)
+{
+	if (batch->count >= batch->size) {
+		return RC_FAIL;
+	}
+
+	batch->cmds[batch->count++] = cmd;
+	return RC_OK;
+}
+
+int task_cmd_batch_sem_give(struct k_cmd_batch *batch, ksem_t sema)
+{
+	return _k_cmd_batch_add(batch,
+				(uint32_t)sema | KERNEL_CMD_SEMAPHORE_TYPE);
+}
+
+int task_cmd_batch_event_send(struct k_cmd_batch *batch, kevent_t event)
+{
+	return _k_cmd_batch_add(batch,
+				(uint32_t)event | KERNEL_CMD_EVENT_TYPE);
+}
+
+void task_cmd_batch_commit(struct k_cmd_batch *batch)
+{
+	struct k_args A;
+
+	if (batch->count == 0) {
+		return;
+	}
+
+	A.Comm = _K_SVC_CMD_BATCH;
+	A.args.b1.cmds = batch->cmds;
+	A.args.b1.count = batch->count;
+	KERNEL_ENTRY(&A);
+
+	batch->count = 0;
+}
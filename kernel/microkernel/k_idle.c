@@ -364,11 +364,7 @@ void _sys_power_save_idle_exit(int32_t ticks)
  */
 static inline int32_t _get_next_timer_expiry(void)
 {
-	uint32_t closest_deadline = (uint32_t)TICKS_UNLIMITED;
-
-	if (_k_timer_list_head) {
-		closest_deadline = _k_timer_list_head->duration;
-	}
+	uint32_t closest_deadline = (uint32_t)_k_timer_next_expiry();
 
 	return (int32_t)min(closest_deadline, _nano_get_earliest_deadline());
 }
@@ -35,6 +35,21 @@
  */
 #define ISASYNCMSG(message) ((message)->tx_block.pool_id != 0)
 
+/*
+ * Special value of [extra] marking a block handoff message, for both the
+ * sender and the receiver side. It is never a valid semaphore.
+ */
+#define MBOX_HANDOFF ((ksem_t)-1)
+
+/**
+ *
+ * @brief Determines if mailbox message is part of a block handoff
+ *
+ * Returns a non-zero value if the message was sent by task_mbox_handoff_put()
+ * or is being received by task_mbox_handoff_get().
+ */
+#define ISHANDOFFMSG(message) ((message)->extra.sema == MBOX_HANDOFF)
+
 /**
  *
  * @brief Copy a packet
@@ -84,6 +99,8 @@ static int match(struct k_args *Reader, struct k_args *Writer)
 		} else {
 			Reader->args.m1.mess.tx_task =
 				Writer->args.m1.mess.tx_task;
+			Writer->args.m1.mess.rx_task =
+				Reader->args.m1.mess.rx_task;
 			Reader->args.m1.mess.tx_data = NULL;
 			Reader->args.m1.mess.tx_block =
 				Writer->args.m1.mess.tx_block;
@@ -157,8 +174,9 @@ static bool prepare_transfer(struct k_args *move,
 		/* reader: */
 		if (reader->args.m1.mess.rx_data == NULL) {
 			all_data_present = false;
-			__ASSERT_NO_MSG(0 == reader->args.m1.mess.extra
-					    .transfer); /* == extra.sema */
+			__ASSERT_NO_MSG((0 == reader->args.m1.mess.extra
+					     .transfer) || /* == extra.sema */
+					ISHANDOFFMSG(&reader->args.m1.mess));
 			reader->args.m1.mess.extra.transfer = move;
 			/*SENDARGS(reader); */
 		} else {
@@ -194,6 +212,26 @@ static bool prepare_transfer(struct k_args *move,
 	return 0; /* == don't care actually */
 }
 
+/**
+ * @brief Hand the block of a message over to its receiver
+ *
+ * Completes a match between a block handoff receiver and a sender that
+ * provided a memory pool block: the receiver gets the block itself and no
+ * data is moved.
+ *
+ * @return N/A
+ */
+static void handoff(struct k_args *reader, struct k_args *writer)
+{
+	prepare_transfer(NULL, reader, writer);
+
+	/* the block now belongs to the receiver; the sender must not free it */
+	writer->args.m1.mess.tx_block.pool_id = (uint32_t)(-1);
+
+	SENDARGS(reader);
+	SENDARGS(writer);
+}
+
 /**
  * @brief Do transfer
  *
@@ -217,7 +255,32 @@ void _k_mbox_send_ack(struct k_args *pCopyWriter)
 {
 	struct k_args *Starter;
 
-	if (ISASYNCMSG(&(pCopyWriter->args.m1.mess))) {
+	if (ISHANDOFFMSG(&(pCopyWriter->args.m1.mess))) {
+		/*
+		 * Once delivered, the block belongs to the receiver. Release
+		 * it if the receiver only copied its data out; when delivery
+		 * failed, it stays with the sender.
+		 */
+
+		if ((pCopyWriter->Time.rcode == RC_OK) &&
+		    (pCopyWriter->args.m1.mess.tx_block.pool_id !=
+		     (uint32_t)(-1))) {
+			struct k_args A;
+
+			A.alloc = false;
+			A.args.p1.pool_id =
+				pCopyWriter->args.m1.mess.tx_block.pool_id;
+			A.args.p1.rep_poolptr =
+				pCopyWriter->args.m1.mess.tx_block
+					.address_in_pool;
+			A.args.p1.rep_dataptr =
+				pCopyWriter->args.m1.mess.tx_block
+					.pointer_to_data;
+			A.args.p1.req_size =
+				pCopyWriter->args.m1.mess.tx_block.req_size;
+			_k_mem_pool_block_release(&A);
+		}
+	} else if (ISASYNCMSG(&(pCopyWriter->args.m1.mess))) {
 		if (pCopyWriter->args.m1.mess.extra.sema) {
 			/*
 			 * Signal the semaphore.  Alternatively, this could
@@ -307,7 +370,8 @@ void _k_mbox_send_request(struct k_args *Writer)
 	struct k_args *temp;
 	bool bAsync;
 
-	bAsync = ISASYNCMSG(&Writer->args.m1.mess);
+	bAsync = ISASYNCMSG(&Writer->args.m1.mess) &&
+		 !ISHANDOFFMSG(&Writer->args.m1.mess);
 
 	struct k_task *sender = NULL;
 
@@ -377,7 +441,11 @@ void _k_mbox_send_request(struct k_args *Writer)
 			}
 #endif
 
-			if (u32Size == 0) {
+			if (ISHANDOFFMSG(&CopyReader->args.m1.mess) &&
+			    ISASYNCMSG(&CopyWriter->args.m1.mess)) {
+				/* Block handoff--no data exchange */
+				handoff(CopyReader, CopyWriter);
+			} else if (u32Size == 0) {
 				/* No data exchange--header only */
 				prepare_transfer(NULL, CopyReader, CopyWriter);
 				SENDARGS(CopyReader);
@@ -584,7 +652,11 @@ void _k_mbox_receive_request(struct k_args *Reader)
 			}
 #endif
 
-			if (u32Size == 0) {
+			if (ISHANDOFFMSG(&CopyReader->args.m1.mess) &&
+			    ISASYNCMSG(&CopyWriter->args.m1.mess)) {
+				/* Block handoff--no data exchange */
+				handoff(CopyReader, CopyWriter);
+			} else if (u32Size == 0) {
 				/* No data exchange--header only */
 				prepare_transfer(NULL, CopyReader, CopyWriter);
 				SENDARGS(CopyReader);
@@ -673,6 +745,72 @@ int task_mbox_get(kmbox_t mbox, struct k_msg *M, int32_t timeout)
 }
 
 
+int task_mbox_handoff_put(kmbox_t mbox, kpriority_t prio, struct k_msg *M,
+			 int32_t timeout)
+{
+	struct k_args A;
+
+	__ASSERT((M->tx_block.pool_id != 0) &&
+		 (M->tx_block.pool_id != (uint32_t)(-1)),
+		 "Invalid mailbox block specification\n");
+
+	M->tx_task = _k_current_task->id;
+	M->tx_data = NULL;
+	M->extra.sema = MBOX_HANDOFF;
+	M->mailbox = mbox;
+
+	A.priority = prio;
+	A.Comm = _K_SVC_MBOX_SEND_REQUEST;
+	A.Time.ticks = timeout;
+	A.args.m1.mess = *M;
+
+	KERNEL_ENTRY(&A);
+
+	*M = A.args.m1.mess;
+	return A.Time.rcode;
+}
+
+int task_mbox_handoff_get(kmbox_t mbox, struct k_msg *M,
+			  struct k_block *block, kmemory_pool_t pool_id,
+			  int32_t timeout)
+{
+	struct k_args A;
+
+	M->rx_task = _k_current_task->id;
+	M->rx_data = NULL;
+	M->tx_block.pool_id = 0;
+	M->extra.sema = MBOX_HANDOFF;
+	M->mailbox = mbox;
+
+	A.priority = _k_current_task->priority;
+	A.Comm = _K_SVC_MBOX_RECEIVE_REQUEST;
+	A.Time.ticks = timeout;
+	A.args.m1.mess = *M;
+
+	KERNEL_ENTRY(&A);
+	*M = A.args.m1.mess;
+
+	if (A.Time.rcode != RC_OK) {
+		return A.Time.rcode;
+	}
+
+	if (!ISHANDOFFMSG(M)) {
+		/* the sender has no block to hand over: copy into a new one */
+		return task_mbox_data_block_get(M, block, pool_id, timeout);
+	}
+
+	M->extra.transfer = NULL;
+
+	if (ISASYNCMSG(M) && (M->tx_block.pool_id != (uint32_t)(-1))) {
+		*block = M->tx_block;
+	} else {
+		/* header only message */
+		block->pool_id = (kmemory_pool_t)-1;
+	}
+
+	return RC_OK;
+}
+
 void _task_mbox_block_put(kmbox_t mbox,
 		 kpriority_t prio,
 		 struct k_msg *M,
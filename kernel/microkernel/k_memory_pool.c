@@ -19,13 +19,43 @@
 #include <toolchain.h>
 #include <sections.h>
 
-/* Auto-Defrag settings */
+/*
+ * Each fragmentation level of a pool keeps the status of its blocks in
+ * groups of 4 siblings, where group N of a level holds the blocks obtained
+ * by splitting block N of the previous (larger) level. A group that is not
+ * in use at all is marked as 4 unavailable blocks. A bitmap per level flags
+ * the groups that contain a free block, so that a free block is found by
+ * scanning 32 groups at a time, and a block being released is located by
+ * its offset in the pool buffer rather than by searching for it.
+ *
+ * A released block is merged with its siblings as soon as all 4 of them are
+ * free, which makes explicit defragmentation unnecessary.
+ */
 
-#define AD_NONE 0
-#define AD_BEFORE_SEARCH4BIGGERBLOCK 1
-#define AD_AFTER_SEARCH4BIGGERBLOCK 2
+#define GROUP_FREE 0x0
+#define GROUP_FULL 0xF
+
+/**
+ *
+ * @brief Set the status of a group of blocks
+ *
+ * @param frag Fragmentation level
+ * @param group Index of the group in the level
+ * @param status New status of the group
+ *
+ * @return N/A
+ */
+static inline void group_status_set(struct pool_block *frag, int group,
+				    int status)
+{
+	frag->blocktable[group].mem_status = (uint8_t)status;
 
-#define AUTODEFRAG AD_AFTER_SEARCH4BIGGERBLOCK
+	if (status == GROUP_FULL) {
+		frag->free_map[group >> 5] &= ~(1U << (group & 0x1F));
+	} else {
+		frag->free_map[group >> 5] |= (1U << (group & 0x1F));
+	}
+}
 
 /**
  *
@@ -39,7 +69,7 @@ void _k_mem_pool_init(void)
 {
 	int i, j, k;
 	struct pool_struct *P;
-	char *memptr;
+	struct pool_block *frag;
 
 	/* for all pools initialise largest blocks */
 	for (i = 0, P = _k_mem_pool_list; i < _k_mem_pool_count; i++, P++) {
@@ -48,126 +78,28 @@ void _k_mem_pool_init(void)
 
 		/* initialise block-arrays */
 		for (k = 0; k < P->nr_of_frags; k++) {
-			P->frag_tab[k].count = 0;
-			for (j = 0; j < P->frag_tab[k].nr_of_entries; j++) {
-				P->frag_tab[k].blocktable[j].mem_blocks = NULL;
-				P->frag_tab[k].blocktable[j].mem_status =
-					0xF; /* all blocks in use */
+			frag = P->frag_tab + k;
+			frag->count = 0;
+			for (j = 0; j < frag->nr_of_entries; j++) {
+				frag->blocktable[j].mem_status =
+					GROUP_FULL; /* all blocks in use */
+			}
+			for (j = 0; j < (frag->nr_of_entries + 31) / 32; j++) {
+				frag->free_map[j] = 0;
 			}
 		}
 
-		memptr = P->bufblock;
-
+		frag = P->frag_tab;
 		while (remaining >= 4) { /* while not all blocks allocated */
-			/* - put pointer in table - */
-			P->frag_tab[0].blocktable[t].mem_blocks = memptr;
-			P->frag_tab[0].blocktable[t].mem_status =
-				0; /* all blocks initial free */
-
-			t++; /* next entry in table  */
+			group_status_set(frag, t++, GROUP_FREE);
 			remaining = remaining - 4;
-			memptr +=
-				OCTET_TO_SIZEOFUNIT(P->frag_tab[0].block_size) *
-				4;
 		}
 
 		if (remaining != 0) {
-
-			/* - put pointer in table - */
-			P->frag_tab[0].blocktable[t].mem_blocks = memptr;
-			P->frag_tab[0].blocktable[t].mem_status =
-				(0xF << remaining) &
-				0xF; /* mark unaccessible blocks as used */
-		}
-	}
-}
-
-/**
- *
- * @brief ???
- *
- * marks ptr as free block in the given list [MYSTERIOUS LEGACY COMMENT]
- *
- * @return N/A
- */
-static void search_bp(char *ptr, struct pool_struct *P, int index)
-{
-	int i = 0, j, block_found = 0;
-
-	while ((P->frag_tab[index].blocktable[i].mem_blocks != NULL) &&
-	       (!block_found)) {
-		for (j = 0; j < 4; j++) {
-			if (ptr ==
-			    ((P->frag_tab[index].blocktable[i].mem_blocks) +
-			     (OCTET_TO_SIZEOFUNIT(
-				     j * P->frag_tab[index].block_size)))) {
-				/* then we've found the right pointer */
-				block_found = 1;
-
-				/* so free it */
-				P->frag_tab[index].blocktable[i].mem_status =
-					P->frag_tab[index]
-						.blocktable[i]
-						.mem_status &
-					(~(1 << j));
-			}
+			/* mark unaccessible blocks as used */
+			group_status_set(frag, t, (GROUP_FULL << remaining) &
+					 GROUP_FULL);
 		}
-		i++;
-	}
-}
-
-/**
- *
- * @brief Defragmentation algorithm for memory pool
- *
- * @return N/A
- */
-static void defrag(struct pool_struct *P,
-				  int ifraglevel_start,
-				  int ifraglevel_stop)
-{
-	int i, j, k;
-
-	j = ifraglevel_start;
-
-	while (j > ifraglevel_stop) {
-		i = 0;
-		while (P->frag_tab[j].blocktable[i].mem_blocks != NULL) {
-			if ((P->frag_tab[j].blocktable[i].mem_status & 0xF) ==
-			    0) { /* blocks for defragmenting */
-				search_bp(
-					P->frag_tab[j].blocktable[i].mem_blocks,
-					P,
-					j - 1);
-
-				/* remove blocks & compact list */
-				k = i;
-				while ((P->frag_tab[j]
-						.blocktable[k]
-						.mem_blocks != NULL) &&
-				       (k <
-					(P->frag_tab[j].nr_of_entries - 1))) {
-					P->frag_tab[j]
-						.blocktable[k]
-						.mem_blocks =
-						P->frag_tab[j]
-							.blocktable[k + 1]
-							.mem_blocks;
-					P->frag_tab[j]
-						.blocktable[k]
-						.mem_status =
-						P->frag_tab[j]
-							.blocktable[k + 1]
-							.mem_status;
-					k++;
-				}
-				P->frag_tab[j].blocktable[k].mem_blocks = NULL;
-				P->frag_tab[j].blocktable[k].mem_status = 0;
-			} else {
-				i++; /* take next block */
-			}
-		}
-		j--;
 	}
 }
 
@@ -175,21 +107,19 @@ static void defrag(struct pool_struct *P,
  *
  * @brief Perform defragment memory pool request
  *
+ * Released blocks are merged with their siblings as soon as possible, so
+ * there is nothing left to defragment; tasks waiting for a block are given
+ * another chance to get one.
+ *
  * @return N/A
  */
 void _k_defrag(struct k_args *A)
 {
 	struct pool_struct *P = _k_mem_pool_list + OBJ_INDEX(A->args.p1.pool_id);
 
-	defrag(P,
-	       P->nr_of_frags - 1, /* start from smallest blocks */
-	       0		   /* and defragment till fragment level 0 */
-	       );
-
 	/* reschedule waiters */
 
-	if (
-		    P->waiters) {
+	if (P->waiters) {
 		struct k_args *NewGet;
 
 		/*
@@ -215,171 +145,98 @@ void task_mem_pool_defragment(kmemory_pool_t Pid)
 
 /**
  *
- * @brief Allocate block using specified fragmentation level
+ * @brief Compute the fragmentation level serving a request size
  *
- * This routine attempts to allocate a free block. [NEED TO EXPAND THIS]
+ * @param P Memory pool
+ * @param req_size Requested block size
  *
- * @return pointer to allocated block, or NULL if none available
+ * @return index in the fragmentation table, negative if the request is
+ * larger than the largest block
  */
-static char *search_block_on_frag_level(struct pool_block *pfraglevelinfo,
-						    int *piblockindex)
+static int frag_level_get(struct pool_struct *P, int req_size)
 {
-	int i, status, end_of_list;
-	char *found;
-
-	i = 0;
-	end_of_list = 0;
-	found = NULL;
+	int start_size = P->minblock_size;
+	int offset = P->nr_of_frags - 1;
 
-	while (!end_of_list) {/* search list */
-
-		if (pfraglevelinfo->blocktable[i].mem_blocks == NULL) {
-			end_of_list = 1;
-		} else {
-			status = pfraglevelinfo->blocktable[i].mem_status;
-			if (!(status & 1)) {
-				found = pfraglevelinfo->blocktable[i]
-						.mem_blocks;
-				pfraglevelinfo->blocktable[i].mem_status |=
-					1; /* set status used */
-#ifdef CONFIG_OBJECT_MONITOR
-				pfraglevelinfo->count++;
-#endif
-				break;
-			} else if (!(status & 2)) {
-				found = pfraglevelinfo->blocktable[i]
-						.mem_blocks +
-					(OCTET_TO_SIZEOFUNIT(
-						pfraglevelinfo->block_size));
-				pfraglevelinfo->blocktable[i].mem_status |=
-					2; /* set status used */
-#ifdef CONFIG_OBJECT_MONITOR
-				pfraglevelinfo->count++;
-#endif
-				break;
-			} else if (!(status & 4)) {
-				found = pfraglevelinfo->blocktable[i]
-						.mem_blocks +
-					(OCTET_TO_SIZEOFUNIT(
-						2 *
-						pfraglevelinfo->block_size));
-				pfraglevelinfo->blocktable[i].mem_status |=
-					4; /* set status used */
-#ifdef CONFIG_OBJECT_MONITOR
-				pfraglevelinfo->count++;
-#endif
-				break;
-			} else if (!(status & 8)) {
-				found = pfraglevelinfo->blocktable[i]
-						.mem_blocks +
-					(OCTET_TO_SIZEOFUNIT(
-						3 *
-						pfraglevelinfo->block_size));
-				pfraglevelinfo->blocktable[i].mem_status |=
-					8; /* set status used */
-#ifdef CONFIG_OBJECT_MONITOR
-				pfraglevelinfo->count++;
-#endif
-				break;
-			}
-
-			i++;
-			if (i >= pfraglevelinfo->nr_of_entries) {
-				end_of_list = 1;
-			}
-		}
-	} /* while (...) */
+	while (req_size > start_size) {
+		start_size = start_size << 2; /* try one larger */
+		offset--;
+	}
 
-	*piblockindex = i;
-	return found;
+	return offset;
 }
 
 /**
  *
  * @brief Recursively get a block, doing fragmentation if necessary
  *
- * @file
- * @brief Memory pool kernel services
+ * Takes the first free block of fragmentation level <index>. If the level
+ * has no free block, a block of the next larger size is allocated and split
+ * into 4 blocks of level <index>, the first of which is returned.
  *
- *
- * not implemented: check if we go below the minimal number of blocks with
- * the maximum size
- *
- * @return pointer to allocated block, or NULL if none available
+ * @return index of the allocated block in its level, or -1 if none available
  */
-static char *get_block_recusive(struct pool_struct *P, int index, int startindex)
+static int get_block_recursive(struct pool_struct *P, int index)
 {
-	int i;
-	char *found, *larger_block;
-	struct pool_block *fr_table;
+	struct pool_block *frag;
+	uint32_t *map;
+	int group, block, status, word;
 
 	if (index < 0) {
-		return NULL; /* no more free blocks in pool */
+		return -1; /* no more free blocks in pool */
 	}
 
-	fr_table = P->frag_tab;
-	i = 0;
+	frag = P->frag_tab + index;
+	map = frag->free_map;
 
-	/* let's inspect the fragmentation level <index> */
-	found = search_block_on_frag_level(&(fr_table[index]), &i);
-	if (found != NULL) {
-		return found;
-	}
+	for (word = 0; word < (frag->nr_of_entries + 31) / 32; word++) {
+		if (map[word] != 0) {
+			group = (word << 5) + find_lsb_set(map[word]) - 1;
+			status = frag->blocktable[group].mem_status;
 
-#if AUTODEFRAG == AD_BEFORE_SEARCH4BIGGERBLOCK
-	/* maybe a partial defrag will free up a block? */
-	if (index == startindex) { /* only for the original request */
-		defrag(P,
-		       P->nr_of_frags - 1, /* start from the smallest blocks */
-		       startindex); /* but only until the requested blocksize
-				     * (fragmentation level) !!
-				     */
-
-		found = search_block_on_frag_level(&(fr_table[index]), &i);
-		if (found != NULL) {
-			return found;
+			/* take the first free block of the group */
+			block = find_lsb_set(~status & GROUP_FULL) - 1;
+			group_status_set(frag, group, status | (1 << block));
+#ifdef CONFIG_OBJECT_MONITOR
+			frag->count++;
+#endif
+			return (group << 2) + block;
 		}
 	}
-	/* partial defrag did not release a block of level <index> */
-#endif
 
-	/* end of list and i is index of first empty entry in blocktable */
-	{
-		/* get a block of one size larger */
-		larger_block = get_block_recusive(
-			P, index - 1, startindex);
+	/* get a block of one size larger and split it */
+	group = get_block_recursive(P, index - 1);
+	if (group < 0) {
+		return -1; /* no block available */
 	}
 
-	if (larger_block != NULL) {
-		/* insert 4 found blocks and mark one block as used */
-		fr_table[index].blocktable[i].mem_blocks = larger_block;
-		fr_table[index].blocktable[i].mem_status = 1;
+	group_status_set(frag, group, 0x1);
 #ifdef CONFIG_OBJECT_MONITOR
-		fr_table[index].count++;
+	frag->count++;
 #endif
-		return larger_block; /* return marked block */
-	}
-
-	/* trying to get a larger block did not succeed */
+	return group << 2;
+}
 
-#if AUTODEFRAG == AD_AFTER_SEARCH4BIGGERBLOCK
-	/* maybe a partial defrag will free up a block? */
-	if (index == startindex) { /* only for the original request */
-		defrag(P,
-		       P->nr_of_frags - 1, /* start from the smallest blocks */
-		       startindex); /* but only until the requested blocksize
-				     * (fragmentation level) !!
-				     */
+/**
+ *
+ * @brief Allocate a block of a memory pool
+ *
+ * @param P Memory pool
+ * @param req_size Requested block size
+ *
+ * @return pointer to allocated block, or NULL if none available
+ */
+static char *get_block(struct pool_struct *P, int req_size)
+{
+	int offset = frag_level_get(P, req_size);
+	int block = get_block_recursive(P, offset);
 
-		found = search_block_on_frag_level(&(fr_table[index]), &i);
-		if (found != NULL) {
-			return found;
-		}
+	if (block < 0) {
+		return NULL;
 	}
-   /* partial defrag did not release a block of level <index> */
-#endif
 
-	return NULL; /* now we have to report failure: no block available */
+	return P->bufblock +
+	       OCTET_TO_SIZEOFUNIT(block * P->frag_tab[offset].block_size);
 }
 
 /**
@@ -398,7 +255,6 @@ void _k_block_waiters_get(struct k_args *A)
 	struct pool_struct *P = _k_mem_pool_list + OBJ_INDEX(A->args.p1.pool_id);
 	char *found_block;
 	struct k_args *curr_task, *prev_task;
-	int start_size, offset;
 
 	curr_task = P->waiters;
 	/* forw is first field in struct */
@@ -407,17 +263,8 @@ void _k_block_waiters_get(struct k_args *A)
 	/* loop all waiters */
 	while (curr_task != NULL) {
 
-		/* calculate size & offset */
-		start_size = P->minblock_size;
-		offset = P->nr_of_frags - 1;
-		while (curr_task->args.p1.req_size > start_size) {
-			start_size = start_size << 2; /* try one larger */
-			offset--;
-		}
-
 		/* allocate block */
-		found_block = get_block_recusive(
-			P, offset, offset); /* allocate and fragment blocks */
+		found_block = get_block(P, curr_task->args.p1.req_size);
 
 		/* if success : remove task from list and reschedule */
 		if (found_block != NULL) {
@@ -477,23 +324,7 @@ void _k_mem_pool_block_get(struct k_args *A)
 	struct pool_struct *P = _k_mem_pool_list + OBJ_INDEX(A->args.p1.pool_id);
 	char *found_block;
 
-	int start_size;
-	int offset;
-
-	/* calculate start size */
-	start_size = P->minblock_size;
-	offset = P->nr_of_frags - 1;
-
-	while (A->args.p1.req_size > start_size) {
-		start_size = start_size << 2; /*try one larger */
-		offset--;
-	}
-
-	/* startsize==the available size that can contain the requeste block size */
-	/* offset: index in fragtable of the minimal blocksize */
-
-	found_block =
-		get_block_recusive(P, offset, offset); /* allocate and fragment blocks */
+	found_block = get_block(P, A->args.p1.req_size);
 
 	if (found_block != NULL) {
 		A->args.p1.rep_poolptr = found_block;
@@ -628,6 +459,56 @@ void *task_malloc(uint32_t size)
 	return ++aligned_addr;
 }
 
+/**
+ *
+ * @brief Release a block of a memory pool
+ *
+ * The block is located from its offset in the pool buffer, and merged with
+ * its siblings into a larger block when all of them are free.
+ *
+ * @param P Memory pool
+ * @param req_size Size requested when the block was allocated
+ * @param ptr Address of the block
+ *
+ * @return 0 if the block was released, -1 if it does not belong to the pool
+ */
+static int put_block(struct pool_struct *P, int req_size, char *ptr)
+{
+	int offset = frag_level_get(P, req_size);
+	struct pool_block *frag;
+	int block, group, status;
+
+	if ((offset < 0) || (ptr < P->bufblock)) {
+		return -1;
+	}
+
+	frag = P->frag_tab + offset;
+	block = SIZEOFUNIT_TO_OCTET(ptr - P->bufblock) / frag->block_size;
+
+	if ((block >= (frag->nr_of_entries << 2)) ||
+	    (ptr != P->bufblock +
+		    OCTET_TO_SIZEOFUNIT(block * frag->block_size))) {
+		return -1;
+	}
+
+	for (;;) {
+		group = block >> 2;
+		status = frag->blocktable[group].mem_status;
+		status &= ~(1 << (block & 3));
+
+		if ((status != GROUP_FREE) || (offset == 0)) {
+			group_status_set(frag, group, status);
+			return 0;
+		}
+
+		/* the group is no longer in use: free its parent block */
+		group_status_set(frag, group, GROUP_FULL);
+		block = group;
+		frag--;
+		offset--;
+	}
+}
+
 /**
  *
  * @brief Perform return memory pool block request
@@ -640,62 +521,24 @@ void *task_malloc(uint32_t size)
 void _k_mem_pool_block_release(struct k_args *A)
 {
 	struct pool_struct *P;
-	struct pool_block *block;
-	struct block_stat *blockstat;
-	int Pid;
-	int start_size, offset;
-	int i, j;
-
-	Pid = A->args.p1.pool_id;
-
-
-	P = _k_mem_pool_list + OBJ_INDEX(Pid);
 
-	/* calculate size */
-	start_size = P->minblock_size;
-	offset = P->nr_of_frags - 1;
+	P = _k_mem_pool_list + OBJ_INDEX(A->args.p1.pool_id);
 
-	while (A->args.p1.req_size > start_size) {
-		start_size = start_size << 2; /* try one larger */
-		offset--;
+	if ((put_block(P, A->args.p1.req_size, A->args.p1.rep_poolptr) == 0) &&
+	    (P->waiters != NULL)) {
+		struct k_args *NewGet;
+		/*
+		 * get new command packet that calls the function that
+		 * reallocate blocks for the waiting tasks
+		 */
+		GETARGS(NewGet);
+		*NewGet = *A;
+		NewGet->Comm = _K_SVC_BLOCK_WAITERS_GET;
+		/* push on command stack */
+		TO_ALIST(&_k_command_stack, NewGet);
 	}
-
-	/* startsize==the available size that contains the requested block size */
-	/* offset: index in fragtable of the block */
-
-	j = 0;
-	block = P->frag_tab + offset;
-
-	while ((j < block->nr_of_entries) &&
-	       ((blockstat = block->blocktable + j)->mem_blocks != 0)) {
-		for (i = 0; i < 4; i++) {
-			if (A->args.p1.rep_poolptr ==
-			    (blockstat->mem_blocks +
-			     (OCTET_TO_SIZEOFUNIT(i * block->block_size)))) {
-				/* we've found the right pointer, so free it */
-				blockstat->mem_status &= ~(1 << i);
-
-				/* waiters? */
-				if (P->waiters != NULL) {
-					struct k_args *NewGet;
-					/*
-					 * get new command packet that calls
-					 * the function that reallocate blocks
-					 * for the waiting tasks
-					 */
-					GETARGS(NewGet);
-					*NewGet = *A;
-					NewGet->Comm = _K_SVC_BLOCK_WAITERS_GET;
-					/* push on command stack */
-					TO_ALIST(&_k_command_stack, NewGet);
-				}
-				if (A->alloc) {
-					FREEARGS(A);
-				}
-				return;
-			}
-		}
-		j++;
+	if (A->alloc) {
+		FREEARGS(A);
 	}
 }
 
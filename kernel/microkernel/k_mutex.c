@@ -261,10 +261,96 @@ void _k_mutex_lock_request(struct k_args *A /* pointer to mutex lock
 	}
 }
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+/**
+ * @brief Lock an unowned or already owned mutex without involving the server
+ *
+ * Tasks only run while the microkernel server is idle, so locking interrupts
+ * is enough to keep the mutex consistent with the requests of other tasks.
+ *
+ * @param Mutex pointer to internal mutex structure
+ *
+ * @return 1 if the mutex was locked, 0 if the server must handle the request
+ */
+static inline int _k_mutex_fast_lock(struct _k_mutex_struct *Mutex)
+{
+	unsigned int key = irq_lock();
+
+	if (Mutex->level != 0 && Mutex->owner != _k_current_task->id) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	/*
+	 * As in _k_mutex_lock_request(), a nested lock also refreshes the
+	 * current owner priority, which may have changed since the mutex was
+	 * first locked.
+	 */
+	Mutex->owner = _k_current_task->id;
+	Mutex->current_owner_priority = _k_current_task->priority;
+	if (Mutex->level == 0) {
+		Mutex->original_owner_priority = Mutex->current_owner_priority;
+	}
+
+#ifdef CONFIG_OBJECT_MONITOR
+	Mutex->count++;
+#endif
+	Mutex->level++;
+	irq_unlock(key);
+
+	return 1;
+}
+
+/**
+ * @brief Unlock a mutex without involving the server
+ *
+ * Only handles nested unlocks and final unlocks of a mutex that has no
+ * waiters and is not involved in priority inheritance.
+ *
+ * @param Mutex pointer to internal mutex structure
+ *
+ * @return 1 if the mutex was unlocked, 0 if the server must handle the request
+ */
+static inline int _k_mutex_fast_unlock(struct _k_mutex_struct *Mutex)
+{
+	unsigned int key = irq_lock();
+
+	if (Mutex->owner != _k_current_task->id) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	if (Mutex->level > 1) {
+		Mutex->level--;
+	} else if (Mutex->waiters == NULL &&
+		   Mutex->current_owner_priority ==
+		   Mutex->original_owner_priority) {
+#ifdef CONFIG_OBJECT_MONITOR
+		Mutex->count++;
+#endif
+		Mutex->owner = ANYTASK;
+		Mutex->level = 0;
+	} else {
+		irq_unlock(key);
+		return 0;
+	}
+
+	irq_unlock(key);
+
+	return 1;
+}
+#endif /* CONFIG_MICROKERNEL_FAST_PATH */
+
 int task_mutex_lock(kmutex_t mutex, int32_t timeout)
 {
 	struct k_args A; /* argument packet */
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+	if (_k_mutex_fast_lock((struct _k_mutex_struct *)mutex)) {
+		return RC_OK;
+	}
+#endif
+
 	A.Comm = _K_SVC_MUTEX_LOCK_REQUEST;
 	A.Time.ticks = timeout;
 	A.args.l1.mutex = mutex;
@@ -377,6 +463,12 @@ void _task_mutex_unlock(kmutex_t mutex)
 {
 	struct k_args A; /* argument packet */
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+	if (_k_mutex_fast_unlock((struct _k_mutex_struct *)mutex)) {
+		return;
+	}
+#endif
+
 	A.Comm = _K_SVC_MUTEX_UNLOCK;
 	A.args.l1.mutex = mutex;
 	A.args.l1.task = _k_current_task->id;
@@ -24,6 +24,8 @@
 #include <k_pipe_util.h>
 #include <microkernel/pipe.h>
 #include <misc/util.h>
+#include <misc/__assert.h>
+#include <string.h>
 
 extern kpipe_t _k_pipe_ptr_start[];
 extern kpipe_t _k_pipe_ptr_end[];
@@ -184,3 +186,159 @@ int _task_pipe_block_put(kpipe_t Id, struct k_block Block,
 	KERNEL_ENTRY(&A);
 	return RC_OK;
 }
+
+/**
+ * @brief Write segments to a pipe buffer without waiting
+ *
+ * @param id Pipe ID.
+ * @param iov Segment holding the first byte to write.
+ * @param offset Offset of the first byte in the segment.
+ * @param size Number of bytes to write.
+ * @param min_size Write nothing unless at least this many bytes fit.
+ *
+ * @return Number of bytes written
+ */
+static int pipe_put_iov(kpipe_t id, const struct k_pipe_iov *iov, int offset,
+			int size, int min_size)
+{
+	struct k_args A;
+
+	A.Comm = _K_SVC_PIPE_PUT_IOV;
+	A.args.pipe_iov.req_info.pipe.id = id;
+	A.args.pipe_iov.iov = iov;
+	A.args.pipe_iov.offset = offset;
+	A.args.pipe_iov.size = size;
+	A.args.pipe_iov.min_size = min_size;
+
+	KERNEL_ENTRY(&A);
+
+	return A.args.pipe_iov.xferred_size;
+}
+
+int task_pipe_put_iov(kpipe_t id, const struct k_pipe_iov *iov, int iovcnt,
+		      int *bytes_written, K_PIPE_OPTION options,
+		      int32_t timeout)
+{
+	int total_size = 0;
+	int offset = 0;
+	int written;
+	int rc = RC_FAIL;
+	int i;
+
+	*bytes_written = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (unlikely(iov[i].size % SIZEOFUNIT_TO_OCTET(1))) {
+			return RC_ALIGNMENT;
+		}
+		total_size += iov[i].size;
+	}
+	if (unlikely(total_size == 0)) {
+		return RC_FAIL;
+	}
+	if (unlikely(options == _0_TO_N && timeout != TICKS_NONE)) {
+		return RC_FAIL;
+	}
+
+	/* without waiting, an _ALL_N request writes everything or nothing */
+	written = pipe_put_iov(id, iov, 0, total_size,
+			       (options == _ALL_N && timeout == TICKS_NONE) ?
+			       total_size : 1);
+	*bytes_written = written;
+
+	while ((*bytes_written < total_size) && (timeout != TICKS_NONE) &&
+	       ((*bytes_written == 0) || (options == _ALL_N))) {
+		/* find the first byte not written yet */
+		offset += written;
+		while (offset >= iov->size) {
+			offset -= iov->size;
+			iov++;
+		}
+
+		if (written == 0) {
+			/* no room: wait while writing the rest of the segment */
+			rc = task_pipe_put(id,
+					   (unsigned char *)iov->data + offset,
+					   iov->size - offset, &written,
+					   _1_TO_N, timeout);
+			if ((rc != RC_OK) || (written == 0)) {
+				*bytes_written += written;
+				break;
+			}
+		} else {
+			/* then copy as much as possible without waiting */
+			written = pipe_put_iov(id, iov, offset,
+					       total_size - *bytes_written, 1);
+		}
+		*bytes_written += written;
+	}
+
+	if (*bytes_written == total_size) {
+		return RC_OK;
+	} else if (*bytes_written != 0) {
+		return (options == _ALL_N) ? RC_INCOMPLETE : RC_OK;
+	} else if (options == _0_TO_N) {
+		return RC_OK;
+	}
+	return (rc == RC_TIME) ? RC_TIME : RC_FAIL;
+}
+
+int task_pipe_put_reserve(kpipe_t id, struct k_pipe_span *span, int size)
+{
+	struct k_args A;
+
+	A.Comm = _K_SVC_PIPE_PUT_RESERVE;
+	A.args.pipe_span.req_info.pipe.id = id;
+	A.args.pipe_span.size = size;
+
+	KERNEL_ENTRY(&A);
+
+	span->data = A.args.pipe_span.data;
+	span->size = A.args.pipe_span.size;
+	span->id = A.args.pipe_span.id;
+	return A.Time.rcode;
+}
+
+void task_pipe_put_commit(kpipe_t id, struct k_pipe_span *span)
+{
+	struct k_args A;
+
+	__ASSERT(span->size > 0, "Invalid pipe area\n");
+
+	A.Comm = _K_SVC_PIPE_PUT_COMMIT;
+	A.args.pipe_span.req_info.pipe.id = id;
+	A.args.pipe_span.size = span->size;
+	A.args.pipe_span.id = span->id;
+
+	KERNEL_ENTRY(&A);
+}
+
+int task_pipe_get_peek(kpipe_t id, struct k_pipe_span *span, int size)
+{
+	struct k_args A;
+
+	A.Comm = _K_SVC_PIPE_GET_PEEK;
+	A.args.pipe_span.req_info.pipe.id = id;
+	A.args.pipe_span.size = size;
+
+	KERNEL_ENTRY(&A);
+
+	span->data = A.args.pipe_span.data;
+	span->size = A.args.pipe_span.size;
+	span->id = A.args.pipe_span.id;
+	return A.Time.rcode;
+}
+
+void task_pipe_get_consume(kpipe_t id, struct k_pipe_span *span)
+{
+	struct k_args A;
+
+	__ASSERT(span->size > 0, "Invalid pipe area\n");
+
+	A.Comm = _K_SVC_PIPE_GET_CONSUME;
+	A.args.pipe_span.req_info.pipe.id = id;
+	A.args.pipe_span.size = span->size;
+	A.args.pipe_span.id = span->id;
+
+	KERNEL_ENTRY(&A);
+}
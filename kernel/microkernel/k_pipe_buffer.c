@@ -23,6 +23,7 @@
  */
 
 #include <microkernel/base_api.h>
+#include <arch/cpu.h>
 #include <k_pipe_buffer.h>
 #include <string.h>
 #include <toolchain.h>
@@ -55,21 +56,13 @@ static void pipe_intrusion_check(struct _k_pipe_desc *desc,
  * Markers
  */
 
-static int MarkerFindFree(struct _k_pipe_marker markers[])
-{
-	struct _k_pipe_marker *pM = markers;
-	int i;
+#define ALL_MARKERS ((1U << MAXNBR_PIPE_MARKERS) - 1)
 
-	for (i = 0; i < MAXNBR_PIPE_MARKERS; i++, pM++) {
-		if (pM->pointer == NULL) {
-			break;
-		}
-	}
-	if (i == MAXNBR_PIPE_MARKERS) {
-		i = -1;
-	}
+static int MarkerFindFree(struct _k_pipe_marker_list *pMarkerList)
+{
+	uint32_t free_markers = ~pMarkerList->used_markers & ALL_MARKERS;
 
-	return i;
+	return free_markers ? (int)find_lsb_set(free_markers) - 1 : -1;
 }
 
 static void MarkerLinkToListAfter(struct _k_pipe_marker markers[],
@@ -101,12 +94,14 @@ static int MarkerAddLast(struct _k_pipe_marker_list *pMarkerList,
 			 int size,
 			 bool buffer_xfer_busy)
 {
-	int i = MarkerFindFree(pMarkerList->markers);
+	int i = MarkerFindFree(pMarkerList);
 
 	if (i == -1) {
 		return i;
 	}
 
+	pMarkerList->used_markers |= (1U << i);
+
 	pMarkerList->markers[i].pointer = pointer;
 	pMarkerList->markers[i].size = size;
 	pMarkerList->markers[i].buffer_xfer_busy = buffer_xfer_busy;
@@ -167,6 +162,7 @@ static void MarkerDelete(struct _k_pipe_marker_list *pMarkerList, int index)
 	__ASSERT_NO_MSG(i != -1);
 
 	pMarkerList->markers[i].pointer = NULL;
+	pMarkerList->used_markers &= ~(1U << i);
 	MarkerUnlinkFromList(pMarkerList->markers, i,
 			     &iPredecessor, &iSuccessor);
 
@@ -205,6 +201,7 @@ static void MarkersClear(struct _k_pipe_marker_list *pMarkerList)
 	pMarkerList->first_marker = -1;
 	pMarkerList->last_marker = -1;
 	pMarkerList->post_wrap_around_marker = -1;
+	pMarkerList->used_markers = 0;
 }
 
 /**/
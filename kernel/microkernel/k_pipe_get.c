@@ -17,10 +17,12 @@
  */
 
 #include <micro_private.h>
+#include <k_pipe_buffer.h>
 #include <k_pipe_util.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <misc/__assert.h>
+#include <misc/util.h>
 
 /**
  *
@@ -260,3 +262,50 @@ void _k_pipe_get_ack(struct k_args *Request)
 
 	FREEARGS(Request);
 }
+
+/**
+ *
+ * @brief Process peek command for a pipe get operation
+ *
+ * Registers a read of up to the requested size at the read pointer of the
+ * pipe buffer, limited to the contiguous data available. Writers cannot
+ * overwrite the area until it is consumed. Nothing is returned while readers
+ * are waiting, so that they get the data first.
+ *
+ * @return N/A
+ */
+void _k_pipe_get_peek(struct k_args *A)
+{
+	struct _pipe_span_arg *span = &A->args.pipe_span;
+	struct _k_pipe_struct *pipe_ptr =
+		(struct _k_pipe_struct *)span->req_info.pipe.id;
+	int size = min(span->size, pipe_ptr->desc.available_data_count);
+
+	if ((pipe_ptr->readers == NULL) && (size > 0) &&
+	    (BuffDeQA(&pipe_ptr->desc, size, &span->data, &span->id) != 0)) {
+		span->size = size;
+		A->Time.rcode = RC_OK;
+	} else {
+		span->size = 0;
+		A->Time.rcode = RC_FAIL;
+	}
+}
+
+/**
+ *
+ * @brief Process consume command for a pipe get operation
+ *
+ * Releases an area returned by a peek command to writers, and serves the
+ * writers waiting for free space.
+ *
+ * @return N/A
+ */
+void _k_pipe_get_consume(struct k_args *A)
+{
+	struct _pipe_span_arg *span = &A->args.pipe_span;
+	struct _k_pipe_struct *pipe_ptr =
+		(struct _k_pipe_struct *)span->req_info.pipe.id;
+
+	BuffDeQA_End(&pipe_ptr->desc, span->id, span->size);
+	_k_pipe_process(pipe_ptr, NULL, NULL);
+}
@@ -17,10 +17,14 @@
  */
 
 #include <micro_private.h>
+#include <k_pipe_buffer.h>
 #include <k_pipe_util.h>
+#include <microkernel/pipe.h>
 #include <toolchain.h>
 #include <sections.h>
 #include <misc/__assert.h>
+#include <misc/util.h>
+#include <string.h>
 
 
 /**
@@ -305,3 +309,120 @@ void _k_pipe_put_ack(struct k_args *Request)
 
 	FREEARGS(Request);
 }
+
+/**
+ *
+ * @brief Process scatter-gather command for a pipe put operation
+ *
+ * Copies the segments into the free space of the pipe buffer, wrapping around
+ * its end if needed. Nothing is written unless the minimum size fits, or
+ * while writers are waiting, so that data keeps its order. As the kernel
+ * server handles the whole command, the data is never interleaved with the
+ * data of other writers.
+ *
+ * @return N/A
+ */
+void _k_pipe_put_iov(struct k_args *A)
+{
+	struct _pipe_iov_arg *req = &A->args.pipe_iov;
+	struct _k_pipe_struct *pipe_ptr =
+		(struct _k_pipe_struct *)req->req_info.pipe.id;
+	const struct k_pipe_iov *iov = req->iov;
+	int offset = req->offset;
+	unsigned char *write_ptr;
+	int free_space;
+	int size;
+	int left;
+	int chunk;
+	int id;
+	int n;
+
+	req->xferred_size = 0;
+
+	BuffGetFreeSpaceTotal(&pipe_ptr->desc, &free_space);
+	size = min(req->size, free_space);
+	if ((pipe_ptr->writers != NULL) || (size == 0) ||
+	    (size < req->min_size)) {
+		A->Time.rcode = RC_FAIL;
+		return;
+	}
+
+	while (size > 0) {
+		/* at most two areas: up to the end of the buffer, then after */
+		n = min(size, pipe_ptr->desc.free_space_count);
+		if (BuffEnQA(&pipe_ptr->desc, n, &write_ptr, &id) == 0) {
+			break;
+		}
+
+		size -= n;
+		req->xferred_size += n;
+		for (left = n; left > 0; left -= chunk) {
+			chunk = min(iov->size - offset, left);
+			memcpy(write_ptr, (unsigned char *)iov->data + offset,
+			       chunk);
+			write_ptr += chunk;
+			offset += chunk;
+			if (offset == iov->size) {
+				iov++;
+				offset = 0;
+			}
+		}
+
+		BuffEnQA_End(&pipe_ptr->desc, id, n);
+	}
+
+	if (req->xferred_size == 0) {
+		A->Time.rcode = RC_FAIL;
+		return;
+	}
+
+	A->Time.rcode = RC_OK;
+	_k_pipe_process(pipe_ptr, NULL, NULL);
+}
+
+/**
+ *
+ * @brief Process reserve command for a pipe put operation
+ *
+ * Registers a write of up to the requested size at the write pointer of the
+ * pipe buffer, limited to the contiguous free space. Readers cannot get past
+ * the reserved area until it is committed. Nothing is reserved while
+ * writers are waiting, so that data keeps its order.
+ *
+ * @return N/A
+ */
+void _k_pipe_put_reserve(struct k_args *A)
+{
+	struct _pipe_span_arg *span = &A->args.pipe_span;
+	struct _k_pipe_struct *pipe_ptr =
+		(struct _k_pipe_struct *)span->req_info.pipe.id;
+	int size = min(span->size, pipe_ptr->desc.free_space_count);
+
+	if ((pipe_ptr->writers == NULL) && (size > 0) &&
+	    (BuffEnQA(&pipe_ptr->desc, size, &span->data, &span->id) != 0)) {
+		span->size = size;
+		A->Time.rcode = RC_OK;
+	} else {
+		span->size = 0;
+		A->Time.rcode = RC_FAIL;
+	}
+}
+
+/**
+ *
+ * @brief Process commit command for a pipe put operation
+ *
+ * Makes the data written into a reserved area available to readers, and
+ * serves the readers waiting for it.
+ *
+ * @return N/A
+ */
+void _k_pipe_put_commit(struct k_args *A)
+{
+	struct _pipe_span_arg *span = &A->args.pipe_span;
+	struct _k_pipe_struct *pipe_ptr =
+		(struct _k_pipe_struct *)span->req_info.pipe.id;
+
+	BuffEnQA_End(&pipe_ptr->desc, span->id, span->size);
+	_k_pipe_process(pipe_ptr, NULL, NULL);
+}
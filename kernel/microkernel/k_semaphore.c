@@ -25,6 +25,7 @@
 #include <sections.h>
 
 #include <micro_private.h>
+#include <atomic.h>
 
 /**
  *
@@ -349,10 +350,76 @@ void _k_sem_wait_request(struct k_args *A)
 	}
 }
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+/**
+ *
+ * @brief Take an available semaphore without involving the server
+ *
+ * Tasks only run while the microkernel server is idle, so the server never
+ * sees a partial update. The compare-and-swap protects against another task
+ * taking the semaphore while the caller is preempted.
+ *
+ * @param S Semaphore structure
+ *
+ * @return 1 if the semaphore was taken, 0 if the server must handle the
+ * request
+ */
+static inline int _k_sem_fast_take(struct _k_sem_struct *S)
+{
+	atomic_val_t level;
+
+	do {
+		level = S->level;
+		if (level <= 0) {
+			return 0;
+		}
+	} while (!atomic_cas((atomic_t *)&S->level, level, level - 1));
+
+	return 1;
+}
+
+/**
+ *
+ * @brief Give a semaphore nobody waits on without involving the server
+ *
+ * Checking for waiters and updating the level must not be separated by a
+ * request from another task being queued, hence the interrupt lock rather
+ * than a compare-and-swap.
+ *
+ * @param S Semaphore structure
+ *
+ * @return 1 if the semaphore was given, 0 if the server must handle the
+ * request
+ */
+static inline int _k_sem_fast_give(struct _k_sem_struct *S)
+{
+	unsigned int key = irq_lock();
+
+	if (S->waiters != NULL) {
+		irq_unlock(key);
+		return 0;
+	}
+
+#ifdef CONFIG_OBJECT_MONITOR
+	S->count++;
+#endif
+	S->level++;
+	irq_unlock(key);
+
+	return 1;
+}
+#endif /* CONFIG_MICROKERNEL_FAST_PATH */
+
 int task_sem_take(ksem_t sema, int32_t timeout)
 {
 	struct k_args A;
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+	if (_k_sem_fast_take((struct _k_sem_struct *)sema)) {
+		return RC_OK;
+	}
+#endif
+
 	A.Comm = _K_SVC_SEM_WAIT_REQUEST;
 	A.Time.ticks = timeout;
 	A.args.s1.sema = sema;
@@ -393,6 +460,12 @@ void task_sem_give(ksem_t sema)
 {
 	struct k_args A;
 
+#ifdef CONFIG_MICROKERNEL_FAST_PATH
+	if (_k_sem_fast_give((struct _k_sem_struct *)sema)) {
+		return;
+	}
+#endif
+
 	A.Comm = _K_SVC_SEM_SIGNAL;
 	A.args.s1.sema = sema;
 	KERNEL_ENTRY(&A);
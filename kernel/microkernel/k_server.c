@@ -70,6 +70,75 @@ static struct k_task *next_task_select(void)
 	return _k_task_priority_list[K_PrioListIdx].head;
 }
 
+/**
+ *
+ * @brief Execute a command taken from the command stack
+ *
+ * @param pArgs Command packet, or event/semaphore and command type bits
+ *
+ * @return N/A
+ */
+static ALWAYS_INLINE void _k_cmd_execute(struct k_args *pArgs)
+{
+	int cmd_type = (int)pArgs & KERNEL_CMD_TYPE_MASK;
+
+	if (cmd_type == KERNEL_CMD_PACKET_TYPE) {
+
+		/* process command packet */
+
+#ifdef CONFIG_TASK_MONITOR
+		if (_k_monitor_mask & MON_KSERV) {
+			_k_task_monitor_args(pArgs);
+		}
+#endif
+		(*pArgs->Comm)(pArgs);
+	} else if (cmd_type == KERNEL_CMD_EVENT_TYPE) {
+
+		/* give event */
+
+#ifdef CONFIG_TASK_MONITOR
+		if (_k_monitor_mask & MON_EVENT) {
+			_k_task_monitor_args(pArgs);
+		}
+#endif
+		kevent_t event = (int)pArgs & ~KERNEL_CMD_TYPE_MASK;
+
+		_k_do_event_signal(event);
+	} else { /* cmd_type == KERNEL_CMD_SEMAPHORE_TYPE */
+
+		/* give semaphore */
+
+#ifdef CONFIG_TASK_MONITOR
+		/* task monitoring for giving semaphore not implemented */
+#endif
+		ksem_t sem = (int)pArgs & ~KERNEL_CMD_TYPE_MASK;
+
+		_k_sem_struct_value_update(1, (struct _k_sem_struct *)sem);
+	}
+}
+
+/**
+ *
+ * @brief Perform command batch request
+ *
+ * Executes the commands of a batch in order, without giving other fibers a
+ * chance to run in between. The next task to run is only selected once the
+ * whole batch has been processed.
+ *
+ * @param A Command packet describing the batch
+ *
+ * @return N/A
+ */
+void _k_cmd_batch(struct k_args *A)
+{
+	uint32_t *cmd = A->args.b1.cmds;
+	int i;
+
+	for (i = 0; i < A->args.b1.count; i++) {
+		_k_cmd_execute((struct k_args *)cmd[i]);
+	}
+}
+
 /**
  *
  * @brief The microkernel thread entry point
@@ -98,41 +167,7 @@ FUNC_NORETURN void _k_server(int unused1, int unused2)
 		(void) nano_fiber_stack_pop(&_k_command_stack, (uint32_t *)&pArgs,
 				TICKS_UNLIMITED); /* will schedule */
 		do {
-			int cmd_type = (int)pArgs & KERNEL_CMD_TYPE_MASK;
-
-			if (cmd_type == KERNEL_CMD_PACKET_TYPE) {
-
-				/* process command packet */
-
-#ifdef CONFIG_TASK_MONITOR
-				if (_k_monitor_mask & MON_KSERV) {
-					_k_task_monitor_args(pArgs);
-				}
-#endif
-				(*pArgs->Comm)(pArgs);
-			} else if (cmd_type == KERNEL_CMD_EVENT_TYPE) {
-
-				/* give event */
-
-#ifdef CONFIG_TASK_MONITOR
-				if (_k_monitor_mask & MON_EVENT) {
-					_k_task_monitor_args(pArgs);
-				}
-#endif
-				kevent_t event = (int)pArgs & ~KERNEL_CMD_TYPE_MASK;
-
-				_k_do_event_signal(event);
-			} else { /* cmd_type == KERNEL_CMD_SEMAPHORE_TYPE */
-
-				/* give semaphore */
-
-#ifdef CONFIG_TASK_MONITOR
-				/* task monitoring for giving semaphore not implemented */
-#endif
-				ksem_t sem = (int)pArgs & ~KERNEL_CMD_TYPE_MASK;
-
-				_k_sem_struct_value_update(1, (struct _k_sem_struct *)sem);
-			}
+			_k_cmd_execute(pArgs);
 
 			/*
 			 * check if another fiber (of equal or greater priority)
@@ -27,6 +27,7 @@
 
 extern struct k_timer _k_timer_blocks[];
 
+#ifndef CONFIG_MICROKERNEL_TIMER_WHEEL
 struct k_timer  *_k_timer_list_head;
 struct k_timer  *_k_timer_list_tail;
 
@@ -81,6 +82,7 @@ void _k_timer_delist(struct k_timer *T)
 		_k_timer_list_head = P;
 	T->duration = -1;
 }
+#endif /* !CONFIG_MICROKERNEL_TIMER_WHEEL */
 
 /**
  * @brief Allocate timer used for command packet timeout
@@ -138,6 +140,7 @@ void _k_timeout_free(struct k_timer *T)
 	SYS_TRACING_OBJ_REMOVE_DLL(micro_timer, T);
 }
 
+#ifndef CONFIG_MICROKERNEL_TIMER_WHEEL
 /**
  * @brief Handle expired timers
  *
@@ -185,6 +188,21 @@ void _k_timer_list_update(int ticks)
 	}
 }
 
+/**
+ * @brief Obtain number of ticks until the first timer expires
+ *
+ * @return Number of ticks, or TICKS_UNLIMITED if no timer is active
+ */
+int32_t _k_timer_next_expiry(void)
+{
+	if (_k_timer_list_head) {
+		return _k_timer_list_head->duration;
+	}
+
+	return TICKS_UNLIMITED;
+}
+#endif /* !CONFIG_MICROKERNEL_TIMER_WHEEL */
+
 /**
  * @brief Handle timer allocation request
  *
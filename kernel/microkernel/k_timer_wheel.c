@@ -0,0 +1,252 @@
+/* timer wheel kernel services */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Active microkernel timers are kept in a hierarchical timer wheel. Level 0
+ * has one slot per tick; each slot of level N covers 32^N ticks. A timer is
+ * placed in the lowest level whose range covers its remaining duration, and
+ * is moved down ("cascaded") when the wheel reaches its slot. Enlisting and
+ * delisting a timer therefore take constant time, and processing a tick only
+ * touches the timers that expire on it plus those that cascade.
+ *
+ * Each level keeps a bitmap of its non-empty slots, which lets the wheel skip
+ * over empty stretches when a tickless idle period announces many ticks at
+ * once, and lets the idle task find the next tick needing attention.
+ */
+
+#include <microkernel.h>
+#include <toolchain.h>
+#include <sections.h>
+
+#include <micro_private.h>
+#include <misc/util.h>
+
+#define WHEEL_BITS 5
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS CONFIG_MICROKERNEL_TIMER_WHEEL_LEVELS
+
+/* number of ticks covered by the whole wheel */
+#define WHEEL_RANGE (1U << (WHEEL_BITS * WHEEL_LEVELS))
+
+static struct k_timer *_k_timer_wheel[WHEEL_LEVELS * WHEEL_SIZE];
+static uint32_t _k_timer_wheel_map[WHEEL_LEVELS];
+
+/* tick count of the most recently processed tick */
+static uint32_t _k_timer_wheel_ticks;
+
+static inline uint32_t _wheel_rotate(uint32_t map, unsigned int n)
+{
+	n &= WHEEL_MASK;
+	return n ? ((map >> n) | (map << (WHEEL_SIZE - n))) : map;
+}
+
+/**
+ * @brief Place a timer in the wheel slot matching its expiry tick
+ * @param T Timer
+ * @return N/A
+ */
+static void _wheel_insert(struct k_timer *T)
+{
+	uint32_t when = T->expiry;
+	uint32_t delta = when - _k_timer_wheel_ticks;
+	unsigned int level = 0;
+	unsigned int slot;
+
+	if (delta >= WHEEL_RANGE) {
+		/* park in the farthest top level slot; re-inserted later */
+		delta = WHEEL_RANGE - 1;
+		when = _k_timer_wheel_ticks + delta;
+	}
+
+	while (delta >= (1U << (WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+
+	slot = (when >> (WHEEL_BITS * level)) & WHEEL_MASK;
+	T->slot = (uint8_t)(level * WHEEL_SIZE + slot);
+
+	T->prev = NULL;
+	T->next = _k_timer_wheel[T->slot];
+	if (T->next) {
+		T->next->prev = T;
+	}
+	_k_timer_wheel[T->slot] = T;
+	_k_timer_wheel_map[level] |= (1 << slot);
+}
+
+/**
+ * @brief Detach all timers from a wheel slot
+ * @param slot Wheel slot
+ * @return List of timers previously held by the slot
+ */
+static struct k_timer *_wheel_slot_take(unsigned int slot)
+{
+	struct k_timer *T = _k_timer_wheel[slot];
+
+	_k_timer_wheel[slot] = NULL;
+	_k_timer_wheel_map[slot / WHEEL_SIZE] &= ~(1 << (slot & WHEEL_MASK));
+
+	return T;
+}
+
+/**
+ * @brief Insert a timer into the timer queue
+ * @param T Timer
+ * @return N/A
+ */
+void _k_timer_enlist(struct k_timer *T)
+{
+	T->expiry = _k_timer_wheel_ticks + T->duration;
+	_wheel_insert(T);
+}
+
+/**
+ * @brief Remove a timer from the timer queue
+ * @param T Timer
+ * @return N/A
+ */
+void _k_timer_delist(struct k_timer *T)
+{
+	struct k_timer *P = T->next;
+	struct k_timer *Q = T->prev;
+
+	if (P) {
+		P->prev = Q;
+	}
+	if (Q) {
+		Q->next = P;
+	} else {
+		_k_timer_wheel[T->slot] = P;
+		if (!P) {
+			_k_timer_wheel_map[T->slot / WHEEL_SIZE] &=
+				~(1 << (T->slot & WHEEL_MASK));
+		}
+	}
+	T->duration = -1;
+}
+
+/**
+ * @brief Process the wheel slots due on the current tick
+ *
+ * Cascades the higher level slots that have come due down the wheel, then
+ * activates the command packet of each timer expiring on this tick.
+ *
+ * @return N/A
+ */
+static void _wheel_tick(void)
+{
+	uint32_t now = _k_timer_wheel_ticks;
+	unsigned int level;
+	unsigned int index;
+	struct k_timer *T;
+	struct k_timer *N;
+
+	for (level = 1; level < WHEEL_LEVELS; level++) {
+		if (now & ((1U << (WHEEL_BITS * level)) - 1)) {
+			break;
+		}
+		index = level * WHEEL_SIZE +
+			((now >> (WHEEL_BITS * level)) & WHEEL_MASK);
+		for (T = _wheel_slot_take(index); T; T = N) {
+			N = T->next;
+			_wheel_insert(T);
+		}
+	}
+
+	for (T = _wheel_slot_take(now & WHEEL_MASK); T; T = N) {
+		N = T->next;
+
+		if (T->expiry != now) {
+			/* parked timer of a single level wheel */
+			_wheel_insert(T);
+			continue;
+		}
+
+		if (T->period) {
+			T->duration = T->period;
+			_k_timer_enlist(T);
+		} else {
+			T->duration = -1;
+		}
+		TO_ALIST(&_k_command_stack, T->args);
+	}
+}
+
+/**
+ * @brief Obtain number of ticks until the wheel needs attention
+ *
+ * Returns the distance to the first non-empty slot of any level. For level 0
+ * this is the exact expiry of a timer; for higher levels it is the tick at
+ * which the slot cascades, which is never later than the expiry of the timers
+ * it holds.
+ *
+ * @return Number of ticks, or TICKS_UNLIMITED if no timer is active
+ */
+int32_t _k_timer_next_expiry(void)
+{
+	uint32_t now = _k_timer_wheel_ticks;
+	uint32_t closest = (uint32_t)TICKS_UNLIMITED;
+	unsigned int level;
+	unsigned int shift;
+	unsigned int index;
+	uint32_t when;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		if (!_k_timer_wheel_map[level]) {
+			continue;
+		}
+
+		shift = WHEEL_BITS * level;
+		index = (now >> shift) & WHEEL_MASK;
+		when = ((now >> shift) +
+			find_lsb_set(_wheel_rotate(_k_timer_wheel_map[level],
+						   index + 1))) << shift;
+
+		closest = min(closest, when - now);
+	}
+
+	return (int32_t)closest;
+}
+
+/**
+ * @brief Handle expired timers
+ *
+ * Advances the timer wheel by the specified number of ticks, activating each
+ * task whose timer has expired along the way. Runs of ticks for which no
+ * slot needs processing are skipped in a single step.
+ *
+ * @param ticks Number of ticks
+ * @return N/A
+ */
+void _k_timer_list_update(int ticks)
+{
+	int32_t next;
+
+	while (ticks > 0) {
+		next = _k_timer_next_expiry();
+		if ((next == TICKS_UNLIMITED) || (next > ticks)) {
+			_k_timer_wheel_ticks += ticks;
+			return;
+		}
+
+		_k_timer_wheel_ticks += next;
+		ticks -= next;
+		_wheel_tick();
+	}
+}
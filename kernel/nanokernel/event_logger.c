@@ -20,12 +20,42 @@
  */
 
 #include <misc/event_logger.h>
-#include <misc/ring_buffer.h>
+#include <misc/util.h>
+#include <misc/__assert.h>
+#include <string.h>
+
+/*
+ * The reserve word holds the index of the first free word, modulo 2^24, and
+ * the number of events dropped since the last reservation in its top bits.
+ */
+#define RESERVE_INDEX_BITS 24
+#define RESERVE_INDEX_MASK ((1 << RESERVE_INDEX_BITS) - 1)
+#define RESERVE_DROPPED(reserve) ((uint32_t)(reserve) >> RESERVE_INDEX_BITS)
+
+#ifdef CONFIG_MICROKERNEL
+#define event_logger_has_waiter(logger) \
+	((logger)->sync_sema.wait_q.head || (logger)->sync_sema.task_q.head)
+#else
+#define event_logger_has_waiter(logger) ((logger)->sync_sema.wait_q.head)
+#endif
 
 void sys_event_logger_init(struct event_logger *logger,
 	uint32_t *logger_buffer, uint32_t buffer_size)
 {
-	sys_ring_buf_init(&logger->ring_buf, buffer_size, logger_buffer);
+	uint32_t size;
+
+	__ASSERT(buffer_size >= EVENT_HEADER_SIZE,
+		 "event logger buffer of %u words is too small\n",
+		 buffer_size);
+
+	size = 1 << (find_msb_set(min(buffer_size, RESERVE_INDEX_MASK)) - 1);
+
+	memset(logger_buffer, 0, size * sizeof(uint32_t));
+
+	logger->buf = logger_buffer;
+	logger->mask = size - 1;
+	logger->reserve = 0;
+	logger->head = 0;
 	nano_sem_init(&(logger->sync_sema));
 }
 
@@ -34,20 +64,49 @@ static void event_logger_put(struct event_logger *logger, uint16_t event_id,
 	uint32_t *event_data, uint8_t data_size,
 	void (*sem_give_fn)(struct nano_sem *))
 {
-	int ret;
-	unsigned int key;
+	uint32_t size = EVENT_HEADER_SIZE + data_size;
+	atomic_val_t reserve;
+	uint32_t start;
+	uint32_t dropped;
+	int i;
 
-	key = irq_lock();
+	/*
+	 * Reserve room for the event and take the drop count, or count the
+	 * event as dropped; other producers may preempt us.
+	 */
+	for (;;) {
+		reserve = atomic_get(&logger->reserve);
+		start = reserve & RESERVE_INDEX_MASK;
+		dropped = RESERVE_DROPPED(reserve);
+
+		if (((start + size - logger->head) & RESERVE_INDEX_MASK) >
+		    logger->mask + 1) {
+			if ((dropped == EVENT_HEADER_DROPPED_MAX) ||
+			    atomic_cas(&logger->reserve, reserve,
+				       reserve + (1 << RESERVE_INDEX_BITS))) {
+				return;
+			}
+		} else if (atomic_cas(&logger->reserve, reserve,
+				      (start + size) & RESERVE_INDEX_MASK)) {
+			break;
+		}
+	}
+
+	for (i = 0; i < data_size; i++) {
+		logger->buf[(start + EVENT_HEADER_SIZE + i) & logger->mask] =
+			event_data[i];
+	}
+
+	/* publish the event */
+	compiler_barrier();
+	logger->buf[start & logger->mask] = EVENT_HEADER_VALID |
+		(dropped << 24) | (data_size << 16) | event_id;
+	compiler_barrier();
 
-	ret = sys_ring_buf_put(&logger->ring_buf, event_id,
-			       logger->ring_buf.dropped_put_count, event_data,
-			       data_size);
-	if (ret == 0) {
-		logger->ring_buf.dropped_put_count = 0;
-		/* inform that there is event data available on the buffer */
+	/* inform a waiting fiber that there is event data on the buffer */
+	if (unlikely(event_logger_has_waiter(logger))) {
 		sem_give_fn(&(logger->sync_sema));
 	}
-	irq_unlock(key);
 }
 
 
@@ -86,29 +145,87 @@ void _sys_event_logger_put_non_preemptible(struct event_logger *logger,
 }
 
 
+/* header of the event at index, 0 if the event is not published yet */
+static inline uint32_t event_logger_header(struct event_logger *logger,
+					   uint32_t index)
+{
+	return *(volatile uint32_t *)&logger->buf[index & logger->mask];
+}
+
+
+/*
+ * Copy words from the head of the ring buffer, clearing them so that they
+ * are not taken for published headers, and free them.
+ */
+static void event_logger_consume(struct event_logger *logger,
+				 uint32_t *buffer, uint32_t size)
+{
+	uint32_t index = logger->head & logger->mask;
+	uint32_t chunk = min(size, logger->mask + 1 - index);
+
+	memcpy(buffer, &logger->buf[index], chunk * sizeof(uint32_t));
+	memset(&logger->buf[index], 0, chunk * sizeof(uint32_t));
+
+	if (chunk < size) {
+		memcpy(buffer + chunk, logger->buf,
+		       (size - chunk) * sizeof(uint32_t));
+		memset(logger->buf, 0, (size - chunk) * sizeof(uint32_t));
+	}
+
+	compiler_barrier();
+	logger->head += size;
+}
+
+
+/* wait until the event at the head is published, return 0 on timeout */
+static int event_logger_wait(struct event_logger *logger, int32_t timeout)
+{
+	unsigned int key;
+	int ret = 1;
+
+	/*
+	 * Producers only give the semaphore when a fiber waits on it, so check
+	 * for an event and start waiting with interrupts locked.
+	 */
+	key = irq_lock();
+	while (!event_logger_header(logger, logger->head)) {
+		if (!nano_fiber_sem_take(&(logger->sync_sema), timeout)) {
+			ret = 0;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	return ret;
+}
+
+
 static int event_logger_get(struct event_logger *logger,
 			    uint16_t *event_id, uint8_t *dropped_event_count,
 			    uint32_t *buffer, uint8_t *buffer_size)
 {
-	int ret;
+	uint32_t header = event_logger_header(logger, logger->head);
+	uint8_t length = EVENT_HEADER_LENGTH(header);
 
-	ret = sys_ring_buf_get(&logger->ring_buf, event_id, dropped_event_count,
-			       buffer, buffer_size);
-	if (likely(!ret)) {
-		return *buffer_size;
+	if (!header) {
+		return 0;
 	}
-	switch (ret) {
-	case -EMSGSIZE:
-		/* if the user can not retrieve the message, we increase the
-		 *  semaphore to indicate that the message remains in the buffer
-		 */
-		nano_fiber_sem_give(&(logger->sync_sema));
+
+	if (length > *buffer_size) {
+		*buffer_size = length;
 		return -EMSGSIZE;
-	case -EAGAIN:
-		return 0;
-	default:
-		return ret;
 	}
+
+	*event_id = EVENT_HEADER_ID(header);
+	*dropped_event_count = EVENT_HEADER_DROPPED(header);
+	*buffer_size = length;
+
+	/* the header is cleared like the data, but not returned */
+	logger->buf[logger->head & logger->mask] = 0;
+	logger->head += EVENT_HEADER_SIZE;
+	event_logger_consume(logger, buffer, length);
+
+	return length;
 }
 
 
@@ -116,11 +233,8 @@ int sys_event_logger_get(struct event_logger *logger, uint16_t *event_id,
 			 uint8_t *dropped_event_count, uint32_t *buffer,
 			 uint8_t *buffer_size)
 {
-	if (nano_fiber_sem_take(&(logger->sync_sema), TICKS_NONE)) {
-		return event_logger_get(logger, event_id, dropped_event_count,
-					buffer, buffer_size);
-	}
-	return 0;
+	return event_logger_get(logger, event_id, dropped_event_count, buffer,
+				buffer_size);
 }
 
 
@@ -128,7 +242,7 @@ int sys_event_logger_get_wait(struct event_logger *logger,  uint16_t *event_id,
 			      uint8_t *dropped_event_count, uint32_t *buffer,
 			      uint8_t *buffer_size)
 {
-	nano_fiber_sem_take(&(logger->sync_sema), TICKS_UNLIMITED);
+	event_logger_wait(logger, TICKS_UNLIMITED);
 
 	return event_logger_get(logger, event_id, dropped_event_count, buffer,
 				buffer_size);
@@ -142,10 +256,47 @@ int sys_event_logger_get_wait_timeout(struct event_logger *logger,
 				      uint32_t *buffer, uint8_t *buffer_size,
 				      uint32_t timeout)
 {
-	if (nano_fiber_sem_take(&(logger->sync_sema), timeout)) {
+	if (event_logger_wait(logger, timeout)) {
 		return event_logger_get(logger, event_id, dropped_event_count,
 					buffer, buffer_size);
 	}
 	return 0;
 }
 #endif /* CONFIG_NANO_TIMEOUTS */
+
+
+int sys_event_logger_drain(struct event_logger *logger, uint32_t *buffer,
+			   int buffer_size)
+{
+	uint32_t header;
+	int size = 0;
+	int event_size;
+
+	/* find the published events that fit in the buffer */
+	while (size <= logger->mask &&
+	       (header = event_logger_header(logger, logger->head + size))) {
+		event_size = EVENT_HEADER_SIZE + EVENT_HEADER_LENGTH(header);
+		if (size + event_size > buffer_size) {
+			if (!size) {
+				return -EMSGSIZE;
+			}
+			break;
+		}
+		size += event_size;
+	}
+
+	if (size) {
+		event_logger_consume(logger, buffer, size);
+	}
+
+	return size;
+}
+
+
+int sys_event_logger_drain_wait(struct event_logger *logger, uint32_t *buffer,
+				int buffer_size)
+{
+	event_logger_wait(logger, TICKS_UNLIMITED);
+
+	return sys_event_logger_drain(logger, buffer, buffer_size);
+}
@@ -35,6 +35,17 @@ static inline void _do_nano_timeout_add(struct tcs *tcs,
 					struct _nano_queue *wait_q,
 					int32_t timeout);
 
+#ifdef CONFIG_NANO_TIMEOUT_QUEUE_WHEEL
+extern void _nano_timeout_queue_init(void);
+extern void _nano_timeout_wheel_add(struct _nano_timeout *t, int32_t timeout);
+extern void _nano_timeout_wheel_remove(struct _nano_timeout *t);
+extern int32_t _nano_timeout_wheel_remaining(struct _nano_timeout *t);
+extern uint32_t _nano_timeout_wheel_next(void);
+extern void _nano_timeout_wheel_announce(int32_t ticks, unsigned int key);
+#else
+#define _nano_timeout_queue_init() do { } while ((0))
+#endif
+
 static inline void _nano_timeout_init(struct _nano_timeout *t,
 				      _nano_timeout_func_t func)
 {
@@ -118,16 +129,13 @@ static inline void _nano_timeout_add(struct tcs *tcs,
 #endif /* CONFIG_NANO_TIMEOUTS */
 
 /*
- * Handle one expired timeout.
- * This removes the fiber from the timeout queue head, and also removes it
- * from the wait queue it is on if waiting for an object. In that case, it
- * also sets the return value to 0/NULL.
+ * Expire a timeout that has been removed from the timeout queue.
+ * This readies the waiting fiber, and also removes it from the wait queue it
+ * is on if waiting for an object. In that case, it also sets the return value
+ * to 0/NULL. Without a waiting fiber, the timeout callback is invoked.
  */
-
-static inline struct _nano_timeout *_nano_timeout_handle_one_timeout(
-	sys_dlist_t *timeout_q)
+static inline void _nano_timeout_expire(struct _nano_timeout *t)
 {
-	struct _nano_timeout *t = (void *)sys_dlist_get(timeout_q);
 	struct tcs *tcs = t->tcs;
 
 	if (tcs != NULL) {
@@ -141,6 +149,95 @@ static inline struct _nano_timeout *_nano_timeout_handle_one_timeout(
 		t->func(t);
 	}
 	t->delta_ticks_from_prev = -1;
+}
+
+#ifdef CONFIG_NANO_TIMEOUT_QUEUE_WHEEL
+
+/*
+ * With the timer wheel, delta_ticks_from_prev only holds the timeout the
+ * entry was queued with, or -1 when it is not queued.
+ */
+
+/**
+ *
+ * @brief abort a timeout
+ *
+ * @param t Timeout to abort
+ *
+ * @return 0 in success and -1 if the timer has expired
+ */
+static inline int _do_nano_timeout_abort(struct _nano_timeout *t)
+{
+	if (-1 == t->delta_ticks_from_prev) {
+		return -1;
+	}
+
+	_nano_timeout_wheel_remove(t);
+	t->delta_ticks_from_prev = -1;
+
+	return 0;
+}
+
+static inline int _nano_timer_timeout_abort(struct _nano_timeout *t)
+{
+	return _do_nano_timeout_abort(t);
+}
+
+/**
+ *
+ * @brief Put timeout on the timeout queue, record waiting fiber and wait queue
+ *
+ * @param tcs Fiber waiting on a timeout
+ * @param t Timeout structure to be added to the nanokernel queue
+ * @wait_q nanokernel object wait queue
+ * @timeout Timeout in ticks
+ *
+ * @return N/A
+ */
+static inline void _do_nano_timeout_add(struct tcs *tcs,
+					struct _nano_timeout *t,
+					struct _nano_queue *wait_q,
+					int32_t timeout)
+{
+	t->tcs = tcs;
+	t->delta_ticks_from_prev = timeout;
+	t->wait_q = wait_q;
+	_nano_timeout_wheel_add(t, timeout);
+}
+
+static inline void _nano_timer_timeout_add(struct _nano_timeout *t,
+				     struct _nano_queue *wait_q,
+				     int32_t timeout)
+{
+	_do_nano_timeout_add(NULL, t, wait_q, timeout);
+}
+
+/* number of ticks until a queued timeout expires */
+static inline int32_t _nano_timeout_remaining(struct _nano_timeout *t)
+{
+	return _nano_timeout_wheel_remaining(t);
+}
+
+/* find the closest deadline in the timeout queue */
+static inline uint32_t _nano_get_earliest_timeouts_deadline(void)
+{
+	return min(_nano_timeout_wheel_next(),
+		   (uint32_t)_nanokernel.task_timeout);
+}
+
+#else /* CONFIG_NANO_TIMEOUT_QUEUE_WHEEL */
+
+/*
+ * Handle one expired timeout.
+ * This removes the timeout from the timeout queue head and expires it.
+ */
+
+static inline struct _nano_timeout *_nano_timeout_handle_one_timeout(
+	sys_dlist_t *timeout_q)
+{
+	struct _nano_timeout *t = (void *)sys_dlist_get(timeout_q);
+
+	_nano_timeout_expire(t);
 
 	return (struct _nano_timeout *)sys_dlist_peek_head(timeout_q);
 }
@@ -249,6 +346,30 @@ static inline void _nano_timer_timeout_add(struct _nano_timeout *t,
 	_do_nano_timeout_add(NULL, t, wait_q, timeout);
 }
 
+/*
+ * Number of ticks until a queued timeout expires.
+ *
+ * As timeouts are stored with delta_ticks_from_prev, walk through the
+ * timeout queue and accumulate all the delta_ticks_from_prev values up to
+ * the timeout.
+ */
+static inline int32_t _nano_timeout_remaining(struct _nano_timeout *t)
+{
+	sys_dlist_t *timeout_q = &_nanokernel.timeout_q;
+	struct _nano_timeout *iterator;
+	int32_t remaining_ticks;
+
+	iterator = (struct _nano_timeout *)sys_dlist_peek_head(timeout_q);
+	remaining_ticks = iterator->delta_ticks_from_prev;
+	while (iterator != t) {
+		iterator = (struct _nano_timeout *)sys_dlist_peek_next(
+			timeout_q, &iterator->node);
+		remaining_ticks += iterator->delta_ticks_from_prev;
+	}
+
+	return remaining_ticks;
+}
+
 /* find the closest deadline in the timeout queue */
 static inline uint32_t _nano_get_earliest_timeouts_deadline(void)
 {
@@ -260,6 +381,8 @@ static inline uint32_t _nano_get_earliest_timeouts_deadline(void)
 			 : (uint32_t)_nanokernel.task_timeout;
 }
 
+#endif /* CONFIG_NANO_TIMEOUT_QUEUE_WHEEL */
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,7 +94,7 @@ void _sys_k_event_logger_context_switch(void)
 	}
 
 	/* if the kernel event logger has not been initialized, we do nothing */
-	if (sys_k_event_logger.ring_buf.buf == NULL) {
+	if (sys_k_event_logger.buf == NULL) {
 		return;
 	}
 
@@ -142,7 +142,7 @@ void _sys_k_event_logger_interrupt(void)
 	}
 
 	/* if the kernel event logger has not been initialized, we do nothing */
-	if (sys_k_event_logger.ring_buf.buf == NULL) {
+	if (sys_k_event_logger.buf == NULL) {
 		return;
 	}
 
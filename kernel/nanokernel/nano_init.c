@@ -84,8 +84,10 @@ char __noinit _interrupt_stack[CONFIG_ISR_STACK_SIZE];
 
 #if defined(CONFIG_NANO_TIMEOUTS) || defined(CONFIG_NANO_TIMERS)
 	#include <misc/dlist.h>
+	#include <wait_q.h>
 	#define initialize_nano_timeouts() do { \
 		sys_dlist_init(&_nanokernel.timeout_q); \
+		_nano_timeout_queue_init(); \
 		_nanokernel.task_timeout = TICKS_UNLIMITED; \
 	} while ((0))
 #else
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Nanokernel single-producer single-consumer ring object
+ *
+ * This module provides the nanokernel SPSC ring object implementation,
+ * including the following APIs:
+ *
+ *  nano_spsc_init
+ *  nano_fiber_spsc_put, nano_task_spsc_put, nano_isr_spsc_put
+ *  nano_fiber_spsc_get, nano_task_spsc_get, nano_isr_spsc_get
+ *
+ * The producer only writes the head index and the consumer only writes the
+ * tail index, so items are passed without locking interrupts. Interrupts are
+ * only locked when the consumer has to wait, and when the producer finds a
+ * consumer waiting.
+ *
+ * @internal
+ * In some cases the compiler "alias" attribute is used to map two or more
+ * APIs to the same function, since they have identical implementations.
+ * @endinternal
+ */
+
+#include <nano_private.h>
+#include <misc/debug/object_tracing_common.h>
+#include <misc/__assert.h>
+#include <toolchain.h>
+#include <sections.h>
+#include <wait_q.h>
+
+#ifdef CONFIG_MICROKERNEL
+#define spsc_has_waiter(spsc) ((spsc)->wait_q.head || (spsc)->task_q.head)
+#else
+#define spsc_has_waiter(spsc) ((spsc)->wait_q.head)
+#endif
+
+void nano_spsc_init(struct nano_spsc *spsc, void **buf, unsigned int size)
+{
+	__ASSERT((size != 0) && ((size & (size - 1)) == 0),
+		 "SPSC ring size %u is not a power of 2\n", size);
+
+	_nano_wait_q_init(&spsc->wait_q);
+	_TASK_PENDQ_INIT(&spsc->task_q);
+	spsc->buf = buf;
+	spsc->mask = size - 1;
+	spsc->head = 0;
+	spsc->tail = 0;
+
+	SYS_TRACING_OBJ_INIT(nano_spsc, spsc);
+}
+
+/**
+ *
+ * @brief Internal routine to append data to a ring
+ *
+ * @return 1 if the data was appended, 0 if the ring is full
+ */
+static inline int spsc_enqueue(struct nano_spsc *spsc, void *data)
+{
+	uint32_t head = spsc->head;
+
+	if (unlikely(head - spsc->tail > spsc->mask)) {
+		return 0;
+	}
+
+	spsc->buf[head & spsc->mask] = data;
+	compiler_barrier();
+	spsc->head = head + 1;
+	compiler_barrier();
+
+	return 1;
+}
+
+/**
+ *
+ * @brief Internal routine to remove data from a ring
+ *
+ * @return The data item removed, or NULL if the ring is empty
+ */
+static inline void *spsc_dequeue(struct nano_spsc *spsc)
+{
+	uint32_t tail = spsc->tail;
+	void *data;
+
+	if (tail == spsc->head) {
+		return NULL;
+	}
+
+	data = spsc->buf[tail & spsc->mask];
+	compiler_barrier();
+	spsc->tail = tail + 1;
+
+	return data;
+}
+
+FUNC_ALIAS(_spsc_put_non_preemptible, nano_isr_spsc_put, int);
+FUNC_ALIAS(_spsc_put_non_preemptible, nano_fiber_spsc_put, int);
+
+/**
+ *
+ * @brief Append an element to a ring (no context switch)
+ *
+ * This routine adds an element to the end of a ring object; it may be called
+ * from either a fiber or an ISR context. A consumer pending on the ring
+ * object will be made ready, but will NOT be scheduled to execute.
+ *
+ * @param spsc Ring on which to interact.
+ * @param data Data to send.
+ *
+ * @return 1 if the element was added, 0 if the ring is full
+ *
+ * @internal
+ * This function is capable of supporting invocations from both a fiber and an
+ * ISR context. However, the nano_isr_spsc_put and nano_fiber_spsc_put aliases
+ * are created to support any required implementation differences in the future
+ * without introducing a source code migration issue.
+ * @endinternal
+ */
+int _spsc_put_non_preemptible(struct nano_spsc *spsc, void *data)
+{
+	struct tcs *tcs;
+	unsigned int key;
+
+	if (!spsc_enqueue(spsc, data)) {
+		return 0;
+	}
+
+	if (unlikely(spsc_has_waiter(spsc))) {
+		key = irq_lock();
+		tcs = _nano_wait_q_remove(&spsc->wait_q);
+		if (tcs) {
+			_nano_timeout_abort(tcs);
+			fiberRtnValueSet(tcs, 1);
+		} else {
+			_NANO_UNPEND_TASKS(&spsc->task_q);
+		}
+		irq_unlock(key);
+	}
+
+	return 1;
+}
+
+int nano_task_spsc_put(struct nano_spsc *spsc, void *data)
+{
+	struct tcs *tcs;
+	unsigned int key;
+
+	if (!spsc_enqueue(spsc, data)) {
+		return 0;
+	}
+
+	if (unlikely(spsc_has_waiter(spsc))) {
+		key = irq_lock();
+		tcs = _nano_wait_q_remove(&spsc->wait_q);
+		if (tcs) {
+			_nano_timeout_abort(tcs);
+			fiberRtnValueSet(tcs, 1);
+			_Swap(key);
+			return 1;
+		}
+		_TASK_NANO_UNPEND_TASKS(&spsc->task_q);
+		irq_unlock(key);
+	}
+
+	return 1;
+}
+
+int nano_spsc_put(struct nano_spsc *spsc, void *data)
+{
+	static int (*func[3])(struct nano_spsc *spsc, void *data) = {
+		nano_isr_spsc_put,
+		nano_fiber_spsc_put,
+		nano_task_spsc_put
+	};
+
+	return func[sys_execution_context_type_get()](spsc, data);
+}
+
+FUNC_ALIAS(_spsc_get, nano_isr_spsc_get, void *);
+FUNC_ALIAS(_spsc_get, nano_fiber_spsc_get, void *);
+
+void *_spsc_get(struct nano_spsc *spsc, int32_t timeout_in_ticks)
+{
+	unsigned int key;
+	void *data;
+
+	data = spsc_dequeue(spsc);
+	if (likely(data) || (timeout_in_ticks == TICKS_NONE)) {
+		return data;
+	}
+
+	/* check again, now that the producer cannot miss the waiter */
+	key = irq_lock();
+	data = spsc_dequeue(spsc);
+	if (data) {
+		irq_unlock(key);
+		return data;
+	}
+
+	_NANO_TIMEOUT_ADD(&spsc->wait_q, timeout_in_ticks);
+	_nano_wait_q_put(&spsc->wait_q);
+	if (_Swap(key)) {
+		return spsc_dequeue(spsc);
+	}
+
+	return NULL;
+}
+
+void *nano_task_spsc_get(struct nano_spsc *spsc, int32_t timeout_in_ticks)
+{
+	int64_t cur_ticks;
+	int64_t limit = 0x7fffffffffffffffll;
+	unsigned int key;
+	void *data;
+
+	data = spsc_dequeue(spsc);
+	if (likely(data) || (timeout_in_ticks == TICKS_NONE)) {
+		return data;
+	}
+
+	key = irq_lock();
+	cur_ticks = _NANO_TIMEOUT_TICK_GET();
+	if (timeout_in_ticks != TICKS_UNLIMITED) {
+		limit = cur_ticks + timeout_in_ticks;
+	}
+
+	do {
+		data = spsc_dequeue(spsc);
+		if (data) {
+			irq_unlock(key);
+			return data;
+		}
+
+		_NANO_OBJECT_WAIT(&spsc->task_q, &spsc->head,
+				timeout_in_ticks, key);
+		cur_ticks = _NANO_TIMEOUT_TICK_GET();
+		_NANO_TIMEOUT_UPDATE(timeout_in_ticks, limit, cur_ticks);
+	} while (cur_ticks < limit);
+
+	irq_unlock(key);
+	return NULL;
+}
+
+void *nano_spsc_get(struct nano_spsc *spsc, int32_t timeout_in_ticks)
+{
+	static void *(*func[3])(struct nano_spsc *, int32_t) = {
+		nano_isr_spsc_get,
+		nano_fiber_spsc_get,
+		nano_task_spsc_get
+	};
+
+	return func[sys_execution_context_type_get()](spsc, timeout_in_ticks);
+}
@@ -150,14 +150,26 @@ uint32_t sys_tick_delta_32(int64_t *reftime)
 
 /* handle the expired timeouts in the nano timeout queue */
 
-#if defined(CONFIG_NANO_TIMEOUTS) || defined(CONFIG_NANO_TIMERS)
+#if defined(CONFIG_NANO_TIMEOUT_QUEUE_WHEEL)
 #include <wait_q.h>
 
-static inline void handle_expired_nano_timeouts(int32_t ticks)
+static inline void handle_expired_nano_timeouts(int32_t ticks,
+						unsigned int key)
+{
+	_nanokernel.task_timeout = TICKS_UNLIMITED;
+	_nano_timeout_wheel_announce(ticks, key);
+}
+#elif defined(CONFIG_NANO_TIMEOUTS) || defined(CONFIG_NANO_TIMERS)
+#include <wait_q.h>
+
+static inline void handle_expired_nano_timeouts(int32_t ticks,
+						unsigned int key)
 {
 	struct _nano_timeout *head =
 		(struct _nano_timeout *)sys_dlist_peek_head(&_nanokernel.timeout_q);
 
+	ARG_UNUSED(key);
+
 	_nanokernel.task_timeout = TICKS_UNLIMITED;
 	if (head) {
 		head->delta_ticks_from_prev -= ticks;
@@ -165,7 +177,7 @@ static inline void handle_expired_nano_timeouts(int32_t ticks)
 	}
 }
 #else
-	#define handle_expired_nano_timeouts(ticks) do { } while ((0))
+	#define handle_expired_nano_timeouts(ticks, key) do { } while ((0))
 #endif
 
 /**
@@ -184,7 +196,7 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	key = irq_lock();
 	_sys_clock_tick_count += ticks;
-	handle_expired_nano_timeouts(ticks);
+	handle_expired_nano_timeouts(ticks, key);
 	irq_unlock(key);
 }
 
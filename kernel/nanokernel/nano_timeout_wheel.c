@@ -0,0 +1,234 @@
+/* nanokernel timeout wheel */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Pending nanokernel timeouts are kept in a hierarchical timer wheel. Level 0
+ * has one slot per tick; each slot of level N covers 32^N ticks. A timeout
+ * is placed in the lowest level whose range covers its remaining ticks, and
+ * is moved down ("cascaded") when the wheel reaches its slot. Each level has
+ * a bitmap of its non-empty slots, used to skip empty runs of ticks and to
+ * find the closest deadline.
+ *
+ * Adding and aborting a timeout take constant time. When ticks are announced,
+ * interrupts are unlocked briefly after each timeout is cascaded or expired,
+ * so the interrupt lock time does not depend on the number of timeouts.
+ *
+ * The tick count used as the base of new timeouts is advanced by all the
+ * announced ticks before the wheel is processed, so a timeout added by an ISR
+ * while interrupts are unlocked cannot expire early. The wheel itself is
+ * processed up to a separate cursor, which catches up with the tick count by
+ * the end of the announcement.
+ */
+
+#include <nano_private.h>
+#include <toolchain.h>
+#include <sections.h>
+#include <misc/util.h>
+#include <wait_q.h>
+
+#define WHEEL_BITS 5
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS CONFIG_NANO_TIMEOUT_QUEUE_WHEEL_LEVELS
+
+/* number of ticks covered by the whole wheel */
+#define WHEEL_RANGE (1U << (WHEEL_BITS * WHEEL_LEVELS))
+
+static sys_dlist_t timeout_wheel[WHEEL_LEVELS * WHEEL_SIZE];
+static uint32_t timeout_wheel_map[WHEEL_LEVELS];
+
+/* tick count of the most recently announced tick */
+static uint32_t timeout_wheel_ticks;
+
+/* tick count of the most recently processed tick */
+static uint32_t timeout_wheel_cursor;
+
+static inline uint32_t wheel_rotate(uint32_t map, unsigned int n)
+{
+	n &= WHEEL_MASK;
+	return n ? ((map >> n) | (map << (WHEEL_SIZE - n))) : map;
+}
+
+static inline void wheel_slot_mark(unsigned int slot)
+{
+	timeout_wheel_map[slot / WHEEL_SIZE] |= (1 << (slot & WHEEL_MASK));
+}
+
+static inline void wheel_slot_update(unsigned int slot)
+{
+	if (sys_dlist_is_empty(&timeout_wheel[slot])) {
+		timeout_wheel_map[slot / WHEEL_SIZE] &=
+			~(1 << (slot & WHEEL_MASK));
+	}
+}
+
+/* place a timeout in the wheel slot matching its expiry tick */
+static void wheel_insert(struct _nano_timeout *t)
+{
+	uint32_t when = t->expiry;
+	uint32_t delta = when - timeout_wheel_cursor;
+	unsigned int level = 0;
+
+	if (delta >= WHEEL_RANGE) {
+		/* park in the farthest top level slot; re-inserted later */
+		delta = WHEEL_RANGE - 1;
+		when = timeout_wheel_cursor + delta;
+	}
+
+	while (delta >= (1U << (WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+
+	t->slot = (uint8_t)(level * WHEEL_SIZE +
+			    ((when >> (WHEEL_BITS * level)) & WHEEL_MASK));
+	sys_dlist_append(&timeout_wheel[t->slot], &t->node);
+	wheel_slot_mark(t->slot);
+}
+
+void _nano_timeout_queue_init(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(timeout_wheel); i++) {
+		sys_dlist_init(&timeout_wheel[i]);
+	}
+}
+
+void _nano_timeout_wheel_add(struct _nano_timeout *t, int32_t timeout)
+{
+	/* a timeout of zero ticks expires on the next tick */
+	t->expiry = timeout_wheel_ticks + max(timeout, 1);
+	wheel_insert(t);
+}
+
+void _nano_timeout_wheel_remove(struct _nano_timeout *t)
+{
+	sys_dlist_remove(&t->node);
+	wheel_slot_update(t->slot);
+}
+
+int32_t _nano_timeout_wheel_remaining(struct _nano_timeout *t)
+{
+	/* not processed yet by an ongoing announcement */
+	return max((int32_t)(t->expiry - timeout_wheel_ticks), 0);
+}
+
+/*
+ * Ticks from the cursor until the wheel needs attention: the exact expiry for
+ * level 0 slots, the tick at which the slot cascades for higher levels.
+ */
+static uint32_t wheel_next(void)
+{
+	uint32_t now = timeout_wheel_cursor;
+	uint32_t closest = (uint32_t)TICKS_UNLIMITED;
+	unsigned int level;
+	unsigned int shift;
+	unsigned int index;
+	uint32_t when;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		if (!timeout_wheel_map[level]) {
+			continue;
+		}
+
+		shift = WHEEL_BITS * level;
+		index = (now >> shift) & WHEEL_MASK;
+		when = ((now >> shift) +
+			find_lsb_set(wheel_rotate(timeout_wheel_map[level],
+						  index + 1))) << shift;
+
+		closest = min(closest, when - now);
+	}
+
+	return closest;
+}
+
+uint32_t _nano_timeout_wheel_next(void)
+{
+	uint32_t next = wheel_next();
+	uint32_t lag = timeout_wheel_ticks - timeout_wheel_cursor;
+
+	if (next == (uint32_t)TICKS_UNLIMITED) {
+		return next;
+	}
+
+	return next > lag ? next - lag : 0;
+}
+
+/* process the wheel slots due on the tick at the cursor */
+static void wheel_tick(unsigned int key)
+{
+	uint32_t now = timeout_wheel_cursor;
+	struct _nano_timeout *t;
+	unsigned int level;
+	unsigned int slot;
+
+	for (level = 1; level < WHEEL_LEVELS; level++) {
+		if (now & ((1U << (WHEEL_BITS * level)) - 1)) {
+			break;
+		}
+
+		slot = level * WHEEL_SIZE +
+		       ((now >> (WHEEL_BITS * level)) & WHEEL_MASK);
+		while ((t = (void *)sys_dlist_get(&timeout_wheel[slot]))) {
+			wheel_insert(t);
+			irq_unlock(key);
+			key = irq_lock();
+		}
+		wheel_slot_update(slot);
+	}
+
+	slot = now & WHEEL_MASK;
+	while ((t = (void *)sys_dlist_peek_head(&timeout_wheel[slot]))) {
+		if (t->expiry != now) {
+			/* parked timeout of a single level wheel */
+			sys_dlist_remove(&t->node);
+			wheel_insert(t);
+			continue;
+		}
+
+		_nano_timeout_wheel_remove(t);
+		_nano_timeout_expire(t);
+		irq_unlock(key);
+		key = irq_lock();
+	}
+	wheel_slot_update(slot);
+}
+
+/*
+ * Announce ticks to the timeout wheel. Must be called with interrupts locked
+ * by the caller, using <key>; interrupts are unlocked briefly between
+ * timeouts.
+ */
+void _nano_timeout_wheel_announce(int32_t ticks, unsigned int key)
+{
+	uint32_t next;
+
+	timeout_wheel_ticks += ticks;
+
+	while (timeout_wheel_cursor != timeout_wheel_ticks) {
+		next = wheel_next();
+		if (next > timeout_wheel_ticks - timeout_wheel_cursor) {
+			timeout_wheel_cursor = timeout_wheel_ticks;
+			return;
+		}
+
+		timeout_wheel_cursor += next;
+		wheel_tick(key);
+	}
+}
@@ -260,27 +260,11 @@ int32_t nano_timer_ticks_remain(struct nano_timer *timer)
 	int key = irq_lock();
 	int32_t remaining_ticks;
 	struct _nano_timeout *t = &timer->timeout_data;
-	sys_dlist_t *timeout_q = &_nanokernel.timeout_q;
-	struct _nano_timeout *iterator;
 
 	if (t->delta_ticks_from_prev == -1) {
 		remaining_ticks = 0;
 	} else {
-		/*
-		 * As nanokernel timeouts are stored in a linked list with
-		 * delta_ticks_from_prev, to get the actual number of ticks
-		 * remaining for the timer, walk through the timeouts list
-		 * and accumulate all the delta_ticks_from_prev values up to
-		 * the timer.
-		 */
-		iterator =
-			(struct _nano_timeout *)sys_dlist_peek_head(timeout_q);
-		remaining_ticks = iterator->delta_ticks_from_prev;
-		while (iterator != t) {
-			iterator = (struct _nano_timeout *)sys_dlist_peek_next(
-				timeout_q, &iterator->node);
-			remaining_ticks += iterator->delta_ticks_from_prev;
-		}
+		remaining_ticks = _nano_timeout_remaining(t);
 	}
 
 	irq_unlock(key);
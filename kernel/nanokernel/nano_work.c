@@ -26,6 +26,45 @@
 
 #include <misc/nano_work.h>
 
+/* Must be called with interrupts locked */
+static struct nano_work *workqueue_get(struct nano_workqueue *wq)
+{
+	sys_slist_t *queue;
+	sys_snode_t *node;
+	int prio;
+
+	if (!wq->pending) {
+		return NULL;
+	}
+
+	prio = find_lsb_set(wq->pending) - 1;
+	queue = &wq->queue[prio];
+
+	node = sys_slist_peek_head(queue);
+	sys_slist_remove(queue, NULL, node);
+	if (sys_slist_is_empty(queue)) {
+		wq->pending &= ~(1 << prio);
+	}
+
+	return CONTAINER_OF(node, struct nano_work, node);
+}
+
+/* Must be called with interrupts locked */
+static struct nano_work *workqueue_steal(struct nano_workqueue *wq)
+{
+	struct nano_workqueue *sibling;
+	struct nano_work *work;
+
+	for (sibling = wq->sibling; sibling != wq; sibling = sibling->sibling) {
+		work = workqueue_get(sibling);
+		if (work) {
+			return work;
+		}
+	}
+
+	return NULL;
+}
+
 static void workqueue_fiber_main(int arg1, int arg2)
 {
 	struct nano_workqueue *wq = (struct nano_workqueue *)arg1;
@@ -35,8 +74,34 @@ static void workqueue_fiber_main(int arg1, int arg2)
 	while (1) {
 		struct nano_work *work;
 		work_handler_t handler;
+		unsigned int key;
 
-		work = nano_fiber_fifo_get(&wq->fifo, TICKS_UNLIMITED);
+		key = irq_lock();
+
+		work = workqueue_get(wq);
+		if (!work) {
+			work = workqueue_steal(wq);
+		}
+
+		if (!work) {
+			/*
+			 * The semaphore is given once for each work item
+			 * submitted, and to wake up thieves, so it can be
+			 * given for work that has been taken already: just
+			 * look again after waking up.
+			 */
+			wq->idle++;
+			irq_unlock(key);
+
+			nano_fiber_sem_take(&wq->sem, TICKS_UNLIMITED);
+
+			key = irq_lock();
+			wq->idle--;
+			irq_unlock(key);
+			continue;
+		}
+
+		irq_unlock(key);
 
 		handler = work->handler;
 
@@ -48,10 +113,49 @@ static void workqueue_fiber_main(int arg1, int arg2)
 	}
 }
 
+void _nano_work_queue_put(struct nano_workqueue *wq, struct nano_work *work)
+{
+	struct nano_workqueue *thief = NULL;
+	unsigned int key = irq_lock();
+
+	sys_slist_append(&wq->queue[work->prio], &work->node);
+	wq->pending |= 1 << work->prio;
+
+	/* All workers are busy: wake up an idle worker of a sibling */
+	if (!wq->idle) {
+		for (thief = wq->sibling; thief != wq; thief = thief->sibling) {
+			if (thief->idle) {
+				break;
+			}
+		}
+	}
+
+	irq_unlock(key);
+
+	if (thief && thief != wq) {
+		nano_sem_give(&thief->sem);
+	}
+
+	nano_sem_give(&wq->sem);
+}
+
+static void workqueue_init(struct nano_workqueue *wq)
+{
+	int i;
+
+	nano_sem_init(&wq->sem);
+	for (i = 0; i < NANO_WORK_PRIORITIES; i++) {
+		sys_slist_init(&wq->queue[i]);
+	}
+	wq->pending = 0;
+	wq->idle = 0;
+	wq->sibling = wq;
+}
+
 void nano_fiber_workqueue_start(struct nano_workqueue *wq,
 				const struct fiber_config *config)
 {
-	nano_fifo_init(&wq->fifo);
+	workqueue_init(wq);
 
 	fiber_fiber_start_config(config, workqueue_fiber_main,
 				 (int)wq, 0, 0);
@@ -60,7 +164,7 @@ void nano_fiber_workqueue_start(struct nano_workqueue *wq,
 void nano_task_workqueue_start(struct nano_workqueue *wq,
 			       const struct fiber_config *config)
 {
-	nano_fifo_init(&wq->fifo);
+	workqueue_init(wq);
 
 	task_fiber_start_config(config, workqueue_fiber_main,
 				(int)wq, 0, 0);
@@ -69,12 +173,32 @@ void nano_task_workqueue_start(struct nano_workqueue *wq,
 void nano_workqueue_start(struct nano_workqueue *wq,
 			  const struct fiber_config *config)
 {
-	nano_fifo_init(&wq->fifo);
+	workqueue_init(wq);
+
+	fiber_start_config(config, workqueue_fiber_main,
+			   (int)wq, 0, 0);
+}
 
+void nano_workqueue_worker_add(struct nano_workqueue *wq,
+			       const struct fiber_config *config)
+{
 	fiber_start_config(config, workqueue_fiber_main,
 			   (int)wq, 0, 0);
 }
 
+void nano_workqueue_sibling_add(struct nano_workqueue *wq,
+				struct nano_workqueue *sibling)
+{
+	unsigned int key = irq_lock();
+	struct nano_workqueue *next = wq->sibling;
+
+	/* Join the two rings of siblings */
+	wq->sibling = sibling->sibling;
+	sibling->sibling = next;
+
+	irq_unlock(key);
+}
+
 static void work_timeout(struct _nano_timeout *t)
 {
 	struct nano_delayed_work *w = CONTAINER_OF(t, struct nano_delayed_work,
@@ -161,21 +285,28 @@ int nano_delayed_work_cancel(struct nano_delayed_work *work)
 
 #include <init.h>
 
-static char __stack sys_wq_stack[CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
-
-static const struct fiber_config sys_wq_config = {
-	.stack = sys_wq_stack,
-	.stack_size = sizeof(sys_wq_stack),
-	.prio = CONFIG_SYSTEM_WORKQUEUE_PRIORITY,
-};
+static char __stack sys_wq_stacks[CONFIG_SYSTEM_WORKQUEUE_WORKERS]
+				 [CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
 
 struct nano_workqueue sys_workqueue;
 
 static int sys_workqueue_init(struct device *dev)
 {
+	struct fiber_config config = {
+		.stack = sys_wq_stacks[0],
+		.stack_size = sizeof(sys_wq_stacks[0]),
+		.prio = CONFIG_SYSTEM_WORKQUEUE_PRIORITY,
+	};
+	int i;
+
 	ARG_UNUSED(dev);
 
-	nano_workqueue_start(&sys_workqueue, &sys_wq_config);
+	nano_workqueue_start(&sys_workqueue, &config);
+
+	for (i = 1; i < CONFIG_SYSTEM_WORKQUEUE_WORKERS; i++) {
+		config.stack = sys_wq_stacks[i];
+		nano_workqueue_worker_add(&sys_workqueue, &config);
+	}
 
 	return 0;
 }
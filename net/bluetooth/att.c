@@ -367,6 +367,7 @@ struct find_type_data {
 	struct net_buf *buf;
 	struct bt_att_handle_group *group;
 	const void *value;
+	uint16_t end_handle;
 	uint8_t value_len;
 	uint8_t err;
 };
@@ -379,20 +380,6 @@ static uint8_t find_type_cb(const struct bt_gatt_attr *attr, void *user_data)
 	int read;
 	uint8_t uuid[16];
 
-	/* Skip secondary services */
-	if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_SECONDARY)) {
-		data->group = NULL;
-		return BT_GATT_ITER_CONTINUE;
-	}
-
-	/* Update group end_handle if not a primary service */
-	if (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_PRIMARY)) {
-		if (data->group && attr->handle > data->group->end_handle) {
-			data->group->end_handle = sys_cpu_to_le16(attr->handle);
-		}
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	BT_DBG("handle 0x%04x", attr->handle);
 
 	/* stop if there is no space left */
@@ -407,13 +394,11 @@ static uint8_t find_type_cb(const struct bt_gatt_attr *attr, void *user_data)
 		 * Since we don't know if it is the service with requested UUID,
 		 * we cannot respond with an error to this request.
 		 */
-		data->group = NULL;
 		return BT_GATT_ITER_CONTINUE;
 	}
 
 	/* Check if data matches */
 	if (read != data->value_len || memcmp(data->value, uuid, read)) {
-		data->group = NULL;
 		return BT_GATT_ITER_CONTINUE;
 	}
 
@@ -423,9 +408,9 @@ static uint8_t find_type_cb(const struct bt_gatt_attr *attr, void *user_data)
 	/* Fast foward to next item position */
 	data->group = net_buf_add(data->buf, sizeof(*data->group));
 	data->group->start_handle = sys_cpu_to_le16(attr->handle);
-	data->group->end_handle = sys_cpu_to_le16(attr->handle);
+	data->group->end_handle =
+		sys_cpu_to_le16(bt_gatt_service_end(attr, data->end_handle));
 
-	/* continue to find the end_handle */
 	return BT_GATT_ITER_CONTINUE;
 }
 
@@ -447,11 +432,14 @@ static uint8_t att_find_type_rsp(struct bt_att *att, uint16_t start_handle,
 	data.group = NULL;
 	data.value = value;
 	data.value_len = value_len;
+	data.end_handle = end_handle;
 
 	/* Pre-set error in case no service will be found */
 	data.err = BT_ATT_ERR_ATTRIBUTE_NOT_FOUND;
 
-	bt_gatt_foreach_attr(start_handle, end_handle, find_type_cb, &data);
+	/* Only primary services can be found by type */
+	bt_gatt_foreach_attr_type(start_handle, end_handle, BT_UUID_GATT_PRIMARY,
+				  find_type_cb, &data);
 
 	/* If error has not been cleared, no service has been found */
 	if (data.err) {
@@ -585,11 +573,6 @@ static uint8_t read_type_cb(const struct bt_gatt_attr *attr, void *user_data)
 	struct bt_conn *conn = att->chan.conn;
 	int read;
 
-	/* Skip if doesn't match */
-	if (bt_uuid_cmp(attr->uuid, data->uuid)) {
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	BT_DBG("handle 0x%04x", attr->handle);
 
 	/*
@@ -666,7 +649,8 @@ static uint8_t att_read_type_rsp(struct bt_att *att, struct bt_uuid *uuid,
 	/* Pre-set error if no attr will be found in handle */
 	data.err = BT_ATT_ERR_ATTRIBUTE_NOT_FOUND;
 
-	bt_gatt_foreach_attr(start_handle, end_handle, read_type_cb, &data);
+	bt_gatt_foreach_attr_type(start_handle, end_handle, uuid, read_type_cb,
+				  &data);
 
 	if (data.err) {
 		net_buf_unref(data.buf);
@@ -889,6 +873,7 @@ struct read_group_data {
 	struct net_buf *buf;
 	struct bt_att_read_group_rsp *rsp;
 	struct bt_att_group_data *group;
+	uint16_t end_handle;
 };
 
 static uint8_t read_group_cb(const struct bt_gatt_attr *attr, void *user_data)
@@ -898,21 +883,6 @@ static uint8_t read_group_cb(const struct bt_gatt_attr *attr, void *user_data)
 	struct bt_conn *conn = att->chan.conn;
 	int read;
 
-	/* Update group end_handle if attribute is not a service */
-	if (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_PRIMARY) &&
-	    bt_uuid_cmp(attr->uuid, BT_UUID_GATT_SECONDARY)) {
-		if (data->group && attr->handle > data->group->end_handle) {
-			data->group->end_handle = sys_cpu_to_le16(attr->handle);
-		}
-		return BT_GATT_ITER_CONTINUE;
-	}
-
-	/* If Group Type don't match skip */
-	if (bt_uuid_cmp(attr->uuid, data->uuid)) {
-		data->group = NULL;
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	BT_DBG("handle 0x%04x", attr->handle);
 
 	/* Stop if there is no space left */
@@ -926,7 +896,8 @@ static uint8_t read_group_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	/* Initialize group handle range */
 	data->group->start_handle = sys_cpu_to_le16(attr->handle);
-	data->group->end_handle = sys_cpu_to_le16(attr->handle);
+	data->group->end_handle =
+		sys_cpu_to_le16(bt_gatt_service_end(attr, data->end_handle));
 
 	/* Read attribute value and store in the buffer */
 	read = attr->read(conn, attr, data->buf->data + data->buf->len,
@@ -947,7 +918,6 @@ static uint8_t read_group_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	net_buf_add(data->buf, read);
 
-	/* Continue to find the end handle */
 	return BT_GATT_ITER_CONTINUE;
 }
 
@@ -970,8 +940,10 @@ static uint8_t att_read_group_rsp(struct bt_att *att, struct bt_uuid *uuid,
 	data.rsp = net_buf_add(data.buf, sizeof(*data.rsp));
 	data.rsp->len = 0;
 	data.group = NULL;
+	data.end_handle = end_handle;
 
-	bt_gatt_foreach_attr(start_handle, end_handle, read_group_cb, &data);
+	bt_gatt_foreach_attr_type(start_handle, end_handle, uuid, read_group_cb,
+				  &data);
 
 	if (!data.rsp->len) {
 		net_buf_unref(data.buf);
@@ -1726,6 +1698,8 @@ void bt_att_init(void)
 
 	net_buf_pool_init(att_pool);
 
+	bt_gatt_init();
+
 	bt_l2cap_le_fixed_chan_register(&chan);
 }
 
@@ -19,12 +19,14 @@
 #include <nanokernel.h>
 #include <arch/cpu.h>
 #include <toolchain.h>
+#include <sections.h>
 #include <string.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <atomic.h>
 #include <misc/byteorder.h>
 #include <misc/util.h>
+#include <misc/stack.h>
 
 #include <bluetooth/log.h>
 #include <bluetooth/hci.h>
@@ -44,14 +46,32 @@
 #define BT_DBG(fmt, ...)
 #endif
 
-/* Pool for outgoing ACL fragments */
+/* Pool for the headers of outgoing ACL fragments, the payload of the
+ * fragments is referenced by slices of the original buffer.
+ */
 static struct nano_fifo frag_buf;
-static NET_BUF_POOL(frag_pool, 1, BT_L2CAP_BUF_SIZE(23), &frag_buf, NULL,
+static NET_BUF_POOL(frag_pool, 1, CONFIG_BLUETOOTH_HCI_SEND_RESERVE +
+		    sizeof(struct bt_hci_acl_hdr), &frag_buf, NULL,
 		    BT_BUF_USER_DATA_MIN);
 
-/* Pool for dummy buffers to wake up the tx fibers */
-static struct nano_fifo dummy;
-static NET_BUF_POOL(dummy_pool, CONFIG_BLUETOOTH_MAX_CONN, 0, &dummy, NULL, 0);
+/* A fragment may reference the end of a buffer and the start of the next */
+static struct nano_fifo frag_slices;
+static NET_BUF_SLICE_POOL(frag_slice_pool, 2, &frag_slices);
+
+/* TX scheduler fiber, serving the tx_queue of all connections */
+static BT_STACK_NOINIT(tx_fiber_stack, 256);
+static struct nano_sem tx_notify;
+
+/* Connection the next TX scheduler round starts with */
+static uint8_t tx_next;
+
+/* ACL packets the controller can still take, per link type. Only the TX
+ * scheduler takes them, they are returned from the HCI RX path.
+ */
+static atomic_t le_tx_credits;
+#if defined(CONFIG_BLUETOOTH_BREDR)
+static atomic_t br_tx_credits;
+#endif /* CONFIG_BLUETOOTH_BREDR */
 
 /* How long until we cancel HCI_LE_Create_Connection */
 #define CONN_TIMEOUT	(3 * sys_clock_ticks_per_sec)
@@ -136,6 +156,33 @@ void notify_le_param_updated(struct bt_conn *conn)
 	}
 }
 
+static void conn_timeout(struct nano_work *work)
+{
+	struct bt_conn *conn = CONTAINER_OF(work, struct bt_conn, timeout);
+
+	/* The flag is cleared if the timeout was cancelled after expiring */
+	if (atomic_test_and_clear_bit(conn->flags, BT_CONN_TIMEOUT)) {
+		bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	}
+
+	/* Drop the reference taken for the timeout */
+	bt_conn_unref(conn);
+}
+
+static void conn_timeout_cancel(struct bt_conn *conn)
+{
+	/* Already expired, conn_timeout() will drop the reference */
+	if (nano_delayed_work_cancel(&conn->timeout) == -EINPROGRESS) {
+		atomic_clear_bit(conn->flags, BT_CONN_TIMEOUT);
+		return;
+	}
+
+	/* Drop the reference taken for the timeout */
+	if (atomic_test_and_clear_bit(conn->flags, BT_CONN_TIMEOUT)) {
+		bt_conn_unref(conn);
+	}
+}
+
 static struct bt_conn *conn_new(void)
 {
 	struct bt_conn *conn = NULL;
@@ -155,6 +202,7 @@ static struct bt_conn *conn_new(void)
 	memset(conn, 0, sizeof(*conn));
 
 	atomic_set(&conn->ref, 1);
+	nano_delayed_work_init(&conn->timeout, conn_timeout);
 
 	return conn;
 }
@@ -836,6 +884,63 @@ int bt_conn_send(struct bt_conn *conn, struct net_buf *buf)
 	}
 
 	nano_fifo_put(&conn->tx_queue, buf);
+	nano_sem_give(&tx_notify);
+
+	return 0;
+}
+
+void bt_conn_tx_notify(void)
+{
+	nano_sem_give(&tx_notify);
+}
+
+static atomic_t *tx_credits(uint8_t type)
+{
+#if defined(CONFIG_BLUETOOTH_BREDR)
+	if (type == BT_CONN_TYPE_BR || !bt_dev.le.mtu) {
+		return &br_tx_credits;
+	}
+#endif /* CONFIG_BLUETOOTH_BREDR */
+
+	return &le_tx_credits;
+}
+
+void bt_conn_tx_credits_init(uint8_t type, uint16_t count)
+{
+	atomic_set(tx_credits(type), count);
+}
+
+int bt_conn_tx_credits_get(uint8_t type)
+{
+	return atomic_get(tx_credits(type));
+}
+
+void bt_conn_tx_complete(struct bt_conn *conn, uint16_t count)
+{
+	if (conn->pending_pkts >= count) {
+		conn->pending_pkts -= count;
+	} else {
+		BT_ERR("completed packets mismatch: %u > %u",
+		       count, conn->pending_pkts);
+		conn->pending_pkts = 0;
+	}
+
+	atomic_add(tx_credits(conn->type), count);
+}
+
+void bt_conn_tx_stack_analyze(void)
+{
+	stack_analyze("conn tx stack", tx_fiber_stack, sizeof(tx_fiber_stack));
+}
+
+int bt_conn_set_tx_weight(struct bt_conn *conn, uint8_t weight)
+{
+	if (!weight) {
+		return -EINVAL;
+	}
+
+	conn->tx_weight = weight;
+
 	return 0;
 }
 
@@ -848,17 +953,17 @@ static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 	BT_DBG("conn %p buf %p len %u flags 0x%02x", conn, buf, buf->len,
 	       flags);
 
-	/* Wait until the controller can accept ACL packets */
-	nano_fiber_sem_take(bt_conn_get_pkts(conn), TICKS_UNLIMITED);
+	/* The TX scheduler checked that the controller can take it */
+	atomic_dec(tx_credits(conn->type));
 
-	/* Check for disconnection while waiting for pkts_sem */
+	/* Check for disconnection while waiting for a fragment buffer */
 	if (conn->state != BT_CONN_CONNECTED) {
 		goto fail;
 	}
 
 	hdr = net_buf_push(buf, sizeof(*hdr));
 	hdr->handle = sys_cpu_to_le16(bt_acl_handle_pack(conn->handle, flags));
-	hdr->len = sys_cpu_to_le16(buf->len - sizeof(*hdr));
+	hdr->len = sys_cpu_to_le16(net_buf_frags_len(buf) - sizeof(*hdr));
 
 	bt_buf_set_type(buf, BT_BUF_ACL_OUT);
 
@@ -872,7 +977,7 @@ static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 	return true;
 
 fail:
-	nano_fiber_sem_give(bt_conn_get_pkts(conn));
+	atomic_inc(tx_credits(conn->type));
 	if (always_consume) {
 		net_buf_unref(buf);
 	}
@@ -892,8 +997,9 @@ static inline uint16_t conn_mtu(struct bt_conn *conn)
 
 static struct net_buf *create_frag(struct bt_conn *conn, struct net_buf *buf)
 {
-	struct net_buf *frag;
-	uint16_t frag_len;
+	struct net_buf *frag, *slice;
+	uint16_t frag_len, len;
+	size_t offset;
 
 	frag = bt_conn_create_pdu(&frag_buf, 0);
 
@@ -902,73 +1008,91 @@ static struct net_buf *create_frag(struct bt_conn *conn, struct net_buf *buf)
 		return NULL;
 	}
 
-	frag_len = min(conn_mtu(conn), net_buf_tailroom(frag));
+	frag_len = min(conn_mtu(conn),
+		       net_buf_frags_len(buf) - conn->tx_offset);
 
-	memcpy(net_buf_add(frag, frag_len), buf->data, frag_len);
-	net_buf_pull(buf, frag_len);
+	/* Reference the payload instead of copying it. The packet is left
+	 * untouched, its fragments may be shared with other connections.
+	 */
+	for (offset = conn->tx_offset; frag_len; frag_len -= len) {
+		while (offset >= buf->len) {
+			offset -= buf->len;
+			buf = buf->frags;
+		}
+
+		len = min(frag_len, buf->len - offset);
+
+		slice = net_buf_slice_at(&frag_slices, buf, offset, len);
+		if (!slice) {
+			net_buf_unref(frag);
+			return NULL;
+		}
+
+		net_buf_frag_add(frag, slice);
+		offset += len;
+	}
+
+	conn->tx_offset += net_buf_frags_len(frag);
 
 	return frag;
 }
 
-static bool send_buf(struct bt_conn *conn, struct net_buf *buf)
+/* The controller has a free buffer for the connection's link type */
+static inline bool conn_tx_credits(struct bt_conn *conn)
 {
+	return atomic_get(tx_credits(conn->type)) > 0;
+}
+
+/* Send the ACL fragments of a packet for as long as the controller has
+ * buffers for them, starting at conn->tx_offset. Returns the packet if the
+ * controller ran out of buffers in the middle of it, or NULL once it has
+ * been sent or dropped.
+ */
+static struct net_buf *send_buf(struct bt_conn *conn, struct net_buf *buf)
+{
+	uint8_t flags = BT_ACL_CONT;
 	struct net_buf *frag;
 
-	BT_DBG("conn %p buf %p len %u", conn, buf, buf->len);
+	BT_DBG("conn %p buf %p len %u offset %u", conn, buf,
+	       net_buf_frags_len(buf), conn->tx_offset);
 
-	/* Send directly if the packet fits the ACL MTU */
-	if (buf->len <= conn_mtu(conn)) {
-		return send_frag(conn, buf, BT_ACL_START_NO_FLUSH, false);
-	}
+	if (!conn->tx_offset) {
+		flags = BT_ACL_START_NO_FLUSH;
 
-	/* Create & enqueue first fragment */
-	frag = create_frag(conn, buf);
-	if (!frag) {
-		return false;
-	}
+		/* Send directly if the packet fits the ACL MTU */
+		if (net_buf_frags_len(buf) <= conn_mtu(conn)) {
+			if (!send_frag(conn, buf, flags, false)) {
+				net_buf_unref(buf);
+			}
 
-	if (!send_frag(conn, frag, BT_ACL_START_NO_FLUSH, true)) {
-		return false;
+			return NULL;
+		}
 	}
 
-	/*
-	 * Send the fragments. For the last one simply use the original
-	 * buffer (which works since we've used net_buf_pull on it.
-	 */
-	while (buf->len > conn_mtu(conn)) {
-		frag = create_frag(conn, buf);
-		if (!frag) {
-			return false;
+	while (conn->tx_offset < net_buf_frags_len(buf)) {
+		if (!conn_tx_credits(conn)) {
+			return buf;
 		}
 
-		if (!send_frag(conn, frag, BT_ACL_CONT, true)) {
-			return false;
+		frag = create_frag(conn, buf);
+		if (!frag || !send_frag(conn, frag, flags, true)) {
+			break;
 		}
+
+		flags = BT_ACL_CONT;
 	}
 
-	return send_frag(conn, buf, BT_ACL_CONT, false);
+	/* The fragments sent keep the data they reference */
+	conn->tx_offset = 0;
+	net_buf_unref(buf);
+
+	return NULL;
 }
 
-static void conn_tx_fiber(int arg1, int arg2)
+static void conn_tx_cleanup(struct bt_conn *conn)
 {
-	struct bt_conn *conn = (struct bt_conn *)arg1;
 	struct net_buf *buf;
 
-	BT_DBG("Started for handle %u", conn->handle);
-
-	while (conn->state == BT_CONN_CONNECTED) {
-		/* Get next ACL packet for connection */
-		buf = nano_fifo_get(&conn->tx_queue, TICKS_UNLIMITED);
-		if (conn->state != BT_CONN_CONNECTED) {
-			net_buf_unref(buf);
-			break;
-		}
-
-		if (!send_buf(conn, buf)) {
-			net_buf_unref(buf);
-		}
-	}
-
 	BT_DBG("handle %u disconnected - cleaning up", conn->handle);
 
 	/* Give back any allocated buffers */
@@ -976,17 +1100,107 @@ static void conn_tx_fiber(int arg1, int arg2)
 		net_buf_unref(buf);
 	}
 
-	/* Return any unacknowledged packets */
-	if (conn->pending_pkts) {
-		while (conn->pending_pkts--) {
-			nano_fiber_sem_give(bt_conn_get_pkts(conn));
-		}
+	if (conn->tx_buf) {
+		net_buf_unref(conn->tx_buf);
+		conn->tx_buf = NULL;
 	}
 
+	conn->tx_offset = 0;
+
+	/* Return the controller buffers of any unacknowledged packets */
+	atomic_add(tx_credits(conn->type), conn->pending_pkts);
+	conn->pending_pkts = 0;
+
 	bt_conn_reset_rx_state(conn);
+}
 
-	BT_DBG("handle %u exiting", conn->handle);
-	bt_conn_unref(conn);
+/* Serve each connection once, sending up to tx_weight packets for it. When
+ * the controller runs out of buffers, the next round starts with the first
+ * connection that could not be served, so that no connection is starved. A
+ * packet only partly sent is kept on its connection, and finished before
+ * any other packet of that connection.
+ * Returns the number of packets sent or resumed.
+ */
+static int conn_tx_round(void)
+{
+	int resume = -1;
+	int sent = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(conns); i++) {
+		int idx = (tx_next + i) % ARRAY_SIZE(conns);
+		struct bt_conn *conn = &conns[idx];
+		struct net_buf *buf;
+		int quota;
+
+		if (conn->state != BT_CONN_CONNECTED) {
+			continue;
+		}
+
+		for (quota = conn->tx_weight; quota > 0; quota--) {
+			if (!conn_tx_credits(conn)) {
+				if (resume < 0) {
+					resume = idx;
+				}
+				break;
+			}
+
+			if (conn->tx_buf) {
+				buf = conn->tx_buf;
+				conn->tx_buf = NULL;
+			} else {
+				buf = nano_fifo_get(&conn->tx_queue,
+						    TICKS_NONE);
+				if (!buf) {
+					break;
+				}
+			}
+
+			buf = send_buf(conn, buf);
+			sent++;
+
+			if (!buf) {
+				continue;
+			}
+
+			/* Out of controller buffers in the middle of it, the
+			 * connection was served so it goes last next round.
+			 */
+			if (conn->state == BT_CONN_CONNECTED) {
+				conn->tx_buf = buf;
+			} else {
+				conn->tx_offset = 0;
+				net_buf_unref(buf);
+			}
+
+			if (resume < 0) {
+				resume = (idx + 1) % ARRAY_SIZE(conns);
+			}
+			break;
+		}
+	}
+
+	if (resume >= 0) {
+		tx_next = resume;
+	} else {
+		tx_next = (tx_next + 1) % ARRAY_SIZE(conns);
+	}
+
+	return sent;
+}
+
+static void conn_tx_fiber(int arg1, int arg2)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	while (1) {
+		/* Wait for new data or new controller buffers */
+		nano_fiber_sem_take(&tx_notify, TICKS_UNLIMITED);
+
+		while (conn_tx_round()) {
+		}
+	}
 }
 
 struct bt_conn *bt_conn_add_le(const bt_addr_le_t *peer)
@@ -1009,18 +1223,6 @@ struct bt_conn *bt_conn_add_le(const bt_addr_le_t *peer)
 	return conn;
 }
 
-static void timeout_fiber(int arg1, int arg2)
-{
-	struct bt_conn *conn = (struct bt_conn *)arg1;
-
-	ARG_UNUSED(arg2);
-
-	conn->timeout = NULL;
-
-	bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
-	bt_conn_unref(conn);
-}
-
 void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 {
 	bt_conn_state_t old_state;
@@ -1045,13 +1247,7 @@ void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 		bt_conn_ref(conn);
 		break;
 	case BT_CONN_CONNECT:
-		if (conn->timeout) {
-			fiber_delayed_start_cancel(conn->timeout);
-			conn->timeout = NULL;
-
-			/* Drop the reference taken by timeout fiber */
-			bt_conn_unref(conn);
-		}
+		conn_timeout_cancel(conn);
 		break;
 	default:
 		break;
@@ -1061,23 +1257,23 @@ void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 	switch (conn->state) {
 	case BT_CONN_CONNECTED:
 		nano_fifo_init(&conn->tx_queue);
-		fiber_start(conn->stack, sizeof(conn->stack), conn_tx_fiber,
-			    (int)bt_conn_ref(conn), 0, 7, 0);
+		if (!conn->tx_weight) {
+			conn->tx_weight = 1;
+		}
 
 		bt_l2cap_connected(conn);
 		notify_connected(conn);
 		break;
 	case BT_CONN_DISCONNECTED:
-		/* Notify disconnection and queue a dummy buffer to wake
-		 * up and stop the tx fiber for states where it was
-		 * running.
+		/* Notify disconnection and clean up the TX state for
+		 * states where the TX scheduler was serving the connection.
 		 */
 		if (old_state == BT_CONN_CONNECTED ||
 		    old_state == BT_CONN_DISCONNECT) {
 			bt_l2cap_disconnected(conn);
 			notify_disconnected(conn);
 
-			nano_fifo_put(&conn->tx_queue, net_buf_get(&dummy, 0));
+			conn_tx_cleanup(conn);
 		} else if (old_state == BT_CONN_CONNECT) {
 			/* conn->err will be set in this case */
 			notify_connected(conn);
@@ -1104,11 +1300,9 @@ void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 		}
 
 		/* Add LE Create Connection timeout */
-		conn->timeout = fiber_delayed_start(conn->stack,
-						    sizeof(conn->stack),
-						    timeout_fiber,
-						    (int)bt_conn_ref(conn),
-						    0, 7, 0, CONN_TIMEOUT);
+		bt_conn_ref(conn);
+		atomic_set_bit(conn->flags, BT_CONN_TIMEOUT);
+		nano_delayed_work_submit(&conn->timeout, CONN_TIMEOUT);
 		break;
 	case BT_CONN_DISCONNECT:
 		break;
@@ -1267,13 +1461,7 @@ static int bt_hci_connect_le_cancel(struct bt_conn *conn)
 {
 	int err;
 
-	if (conn->timeout) {
-		fiber_delayed_start_cancel(conn->timeout);
-		conn->timeout = NULL;
-
-		/* Drop the reference took by timeout fiber */
-		bt_conn_unref(conn);
-	}
+	conn_timeout_cancel(conn);
 
 	err = bt_hci_cmd_send(BT_HCI_OP_LE_CREATE_CONN_CANCEL, NULL);
 	if (err) {
@@ -1641,7 +1829,11 @@ int bt_conn_init(void)
 	int err;
 
 	net_buf_pool_init(frag_pool);
-	net_buf_pool_init(dummy_pool);
+	net_buf_pool_init(frag_slice_pool);
+
+	nano_sem_init(&tx_notify);
+	fiber_start(tx_fiber_stack, sizeof(tx_fiber_stack), conn_tx_fiber,
+		    0, 0, 7, 0);
 
 	bt_att_init();
 
@@ -18,6 +18,8 @@
  * limitations under the License.
  */
 
+#include <misc/nano_work.h>
+
 typedef enum __packed {
 	BT_CONN_DISCONNECTED,
 	BT_CONN_CONNECT_SCAN,
@@ -34,6 +36,7 @@ enum {
 	BT_CONN_BR_PAIRING,		/* BR connection in pairing context */
 	BT_CONN_BR_NOBOND,		/* SSP no bond pairing tracker */
 	BT_CONN_BR_PAIRING_INITIATOR,	/* local host starts authentication */
+	BT_CONN_TIMEOUT,		/* LE Create Connection timeout pending */
 };
 
 struct bt_conn_le {
@@ -75,12 +78,21 @@ struct bt_conn {
 
 	uint8_t			pending_pkts;
 
+	/* Packets sent per TX scheduler round while others are waiting */
+	uint8_t			tx_weight;
+
 	uint16_t		rx_len;
 	struct net_buf		*rx;
 
 	/* Queue for outgoing ACL data */
 	struct nano_fifo	tx_queue;
 
+	/* Packet the controller ran out of buffers for, and how much of it
+	 * has been sent.
+	 */
+	struct net_buf		*tx_buf;
+	uint16_t		tx_offset;
+
 	struct bt_keys		*keys;
 
 	/* L2CAP channels */
@@ -93,8 +105,8 @@ struct bt_conn {
 
 	bt_conn_state_t		state;
 
-	/* Handle allowing to cancel timeout fiber */
-	nano_thread_id_t timeout;
+	/* LE Create Connection timeout */
+	struct nano_delayed_work timeout;
 
 	union {
 		struct bt_conn_le	le;
@@ -102,12 +114,6 @@ struct bt_conn {
 		struct bt_conn_br	br;
 #endif
 	};
-
-	/* Stack for TX fiber and timeout fiber.
-	 * Since these fibers don't overlap, one stack can be used by
-	 * both of them.
-	 */
-	BT_STACK(stack, 256);
 };
 
 /* Process incoming data for a connection */
@@ -116,6 +122,21 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags);
 /* Send data over a connection */
 int bt_conn_send(struct bt_conn *conn, struct net_buf *buf);
 
+/* Wake up the TX scheduler, e.g. when the controller returned buffers */
+void bt_conn_tx_notify(void);
+
+/* Set the number of ACL packets the controller can take for a link type */
+void bt_conn_tx_credits_init(uint8_t type, uint16_t count);
+
+/* Get the number of ACL packets the controller can still take */
+int bt_conn_tx_credits_get(uint8_t type);
+
+/* The controller has sent count packets of the connection */
+void bt_conn_tx_complete(struct bt_conn *conn, uint16_t count);
+
+/* Check the stack usage of the TX scheduler fiber */
+void bt_conn_tx_stack_analyze(void);
+
 /* Add a new LE connection */
 struct bt_conn *bt_conn_add_le(const bt_addr_le_t *peer);
 
@@ -168,15 +189,3 @@ struct net_buf *bt_conn_create_pdu(struct nano_fifo *fifo, size_t reserve);
 
 /* Initialize connection management */
 int bt_conn_init(void);
-
-/* Selects based on connecton type right semaphore for ACL packets */
-static inline struct nano_sem *bt_conn_get_pkts(struct bt_conn *conn)
-{
-#if defined(CONFIG_BLUETOOTH_BREDR)
-	if (conn->type == BT_CONN_TYPE_BR || !bt_dev.le.mtu) {
-		return &bt_dev.br.pkts;
-	}
-#endif /* CONFIG_BLUETOOTH_BREDR */
-
-	return &bt_dev.le.pkts;
-}
@@ -55,11 +55,233 @@ static struct bt_gatt_subscribe_params *subscriptions;
 static size_t attr_count;
 #endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
 
+/* Attribute tables given to bt_gatt_register(). Handles only grow within
+ * a table and from a table to the next one, so attributes are looked up by
+ * handle with binary searches instead of walking the database.
+ */
+struct gatt_table {
+	struct bt_gatt_attr	*attrs;
+	uint16_t		count;
+};
+
+#if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+/* Tables registered once this is full are still linked in the database,
+ * they are reached by walking from the last indexed table.
+ */
+static struct gatt_table tables[CONFIG_BLUETOOTH_GATT_DYNAMIC_DB_TABLES];
+#else
+static struct gatt_table tables[1];
+#endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+static uint8_t table_count;
+
+/* Attribute types having an index of their attributes, in handle order */
+enum {
+	GATT_INDEX_PRIMARY,
+	GATT_INDEX_SECONDARY,
+	GATT_INDEX_INCLUDE,
+	GATT_INDEX_CHRC,
+	GATT_INDEX_CCC,
+
+	GATT_INDEX_TYPES,
+};
+
+/* The attributes of each type are kept in the slice
+ * type_index[type_start[type]] to type_index[type_start[type + 1] - 1].
+ * If there is no room left for an attribute, the index is not used anymore
+ * and lookups by type fall back to walking the attributes.
+ */
+static struct bt_gatt_attr *type_index[CONFIG_BLUETOOTH_GATT_INDEX_SIZE];
+static uint8_t type_start[GATT_INDEX_TYPES + 1];
+static bool type_index_full;
+
+static int gatt_index_type(const struct bt_uuid *uuid)
+{
+	if (!bt_uuid_cmp(uuid, BT_UUID_GATT_PRIMARY)) {
+		return GATT_INDEX_PRIMARY;
+	}
+
+	if (!bt_uuid_cmp(uuid, BT_UUID_GATT_SECONDARY)) {
+		return GATT_INDEX_SECONDARY;
+	}
+
+	if (!bt_uuid_cmp(uuid, BT_UUID_GATT_INCLUDE)) {
+		return GATT_INDEX_INCLUDE;
+	}
+
+	if (!bt_uuid_cmp(uuid, BT_UUID_GATT_CHRC)) {
+		return GATT_INDEX_CHRC;
+	}
+
+	if (!bt_uuid_cmp(uuid, BT_UUID_GATT_CCC)) {
+		return GATT_INDEX_CCC;
+	}
+
+	return -ENOENT;
+}
+
+static void type_index_add(int type, struct bt_gatt_attr *attr)
+{
+	uint8_t pos = type_start[type + 1];
+	uint8_t len = type_start[GATT_INDEX_TYPES];
+	int i;
+
+	if (len == ARRAY_SIZE(type_index)) {
+		BT_WARN("GATT type index full");
+		type_index_full = true;
+		return;
+	}
+
+	/* Handles are registered in growing order, append to the slice */
+	memmove(&type_index[pos + 1], &type_index[pos],
+		(len - pos) * sizeof(type_index[0]));
+	type_index[pos] = attr;
+
+	for (i = type + 1; i <= GATT_INDEX_TYPES; i++) {
+		type_start[i]++;
+	}
+}
+
+static void gatt_index_add(struct bt_gatt_attr *attrs, size_t count)
+{
+	int type;
+
+	if (table_count < ARRAY_SIZE(tables)) {
+		tables[table_count].attrs = attrs;
+		tables[table_count].count = count;
+		table_count++;
+	}
+
+	for (; count; attrs++, count--) {
+		type = gatt_index_type(attrs->uuid);
+		if (type >= 0 && !type_index_full) {
+			type_index_add(type, attrs);
+		}
+	}
+}
+
+static inline struct bt_gatt_attr *table_last(struct gatt_table *table)
+{
+	return &table->attrs[table->count - 1];
+}
+
+/* Index of the first attribute of the table with a handle not below the
+ * given one, the table must have such an attribute.
+ */
+static int table_lower_bound(struct gatt_table *table, uint16_t handle)
+{
+	int lo = 0, hi = table->count - 1;
+
+	/* Handles are usually allocated without holes */
+	if (handle >= table->attrs[0].handle &&
+	    handle - table->attrs[0].handle < table->count &&
+	    table->attrs[handle - table->attrs[0].handle].handle == handle) {
+		return handle - table->attrs[0].handle;
+	}
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (table->attrs[mid].handle < handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/* Find the first attribute with a handle not below the given one */
+static struct bt_gatt_attr *gatt_attr_find(uint16_t handle)
+{
+	int lo = 0, hi = table_count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (table_last(&tables[mid])->handle < handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo < table_count) {
+		return &tables[lo].attrs[table_lower_bound(&tables[lo],
+							   handle)];
+	}
+
+#if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+	if (table_count) {
+		struct bt_gatt_attr *attr;
+
+		/* Walk the tables that did not fit in the index */
+		for (attr = table_last(&tables[table_count - 1])->_next;
+		     attr && attr->handle < handle; attr = attr->_next) {
+		}
+
+		return attr;
+	}
+#endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+
+	return NULL;
+}
+
+/* Find the last attribute with a handle not above the given one */
+static struct bt_gatt_attr *gatt_attr_find_last(uint16_t handle)
+{
+	struct bt_gatt_attr *attr;
+	int lo = 0, hi = table_count;
+	int i;
+
+	/* Find the first table starting above the handle */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (tables[mid].attrs[0].handle <= handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (!lo) {
+		return NULL;
+	}
+
+	attr = table_last(&tables[lo - 1]);
+
+#if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+	if (lo == table_count) {
+		struct bt_gatt_attr *next;
+
+		/* Walk the tables that did not fit in the index */
+		for (next = attr->_next; next && next->handle <= handle;
+		     next = next->_next) {
+			attr = next;
+		}
+	}
+#endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+
+	if (attr->handle <= handle) {
+		return attr;
+	}
+
+	i = table_lower_bound(&tables[lo - 1], handle);
+	if (tables[lo - 1].attrs[i].handle > handle) {
+		i--;
+	}
+
+	return &tables[lo - 1].attrs[i];
+}
+
 int bt_gatt_register(struct bt_gatt_attr *attrs, size_t count)
 {
 #if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
 	struct bt_gatt_attr *last;
 #endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+	struct bt_gatt_attr *first = attrs;
+	size_t total = count;
 	uint16_t handle;
 
 	if (!attrs || !count) {
@@ -70,6 +292,11 @@ int bt_gatt_register(struct bt_gatt_attr *attrs, size_t count)
 	handle = 0;
 	db = attrs;
 	attr_count = count;
+
+	/* The new table replaces the database */
+	table_count = 0;
+	memset(type_start, 0, sizeof(type_start));
+	type_index_full = false;
 #else
 	if (!db) {
 		db = attrs;
@@ -79,9 +306,7 @@ int bt_gatt_register(struct bt_gatt_attr *attrs, size_t count)
 	}
 
 	/* Fast forward to last attribute in the list */
-	for (last = db; last->_next;) {
-		last = last->_next;
-	}
+	last = gatt_attr_find_last(0xffff);
 
 	handle = last->handle;
 	last->_next = attrs;
@@ -99,7 +324,11 @@ populate:
 		} else {
 			/* Service has conflicting handles */
 #if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
-			last->_next = NULL;
+			if (last) {
+				last->_next = NULL;
+			} else {
+				db = NULL;
+			}
 #endif
 			BT_ERR("Unable to register handle 0x%04x",
 			       attrs->handle);
@@ -117,6 +346,8 @@ populate:
 		       bt_uuid_str(attrs->uuid), attrs->perm);
 	}
 
+	gatt_index_add(first, total);
+
 	return 0;
 }
 
@@ -260,18 +491,125 @@ void bt_gatt_foreach_attr(uint16_t start_handle, uint16_t end_handle,
 {
 	const struct bt_gatt_attr *attr;
 
-	for (attr = db; attr; attr = bt_gatt_attr_next(attr)) {
-		/* Check if attribute handle is within range */
-		if (attr->handle < start_handle || attr->handle > end_handle) {
-			continue;
+	for (attr = gatt_attr_find(start_handle);
+	     attr && attr->handle <= end_handle;
+	     attr = bt_gatt_attr_next(attr)) {
+		if (func(attr, user_data) == BT_GATT_ITER_STOP) {
+			break;
 		}
+	}
+}
 
-		if (func(attr, user_data) == BT_GATT_ITER_STOP) {
+/* Index of the first attribute of the type slice with a handle not below
+ * the given one, or the end of the slice.
+ */
+static int type_index_find(int type, uint16_t handle)
+{
+	int lo = type_start[type], hi = type_start[type + 1];
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (type_index[mid]->handle < handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+void bt_gatt_foreach_attr_type(uint16_t start_handle, uint16_t end_handle,
+			       const struct bt_uuid *uuid,
+			       bt_gatt_attr_func_t func, void *user_data)
+{
+	const struct bt_gatt_attr *attr;
+	int type, i;
+
+	type = gatt_index_type(uuid);
+	if (type < 0 || type_index_full) {
+		for (attr = gatt_attr_find(start_handle);
+		     attr && attr->handle <= end_handle;
+		     attr = bt_gatt_attr_next(attr)) {
+			if (bt_uuid_cmp(attr->uuid, uuid)) {
+				continue;
+			}
+
+			if (func(attr, user_data) == BT_GATT_ITER_STOP) {
+				break;
+			}
+		}
+
+		return;
+	}
+
+	for (i = type_index_find(type, start_handle);
+	     i < type_start[type + 1] && type_index[i]->handle <= end_handle;
+	     i++) {
+		if (func(type_index[i], user_data) == BT_GATT_ITER_STOP) {
 			break;
 		}
 	}
 }
 
+/* Find the handle of the first attribute of one of the given types after
+ * the attribute, or 0 if there is none.
+ */
+static uint16_t gatt_find_next_type(const struct bt_gatt_attr *attr,
+				    const int *types, size_t count)
+{
+	uint16_t next = 0;
+	size_t j;
+	int i;
+
+	if (type_index_full) {
+		for (attr = bt_gatt_attr_next(attr); attr;
+		     attr = bt_gatt_attr_next(attr)) {
+			int type = gatt_index_type(attr->uuid);
+
+			for (j = 0; j < count; j++) {
+				if (type == types[j]) {
+					return attr->handle;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	for (j = 0; j < count; j++) {
+		i = type_index_find(types[j], attr->handle + 1);
+		if (i == type_start[types[j] + 1]) {
+			continue;
+		}
+
+		if (!next || type_index[i]->handle < next) {
+			next = type_index[i]->handle;
+		}
+	}
+
+	return next;
+}
+
+uint16_t bt_gatt_service_end(const struct bt_gatt_attr *attr,
+			     uint16_t end_handle)
+{
+	static const int types[] = { GATT_INDEX_PRIMARY,
+				     GATT_INDEX_SECONDARY };
+	const struct bt_gatt_attr *last;
+	uint16_t next;
+
+	next = gatt_find_next_type(attr, types, ARRAY_SIZE(types));
+	if (next && next - 1 < end_handle) {
+		end_handle = next - 1;
+	}
+
+	last = gatt_attr_find_last(end_handle);
+
+	return last ? last->handle : attr->handle;
+}
+
 struct bt_gatt_attr *bt_gatt_attr_next(const struct bt_gatt_attr *attr)
 {
 #if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
@@ -308,6 +646,23 @@ ssize_t bt_gatt_attr_read_ccc(struct bt_conn *conn,
 				 sizeof(value));
 }
 
+/* Cache the connection of a peer in its CCC configuration, holding a
+ * reference to it until the peer disconnects.
+ */
+static void gatt_ccc_cfg_set_conn(struct bt_gatt_ccc_cfg *cfg,
+				  struct bt_conn *conn)
+{
+	if (cfg->_conn == conn) {
+		return;
+	}
+
+	if (cfg->_conn) {
+		bt_conn_unref(cfg->_conn);
+	}
+
+	cfg->_conn = conn ? bt_conn_ref(conn) : NULL;
+}
+
 static void gatt_ccc_changed(struct _bt_gatt_ccc *ccc)
 {
 	int i;
@@ -370,6 +725,7 @@ ssize_t bt_gatt_attr_write_ccc(struct bt_conn *conn,
 	}
 
 	ccc->cfg[i].value = sys_le16_to_cpu(*data);
+	gatt_ccc_cfg_set_conn(&ccc->cfg[i], conn);
 
 	BT_DBG("handle 0x%04x value %u", attr->handle, ccc->cfg[i].value);
 
@@ -418,10 +774,27 @@ struct notify_data {
 	const void *data;
 	uint16_t len;
 	struct bt_gatt_indicate_params *params;
+	/* Notification PDU encoded for all peers */
+	struct net_buf *buf;
 };
 
-static int att_notify(struct bt_conn *conn, uint16_t handle, const void *data,
-		      size_t len)
+/* L2CAP and ACL headers of a notification to one of several peers, the PDU
+ * itself being shared by all of them.
+ */
+static struct nano_fifo notify_hdr;
+static NET_BUF_POOL(notify_hdr_pool, CONFIG_BLUETOOTH_MAX_CONN,
+		    BT_L2CAP_BUF_SIZE(0), &notify_hdr, NULL,
+		    BT_BUF_USER_DATA_MIN);
+
+/* The PDU is referenced by a slice of its own in each notification, so that
+ * sending one of them does not touch the PDU as seen by the others.
+ */
+static struct nano_fifo notify_slices;
+static NET_BUF_SLICE_POOL(notify_slice_pool, CONFIG_BLUETOOTH_MAX_CONN,
+			  &notify_slices);
+
+static struct net_buf *notify_create(struct bt_conn *conn, uint16_t handle,
+				     const void *data, size_t len)
 {
 	struct net_buf *buf;
 	struct bt_att_notify *nfy;
@@ -429,7 +802,7 @@ static int att_notify(struct bt_conn *conn, uint16_t handle, const void *data,
 	buf = bt_att_create_pdu(conn, BT_ATT_OP_NOTIFY, sizeof(*nfy) + len);
 	if (!buf) {
 		BT_WARN("No buffer available to send notification");
-		return -ENOMEM;
+		return NULL;
 	}
 
 	BT_DBG("conn %p handle 0x%04x", conn, handle);
@@ -440,6 +813,19 @@ static int att_notify(struct bt_conn *conn, uint16_t handle, const void *data,
 	net_buf_add(buf, len);
 	memcpy(nfy->value, data, len);
 
+	return buf;
+}
+
+static int att_notify(struct bt_conn *conn, uint16_t handle, const void *data,
+		      size_t len)
+{
+	struct net_buf *buf;
+
+	buf = notify_create(conn, handle, data, len);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
 	bt_l2cap_send(conn, BT_L2CAP_CID_ATT, buf);
 
 	return 0;
@@ -492,20 +878,50 @@ static int att_indicate(struct bt_conn *conn,
 	return gatt_send(conn, buf, gatt_indicate_rsp, params, NULL);
 }
 
+/* A notification to several peers is only encoded once, for the first one.
+ * Each peer then gets a buffer of its own for the L2CAP and ACL headers,
+ * followed by a slice of the encoded PDU.
+ */
+static int notify_fanout(struct notify_data *data, struct bt_conn *conn)
+{
+	struct net_buf *buf, *slice;
+
+	if (!data->buf) {
+		data->buf = notify_create(conn, data->attr->handle, data->data,
+					  data->len);
+		if (!data->buf) {
+			return -ENOMEM;
+		}
+	} else if (data->buf->len > bt_att_get_mtu(conn)) {
+		BT_WARN("ATT MTU of conn %p exceeded", conn);
+		return 0;
+	}
+
+	buf = bt_l2cap_create_pdu(&notify_hdr);
+	if (!buf) {
+		BT_WARN("No buffer available to send notification");
+		return -ENOMEM;
+	}
+
+	slice = net_buf_slice_at(&notify_slices, data->buf, 0, data->buf->len);
+	if (!slice) {
+		BT_WARN("No slice available to send notification");
+		net_buf_unref(buf);
+		return -ENOMEM;
+	}
+
+	net_buf_frag_add(buf, slice);
+	bt_l2cap_send(conn, BT_L2CAP_CID_ATT, buf);
+
+	return 0;
+}
+
 static uint8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 {
 	struct notify_data *data = user_data;
 	struct _bt_gatt_ccc *ccc;
 	size_t i;
 
-	if (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CCC)) {
-		/* Stop if we reach the next characteristic */
-		if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CHRC)) {
-			return BT_GATT_ITER_STOP;
-		}
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	/* Check attribute user_data must be of type struct _bt_gatt_ccc */
 	if (attr->write != bt_gatt_attr_write_ccc) {
 		return BT_GATT_ITER_CONTINUE;
@@ -513,29 +929,27 @@ static uint8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	ccc = attr->user_data;
 
+	if (ccc->value != data->type) {
+		return BT_GATT_ITER_CONTINUE;
+	}
+
 	/* Notify all peers configured */
 	for (i = 0; i < ccc->cfg_len; i++) {
-		struct bt_conn *conn;
+		struct bt_conn *conn = ccc->cfg[i]._conn;
 		int err;
 
-		if (ccc->value != data->type) {
-			continue;
-		}
-
-		conn = bt_conn_lookup_addr_le(&ccc->cfg[i].peer);
-		if (!conn || conn->state != BT_CONN_CONNECTED) {
+		/* Skip peers not connected, or not subscribed */
+		if (!conn || !ccc->cfg[i].value ||
+		    conn->state != BT_CONN_CONNECTED) {
 			continue;
 		}
 
 		if (data->type == BT_GATT_CCC_INDICATE) {
 			err = att_indicate(conn, data->params);
 		} else {
-			err = att_notify(conn, data->attr->handle, data->data,
-					 data->len);
+			err = notify_fanout(data, conn);
 		}
 
-		bt_conn_unref(conn);
-
 		if (err < 0) {
 			return BT_GATT_ITER_STOP;
 		}
@@ -544,6 +958,25 @@ static uint8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 	return BT_GATT_ITER_CONTINUE;
 }
 
+/* Iterate over the CCC descriptors of the characteristic of a value */
+static void gatt_foreach_ccc(const struct bt_gatt_attr *attr,
+			     bt_gatt_attr_func_t func, void *user_data)
+{
+	static const int types[] = { GATT_INDEX_CHRC };
+	uint16_t end_handle;
+
+	/* Stop at the next characteristic */
+	end_handle = gatt_find_next_type(attr, types, ARRAY_SIZE(types));
+	if (!end_handle) {
+		end_handle = 0xffff;
+	} else {
+		end_handle--;
+	}
+
+	bt_gatt_foreach_attr_type(attr->handle, end_handle, BT_UUID_GATT_CCC,
+				  func, user_data);
+}
+
 int bt_gatt_notify(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 		   const void *data, uint16_t len)
 {
@@ -561,8 +994,13 @@ int bt_gatt_notify(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 	nfy.type = BT_GATT_CCC_NOTIFY;
 	nfy.data = data;
 	nfy.len = len;
+	nfy.buf = NULL;
 
-	bt_gatt_foreach_attr(attr->handle, 0xffff, notify_cb, &nfy);
+	gatt_foreach_ccc(attr, notify_cb, &nfy);
+
+	if (nfy.buf) {
+		net_buf_unref(nfy.buf);
+	}
 
 	return 0;
 }
@@ -583,7 +1021,7 @@ int bt_gatt_indicate(struct bt_conn *conn,
 	nfy.type = BT_GATT_CCC_INDICATE;
 	nfy.params = params;
 
-	bt_gatt_foreach_attr(params->attr->handle, 0xffff, notify_cb, &nfy);
+	gatt_foreach_ccc(params->attr, notify_cb, &nfy);
 
 	return 0;
 }
@@ -601,20 +1039,18 @@ static uint8_t connected_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	ccc = attr->user_data;
 
-	/* If already enabled skip */
-	if (ccc->value) {
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	for (i = 0; i < ccc->cfg_len; i++) {
 		/* Ignore configuration for different peer */
 		if (bt_addr_le_cmp(&conn->le.dst, &ccc->cfg[i].peer)) {
 			continue;
 		}
 
-		if (ccc->cfg[i].value) {
+		/* Cache the connection so the peer can be notified */
+		gatt_ccc_cfg_set_conn(&ccc->cfg[i], conn);
+
+		/* Enable the value if not already enabled */
+		if (!ccc->value && ccc->cfg[i].value) {
 			gatt_ccc_changed(ccc);
-			return BT_GATT_ITER_CONTINUE;
 		}
 	}
 
@@ -625,6 +1061,7 @@ static uint8_t disconnected_cb(const struct bt_gatt_attr *attr, void *user_data)
 {
 	struct bt_conn *conn = user_data;
 	struct _bt_gatt_ccc *ccc;
+	bool connected = false;
 	size_t i;
 
 	/* Check attribute user_data must be of type struct _bt_gatt_ccc */
@@ -634,33 +1071,23 @@ static uint8_t disconnected_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	ccc = attr->user_data;
 
-	/* If already disabled skip */
-	if (!ccc->value) {
-		return BT_GATT_ITER_CONTINUE;
-	}
-
 	for (i = 0; i < ccc->cfg_len; i++) {
-		/* Ignore configurations with disabled value */
-		if (!ccc->cfg[i].value) {
+		if (ccc->cfg[i]._conn == conn) {
+			gatt_ccc_cfg_set_conn(&ccc->cfg[i], NULL);
 			continue;
 		}
 
-		if (bt_addr_le_cmp(&conn->le.dst, &ccc->cfg[i].peer)) {
-			struct bt_conn *tmp;
-
-			/* Skip if there is another peer connected */
-			tmp = bt_conn_lookup_addr_le(&ccc->cfg[i].peer);
-			if (tmp) {
-				if (tmp->state == BT_CONN_CONNECTED) {
-					bt_conn_unref(tmp);
-					return BT_GATT_ITER_CONTINUE;
-				}
-
-				bt_conn_unref(tmp);
-			}
+		/* Skip if there is another peer connected */
+		if (ccc->cfg[i].value && ccc->cfg[i]._conn) {
+			connected = true;
 		}
 	}
 
+	/* If already disabled, or still in use, skip */
+	if (!ccc->value || connected) {
+		return BT_GATT_ITER_CONTINUE;
+	}
+
 	/* Reset value while disconnected */
 	memset(&ccc->value, 0, sizeof(ccc->value));
 	ccc->cfg_changed(ccc->value);
@@ -1705,10 +2132,17 @@ static void add_subscriptions(struct bt_conn *conn)
 
 #endif /* CONFIG_BLUETOOTH_GATT_CLIENT */
 
+void bt_gatt_init(void)
+{
+	net_buf_pool_init(notify_hdr_pool);
+	net_buf_pool_init(notify_slice_pool);
+}
+
 void bt_gatt_connected(struct bt_conn *conn)
 {
 	BT_DBG("conn %p", conn);
-	bt_gatt_foreach_attr(0x0001, 0xffff, connected_cb, conn);
+	bt_gatt_foreach_attr_type(0x0001, 0xffff, BT_UUID_GATT_CCC, connected_cb,
+				  conn);
 #if defined(CONFIG_BLUETOOTH_GATT_CLIENT)
 	add_subscriptions(conn);
 #endif /* CONFIG_BLUETOOTH_GATT_CLIENT */
@@ -1717,7 +2151,8 @@ void bt_gatt_connected(struct bt_conn *conn)
 void bt_gatt_disconnected(struct bt_conn *conn)
 {
 	BT_DBG("conn %p", conn);
-	bt_gatt_foreach_attr(0x0001, 0xffff, disconnected_cb, conn);
+	bt_gatt_foreach_attr_type(0x0001, 0xffff, BT_UUID_GATT_CCC,
+				  disconnected_cb, conn);
 
 #if defined(CONFIG_BLUETOOTH_GATT_CLIENT)
 	/* If bonded don't remove subscriptions */
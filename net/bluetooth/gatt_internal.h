@@ -18,9 +18,22 @@
  * limitations under the License.
  */
 
+void bt_gatt_init(void);
+
 void bt_gatt_connected(struct bt_conn *conn);
 void bt_gatt_disconnected(struct bt_conn *conn);
 
+/* Iterate over the attributes of the given type within the handle range */
+void bt_gatt_foreach_attr_type(uint16_t start_handle, uint16_t end_handle,
+			       const struct bt_uuid *uuid,
+			       bt_gatt_attr_func_t func, void *user_data);
+
+/* Return the handle of the last attribute of the service declared by attr,
+ * not above end_handle.
+ */
+uint16_t bt_gatt_service_end(const struct bt_gatt_attr *attr,
+			     uint16_t end_handle);
+
 #if defined(CONFIG_BLUETOOTH_GATT_CLIENT)
 void bt_gatt_notification(struct bt_conn *conn, uint16_t handle,
 			  const void *data, uint16_t length);
@@ -321,6 +321,102 @@ static int bt_hci_stop_scanning(void)
 	return err;
 }
 
+/* Peers resolved by the controller are reported with their identity
+ * address, using dedicated address types.
+ */
+static void id_addr_type_fixup(bt_addr_le_t *addr)
+{
+	switch (addr->type) {
+	case BT_ADDR_LE_PUBLIC_ID:
+		addr->type = BT_ADDR_LE_PUBLIC;
+		break;
+	case BT_ADDR_LE_RANDOM_ID:
+		addr->type = BT_ADDR_LE_RANDOM;
+		break;
+	default:
+		break;
+	}
+}
+
+#if defined(CONFIG_BLUETOOTH_SMP)
+int bt_le_rl_add(struct bt_keys *keys)
+{
+	struct bt_hci_cp_le_add_dev_to_rl *cp;
+	struct net_buf *buf;
+	int err;
+
+	if (atomic_test_bit(&keys->flags, BT_KEYS_RESOLVING)) {
+		return 0;
+	}
+
+	if (!bt_dev.le.rl_size) {
+		return -ENOTSUP;
+	}
+
+	/* The host keeps resolving the RPAs of peers not in the list */
+	if (bt_dev.le.rl_entries == bt_dev.le.rl_size) {
+		BT_DBG("Resolving list full");
+		return -ENOMEM;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_ADD_DEV_TO_RL, sizeof(*cp));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	bt_addr_le_copy(&cp->peer_id_addr, &keys->addr);
+	memcpy(cp->peer_irk, keys->irk.val, 16);
+#if defined(CONFIG_BLUETOOTH_PRIVACY)
+	memcpy(cp->local_irk, bt_dev.irk, 16);
+#else
+	memset(cp->local_irk, 0, 16);
+#endif /* CONFIG_BLUETOOTH_PRIVACY */
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_ADD_DEV_TO_RL, buf, NULL);
+	if (err) {
+		BT_WARN("Unable to add %s to resolving list (err %d)",
+			bt_addr_le_str(&keys->addr), err);
+		return err;
+	}
+
+	bt_dev.le.rl_entries++;
+	atomic_set_bit(&keys->flags, BT_KEYS_RESOLVING);
+
+	return 0;
+}
+
+void bt_le_rl_remove(struct bt_keys *keys)
+{
+	struct bt_hci_cp_le_rem_dev_from_rl *cp;
+	struct net_buf *buf;
+	int err;
+
+	if (!atomic_test_and_clear_bit(&keys->flags, BT_KEYS_RESOLVING)) {
+		return;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_REM_DEV_FROM_RL, sizeof(*cp));
+	if (!buf) {
+		BT_WARN("Unable to remove %s from resolving list",
+			bt_addr_le_str(&keys->addr));
+		return;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	bt_addr_le_copy(&cp->peer_id_addr, &keys->addr);
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_REM_DEV_FROM_RL, buf, NULL);
+	if (err) {
+		BT_WARN("Unable to remove %s from resolving list (err %d)",
+			bt_addr_le_str(&keys->addr), err);
+		return;
+	}
+
+	bt_dev.le.rl_entries--;
+}
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 static const bt_addr_le_t *find_id_addr(const bt_addr_le_t *addr)
 {
 #if defined(CONFIG_BLUETOOTH_SMP)
@@ -469,20 +565,11 @@ static void hci_num_completed_packets(struct net_buf *buf)
 			continue;
 		}
 
-		if (conn->pending_pkts >= count) {
-			conn->pending_pkts -= count;
-		} else {
-			BT_ERR("completed packets mismatch: %u > %u",
-			       count, conn->pending_pkts);
-			conn->pending_pkts = 0;
-		}
-
-		while (count--) {
-			nano_fiber_sem_give(bt_conn_get_pkts(conn));
-		}
-
+		bt_conn_tx_complete(conn, count);
 		bt_conn_unref(conn);
 	}
+
+	bt_conn_tx_notify();
 }
 
 static int hci_le_create_conn(const struct bt_conn *conn)
@@ -537,7 +624,7 @@ static void hci_disconn_complete(struct net_buf *buf)
 	stack_analyze("rx stack", rx_fiber_stack, sizeof(rx_fiber_stack));
 	stack_analyze("cmd tx stack", cmd_tx_fiber_stack,
 		      sizeof(cmd_tx_fiber_stack));
-	stack_analyze("conn tx stack", conn->stack, sizeof(conn->stack));
+	bt_conn_tx_stack_analyze();
 
 	bt_conn_set_state(conn, BT_CONN_DISCONNECTED);
 	conn->handle = 0;
@@ -609,6 +696,7 @@ static void le_conn_complete(struct net_buf *buf)
 	BT_DBG("status %u handle %u role %u %s", evt->status, handle,
 	       evt->role, bt_addr_le_str(&evt->peer_addr));
 
+	id_addr_type_fixup(&evt->peer_addr);
 	id_addr = find_id_addr(&evt->peer_addr);
 
 	/* Make lookup to check if there's a connection object in CONNECT state
@@ -2328,6 +2416,7 @@ static void le_adv_report(struct net_buf *buf)
 		       bt_addr_le_str(&info->addr),
 		       info->evt_type, info->length, rssi);
 
+		id_addr_type_fixup(&info->addr);
 		addr = find_id_addr(&info->addr);
 
 		if (scan_dev_found_cb) {
@@ -2550,17 +2639,6 @@ static void read_le_features_complete(struct net_buf *buf)
 	memcpy(bt_dev.le.features, rp->features, sizeof(bt_dev.le.features));
 }
 
-static void init_sem(struct nano_sem *sem, size_t count)
-{
-	/* Initialize & prime the semaphore for counting controller-side
-	 * available ACL packet buffers.
-	 */
-	nano_sem_init(sem);
-	while (count--) {
-		nano_sem_give(sem);
-	};
-}
-
 #if defined(CONFIG_BLUETOOTH_BREDR)
 static void read_buffer_size_complete(struct net_buf *buf)
 {
@@ -2574,7 +2652,7 @@ static void read_buffer_size_complete(struct net_buf *buf)
 
 	BT_DBG("ACL BR/EDR buffers: pkts %u mtu %u", pkts, bt_dev.br.mtu);
 
-	init_sem(&bt_dev.br.pkts, pkts);
+	bt_conn_tx_credits_init(BT_CONN_TYPE_BR, pkts);
 }
 #else
 static void read_buffer_size_complete(struct net_buf *buf)
@@ -2594,7 +2672,9 @@ static void read_buffer_size_complete(struct net_buf *buf)
 
 	BT_DBG("ACL BR/EDR buffers: pkts %u mtu %u", pkts, bt_dev.le.mtu);
 
-	init_sem(&bt_dev.le.pkts, pkts);
+#if defined(CONFIG_BLUETOOTH_CONN)
+	bt_conn_tx_credits_init(BT_CONN_TYPE_LE, pkts);
+#endif /* CONFIG_BLUETOOTH_CONN */
 }
 #endif
 
@@ -2607,7 +2687,9 @@ static void le_read_buffer_size_complete(struct net_buf *buf)
 	bt_dev.le.mtu = sys_le16_to_cpu(rp->le_max_len);
 
 	if (bt_dev.le.mtu) {
-		init_sem(&bt_dev.le.pkts, rp->le_max_num);
+#if defined(CONFIG_BLUETOOTH_CONN)
+		bt_conn_tx_credits_init(BT_CONN_TYPE_LE, rp->le_max_num);
+#endif /* CONFIG_BLUETOOTH_CONN */
 		BT_DBG("ACL LE buffers: pkts %u mtu %u", rp->le_max_num,
 		       bt_dev.le.mtu);
 	}
@@ -2689,6 +2771,51 @@ static int common_init(void)
 	return 0;
 }
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+/* Let the controller resolve the RPAs of the paired devices, which are
+ * added to its resolving list as they distribute their IRK.
+ */
+static int le_rl_init(void)
+{
+	struct bt_hci_rp_le_read_rl_size *rp;
+	struct bt_hci_cp_le_set_addr_res_enable *cp;
+	struct net_buf *buf;
+	struct net_buf *rsp;
+	int err;
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_RL_SIZE, NULL, &rsp);
+	if (err) {
+		return err;
+	}
+
+	rp = (void *)rsp->data;
+	bt_dev.le.rl_size = rp->rl_size;
+	net_buf_unref(rsp);
+
+	BT_DBG("Resolving list size %u", bt_dev.le.rl_size);
+
+	if (!bt_dev.le.rl_size) {
+		return 0;
+	}
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_CLEAR_RL, NULL, NULL);
+	if (err) {
+		return err;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_SET_ADDR_RES_ENABLE, sizeof(*cp));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->enable = 0x01;
+
+	return bt_hci_cmd_send_sync(BT_HCI_OP_LE_SET_ADDR_RES_ENABLE, buf,
+				    NULL);
+}
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 static int le_init(void)
 {
 	struct bt_hci_cp_write_le_host_supp *cp_le;
@@ -2790,6 +2917,13 @@ static int le_init(void)
 			return err;
 		}
 	}
+
+	if (bt_dev.le.features[0] & BT_HCI_LE_PRIVACY) {
+		err = le_rl_init();
+		if (err) {
+			return err;
+		}
+	}
 #endif /* CONFIG_BLUETOOTH_SMP */
 
 	return prng_init(&prng);
@@ -3018,7 +3152,7 @@ int bt_send(struct net_buf *buf)
 {
 	BT_DBG("buf %p len %u type %u", buf, buf->len, bt_buf_get_type(buf));
 
-	bt_monitor_send(bt_monitor_opcode(buf), buf->data, buf->len);
+	bt_monitor_send_buf(bt_monitor_opcode(buf), buf);
 
 	return bt_dev.drv->send(buf);
 }
@@ -48,14 +48,18 @@ struct bt_dev_le {
 
 	/* Controller buffer information */
 	uint16_t		mtu;
-	struct nano_sem		pkts;
+
+#if defined(CONFIG_BLUETOOTH_SMP)
+	/* Controller resolving list size, 0 if it is not used */
+	uint8_t			rl_size;
+	uint8_t			rl_entries;
+#endif /* CONFIG_BLUETOOTH_SMP */
 };
 
 #if defined(CONFIG_BLUETOOTH_BREDR)
 struct bt_dev_br {
 	/* Max controller's acceptable ACL packet length */
 	uint16_t		mtu;
-	struct nano_sem		pkts;
 };
 #endif
 
@@ -184,6 +188,13 @@ int bt_le_scan_update(bool fast_scan);
 
 bool bt_addr_le_is_bonded(const bt_addr_le_t *addr);
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+struct bt_keys;
+
+int bt_le_rl_add(struct bt_keys *keys);
+void bt_le_rl_remove(struct bt_keys *keys);
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 int bt_send(struct net_buf *buf);
 
 uint16_t bt_hci_get_cmd_opcode(struct net_buf *buf);
@@ -26,6 +26,10 @@
 #include <bluetooth/conn.h>
 #include <bluetooth/hci.h>
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+#include <tinycrypt/aes.h>
+#endif
+
 #include "hci_core.h"
 #include "smp.h"
 #include "keys.h"
@@ -38,6 +42,78 @@
 static struct bt_keys key_pool[CONFIG_BLUETOOTH_MAX_PAIRED];
 
 #if defined(CONFIG_BLUETOOTH_SMP)
+/* Expanded AES key schedules of the IRKs, so that resolving an RPA
+ * only costs one block encryption per IRK.
+ */
+static struct tc_aes_key_sched_struct irk_sched[ARRAY_SIZE(key_pool)];
+
+/* Recently looked up RPAs, most recently used first. A NULL keys pointer
+ * means that none of the IRKs resolves the RPA.
+ */
+struct rpa_cache_entry {
+	bt_addr_t		rpa;
+	struct bt_keys		*keys;
+};
+
+#if CONFIG_BLUETOOTH_RPA_CACHE_SIZE > 0
+static struct rpa_cache_entry rpa_cache[CONFIG_BLUETOOTH_RPA_CACHE_SIZE];
+static uint8_t rpa_cache_len;
+
+static struct rpa_cache_entry *rpa_cache_lookup(const bt_addr_t *rpa)
+{
+	struct rpa_cache_entry entry;
+	int i;
+
+	for (i = 0; i < rpa_cache_len; i++) {
+		if (bt_addr_cmp(&rpa_cache[i].rpa, rpa)) {
+			continue;
+		}
+
+		if (i) {
+			entry = rpa_cache[i];
+			memmove(&rpa_cache[1], &rpa_cache[0],
+				i * sizeof(rpa_cache[0]));
+			rpa_cache[0] = entry;
+		}
+
+		return &rpa_cache[0];
+	}
+
+	return NULL;
+}
+
+static void rpa_cache_add(const bt_addr_t *rpa, struct bt_keys *keys)
+{
+	if (rpa_cache_len < ARRAY_SIZE(rpa_cache)) {
+		rpa_cache_len++;
+	}
+
+	/* The least recently used entry falls off the end */
+	memmove(&rpa_cache[1], &rpa_cache[0],
+		(rpa_cache_len - 1) * sizeof(rpa_cache[0]));
+	bt_addr_copy(&rpa_cache[0].rpa, rpa);
+	rpa_cache[0].keys = keys;
+}
+
+static void rpa_cache_flush(void)
+{
+	rpa_cache_len = 0;
+}
+#else
+static inline struct rpa_cache_entry *rpa_cache_lookup(const bt_addr_t *rpa)
+{
+	return NULL;
+}
+
+static inline void rpa_cache_add(const bt_addr_t *rpa, struct bt_keys *keys)
+{
+}
+
+static inline void rpa_cache_flush(void)
+{
+}
+#endif /* CONFIG_BLUETOOTH_RPA_CACHE_SIZE > 0 */
+
 struct bt_keys *bt_keys_get_addr(const bt_addr_le_t *addr)
 {
 	struct bt_keys *keys;
@@ -100,8 +176,31 @@ struct bt_keys *bt_keys_get_type(int type, const bt_addr_le_t *addr)
 	return keys;
 }
 
+static struct bt_keys *irk_resolve(const bt_addr_t *rpa)
+{
+	uint8_t prand[16];
+	int i;
+
+	/* r' is the same for all the IRKs */
+	bt_smp_rpa_prepare(rpa, prand);
+
+	for (i = 0; i < ARRAY_SIZE(key_pool); i++) {
+		if (!(key_pool[i].keys & BT_KEYS_IRK)) {
+			continue;
+		}
+
+		if (bt_smp_irk_sched_matches(&irk_sched[i], prand, rpa)) {
+			return &key_pool[i];
+		}
+	}
+
+	return NULL;
+}
+
 struct bt_keys *bt_keys_find_irk(const bt_addr_le_t *addr)
 {
+	struct rpa_cache_entry *entry;
+	struct bt_keys *keys;
 	int i;
 
 	BT_DBG("%s", bt_addr_le_str(addr));
@@ -110,6 +209,12 @@ struct bt_keys *bt_keys_find_irk(const bt_addr_le_t *addr)
 		return NULL;
 	}
 
+	entry = rpa_cache_lookup(&addr->a);
+	if (entry) {
+		BT_DBG("RPA %s found in cache", bt_addr_str(&addr->a));
+		return entry->keys;
+	}
+
 	for (i = 0; i < ARRAY_SIZE(key_pool); i++) {
 		if (!(key_pool[i].keys & BT_KEYS_IRK)) {
 			continue;
@@ -119,24 +224,20 @@ struct bt_keys *bt_keys_find_irk(const bt_addr_le_t *addr)
 			BT_DBG("cached RPA %s for %s",
 			       bt_addr_str(&key_pool[i].irk.rpa),
 			       bt_addr_le_str(&key_pool[i].addr));
+			rpa_cache_add(&addr->a, &key_pool[i]);
 			return &key_pool[i];
 		}
 	}
 
-	for (i = 0; i < ARRAY_SIZE(key_pool); i++) {
-		if (!(key_pool[i].keys & BT_KEYS_IRK)) {
-			continue;
-		}
-
-		if (bt_smp_irk_matches(key_pool[i].irk.val, &addr->a)) {
-			BT_DBG("RPA %s matches %s",
-			       bt_addr_str(&key_pool[i].irk.rpa),
-			       bt_addr_le_str(&key_pool[i].addr));
+	keys = irk_resolve(&addr->a);
+	rpa_cache_add(&addr->a, keys);
+	if (keys) {
+		BT_DBG("RPA %s matches %s", bt_addr_str(&addr->a),
+		       bt_addr_le_str(&keys->addr));
 
-			bt_addr_copy(&key_pool[i].irk.rpa, &addr->a);
+		bt_addr_copy(&keys->irk.rpa, &addr->a);
 
-			return &key_pool[i];
-		}
+		return keys;
 	}
 
 	BT_DBG("No IRK for %s", bt_addr_le_str(addr));
@@ -158,6 +259,17 @@ struct bt_keys *bt_keys_find_addr(const bt_addr_le_t *addr)
 
 	return NULL;
 }
+
+void bt_keys_set_irk(struct bt_keys *keys, const uint8_t irk[16])
+{
+	BT_DBG("keys for %s", bt_addr_le_str(&keys->addr));
+
+	memcpy(keys->irk.val, irk, 16);
+	bt_smp_irk_sched_init(keys->irk.val, &irk_sched[keys - key_pool]);
+
+	/* RPAs not resolved so far may be resolved by the new IRK */
+	rpa_cache_flush();
+}
 #endif /* CONFIG_BLUETOOTH_SMP */
 
 void bt_keys_add_type(struct bt_keys *keys, int type)
@@ -169,6 +281,13 @@ void bt_keys_clear(struct bt_keys *keys, int type)
 {
 	BT_DBG("keys for %s type %d", bt_addr_le_str(&keys->addr), type);
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+	if (keys->keys & type & BT_KEYS_IRK) {
+		rpa_cache_flush();
+		bt_le_rl_remove(keys);
+	}
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 	keys->keys &= ~type;
 
 	if (!keys->keys) {
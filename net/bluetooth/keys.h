@@ -36,6 +36,8 @@ enum {
 	BT_KEYS_AUTHENTICATED,
 	BT_KEYS_BR_LEGACY,
 	BT_KEYS_DEBUG,
+	/* Keys are in the controller resolving list */
+	BT_KEYS_RESOLVING,
 };
 
 struct bt_ltk {
@@ -96,6 +98,7 @@ struct bt_keys *bt_keys_get_type(int type, const bt_addr_le_t *addr);
 struct bt_keys *bt_keys_find(int type, const bt_addr_le_t *addr);
 struct bt_keys *bt_keys_find_irk(const bt_addr_le_t *addr);
 struct bt_keys *bt_keys_find_addr(const bt_addr_le_t *addr);
+void bt_keys_set_irk(struct bt_keys *keys, const uint8_t irk[16]);
 #endif /* CONFIG_BLUETOOTH_SMP */
 
 void bt_keys_add_type(struct bt_keys *keys, int type);
@@ -72,11 +72,16 @@ static NET_BUF_POOL(le_sig_pool, CONFIG_BLUETOOTH_MAX_CONN,
 		    BT_BUF_USER_DATA_MIN);
 
 #if defined(CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL)
-/* Pool for outgoing LE data packets, MTU is 23 */
+/* Pool for the headers of outgoing LE data segments, the payload of the
+ * segments is referenced by slices of the SDU.
+ */
 static struct nano_fifo le_data;
 static NET_BUF_POOL(le_data_pool, CONFIG_BLUETOOTH_MAX_CONN,
-		    BT_L2CAP_BUF_SIZE(L2CAP_LE_MIN_MTU), &le_data, NULL,
+		    BT_L2CAP_BUF_SIZE(BT_L2CAP_SDU_HDR_LEN), &le_data, NULL,
 		    BT_BUF_USER_DATA_MIN);
+static struct nano_fifo le_data_slices;
+static NET_BUF_SLICE_POOL(le_data_slice_pool, CONFIG_BLUETOOTH_MAX_CONN,
+			  &le_data_slices);
 #endif /* CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL */
 
 /* L2CAP signalling channel specific context */
@@ -242,7 +247,7 @@ void bt_l2cap_send(struct bt_conn *conn, uint16_t cid, struct net_buf *buf)
 	struct bt_l2cap_hdr *hdr;
 
 	hdr = net_buf_push(buf, sizeof(*hdr));
-	hdr->len = sys_cpu_to_le16(buf->len - sizeof(*hdr));
+	hdr->len = sys_cpu_to_le16(net_buf_frags_len(buf) - sizeof(*hdr));
 	hdr->cid = sys_cpu_to_le16(cid);
 
 	bt_conn_send(conn, buf);
@@ -1070,6 +1075,7 @@ void bt_l2cap_init(void)
 	net_buf_pool_init(le_sig_pool);
 #if defined(CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL)
 	net_buf_pool_init(le_data_pool);
+	net_buf_pool_init(le_data_slice_pool);
 #endif /* CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL */
 
 	bt_l2cap_le_fixed_chan_register(&chan);
@@ -1205,7 +1211,7 @@ static struct net_buf *l2cap_chan_create_seg(struct bt_l2cap_chan *chan,
 					     struct net_buf *buf,
 					     size_t sdu_hdr_len)
 {
-	struct net_buf *seg;
+	struct net_buf *seg, *slice;
 	uint16_t headroom;
 	uint16_t len;
 
@@ -1236,11 +1242,17 @@ segment:
 		net_buf_add_le16(seg, buf->len);
 	}
 
-	len = min(min(buf->len, L2CAP_LE_MIN_MTU - sdu_hdr_len), chan->tx.mps);
-	memcpy(net_buf_add(seg, len), buf->data, len);
-	net_buf_pull(buf, len);
+	/* Reference the payload instead of copying it */
+	len = min(buf->len, chan->tx.mps - sdu_hdr_len);
+	slice = net_buf_slice(&le_data_slices, buf, len);
+	if (!slice) {
+		net_buf_unref(seg);
+		return NULL;
+	}
+
+	net_buf_frag_add(seg, slice);
 
-	BT_DBG("chan %p seg %p len %u", chan, seg, seg->len);
+	BT_DBG("chan %p seg %p len %u", chan, seg, net_buf_frags_len(seg));
 
 	return seg;
 }
@@ -1264,10 +1276,10 @@ static int l2cap_chan_le_send(struct bt_l2cap_chan *chan, struct net_buf *buf,
 		return -ECONNRESET;
 	}
 
-	BT_DBG("chan %p cid 0x%04x len %u credits %u", chan, chan->tx.cid,
-	       buf->len, chan->tx.credits.nsig);
+	len = net_buf_frags_len(buf);
 
-	len = buf->len;
+	BT_DBG("chan %p cid 0x%04x len %u credits %u", chan, chan->tx.cid,
+	       len, chan->tx.credits.nsig);
 
 	bt_l2cap_send(chan->conn, chan->tx.cid, buf);
 
@@ -90,12 +90,16 @@ static inline uint8_t bt_monitor_opcode(struct net_buf *buf)
 
 void bt_monitor_send(uint16_t opcode, const void *data, size_t len);
 
+/* Send a buffer and all its fragments as one packet */
+void bt_monitor_send_buf(uint16_t opcode, struct net_buf *buf);
+
 void bt_monitor_new_index(uint8_t type, uint8_t bus, bt_addr_t *addr,
 			  const char *name);
 
 #else /* !CONFIG_BLUETOOTH_DEBUG_MONITOR */
 
 #define bt_monitor_send(opcode, data, len)
+#define bt_monitor_send_buf(opcode, buf)
 #define bt_monitor_new_index(type, bus, addr, name)
 
 #endif
@@ -2108,7 +2108,7 @@ static uint8_t smp_ident_info(struct bt_smp *smp, struct net_buf *buf)
 			return BT_SMP_ERR_UNSPECIFIED;
 		}
 
-		memcpy(keys->irk.val, req->irk, 16);
+		bt_keys_set_irk(keys, req->irk);
 	}
 
 	atomic_set_bit(&smp->allowed_cmds, BT_SMP_CMD_IDENT_ADDR_INFO);
@@ -2169,6 +2169,11 @@ static uint8_t smp_ident_addr_info(struct bt_smp *smp, struct net_buf *buf)
 				bt_conn_identity_resolved(conn);
 			}
 		}
+
+		/* Let the controller resolve the RPAs of the peer too */
+		if (bt_addr_le_is_identity(&keys->addr)) {
+			bt_le_rl_add(keys);
+		}
 	}
 
 	smp->remote_dist &= ~BT_SMP_DIST_ID_KEY;
@@ -2722,6 +2727,44 @@ static void bt_smp_encrypt_change(struct bt_l2cap_chan *chan)
 	}
 }
 
+int bt_smp_irk_sched_init(const uint8_t irk[16],
+			  struct tc_aes_key_sched_struct *s)
+{
+	uint8_t tmp[16];
+
+	swap_buf(tmp, irk, 16);
+
+	if (tc_aes128_set_encrypt_key(s, tmp) == TC_FAIL) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+void bt_smp_rpa_prepare(const bt_addr_t *addr, uint8_t prand[16])
+{
+	/* r' = padding || r, in the byte order of the AES block */
+	memset(prand, 0, 13);
+	swap_buf(prand + 13, addr->val + 3, 3);
+}
+
+bool bt_smp_irk_sched_matches(struct tc_aes_key_sched_struct *s,
+			      const uint8_t prand[16], const bt_addr_t *addr)
+{
+	uint8_t enc_data[16];
+
+	if (tc_aes_encrypt(enc_data, prand, s) == TC_FAIL) {
+		return false;
+	}
+
+	/* ah(h, r) is the least significant 24 bits of the big endian
+	 * output of e, i.e. its last three octets.
+	 */
+	return (addr->val[0] == enc_data[15] &&
+		addr->val[1] == enc_data[14] &&
+		addr->val[2] == enc_data[13]);
+}
+
 bool bt_smp_irk_matches(const uint8_t irk[16], const bt_addr_t *addr)
 {
 	uint8_t hash[3];
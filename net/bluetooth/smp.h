@@ -130,7 +130,14 @@ struct bt_smp_dhkey_check {
 	uint8_t e[16];
 } __packed;
 
+struct tc_aes_key_sched_struct;
+
 bool bt_smp_irk_matches(const uint8_t irk[16], const bt_addr_t *addr);
+int bt_smp_irk_sched_init(const uint8_t irk[16],
+			  struct tc_aes_key_sched_struct *s);
+void bt_smp_rpa_prepare(const bt_addr_t *addr, uint8_t prand[16]);
+bool bt_smp_irk_sched_matches(struct tc_aes_key_sched_struct *s,
+			      const uint8_t prand[16], const bt_addr_t *addr);
 int bt_smp_create_rpa(const uint8_t irk[16], bt_addr_t *rpa);
 int bt_smp_send_pairing_req(struct bt_conn *conn);
 int bt_smp_send_security_req(struct bt_conn *conn);
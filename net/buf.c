@@ -57,9 +57,10 @@ struct net_buf *net_buf_get_timeout(struct nano_fifo *fifo,
 		return NULL;
 	}
 
-	buf->ref  = 1;
-	buf->data = buf->__buf + reserve_head;
-	buf->len  = 0;
+	buf->ref   = 1;
+	buf->data  = buf->__buf + reserve_head;
+	buf->len   = 0;
+	buf->frags = NULL;
 
 	NET_BUF_DBG("buf %p fifo %p reserve %u\n", buf, fifo, reserve_head);
 
@@ -84,17 +85,26 @@ struct net_buf *net_buf_get(struct nano_fifo *fifo, size_t reserve_head)
 
 void net_buf_unref(struct net_buf *buf)
 {
-	NET_BUF_DBG("buf %p ref %u fifo %p\n", buf, buf->ref, buf->free);
-	NET_BUF_ASSERT(buf->ref > 0);
+	while (buf) {
+		struct net_buf *frags = buf->frags;
 
-	if (--buf->ref) {
-		return;
-	}
+		NET_BUF_DBG("buf %p ref %u fifo %p frags %p\n", buf, buf->ref,
+			    buf->free, buf->frags);
+		NET_BUF_ASSERT(buf->ref > 0);
+
+		if (--buf->ref) {
+			return;
+		}
+
+		buf->frags = NULL;
 
-	if (buf->destroy) {
-		buf->destroy(buf);
-	} else {
-		nano_fifo_put(buf->free, buf);
+		if (buf->destroy) {
+			buf->destroy(buf);
+		} else {
+			nano_fifo_put(buf->free, buf);
+		}
+
+		buf = frags;
 	}
 }
 
@@ -105,6 +115,74 @@ struct net_buf *net_buf_ref(struct net_buf *buf)
 	return buf;
 }
 
+struct net_buf *net_buf_slice_at(struct nano_fifo *fifo, struct net_buf *buf,
+				 size_t offset, size_t len)
+{
+	struct net_buf *slice;
+
+	NET_BUF_DBG("buf %p offset %u len %u\n", buf, offset, len);
+	NET_BUF_ASSERT(buf->len >= offset + len);
+
+	slice = net_buf_get(fifo, 0);
+	if (!slice) {
+		return NULL;
+	}
+
+	/* The slice keeps the sliced buffer until it is freed */
+	*(struct net_buf **)net_buf_user_data(slice) = net_buf_ref(buf);
+
+	slice->data = buf->data + offset;
+	slice->len = len;
+
+	return slice;
+}
+
+struct net_buf *net_buf_slice(struct nano_fifo *fifo, struct net_buf *buf,
+			      size_t len)
+{
+	struct net_buf *slice;
+
+	slice = net_buf_slice_at(fifo, buf, 0, len);
+	if (slice) {
+		net_buf_pull(buf, len);
+	}
+
+	return slice;
+}
+
+void net_buf_slice_destroy(struct net_buf *buf)
+{
+	struct net_buf **sliced = net_buf_user_data(buf);
+
+	NET_BUF_DBG("slice %p buf %p\n", buf, *sliced);
+
+	net_buf_unref(*sliced);
+	nano_fifo_put(buf->free, buf);
+}
+
+struct net_buf *net_buf_frag_last(struct net_buf *frags)
+{
+	while (frags->frags) {
+		frags = frags->frags;
+	}
+
+	return frags;
+}
+
+void net_buf_frag_insert(struct net_buf *parent, struct net_buf *frag)
+{
+	if (parent->frags) {
+		net_buf_frag_last(frag)->frags = parent->frags;
+	}
+
+	parent->frags = frag;
+}
+
+void net_buf_frag_add(struct net_buf *head, struct net_buf *frag)
+{
+	net_buf_frag_insert(net_buf_frag_last(head), frag);
+}
+
 struct net_buf *net_buf_clone(struct net_buf *buf)
 {
 	struct net_buf *clone;
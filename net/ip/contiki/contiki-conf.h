@@ -251,4 +251,14 @@ typedef unsigned int uip_stats_t;
 #define NBR_TABLE_CONF_MAX_NEIGHBORS CONFIG_NETWORKING_MAX_NEIGHBORS
 #endif
 
+#if defined(CONFIG_NETWORKING_MAX_ROUTES)
+#define UIP_CONF_MAX_ROUTES CONFIG_NETWORKING_MAX_ROUTES
+#endif
+
+#if defined(CONFIG_NETWORKING_IPV6_ROUTE_TRIE)
+#define UIP_CONF_DS6_ROUTE_TRIE 1
+#else
+#define UIP_CONF_DS6_ROUTE_TRIE 0
+#endif
+
 #endif /* __CONTIKI_CONF_H__ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *         Internet checksum (RFC 1071) and incremental checksum
+ *         update (RFC 1624) shared by the IPv4 and IPv6 stacks.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "contiki/ip/uip.h"
+
+#if ! UIP_ARCH_CHKSUM
+/*---------------------------------------------------------------------------*/
+static inline uint32_t
+load32(const uint8_t *data)
+{
+  uint32_t word;
+
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+/*---------------------------------------------------------------------------*/
+static inline uint16_t
+load16(const uint8_t *data)
+{
+  uint16_t word;
+
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint64_t acc = 0;
+  uint16_t word = 0;
+  uint8_t odd;
+
+  /*
+   * The one's complement sum does not depend on the byte order, so
+   * the buffer is summed in native order, 32 bits at a time, and
+   * converted once at the end (RFC 1071, section 2).
+   */
+  odd = ((uintptr_t)data & 1) && len > 0;
+  if(odd) {
+    /*
+     * Pair the first byte with a zero byte in front of it. All the
+     * following words are then summed shifted by one byte, which is
+     * undone by swapping the bytes of the folded sum.
+     */
+    acc = uip_htons(data[0]);
+    data++;
+    len--;
+  }
+
+  if(((uintptr_t)data & 2) && len >= 2) {
+    acc += load16(data);
+    data += 2;
+    len -= 2;
+  }
+
+  while(len >= 16) {
+    acc += load32(data);
+    acc += load32(data + 4);
+    acc += load32(data + 8);
+    acc += load32(data + 12);
+    data += 16;
+    len -= 16;
+  }
+
+  while(len >= 4) {
+    acc += load32(data);
+    data += 4;
+    len -= 4;
+  }
+
+  if(len >= 2) {
+    acc += load16(data);
+    data += 2;
+    len -= 2;
+  }
+
+  if(len > 0) {
+    /* The last byte is padded with a zero byte behind it. */
+    memcpy(&word, data, 1);
+    acc += word;
+  }
+
+  /* Fold the 64-bit accumulator down to 16 bits. */
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+
+  word = (uint16_t)acc;
+  if(odd) {
+    word = (word << 8) | (word >> 8);
+  }
+  word = uip_ntohs(word);
+
+  /* Add the sum of the previous chunks, in host byte order. */
+  word += sum;
+  if(word < sum) {
+    word++;		/* carry */
+  }
+
+  return word;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum, const uint8_t *old_data,
+                  const uint8_t *new_data, uint16_t len)
+{
+  return uip_chksum_update16(chksum, uip_chksum_add(0, old_data, len),
+                             uip_chksum_add(0, new_data, len));
+}
+#endif /* UIP_ARCH_CHKSUM */
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update16(uint16_t chksum, uint16_t old_val, uint16_t new_val)
+{
+  uint32_t sum;
+
+  /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+  sum = (uint16_t)~chksum;
+  sum += (uint16_t)~old_val;
+  sum += new_val;
+  sum = (sum >> 16) + (sum & 0xffff);
+  sum += sum >> 16;
+
+  return ~sum;
+}
+/*---------------------------------------------------------------------------*/
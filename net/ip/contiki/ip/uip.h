@@ -2189,6 +2189,63 @@ CCIF extern uip_lladdr_t uip_lladdr;
  */
 uint16_t uip_chksum(uint16_t *data, uint16_t len);
 
+/**
+ * Add the Internet checksum of a buffer to a partial sum.
+ *
+ * The buffer may start at any address and have any length; it is
+ * summed a 32-bit word at a time. Checksums of consecutive chunks can
+ * be chained by passing the result of one call as the \c sum of the
+ * next, as long as every chunk but the last has an even length.
+ *
+ * \param sum The partial sum to add to, in host byte order.
+ *
+ * \param data A pointer to the buffer to add.
+ *
+ * \param len The length of the buffer.
+ *
+ * \return The one's complement sum, in host byte order.
+ */
+uint16_t uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
+/**
+ * Update a checksum after a 16-bit word it covers changed.
+ *
+ * Implements eqn. 3 of RFC1624, so a header rewrite does not need to
+ * sum the payload again. The checksum is the value stored in the
+ * packet, i.e. the complement of the sum; all values must be in the
+ * same byte order.
+ *
+ * \param chksum The checksum stored in the packet.
+ *
+ * \param old_val The old value of the word.
+ *
+ * \param new_val The new value of the word.
+ *
+ * \return The updated checksum.
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_val,
+                             uint16_t new_val);
+
+/**
+ * Update a checksum after a field it covers changed.
+ *
+ * Same as uip_chksum_update16() for a field of \c len bytes, such as
+ * an IP address. The field must start at an even offset in the data
+ * covered by the checksum.
+ *
+ * \param chksum The checksum stored in the packet, in host byte order.
+ *
+ * \param old_data The old contents of the field.
+ *
+ * \param new_data The new contents of the field.
+ *
+ * \param len The length of the field.
+ *
+ * \return The updated checksum, in host byte order.
+ */
+uint16_t uip_chksum_update(uint16_t chksum, const uint8_t *old_data,
+                           const uint8_t *new_data, uint16_t len);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
@@ -95,6 +95,9 @@ void *net_context_get_internal_connection(struct net_context *context);
 void net_context_set_internal_connection(struct net_context *context,
 					 void *conn);
 struct net_context *net_context_find_internal_connection(void *conn);
+struct uip_udp_conn *net_context_find_udp_connection(const uint8_t *src,
+						     uint16_t srcport,
+						     uint16_t destport);
 void net_context_tcp_set_pending(struct net_context *context,
 				 struct net_buf *buf);
 
@@ -287,41 +290,10 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
-static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {	/* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
 {
-  return uip_htons(chksum(0, (uint8_t *)data, len));
+  return uip_htons(uip_chksum_add(0, (uint8_t *)data, len));
 }
 /*---------------------------------------------------------------------------*/
 #ifndef UIP_ARCH_IPCHKSUM
@@ -330,7 +302,7 @@ uip_ipchksum(struct net_buf *buf)
 {
   uint16_t sum;
 
-  sum = chksum(0, &uip_buf(buf)[UIP_LLH_LEN], UIP_IPH_LEN);
+  sum = uip_chksum_add(0, &uip_buf(buf)[UIP_LLH_LEN], UIP_IPH_LEN);
   DEBUG_PRINTF("uip_ipchksum: sum 0x%04x\n", sum);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -353,11 +325,12 @@ upper_layer_chksum(struct net_buf *buf, uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = upper_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&BUF(buf)->srcipaddr, 2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&BUF(buf)->srcipaddr,
+                       2 * sizeof(uip_ipaddr_t));
 
   /* Sum TCP header and data. */
-  sum = chksum(sum, &uip_buf(buf)[UIP_IPH_LEN + UIP_LLH_LEN],
-	       upper_layer_len);
+  sum = uip_chksum_add(sum, &uip_buf(buf)[UIP_IPH_LEN + UIP_LLH_LEN],
+                       upper_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -1135,11 +1108,9 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
 
   ICMPBUF(buf)->type = ICMP_ECHO_REPLY;
 
-  if(ICMPBUF(buf)->icmpchksum >= UIP_HTONS(0xffff - (ICMP_ECHO << 8))) {
-    ICMPBUF(buf)->icmpchksum += UIP_HTONS(ICMP_ECHO << 8) + 1;
-  } else {
-    ICMPBUF(buf)->icmpchksum += UIP_HTONS(ICMP_ECHO << 8);
-  }
+  ICMPBUF(buf)->icmpchksum =
+    uip_chksum_update16(ICMPBUF(buf)->icmpchksum, UIP_HTONS(ICMP_ECHO << 8),
+                        UIP_HTONS(ICMP_ECHO_REPLY << 8));
 
   /* Swap IP addresses. */
   uip_ipaddr_copy(&BUF(buf)->destipaddr, &BUF(buf)->srcipaddr);
@@ -1246,6 +1217,15 @@ uip_process(struct net_buf **buf_out, uint8_t flag)
     goto drop;
   }
 
+  /* Packets for network contexts are found in their hash table, the
+     other UDP "connections" are searched below. */
+  uip_set_udp_conn(buf) =
+    net_context_find_udp_connection(BUF(buf)->srcipaddr.u8,
+                                    UDPBUF(buf)->srcport, UDPBUF(buf)->destport);
+  if(uip_udp_conn(buf) != NULL) {
+    goto udp_found;
+  }
+
   /* Demultiplex this UDP packet between the UDP "connections". */
   for(i = 0, uip_set_udp_conn(buf) = &uip_udp_conns[0];
       i < UIP_UDP_CONNS && uip_udp_conn(buf) < &uip_udp_conns[UIP_UDP_CONNS];
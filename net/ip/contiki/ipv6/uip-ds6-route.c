@@ -72,6 +72,28 @@ LIST(notificationlist);
 
 static int num_routes = 0;
 
+#if UIP_DS6_ROUTE_TRIE
+/* The routes are also indexed in a path compressed binary trie. Each
+   node holds a prefix, and the route to that prefix if there is one.
+   The children of a node hold longer prefixes, and the first bit
+   after the prefix of the node selects the child. A node without a
+   route always has two children, so the trie has at most two nodes
+   per route. */
+struct route_trie_node {
+  struct route_trie_node *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+};
+
+MEMB(routetriememb, struct route_trie_node, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie_node *route_trie;
+
+/* Incremented on every successful lookup, the routes record it in
+   their last_lookup field. */
+static uint32_t lookup_clock;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 #ifdef CONFIG_NETWORK_IP_STACK_DEBUG_IPV6_ROUTE
 #define DEBUG 1
 #endif
@@ -79,6 +101,171 @@ static int num_routes = 0;
 
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_TRIE
+static uint8_t
+prefix_bit(const uip_ipaddr_t *addr, uint8_t bit)
+{
+  return (addr->u8[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of leading bits, up to max, that a and b have in
+   common. The first "from" bits are known to be equal. */
+static uint8_t
+common_prefix_length(const uip_ipaddr_t *a, const uip_ipaddr_t *b,
+                     uint8_t from, uint8_t max)
+{
+  uint8_t length;
+  uint8_t diff;
+  int i;
+
+  for(i = from >> 3, length = i << 3; length < max; i++, length += 8) {
+    diff = a->u8[i] ^ b->u8[i];
+    if(diff != 0) {
+      while(!(diff & 0x80)) {
+        diff <<= 1;
+        length++;
+      }
+      break;
+    }
+  }
+
+  return length < max ? length : max;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+route_trie_node_alloc(const uip_ipaddr_t *prefix, uint8_t length,
+                      uip_ds6_route_t *route)
+{
+  struct route_trie_node *n;
+
+  n = memb_alloc(&routetriememb);
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the route with the longest prefix matching addr, or the
+   route to the prefix addr/length if exact is set. */
+static uip_ds6_route_t *
+route_trie_lookup(const uip_ipaddr_t *addr, uint8_t length, int exact)
+{
+  struct route_trie_node *n;
+  uip_ds6_route_t *found;
+  uint8_t matched;
+
+  found = NULL;
+  matched = 0;
+  for(n = route_trie; n != NULL && n->length <= length;
+      n = n->child[prefix_bit(addr, matched)]) {
+    matched = common_prefix_length(addr, &n->prefix, matched, n->length);
+    if(matched < n->length) {
+      break;
+    }
+    if(n->route != NULL && (!exact || n->length == length)) {
+      found = n->route;
+    }
+    if(matched == length) {
+      break;
+    }
+  }
+
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_trie_insert(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node *n;
+  struct route_trie_node *leaf;
+  struct route_trie_node *glue;
+  uint8_t matched;
+
+  matched = 0;
+  for(link = &route_trie; (n = *link) != NULL;
+      link = &n->child[prefix_bit(&r->ipaddr, matched)]) {
+    matched = common_prefix_length(&r->ipaddr, &n->prefix, matched,
+                                   r->length < n->length ?
+                                   r->length : n->length);
+    if(matched == n->length) {
+      if(matched == r->length) {
+        /* The node exists already, possibly without a route. */
+        n->route = r;
+        return 1;
+      }
+      continue;
+    }
+
+    /* The prefix of the route ends or diverges within the prefix of
+       n, so a node has to be put above n. */
+    leaf = route_trie_node_alloc(&r->ipaddr, r->length, r);
+    if(leaf == NULL) {
+      return 0;
+    }
+    if(matched == r->length) {
+      leaf->child[prefix_bit(&n->prefix, matched)] = n;
+      *link = leaf;
+      return 1;
+    }
+
+    glue = route_trie_node_alloc(&r->ipaddr, matched, NULL);
+    if(glue == NULL) {
+      memb_free(&routetriememb, leaf);
+      return 0;
+    }
+    glue->child[prefix_bit(&r->ipaddr, matched)] = leaf;
+    glue->child[prefix_bit(&n->prefix, matched)] = n;
+    *link = glue;
+    return 1;
+  }
+
+  *link = route_trie_node_alloc(&r->ipaddr, r->length, r);
+  return *link != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_trie_remove(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node **parent_link;
+  struct route_trie_node *n;
+  struct route_trie_node *child;
+
+  parent_link = NULL;
+  for(link = &route_trie;
+      (n = *link) != NULL && n->length < r->length;
+      link = &n->child[prefix_bit(&r->ipaddr, n->length)]) {
+    parent_link = link;
+  }
+
+  if(n == NULL || n->route != r) {
+    return;
+  }
+
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    /* Still needed to tell the two subtries apart. */
+    return;
+  }
+
+  child = n->child[0] != NULL ? n->child[0] : n->child[1];
+  *link = child;
+  memb_free(&routetriememb, n);
+
+  if(child == NULL && parent_link != NULL && (*parent_link)->route == NULL) {
+    /* The parent was only there to hold n and its sibling, the
+       sibling takes its place. */
+    n = *parent_link;
+    *parent_link = n->child[0] != NULL ? n->child[0] : n->child[1];
+    memb_free(&routetriememb, n);
+  }
+}
+#endif /* UIP_DS6_ROUTE_TRIE */
+/*---------------------------------------------------------------------------*/
 #if DEBUG != DEBUG_NONE
 static void
 assert_nbr_routes_list_sane(void)
@@ -149,6 +336,10 @@ uip_ds6_route_init(void)
 {
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&routetriememb);
+  route_trie = NULL;
+#endif
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
@@ -206,15 +397,20 @@ uip_ds6_route_num_routes(void)
 uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = route_trie_lookup(addr, 128, 0);
+#else
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -230,6 +426,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -241,6 +438,13 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
+#if UIP_DS6_ROUTE_TRIE
+  if(found_route != NULL) {
+    /* Moving the route to the start of the routelist would walk the
+       list, the time of the lookup is recorded instead. */
+    found_route->last_lookup = ++lookup_clock;
+  }
+#else
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -250,6 +454,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   return found_route;
 }
@@ -276,9 +481,14 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   /* First make sure that we don't add a route twice. If we find an
      existing route for our destination, we'll delete the old
-     one first. */
+     one first. A route to a shorter or longer prefix covering
+     our destination is another route. */
+#if UIP_DS6_ROUTE_TRIE
+  r = route_trie_lookup(ipaddr, length, 1);
+#else
   r = uip_ds6_route_lookup(ipaddr);
-  if(r != NULL) {
+#endif
+  if(r != NULL && r->length == length) {
     uip_ipaddr_t *current_nexthop;
     current_nexthop = uip_ds6_route_nexthop(r);
     if(current_nexthop != NULL && uip_ipaddr_cmp(nexthop, current_nexthop)) {
@@ -302,7 +512,19 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
          least recently used route is the first route on the list. */
       uip_ds6_route_t *oldest;
 
+#if UIP_DS6_ROUTE_TRIE
+      oldest = uip_ds6_route_head();
+      for(r = uip_ds6_route_next(oldest);
+          r != NULL;
+          r = uip_ds6_route_next(r)) {
+        if(lookup_clock - r->last_lookup >
+           lookup_clock - oldest->last_lookup) {
+          oldest = r;
+        }
+      }
+#else
       oldest = list_tail(routelist); /* uip_ds6_route_head(); */
+#endif /* UIP_DS6_ROUTE_TRIE */
       PRINTF("uip_ds6_route_add: dropping route to ");
       PRINT6ADDR(&oldest->ipaddr);
       PRINTF("\n");
@@ -348,10 +570,6 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
       return NULL;
     }
 
-    /* add new routes first - assuming that there is a reason to add this
-       and that there is a packet coming soon. */
-    list_push(routelist, r);
-
     nbrr = memb_alloc(&neighborroutememb);
     if(nbrr == NULL) {
       /* This should not happen, as we explicitly deallocated one
@@ -361,6 +579,24 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
       return NULL;
     }
 
+#if UIP_DS6_ROUTE_TRIE
+    uip_ipaddr_copy(&(r->ipaddr), ipaddr);
+    r->length = length;
+    if(!route_trie_insert(r)) {
+      /* This should not happen either, there are two trie nodes per
+         route table entry. */
+      PRINTF("uip_ds6_route_add: could not allocate route trie node\n");
+      memb_free(&neighborroutememb, nbrr);
+      memb_free(&routememb, r);
+      return NULL;
+    }
+    r->last_lookup = ++lookup_clock;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
+    /* add new routes first - assuming that there is a reason to add this
+       and that there is a packet coming soon. */
+    list_push(routelist, r);
+
     nbrr->route = r;
     /* Add the route to this neighbor */
     list_add(routes->route_list, nbrr);
@@ -410,6 +646,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_TRIE
+    route_trie_remove(route);
+#endif
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
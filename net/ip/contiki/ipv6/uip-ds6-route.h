@@ -88,6 +88,15 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB UIP_CONF_MAX_ROUTES
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* UIP_DS6_ROUTE_TRIE indexes the routing table in a path compressed
+   binary trie, so that uip_ds6_route_lookup() does not walk the
+   whole table. */
+#ifdef UIP_CONF_DS6_ROUTE_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_CONF_DS6_ROUTE_TRIE
+#else
+#define UIP_DS6_ROUTE_TRIE 1
+#endif
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -119,6 +128,11 @@ typedef struct uip_ds6_route {
   uip_ipaddr_t ipaddr;
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
+#endif
+#if UIP_DS6_ROUTE_TRIE
+  /* Value of the lookup clock when the route was last looked up, to
+     drop the least recently used route when the table is full. */
+  uint32_t last_lookup;
 #endif
   uint8_t length;
 } uip_ds6_route_t;
@@ -122,6 +122,9 @@ echo_request_input(struct net_buf *buf)
 #if UIP_CONF_IPV6_RPL
   uint8_t temp_ext_len;
 #endif /* UIP_CONF_IPV6_RPL */
+  uip_ipaddr_t tmp_ipaddr;
+  uint16_t chksum;
+
   /*
    * we send an echo reply. It is trivial if there was no extension
    * headers in the request otherwise we need to remove the extension
@@ -133,15 +136,28 @@ echo_request_input(struct net_buf *buf)
   PRINT6ADDR(&UIP_IP_BUF(buf)->destipaddr);
   PRINTF("\n");
 
+  /*
+   * The reply carries the same ICMP message, so its checksum is
+   * updated for the fields that change instead of summed again
+   * (RFC 1624).
+   */
+  chksum = uip_chksum_update16(uip_ntohs(UIP_ICMP_BUF(buf)->icmpchksum),
+                               (UIP_ICMP_BUF(buf)->type << 8) |
+                               UIP_ICMP_BUF(buf)->icode,
+                               ICMP6_ECHO_REPLY << 8);
+
   /* IP header */
   UIP_IP_BUF(buf)->ttl = uip_ds6_if.cur_hop_limit;
 
   if(uip_is_addr_mcast(&UIP_IP_BUF(buf)->destipaddr)){
+    uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF(buf)->destipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->destipaddr, &UIP_IP_BUF(buf)->srcipaddr);
     uip_ds6_select_src(&UIP_IP_BUF(buf)->srcipaddr, &UIP_IP_BUF(buf)->destipaddr);
+    /* The multicast destination is replaced by our own address. */
+    chksum = uip_chksum_update(chksum, tmp_ipaddr.u8,
+                               UIP_IP_BUF(buf)->srcipaddr.u8,
+                               sizeof(uip_ipaddr_t));
   } else {
-    uip_ipaddr_t tmp_ipaddr;
-
     uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF(buf)->srcipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->srcipaddr, &UIP_IP_BUF(buf)->destipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->destipaddr, &tmp_ipaddr);
@@ -193,8 +209,7 @@ echo_request_input(struct net_buf *buf)
   /* Note: now UIP_ICMP_BUF points to the beginning of the echo reply */
   UIP_ICMP_BUF(buf)->type = ICMP6_ECHO_REPLY;
   UIP_ICMP_BUF(buf)->icode = 0;
-  UIP_ICMP_BUF(buf)->icmpchksum = 0;
-  UIP_ICMP_BUF(buf)->icmpchksum = ~uip_icmp6chksum(buf);
+  UIP_ICMP_BUF(buf)->icmpchksum = uip_htons(chksum);
 
   PRINTF("Sending Echo Reply to ");
   PRINT6ADDR(&UIP_IP_BUF(buf)->destipaddr);
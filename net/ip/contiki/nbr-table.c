@@ -62,6 +62,18 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+/* Open addressing hash table of the neighbors, indexed by their
+ * link-layer address. A slot holds a neighbor index plus one, or 0 when
+ * empty. There are twice as many slots as neighbors, so that the probe
+ * sequences stay short. */
+#define NBR_TABLE_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS + 1)
+static uint16_t lladdr_hash[NBR_TABLE_HASH_SIZE];
+
+/* For each neighbor, the value of use_clock when it was last looked up,
+ * to evict the least recently used neighbor when the table is full */
+static uint32_t last_used[NBR_TABLE_MAX_NEIGHBORS];
+static uint32_t use_clock;
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -105,22 +117,83 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+/* Get the first hash slot to probe for a link-layer address (FNV-1a) */
+static int
+hash_slot(const linkaddr_t *lladdr)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = (hash ^ lladdr->u8[i]) * 16777619u;
+  }
+  return hash % NBR_TABLE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Add the key of a neighbor to the hash table */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  int slot = hash_slot(&key->lladdr);
+
+  while(lladdr_hash[slot] != 0) {
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+  }
+  lladdr_hash[slot] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the key of a neighbor from the hash table */
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  int index = index_from_key(key);
+  int slot = hash_slot(&key->lladdr);
+  int next;
+  int home;
+
+  while(lladdr_hash[slot] != index + 1) {
+    if(lladdr_hash[slot] == 0) {
+      return;
+    }
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+  }
+  lladdr_hash[slot] = 0;
+
+  /* Move back the following keys of the probe sequence that could no
+   * longer be found past the emptied slot */
+  for(next = (slot + 1) % NBR_TABLE_HASH_SIZE;
+      lladdr_hash[next] != 0;
+      next = (next + 1) % NBR_TABLE_HASH_SIZE) {
+    home = hash_slot(&key_from_index(lladdr_hash[next] - 1)->lladdr);
+    if(slot <= next ? (slot < home && home <= next)
+                    : (slot < home || home <= next)) {
+      continue;
+    }
+    lladdr_hash[slot] = lladdr_hash[next];
+    lladdr_hash[next] = 0;
+    slot = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
+  int slot;
+  int index;
+
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
-  key = list_head(nbr_table_keys);
-  while(key != NULL) {
-    if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
-      return index_from_key(key);
+  for(slot = hash_slot(lladdr);
+      lladdr_hash[slot] != 0;
+      slot = (slot + 1) % NBR_TABLE_HASH_SIZE) {
+    index = lladdr_hash[slot] - 1;
+    if(linkaddr_cmp(lladdr, &key_from_index(index)->lladdr)) {
+      return index;
     }
-    key = list_item_next(key);
   }
   return -1;
 }
@@ -161,6 +234,7 @@ nbr_table_allocate(void)
 {
   nbr_table_key_t *key;
   int least_used_count = 0;
+  uint32_t least_used_age = 0;
   nbr_table_key_t *least_used_key = NULL;
 
   key = memb_alloc(&neighbor_addr_mem);
@@ -170,7 +244,7 @@ nbr_table_allocate(void)
             * The replacement policy is the following: remove neighbor that is:
             * (1) not locked
             * (2) used by fewest tables
-            * (3) oldest (the list is ordered by insertion time)
+            * (3) least recently looked up
             * */
     /* Get item from first key */
     key = list_head(nbr_table_keys);
@@ -181,6 +255,7 @@ nbr_table_allocate(void)
       if(!locked) {
         int used = used_map[item_index];
         int used_count = 0;
+        uint32_t age = use_clock - last_used[item_index];
         /* Count how many tables are using this item */
         while(used != 0) {
           if((used & 1) == 1) {
@@ -188,13 +263,12 @@ nbr_table_allocate(void)
           }
           used >>= 1;
         }
-        /* Find least used item */
-        if(least_used_key == NULL || used_count < least_used_count) {
+        /* Find least used item, and the least recently used one of those */
+        if(least_used_key == NULL || used_count < least_used_count ||
+           (used_count == least_used_count && age > least_used_age)) {
           least_used_key = key;
           least_used_count = used_count;
-          if(used_count == 0) { /* We won't find any least used item */
-            break;
-          }
+          least_used_age = age;
         }
       }
       key = list_item_next(key);
@@ -216,8 +290,9 @@ nbr_table_allocate(void)
       }
       /* Empty used map */
       used_map[index_from_key(least_used_key)] = 0;
-      /* Remove neighbor from list */
+      /* Remove neighbor from list and hash table */
       list_remove(nbr_table_keys, least_used_key);
+      hash_remove(least_used_key);
       /* Return associated key */
       return least_used_key;
     }
@@ -298,7 +373,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr)
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+    hash_add(key);
   }
+  last_used[index] = ++use_clock;
 
   /* Get item in the current table */
   item = item_from_index(table, index);
@@ -314,8 +391,14 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr)
 void *
 nbr_table_get_from_lladdr(nbr_table_t *table, const linkaddr_t *lladdr)
 {
-  void *item = item_from_index(table, index_from_lladdr(lladdr));
-  return nbr_get_bit(used_map, table, item) ? item : NULL;
+  int index = index_from_lladdr(lladdr);
+  void *item = item_from_index(table, index);
+
+  if(nbr_get_bit(used_map, table, item)) {
+    last_used[index] = ++use_clock;
+    return item;
+  }
+  return NULL;
 }
 /*---------------------------------------------------------------------------*/
 /* Removes a neighbor from the current table (unset "used" bit) */
@@ -41,9 +41,16 @@
  * \file
  * Memory block allocation routines.
  * \author Adam Dunkels <adam@sics.se>
+ *
+ * The allocated chunks are tracked in a bitmap next to the reference
+ * counts, so that memb_alloc() finds a free chunk with one bit scan per
+ * 32 chunks, and memb_free() computes the chunk index from the pointer
+ * instead of walking through the memory block.
  */
 #include <string.h>
 
+#include <nanokernel.h>
+
 #include "contiki.h"
 #include "lib/memb.h"
 
@@ -52,19 +59,27 @@ void
 memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
+  memset(m->used, 0, MEMB_MAP_WORDS(m->num) * sizeof(uint32_t));
   memset(m->mem, 0, m->size * m->num);
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
+  int w;
   int i;
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-	 indicate that it now is used and return a pointer to the
-	 memory block. */
+  for(w = 0; w < MEMB_MAP_WORDS(m->num); ++w) {
+    if(m->used[w] != 0xffffffff) {
+      i = (w << 5) + find_lsb_set(~m->used[w]) - 1;
+      if(i >= m->num) {
+	/* Only the padding bits of the last word were clear. */
+	break;
+      }
+
+      /* This block was unused, so we mark it as used, increase the
+	 reference count and return a pointer to the memory block. */
+      m->used[w] |= (uint32_t)1 << (i & 31);
       ++(m->count[i]);
       return (void *)((char *)m->mem + (i * m->size));
     }
@@ -78,26 +93,28 @@ memb_alloc(struct memb *m)
 char
 memb_free(struct memb *m, void *ptr)
 {
+  unsigned int offset;
   int i;
-  char *ptr2;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-	 reference count and return the new value of it. */
-      if(m->count[i] > 0) {
-	/* Make sure that we don't deallocate free memory. */
-	--(m->count[i]);
-      }
-      return m->count[i];
+  /* Find the block to which the pointer "ptr" points to. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+
+  /* Decrease the reference count and return the new value of it. */
+  if(m->count[i] > 0) {
+    /* Make sure that we don't deallocate free memory. */
+    if(--(m->count[i]) == 0) {
+      m->used[i >> 5] &= ~((uint32_t)1 << (i & 31));
     }
-    ptr2 += m->size;
   }
-  return -1;
+  return m->count[i];
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -110,12 +127,14 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
-  int i;
-  int num_free = 0;
+  uint32_t used;
+  int w;
+  int num_free = m->num;
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      ++num_free;
+  for(w = 0; w < MEMB_MAP_WORDS(m->num); ++w) {
+    /* Clear the lowest set bit until no allocated chunk is left. */
+    for(used = m->used[w]; used != 0; used &= used - 1) {
+      --num_free;
     }
   }
 
@@ -63,8 +63,16 @@
 #ifndef MEMB_H_
 #define MEMB_H_
 
+#include <stdint.h>
+
 #include "sys/cc.h"
 
+/**
+ * Number of 32-bit words in the map of used blocks of a memory block
+ * holding \a num chunks.
+ */
+#define MEMB_MAP_WORDS(num) (((num) + 31) / 32)
+
 /**
  * Declare a memory block.
  *
@@ -89,15 +97,20 @@ MEMB(connections, struct connection, 16);
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static uint32_t CC_CONCAT(name,_memb_used)[MEMB_MAP_WORDS(num)]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_used)}
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+  /* One bit per chunk, set while the chunk is allocated. A cleared map
+     means that all chunks are free, like a cleared count array. */
+  uint32_t *used;
 };
 
 /**
@@ -43,11 +43,13 @@
  */
 
 #include <net/buf.h>
+#include <misc/util.h>
 
 #include "sys/ctimer.h"
 #include "contiki.h"
 #include "lib/list.h"
 
+/* Timers set before ctimer_process was started */
 LIST(ctimer_list);
 
 static char initialized;
@@ -73,21 +75,18 @@ PROCESS_THREAD(ctimer_process, ev, data, buf, user_data)
   for(c = list_head(ctimer_list); c != NULL; c = c->next) {
     etimer_set(&c->etimer, c->etimer.timer.interval, &ctimer_process);
   }
+  list_init(ctimer_list);
   initialized = 1;
 
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
-    for(c = list_head(ctimer_list); c != NULL; c = c->next) {
-      if(&c->etimer == data) {
-	list_remove(ctimer_list, c);
-	PROCESS_CONTEXT_BEGIN(c->p);
-	if(c->f != NULL) {
-          c->f(c->buf, c->ptr);
-	}
-	PROCESS_CONTEXT_END(c->p);
-	break;
-      }
+    /* Only the etimers of callback timers are posted to this process. */
+    c = CONTAINER_OF(data, struct ctimer, etimer);
+    PROCESS_CONTEXT_BEGIN(c->p);
+    if(c->f != NULL) {
+      c->f(c->buf, c->ptr);
     }
+    PROCESS_CONTEXT_END(c->p);
   }
   PROCESS_END();
 }
@@ -116,9 +115,8 @@ ctimer_set(struct net_buf *buf, struct ctimer *c, clock_time_t t,
     PROCESS_CONTEXT_END(&ctimer_process);
   } else {
     c->etimer.timer.interval = t;
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -128,9 +126,9 @@ ctimer_reset(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_reset(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -140,9 +138,9 @@ ctimer_restart(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_restart(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -153,8 +151,8 @@ ctimer_stop(struct ctimer *c)
   } else {
     c->etimer.next = NULL;
     //c->etimer.p = PROCESS_NONE;
+    list_remove(ctimer_list, c);
   }
-  list_remove(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -54,62 +54,172 @@
 
 extern void net_timer_check(void);
 
-static struct etimer *timerlist;
+/*
+ * Pending timers are kept in a pairing heap, ordered by expiration
+ * time, so that the first timer to expire is always at the root. A
+ * node links to its first child (child), to its next sibling (next),
+ * and to its previous sibling or, for a first child, its parent
+ * (prev). Expired timers are removed from the heap when their event
+ * is posted.
+ */
+static struct etimer *timerheap;
 static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
-static void
-update_time(void)
+static int
+expires_before(struct etimer *a, struct etimer *b)
+{
+  return (int32_t)(etimer_expiration_time(a) -
+                   etimer_expiration_time(b)) < 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Meld two detached heaps, and return the root of the result. */
+static struct etimer *
+meld(struct etimer *a, struct etimer *b)
 {
   struct etimer *t;
-  clock_time_t remaining;
 
-  if (timerlist == NULL) {
+  if(a == NULL) {
+    return b;
+  }
+  if(b == NULL) {
+    return a;
+  }
+
+  if(expires_before(b, a)) {
+    t = a;
+    a = b;
+    b = t;
+  }
+
+  /* b becomes the first child of a. */
+  b->prev = a;
+  b->next = a->child;
+  if(a->child != NULL) {
+    a->child->prev = b;
+  }
+  a->child = b;
+
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+/* Meld a list of siblings into one heap, in two passes. */
+static struct etimer *
+merge_pairs(struct etimer *first)
+{
+  struct etimer *a, *b, *next, *pairs = NULL;
+
+  /* Meld the siblings by pairs, left to right, stacking the results. */
+  while(first != NULL) {
+    a = first;
+    b = a->next;
+    next = b != NULL ? b->next : NULL;
+
+    a->next = a->prev = NULL;
+    if(b != NULL) {
+      b->next = b->prev = NULL;
+      a = meld(a, b);
+    }
+
+    a->next = pairs;
+    pairs = a;
+    first = next;
+  }
+
+  /* Meld the pairs, right to left. */
+  first = NULL;
+  while(pairs != NULL) {
+    next = pairs->next;
+    pairs->next = NULL;
+    first = meld(first, pairs);
+    pairs = next;
+  }
+
+  return first;
+}
+/*---------------------------------------------------------------------------*/
+static int
+timer_in_heap(struct etimer *et)
+{
+  return et == timerheap || et->prev != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_timer(struct etimer *et)
+{
+  struct etimer *children;
+
+  if(et == timerheap) {
+    timerheap = merge_pairs(et->child);
+  } else {
+    if(et->prev->child == et) {
+      et->prev->child = et->next;
+    } else {
+      et->prev->next = et->next;
+    }
+    if(et->next != NULL) {
+      et->next->prev = et->prev;
+    }
+
+    children = merge_pairs(et->child);
+    timerheap = meld(timerheap, children);
+  }
+
+  et->child = et->next = et->prev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_time(void)
+{
+  if(timerheap == NULL) {
     next_expiration = 0;
   } else {
-    clock_time_t shortest = 0;
-    for(t = timerlist; t != NULL; t = t->next) {
-      remaining = timer_remaining(&t->timer);
-      PRINTF("%s():%d etimer %p left %d shortest %d triggered %d\n",
-	     __FUNCTION__, __LINE__,
-	     t, remaining, shortest, etimer_is_triggered(t));
-      if((shortest > remaining || shortest == 0) && remaining != 0) {
-        shortest = remaining;
-      }
+    /* Never 0, which means that there are no timers. */
+    next_expiration = timer_remaining(&timerheap->timer);
+    if(next_expiration == 0) {
+      next_expiration = 1;
     }
-    next_expiration = shortest;
-    PRINTF("%s():%d next expiration %d\n", __FUNCTION__, __LINE__,
-	   next_expiration);
   }
 
-  net_timer_check();
+  PRINTF("%s():%d next expiration %d\n", __FUNCTION__, __LINE__,
+	 next_expiration);
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data, buf, user_data)
 {
   struct etimer *t;
+  clock_time_t now;
 
   PROCESS_BEGIN();
 
   while(1) {
     PROCESS_YIELD();
 
-    PRINTF("%s():%d timerlist %p\n", __FUNCTION__, __LINE__, timerlist);
-    for(t = timerlist; t != NULL; t = t->next) {
-      PRINTF("%s():%d timer %p remaining %d triggered %d\n",
-	     __FUNCTION__, __LINE__,
-	     t, timer_remaining(&t->timer), etimer_is_triggered(t));
-      if(etimer_expired(t) && !etimer_is_triggered(t)) {
-        PRINTF("%s():%d timer %p expired, process %p\n",
-	       __FUNCTION__, __LINE__, t, t->p);
-
-	if (t->p == NULL) {
-          PRINTF("calling tcpip_process\n");
-          process_post_synch(&tcpip_process, PROCESS_EVENT_TIMER, t, NULL);
-	} else {
-          process_post_synch(t->p, PROCESS_EVENT_TIMER, t, NULL);
-	}
+    PRINTF("%s():%d timerheap %p\n", __FUNCTION__, __LINE__, timerheap);
+
+    /*
+     * Only the expired timers at the top of the heap are touched.
+     * A timer set again by the process it is posted to expires after
+     * now, and is left for the next poll.
+     */
+    now = clock_time();
+    while((t = timerheap) != NULL && etimer_expired(t) &&
+          (int32_t)(etimer_expiration_time(t) - now) <= 0) {
+      remove_timer(t);
+
+      if(etimer_is_triggered(t)) {
+        continue;
+      }
+
+      PRINTF("%s():%d timer %p expired, process %p\n",
+	     __FUNCTION__, __LINE__, t, t->p);
+
+      if (t->p == NULL) {
+        PRINTF("calling tcpip_process\n");
+        process_post_synch(&tcpip_process, PROCESS_EVENT_TIMER, t, NULL);
+      } else {
+        process_post_synch(t->p, PROCESS_EVENT_TIMER, t, NULL);
       }
     }
     update_time();
@@ -129,21 +239,18 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
-  struct etimer *t;
-
-  for(t = timerlist; t != NULL; t = t->next) {
-    if(t == timer) {
-      /* Timer already on list, bail out. */
-	update_time();
-	return;
-    }
+  /* The expiration time has changed, move the timer to its new place. */
+  if(timer_in_heap(timer)) {
+    remove_timer(timer);
   }
 
-  /* Timer not on list. */
-  timer->next = timerlist;
-  timerlist = timer;
-
+  timerheap = meld(timerheap, timer);
   update_time();
+
+  /* Wake up the timer fiber only if it has to wake up sooner. */
+  if(timerheap == timer) {
+    net_timer_check();
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -173,7 +280,9 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
-  update_time();
+  if(timer_in_heap(et)) {
+    add_timer(et);
+  }
 }
 #endif
 /*---------------------------------------------------------------------------*/
@@ -198,7 +307,7 @@ etimer_start_time(struct etimer *et)
 int
 etimer_pending(void)
 {
-  return timerlist != NULL;
+  return timerheap != NULL;
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
@@ -210,33 +319,14 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
-  struct etimer *t;
-
   timer_stop(&et->timer);
 
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
+  if(timer_in_heap(et)) {
+    remove_timer(et);
     update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next);
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-        to remove. We point the items next pointer to the event after
-        the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
   }
 
-  /* Remove the next pointer from the item to be removed. */
-  et->next = NULL;
-
-  PRINTF("%s():%d timer %p removed\n", __FUNCTION__, __LINE__);
+  PRINTF("%s():%d timer %p removed\n", __FUNCTION__, __LINE__, et);
 }
 /*---------------------------------------------------------------------------*/
 bool etimer_is_triggered(struct etimer *t)
@@ -77,6 +77,8 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+  struct etimer *child;
+  struct etimer *prev;
 };
 
 /**
@@ -67,12 +67,14 @@
 #include <net/l2_buf.h>
 #include <net_driver_15_4.h>
 #include "contiki/sicslowpan/sicslowpan_fragmentation.h"
+#include "contiki/sicslowpan/sicslowpan_compression.h"
 #include "contiki/netstack.h"
 #include "contiki/packetbuf.h"
 #include "contiki/queuebuf.h"
 #include "contiki/ip/uip.h"
 #include "contiki/ip/tcpip.h"
 #include "dev/watchdog.h"
+#include "sys/ctimer.h"
 
 #include "contiki/ipv6/uip-ds6-nbr.h"
 
@@ -145,19 +147,19 @@ void uip_log(char *msg);
 #define MAC_MAX_PAYLOAD (127 - 2)
 #endif /* SICSLOWPAN_CONF_MAC_MAX_PAYLOAD */
 
-#define SICSLOWPAN_DISPATCH_IPV6	0x41 /* 01000001 = 65 */
-
 static int last_rssi;
 
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/* This needs to be defined in NBR / Nodes depending on available RAM   */
-/*   and expected reassembly requirements                               */
+/* FRAGMENT_BUFFERS is the number of received fragments that the      */
+/* reassemblies may hold together. The fragments are kept in the L2    */
+/* buffers they were received in, so this has to leave L2 buffers for  */
+/* sending. 13 fragments hold a 1280 byte datagram.                    */
 #ifdef SICSLOWPAN_CONF_FRAGMENT_BUFFERS
 #define SICSLOWPAN_FRAGMENT_BUFFERS SICSLOWPAN_CONF_FRAGMENT_BUFFERS
 #else
-#define SICSLOWPAN_FRAGMENT_BUFFERS 16
+#define SICSLOWPAN_FRAGMENT_BUFFERS 13
 #endif
 
 /* REASS_CONTEXTS corresponds to the number of simultaneous             */
@@ -165,7 +167,7 @@ static uint16_t my_tag;
 #ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
 #define SICSLOWPAN_REASS_CONTEXTS SICSLOWPAN_CONF_REASS_CONTEXTS
 #else
-#define SICSLOWPAN_REASS_CONTEXTS 2
+#define SICSLOWPAN_REASS_CONTEXTS 8
 #endif
 
 /* The size of each fragment (IP payload) for the 6lowpan fragmentation */
@@ -186,152 +188,298 @@ struct sicslowpan_frag_info {
   linkaddr_t receiver;
   /** When reassembling, the tag in the fragments being merged. */
   uint16_t tag;
-  /** Total length of the fragmented packet */
+  /** Total length of the fragmented packet (if zero this context is free) */
   uint16_t len;
-  /** Current length of reassembled fragments */
-  uint16_t reassembled_len;
-  /** Last fragment */
-  uint8_t last_fragment;
-  /** Reassembly %process %timer. */
-  struct timer reass_timer;
+  /** The L2 buffers of the received fragments, ordered by offset and
+      chained through their frags field */
+  struct net_buf *frags;
+  /** Reassembly timer, the fragments are dropped when it expires. */
+  struct ctimer reass_timer;
 };
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 
-struct sicslowpan_frag_buf {
-  /* the index of the frag_info */
-  uint8_t index;
-  /* Fragment offset */
-  uint8_t offset;
-  /* Length of this fragment (if zero this buffer is not allocated) */
-  uint8_t len;
-  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
-};
-
-static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
+/* Number of fragments held by all the reassembly contexts */
+static int frag_count;
 
 /*---------------------------------------------------------------------------*/
-static int
-clear_fragments(uint8_t frag_info_index)
+/* The payload of a received fragment, after its fragmentation header */
+static uint8_t *
+frag_payload(struct net_buf *mbuf)
 {
-  int i, clear_count;
-  clear_count = 0;
-  frag_info[frag_info_index].len = 0;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
-      /* deallocate the buffer */
-      frag_buf[i].len = 0;
-      clear_count++;
-    }
+  return uip_packetbuf_ptr(mbuf) + uip_packetbuf_hdr_len(mbuf);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+frag_payload_len(struct net_buf *mbuf)
+{
+  return packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf);
+}
+/*---------------------------------------------------------------------------*/
+/* The offset of a received fragment in the datagram, in bytes */
+static uint16_t
+fragment_offset(struct net_buf *mbuf)
+{
+  if(uip_packetbuf_hdr_len(mbuf) == SICSLOWPAN_FRAG1_HDR_LEN) {
+    return 0;
   }
-  return clear_count;
+  return (uint16_t)uip_packetbuf_ptr(mbuf)[PACKETBUF_FRAG_OFFSET] << 3;
 }
 /*---------------------------------------------------------------------------*/
+/* The end of a received fragment in the datagram, in bytes. For the first
+   fragment, uncomp_hdr_len and payload_len are set by frag1_headers(). */
+static uint16_t
+fragment_end(struct net_buf *mbuf)
+{
+  return fragment_offset(mbuf) + uip_uncomp_hdr_len(mbuf) +
+         uip_packetbuf_payload_len(mbuf);
+}
+/*---------------------------------------------------------------------------*/
+/* Inline lengths of the IPHC addresses, indexed by address mode */
+static const uint8_t iphc_ll_addr_len[] = { 16, 8, 2, 0 };
+static const uint8_t iphc_ctx_addr_len[] = { 0, 8, 2, 0 };
+static const uint8_t iphc_mcast_addr_len[] = { 16, 6, 4, 1 };
+/* Inline lengths of the compressed UDP ports, with the NHC byte */
+static const uint8_t nhc_udp_ports_len[] = { 5, 4, 4, 2 };
+
+/* The headers of a first fragment grow when they are uncompressed, so
+   it ends further in the datagram than its length. Find the length of
+   its headers, as received and as uncompressed, the same way
+   uncompress_hdr_iphc() walks them. The uncompressed length goes to
+   uncomp_hdr_len and the length of the data after the headers to
+   payload_len. */
 static int
-store_fragment(struct net_buf *mbuf, uint8_t index, uint8_t offset)
+frag1_headers(struct net_buf *mbuf)
 {
-  int i;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer
-       * and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf);
-      frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, uip_packetbuf_ptr(mbuf) + uip_packetbuf_hdr_len(mbuf),
-             packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf));
-
-      PRINTF("Fragment payload length: %d\n", frag_buf[i].len);
-      /* return the length of the stored fragment */
-      return frag_buf[i].len;
+  uint8_t *hdr = frag_payload(mbuf);
+  uint16_t len = frag_payload_len(mbuf);
+  uint8_t iphc0, iphc1, nhc;
+  uint16_t hdr_len;
+
+  if(len > 0 && hdr[0] == SICSLOWPAN_DISPATCH_IPV6) {
+    /* Only the dispatch is removed */
+    uip_uncomp_hdr_len(mbuf) = 0;
+    uip_packetbuf_payload_len(mbuf) = len - SICSLOWPAN_IPV6_HDR_LEN;
+    return 1;
+  }
+
+  if(len < 2 || (hdr[0] & 0xe0) != SICSLOWPAN_DISPATCH_IPHC) {
+    return 0;
+  }
+
+  iphc0 = hdr[0];
+  iphc1 = hdr[1];
+  hdr_len = 2;
+
+  if(iphc1 & SICSLOWPAN_IPHC_CID) {
+    hdr_len++;
+  }
+
+  /* Traffic class and flow label */
+  switch(iphc0 & (SICSLOWPAN_IPHC_FL_C | SICSLOWPAN_IPHC_TC_C)) {
+  case 0:
+    hdr_len += 4;
+    break;
+  case SICSLOWPAN_IPHC_TC_C:
+    hdr_len += 3;
+    break;
+  case SICSLOWPAN_IPHC_FL_C:
+    hdr_len += 1;
+    break;
+  }
+
+  if((iphc0 & SICSLOWPAN_IPHC_NH_C) == 0) {
+    hdr_len++;
+  }
+  if((iphc0 & 0x03) == SICSLOWPAN_IPHC_TTL_I) {
+    hdr_len++;
+  }
+
+  /* Source address */
+  if(iphc1 & SICSLOWPAN_IPHC_SAC) {
+    hdr_len += iphc_ctx_addr_len[(iphc1 & SICSLOWPAN_IPHC_SAM_11) >>
+                                 SICSLOWPAN_IPHC_SAM_BIT];
+  } else {
+    hdr_len += iphc_ll_addr_len[(iphc1 & SICSLOWPAN_IPHC_SAM_11) >>
+                                SICSLOWPAN_IPHC_SAM_BIT];
+  }
+
+  /* Destination address, context based multicast is not supported */
+  if(iphc1 & SICSLOWPAN_IPHC_M) {
+    if(iphc1 & SICSLOWPAN_IPHC_DAC) {
+      return 0;
+    }
+    hdr_len += iphc_mcast_addr_len[iphc1 & SICSLOWPAN_IPHC_DAM_11];
+  } else if(iphc1 & SICSLOWPAN_IPHC_DAC) {
+    hdr_len += iphc_ctx_addr_len[iphc1 & SICSLOWPAN_IPHC_DAM_11];
+  } else {
+    hdr_len += iphc_ll_addr_len[iphc1 & SICSLOWPAN_IPHC_DAM_11];
+  }
+
+  uip_uncomp_hdr_len(mbuf) = UIP_IPH_LEN;
+
+  if((iphc0 & SICSLOWPAN_IPHC_NH_C) && hdr_len < len &&
+     (hdr[hdr_len] & SICSLOWPAN_NHC_UDP_MASK) == SICSLOWPAN_NHC_UDP_ID) {
+    nhc = hdr[hdr_len];
+    hdr_len += nhc_udp_ports_len[nhc & 0x03];
+    if((nhc & SICSLOWPAN_NHC_UDP_CHECKSUMC) == 0) {
+      hdr_len += 2;
     }
+    uip_uncomp_hdr_len(mbuf) += UIP_UDPH_LEN;
+  }
+
+  if(hdr_len > len) {
+    return 0;
   }
-  /* failed */
-  return -1;
+
+  uip_packetbuf_payload_len(mbuf) = len - hdr_len;
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
-static int8_t
-add_fragment(struct net_buf *mbuf, uint16_t tag, uint16_t frag_size, uint8_t offset)
+static void
+clear_fragments(struct sicslowpan_frag_info *info)
 {
-  int i;
-  int len;
-  int8_t found = -1;
-
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-       clear_fragments(i);
-      }
+  struct net_buf *frag;
 
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
-      }
-    }
+  ctimer_stop(&info->reass_timer);
+  info->len = 0;
 
-    if(found < 0) {
-      PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
-      return -1;
-    }
+  while(info->frags != NULL) {
+    frag = info->frags;
+    info->frags = frag->frags;
+    frag->frags = NULL;
+    l2_buf_unref(frag);
+    frag_count--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+reass_timeout(struct net_buf *buf, void *ptr)
+{
+  struct sicslowpan_frag_info *info = ptr;
 
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER));
-    linkaddr_copy(&frag_info[found].receiver,
-                  packetbuf_addr(mbuf, PACKETBUF_ADDR_RECEIVER));
+  PRINTF("*** Reassembly timeout - dropping fragments - tag: %d\n", info->tag);
+  clear_fragments(info);
+}
+/*---------------------------------------------------------------------------*/
+/* Add a new fragment to the reassembly context of its sender and tag. The
+   L2 buffer of the fragment is kept by the context. */
+static struct sicslowpan_frag_info *
+add_fragment(struct net_buf *mbuf, uint16_t tag, uint16_t frag_size)
+{
+  const linkaddr_t *sender = packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER);
+  struct sicslowpan_frag_info *info = NULL;
+  struct net_buf *prev;
+  struct net_buf *frag;
+  uint16_t offset;
+  int i;
 
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-    i = found;
-    goto store;
+  if(frag_count >= SICSLOWPAN_FRAGMENT_BUFFERS) {
+    PRINTF("*** Failed to store fragment - no free fragment buffer - tag: %d\n", tag);
+    return NULL;
   }
 
-  /* This is a N-fragment - should find the info */
   for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER))) {
+    if(frag_info[i].len > 0 && frag_info[i].tag == tag &&
+       linkaddr_cmp(&frag_info[i].sender, sender)) {
       /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
+      info = &frag_info[i];
       break;
     }
+    if(info == NULL && frag_info[i].len == 0) {
+      /* We remember the first free fragment info in case this is the
+         first fragment received of the packet. */
+      info = &frag_info[i];
+    }
   }
 
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    PRINTF("*** Failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
-    return -1;
+  if(info == NULL) {
+    PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
+    return NULL;
   }
 
-store:
-  /* i is the index of the reassembly context */
-  len = store_fragment(mbuf, i, offset);
-  if(len > 0) {
-    frag_info[i].reassembled_len += len;
-    if((offset << 3)+ len >= frag_size) {
-      frag_info[i].last_fragment = 1;
-    } else {
-      frag_info[i].last_fragment = 0;
-    }
-    return i;
+  /* A fragment that disagrees with the ones received so far on the
+     packet size or on the offsets discards them, and a new reassembly
+     starts with it (RFC 4944, section 5.3). */
+  if(info->len > 0 && info->len != frag_size) {
+    PRINTF("*** Fragment size %d does not match packet size %d - tag: %d\n",
+           frag_size, info->len, tag);
+    clear_fragments(info);
+  }
+
+  /* Keep the fragments ordered by offset */
+  offset = fragment_offset(mbuf);
+  prev = NULL;
+  for(frag = info->frags;
+      frag != NULL && fragment_offset(frag) < offset;
+      frag = frag->frags) {
+    prev = frag;
+  }
+
+  if(frag != NULL && fragment_offset(frag) == offset &&
+     fragment_end(frag) == fragment_end(mbuf)) {
+    PRINTF("Duplicate fragment - tag: %d offset: %d\n", tag, offset);
+    return NULL;
+  }
+
+  if((prev != NULL && fragment_end(prev) > offset) ||
+     (frag != NULL && fragment_offset(frag) < fragment_end(mbuf))) {
+    PRINTF("*** Overlapping fragment - tag: %d offset: %d\n", tag, offset);
+    clear_fragments(info);
+    prev = NULL;
+  }
+
+  if(info->len == 0) {
+    /* The fragments may arrive in any order, so any of them starts a
+       new reassembly. */
+    info->len = frag_size;
+    info->tag = tag;
+    linkaddr_copy(&info->sender, sender);
+    linkaddr_copy(&info->receiver,
+                  packetbuf_addr(mbuf, PACKETBUF_ADDR_RECEIVER));
+    ctimer_set(NULL, &info->reass_timer,
+               SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16,
+               reass_timeout, info);
+  }
+
+  if(prev != NULL) {
+    net_buf_frag_insert(prev, mbuf);
   } else {
-    /* should we also clear all fragments since we failed to store this fragment? */
-    PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
-    return -1;
+    mbuf->frags = info->frags;
+    info->frags = mbuf;
   }
+  frag_count++;
+
+  PRINTF("Fragment payload length: %d\n", frag_payload_len(mbuf));
+  return info;
 }
+/*---------------------------------------------------------------------------*/
+/* Check that the fragments of a context cover the whole packet, with
+   no hole. The fragments do not overlap, so each one must start where
+   the previous one ends, from the first fragment to the packet size. */
+static int
+is_complete(struct sicslowpan_frag_info *info)
+{
+  struct net_buf *frag;
+  uint16_t end = 0;
+
+  for(frag = info->frags; frag != NULL; frag = frag->frags) {
+    if(fragment_offset(frag) != end) {
+      return 0;
+    }
+    end = fragment_end(frag);
+  }
 
+  return end == info->len;
+}
 /*---------------------------------------------------------------------------*/
 /* Copy all the fragments that are associated with a specific context into uip */
-static struct net_buf *copy_frags2uip(int context)
+static struct net_buf *copy_frags2uip(struct sicslowpan_frag_info *info)
 {
-  int i, total_len = 0;
+  struct net_buf *frag;
   struct net_buf *buf;
+  uint8_t *data;
+  int len, total_len = 0;
 
   buf = ip_buf_get_reserve_rx(0);
   if(!buf) {
@@ -339,33 +487,29 @@ static struct net_buf *copy_frags2uip(int context)
   }
 
   /* Copy from the fragment context info buffer first */
-  linkaddr_copy(&ip_buf_ll_dest(buf), &frag_info[context].receiver);
-  linkaddr_copy(&ip_buf_ll_src(buf), &frag_info[context].sender);
-
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(i == 0) {
-       uip_first_frag_len(buf) = frag_buf[i].len;
-       if(frag_buf[i].data[0] == SICSLOWPAN_DISPATCH_IPV6) {
-         memmove(frag_buf[i].data, frag_buf[i].data + 1, frag_buf[i].len - 1);
-         frag_buf[i].len -= 1;
-         uip_uncompressed(buf) = 1;
-        } else {
-         uip_uncompressed(buf) = 0;
-        }
-    }
-    /* And also copy all matching fragments */
-    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
-      memcpy(uip_buf(buf) + (uint16_t)(frag_buf[i].offset << 3),
-            (uint8_t *)frag_buf[i].data, frag_buf[i].len);
-      total_len += frag_buf[i].len;
+  linkaddr_copy(&ip_buf_ll_dest(buf), &info->receiver);
+  linkaddr_copy(&ip_buf_ll_src(buf), &info->sender);
+
+  /* Each fragment is copied once, straight from its L2 buffer */
+  for(frag = info->frags; frag != NULL; frag = frag->frags) {
+    data = frag_payload(frag);
+    len = frag_payload_len(frag);
+    if(frag == info->frags) {
+      uip_first_frag_len(buf) = len;
+      if(data[0] == SICSLOWPAN_DISPATCH_IPV6) {
+        data++;
+        len--;
+        uip_uncompressed(buf) = 1;
+      } else {
+        uip_uncompressed(buf) = 0;
+      }
     }
+    memcpy(uip_buf(buf) + fragment_offset(frag), data, len);
+    total_len += len;
   }
   net_buf_add(buf, total_len);
   uip_len(buf) = total_len;
 
-  /* deallocate all the fragments for this context */
-  clear_fragments(context);
-
   return buf;
 }
 
@@ -621,14 +765,12 @@ static int reassemble(struct net_buf *mbuf)
 {
   /* size of the IP packet (read from fragment) */
   uint16_t frag_size = 0;
-  int8_t frag_context = 0;
+  struct sicslowpan_frag_info *info;
   /* offset of the fragment in the IP packet */
   uint8_t frag_offset = 0;
-  uint8_t is_fragment = 0;
   /* tag of the fragment */
   uint16_t frag_tag = 0;
-  uint8_t first_fragment = 0, last_fragment = 0;
-  struct net_buf *buf = NULL; 
+  struct net_buf *buf = NULL;
 
   /* init */
   uip_uncomp_hdr_len(mbuf) = 0;
@@ -654,22 +796,7 @@ static int reassemble(struct net_buf *mbuf)
 
       PRINTF("size %d, tag %d, offset %d\n", frag_size, frag_tag, frag_offset);
 
-      if (frag_size > IP_BUF_MAX_DATA) {
-        PRINTF("Too big packet %d bytes (max %d), fragment discarded\n",
-	       frag_size, IP_BUF_MAX_DATA);
-	goto fail;
-      }
-
       uip_packetbuf_hdr_len(mbuf) += SICSLOWPAN_FRAG1_HDR_LEN;
-      first_fragment = 1;
-      is_fragment = 1;
-
-      /* Add the fragment to the fragmentation context (this will also copy the payload)*/
-      frag_context = add_fragment(mbuf, frag_tag, frag_size, frag_offset);
-      if(frag_context == -1) {
-        goto fail;
-      }
-
       break;
 
     case SICSLOWPAN_DISPATCH_FRAGN:
@@ -684,21 +811,12 @@ static int reassemble(struct net_buf *mbuf)
 
       PRINTF("reassemble: size %d, tag %d, offset %d\n", frag_size, frag_tag, frag_offset);
 
-      uip_packetbuf_hdr_len(mbuf) += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      /* Add the fragment to the fragmentation context  (this will also copy the payload) */
-      frag_context = add_fragment(mbuf, frag_tag, frag_size, frag_offset);
-      if(frag_context == -1) {
+      /* Offset zero is the place of the first fragment */
+      if(frag_offset == 0) {
         goto fail;
       }
 
-      if(frag_info[frag_context].reassembled_len >= frag_size
-         || frag_info[frag_context].last_fragment) {
-        last_fragment = 1;
-      }
-      is_fragment = 1;
+      uip_packetbuf_hdr_len(mbuf) += SICSLOWPAN_FRAGN_HDR_LEN;
       break;
 
     default:
@@ -712,13 +830,12 @@ static int reassemble(struct net_buf *mbuf)
       goto out;
   }
 
-  /*
-   * copy "payload" from the packetbuf buffer to the sicslowpan_buf
-   * if this is a first fragment or not fragmented packet,
-   * we have already copied the compressed headers, uncomp_hdr_len
-   * and packetbuf_hdr_len are non 0, frag_offset is.
-   * If this is a subsequent fragment, this is the contrary.
-   */
+  if (frag_size > IP_BUF_MAX_DATA) {
+    PRINTF("Too big packet %d bytes (max %d), fragment discarded\n",
+           frag_size, IP_BUF_MAX_DATA);
+    goto fail;
+  }
+
   if(packetbuf_datalen(mbuf) < uip_packetbuf_hdr_len(mbuf)) {
     PRINTF("reassemble: packet dropped due to header > total packet\n");
     goto fail;
@@ -738,41 +855,47 @@ static int reassemble(struct net_buf *mbuf)
     }
   }
 
-  if(frag_size > 0) {
-    /* Add the size of the header only for the first fragment. */
-    if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uip_uncomp_hdr_len(mbuf) + uip_packetbuf_payload_len(mbuf);
-    }
+  if(uip_packetbuf_hdr_len(mbuf) == SICSLOWPAN_FRAG1_HDR_LEN &&
+     !frag1_headers(mbuf)) {
+    PRINTF("reassemble: packet dropped, unknown headers in FRAG1\n");
+    goto fail;
+  }
 
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      frag_info[frag_context].reassembled_len = frag_size;
-      /* copy to uip(net_buf) */
-      buf = copy_frags2uip(frag_context);
-      if(!buf)
-        goto fail;
-    }
+  if(fragment_end(mbuf) > frag_size) {
+    PRINTF("reassemble: packet dropped, fragment past the packet size %d\n",
+           frag_size);
+    goto fail;
+  }
+
+  /* Add the fragment to the fragmentation context, which keeps mbuf */
+  info = add_fragment(mbuf, frag_tag, frag_size);
+  if(info == NULL) {
+    goto fail;
+  }
+
+  if(!is_complete(info)) {
+    return 1;
+  }
+
+  /* copy to uip(net_buf), the fragments are released in any case */
+  buf = copy_frags2uip(info);
+  clear_fragments(info);
+  if(!buf) {
+    return 1;
   }
 
   /*
-   * If we have a full IP packet in sicslowpan_buf, deliver it to
+   * We have a full IP packet in sicslowpan_buf, deliver it to
    * the IP stack
    */
-  if(!is_fragment || last_fragment) {
-    /* packet is in uip already - just set length */
-    if(is_fragment != 0 && last_fragment != 0) {
-      uip_len(buf) = frag_size;
-    } else {
-      uip_len(buf) = uip_packetbuf_payload_len(mbuf) + uip_uncomp_hdr_len(mbuf);
-    }
+  uip_len(buf) = frag_size;
 
-    PRINTF("reassemble: IP packet ready (length %d)\n", uip_len(buf));
+  PRINTF("reassemble: IP packet ready (length %d)\n", uip_len(buf));
 
-    if(net_driver_15_4_recv(buf) < 0) {
-      goto fail;
-    }
+  if(net_driver_15_4_recv(buf) < 0) {
+    ip_buf_unref(buf);
   }
+  return 1;
 
 out:
   /* free MAC buffer */
@@ -217,6 +217,7 @@ static struct net_buf *ip_buf_get_reserve(enum ip_buf_type type,
 	}
 
 	ip_buf_type(buf) = type;
+	ip_buf_queue_class(buf) = NET_QUEUE_BULK;
 	ip_buf_appdata(buf) = buf->data + reserve_head;
 	ip_buf_appdatalen(buf) = 0;
 	ip_buf_reserve(buf) = reserve_head;
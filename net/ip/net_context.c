@@ -29,6 +29,8 @@
 #include <string.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <misc/slist.h>
+#include <misc/util.h>
 
 #include <net/net_ip.h>
 #include <net/net_socket.h>
@@ -77,6 +79,24 @@ struct net_context {
 	};
 
 	bool receiver_registered;
+
+	/* Entry in port_hash, keyed by protocol and local port */
+	sys_snode_t port_node;
+
+	/* Entry in demux_hash, keyed by protocol, local port and remote
+	 * address and port if both are set.
+	 */
+	sys_snode_t demux_node;
+
+	/* Bucket of demux_hash, the remote address is owned by the
+	 * application and could change while the context is used.
+	 */
+	uint8_t demux_index;
+
+#ifdef CONFIG_NETWORKING_WITH_TCP
+	/* Entry in conn_hash, keyed by internal connection */
+	sys_snode_t conn_node;
+#endif
 };
 
 /* Override this in makefile if needed */
@@ -86,9 +106,43 @@ struct net_context {
 #define NET_MAX_CONTEXT 5
 #endif
 
+#if defined(CONFIG_NET_CONTEXT_HASH_SIZE)
+#define NET_CONTEXT_HASH_SIZE CONFIG_NET_CONTEXT_HASH_SIZE
+#else
+#define NET_CONTEXT_HASH_SIZE 8
+#endif
+
+/* Ephemeral ports are allocated from 0x8000 to 0xffff */
+#define EPHEMERAL_PORT_MIN 0x8000
+
+#ifdef CONFIG_NETWORKING_WITH_IPV6
+#define context_addr(addr) ((addr)->in6_addr.s6_addr)
+#define CONTEXT_ADDR_LEN sizeof(struct in6_addr)
+#else
+#define context_addr(addr) ((addr)->in_addr.s4_addr)
+#define CONTEXT_ADDR_LEN sizeof(struct in_addr)
+#endif
+
 static struct net_context contexts[NET_MAX_CONTEXT];
 static struct nano_sem contexts_lock;
 
+/* Contexts in use, hashed by protocol and local port. Used to check for
+ * bind conflicts and to allocate ephemeral ports.
+ */
+static sys_slist_t port_hash[NET_CONTEXT_HASH_SIZE];
+
+/* Contexts in use, hashed by 5-tuple. Contexts bound to a wildcard remote
+ * address or port are hashed as if the remote address and port were zero,
+ * and are found after the exact matches.
+ */
+static sys_slist_t demux_hash[NET_CONTEXT_HASH_SIZE];
+
+#ifdef CONFIG_NETWORKING_WITH_TCP
+static sys_slist_t conn_hash[NET_CONTEXT_HASH_SIZE];
+#endif
+
+static uint16_t ephemeral_port;
+
 static void context_sem_give(struct nano_sem *chan)
 {
 	switch (sys_execution_context_type_get()) {
@@ -105,17 +159,174 @@ static void context_sem_give(struct nano_sem *chan)
 	}
 }
 
+static inline bool context_addr_unspecified(const struct net_addr *addr)
+{
+	int i;
+
+	if (!addr) {
+		return true;
+	}
+
+	for (i = 0; i < CONTEXT_ADDR_LEN; i++) {
+		if (context_addr(addr)[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static inline bool context_is_wildcard(const struct net_tuple *tuple)
+{
+	return !tuple->remote_port ||
+		context_addr_unspecified(tuple->remote_addr);
+}
+
+static unsigned int context_hash(enum ip_protocol ip_proto,
+				 uint16_t local_port,
+				 const uint8_t *remote_addr,
+				 uint16_t remote_port)
+{
+	uint32_t hash = ip_proto ^ ((uint32_t)local_port << 16) ^ remote_port;
+	int i;
+
+	if (remote_addr) {
+		for (i = 0; i < CONTEXT_ADDR_LEN; i++) {
+			hash = hash * 31 + remote_addr[i];
+		}
+	}
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return hash % NET_CONTEXT_HASH_SIZE;
+}
+
+static inline unsigned int port_hash_index(enum ip_protocol ip_proto,
+					   uint16_t local_port)
+{
+	return context_hash(ip_proto, local_port, NULL, 0);
+}
+
+static unsigned int demux_hash_index(const struct net_tuple *tuple)
+{
+	if (context_is_wildcard(tuple)) {
+		return context_hash(tuple->ip_proto, tuple->local_port,
+				    NULL, 0);
+	}
+
+	return context_hash(tuple->ip_proto, tuple->local_port,
+			    context_addr(tuple->remote_addr),
+			    tuple->remote_port);
+}
+
+#ifdef CONFIG_NETWORKING_WITH_TCP
+static inline unsigned int conn_hash_index(void *conn)
+{
+	return (POINTER_TO_UINT(conn) >> 2) % NET_CONTEXT_HASH_SIZE;
+}
+#endif
+
+/* The RX fiber walks the hash tables without taking contexts_lock, so they
+ * are only modified with interrupts locked.
+ */
+static void context_hash_add(struct net_context *context)
+{
+	struct net_tuple *tuple = &context->tuple;
+	unsigned int key;
+
+	key = irq_lock();
+	sys_slist_append(&port_hash[port_hash_index(tuple->ip_proto,
+						    tuple->local_port)],
+			 &context->port_node);
+	context->demux_index = demux_hash_index(tuple);
+	sys_slist_append(&demux_hash[context->demux_index],
+			 &context->demux_node);
+	irq_unlock(key);
+}
+
+static void context_hash_remove(struct net_context *context)
+{
+	struct net_tuple *tuple = &context->tuple;
+	unsigned int key;
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&port_hash[port_hash_index(tuple->ip_proto,
+							     tuple->local_port)],
+				  &context->port_node);
+	sys_slist_find_and_remove(&demux_hash[context->demux_index],
+				  &context->demux_node);
+#ifdef CONFIG_NETWORKING_WITH_TCP
+	if (tuple->ip_proto == IPPROTO_TCP && context->conn) {
+		sys_slist_find_and_remove(&conn_hash[conn_hash_index(context->conn)],
+					  &context->conn_node);
+	}
+#endif
+	irq_unlock(key);
+}
+
+/* Check whether any context is bound to the local address and port */
 static int context_port_used(enum ip_protocol ip_proto, uint16_t local_port,
 			     const struct net_addr *local_addr)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&port_hash[port_hash_index(ip_proto,
+							   local_port)],
+				node) {
+		struct net_context *context = CONTAINER_OF(node,
+							   struct net_context,
+							   port_node);
+
+		if (context->tuple.ip_proto == ip_proto &&
+		    context->tuple.local_port == local_port &&
+		    !memcmp(context_addr(context->tuple.local_addr),
+			    context_addr(local_addr), CONTEXT_ADDR_LEN)) {
+			return -EEXIST;
+		}
+	}
 
+	return 0;
+}
+
+/* Check whether a context is bound to the same 5-tuple. Contexts with a
+ * wildcard remote address or port only conflict with each other, a packet
+ * being delivered to the context matching its remote endpoint first.
+ */
+static int context_tuple_used(enum ip_protocol ip_proto,
+			      const struct net_addr *remote_addr,
+			      uint16_t remote_port,
+			      const struct net_addr *local_addr,
+			      uint16_t local_port)
 {
-	int i;
+	bool wildcard = !remote_port || context_addr_unspecified(remote_addr);
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&port_hash[port_hash_index(ip_proto,
+							   local_port)],
+				node) {
+		struct net_context *context = CONTAINER_OF(node,
+							   struct net_context,
+							   port_node);
+
+		if (context->tuple.ip_proto != ip_proto ||
+		    context->tuple.local_port != local_port ||
+		    memcmp(context_addr(context->tuple.local_addr),
+			   context_addr(local_addr), CONTEXT_ADDR_LEN)) {
+			continue;
+		}
 
-	for (i = 0; i < NET_MAX_CONTEXT; i++) {
-		if (contexts[i].tuple.ip_proto == ip_proto &&
-		    contexts[i].tuple.local_port == local_port &&
-		    !memcmp(&contexts[i].tuple.local_addr, local_addr,
-			   sizeof(struct net_addr))) {
+		if (context_is_wildcard(&context->tuple)) {
+			if (wildcard) {
+				return -EEXIST;
+			}
+
+			continue;
+		}
+
+		if (!wildcard && context->tuple.remote_port == remote_port &&
+		    !memcmp(context_addr(context->tuple.remote_addr),
+			    context_addr(remote_addr), CONTEXT_ADDR_LEN)) {
 			return -EEXIST;
 		}
 	}
@@ -123,6 +334,101 @@ static int context_port_used(enum ip_protocol ip_proto, uint16_t local_port,
 	return 0;
 }
 
+/* Walk the ephemeral port range from a random start. At most
+ * NET_MAX_CONTEXT ports can be in use, so this ends quickly.
+ */
+static uint16_t context_ephemeral_port(enum ip_protocol ip_proto,
+				       const struct net_addr *local_addr)
+{
+	int i;
+
+	for (i = 0; i <= NET_MAX_CONTEXT; i++) {
+		uint16_t port = ephemeral_port;
+
+		ephemeral_port = (ephemeral_port + 1) | EPHEMERAL_PORT_MIN;
+
+		if (!context_port_used(ip_proto, port, local_addr)) {
+			return port;
+		}
+	}
+
+	return 0;
+}
+
+static struct net_context *context_find(enum ip_protocol ip_proto,
+					uint16_t local_port,
+					const uint8_t *remote_addr,
+					uint16_t remote_port)
+{
+	sys_snode_t *node;
+	struct net_context *context;
+	unsigned int index;
+
+	index = context_hash(ip_proto, local_port, remote_addr, remote_port);
+
+	SYS_SLIST_FOR_EACH_NODE(&demux_hash[index], node) {
+		context = CONTAINER_OF(node, struct net_context, demux_node);
+
+		if (context->tuple.ip_proto == ip_proto &&
+		    context->tuple.local_port == local_port &&
+		    context->tuple.remote_port == remote_port &&
+		    !context_is_wildcard(&context->tuple) &&
+		    !memcmp(context_addr(context->tuple.remote_addr),
+			    remote_addr, CONTEXT_ADDR_LEN)) {
+			return context;
+		}
+	}
+
+	index = context_hash(ip_proto, local_port, NULL, 0);
+
+	SYS_SLIST_FOR_EACH_NODE(&demux_hash[index], node) {
+		context = CONTAINER_OF(node, struct net_context, demux_node);
+
+		if (context->tuple.ip_proto != ip_proto ||
+		    context->tuple.local_port != local_port ||
+		    !context_is_wildcard(&context->tuple)) {
+			continue;
+		}
+
+		if (context->tuple.remote_port &&
+		    context->tuple.remote_port != remote_port) {
+			continue;
+		}
+
+		if (!context_addr_unspecified(context->tuple.remote_addr) &&
+		    memcmp(context_addr(context->tuple.remote_addr),
+			   remote_addr, CONTEXT_ADDR_LEN)) {
+			continue;
+		}
+
+		return context;
+	}
+
+	return NULL;
+}
+
+struct uip_udp_conn *net_context_find_udp_connection(const uint8_t *src,
+						     uint16_t srcport,
+						     uint16_t destport)
+{
+	struct net_context *context;
+	struct uip_udp_conn *conn;
+
+	context = context_find(IPPROTO_UDP, uip_ntohs(destport), src,
+			       uip_ntohs(srcport));
+	if (!context || !context->receiver_registered) {
+		return NULL;
+	}
+
+	conn = context->udp.udp_conn;
+	if (!conn || conn->lport != destport ||
+	    (conn->rport && conn->rport != srcport)) {
+		return NULL;
+	}
+
+	return conn;
+}
+
 struct net_context *net_context_get(enum ip_protocol ip_proto,
 					const struct net_addr *remote_addr,
 					uint16_t remote_port,
@@ -165,14 +471,17 @@ struct net_context *net_context_get(enum ip_protocol ip_proto,
 	nano_sem_take(&contexts_lock, TICKS_UNLIMITED);
 
 	if (local_port) {
-		if (context_port_used(ip_proto, local_port, local_addr) < 0) {
+		if (context_tuple_used(ip_proto, remote_addr, remote_port,
+				       local_addr, local_port) < 0) {
+			context_sem_give(&contexts_lock);
 			return NULL;
 		}
 	} else {
-		do {
-			local_port = random_rand() | 0x8000;
-		} while (context_port_used(ip_proto, local_port,
-					   local_addr) == -EEXIST);
+		local_port = context_ephemeral_port(ip_proto, local_addr);
+		if (!local_port) {
+			context_sem_give(&contexts_lock);
+			return NULL;
+		}
 	}
 
 	for (i = 0; i < NET_MAX_CONTEXT; i++) {
@@ -183,6 +492,7 @@ struct net_context *net_context_get(enum ip_protocol ip_proto,
 			contexts[i].tuple.local_addr = (struct net_addr *)local_addr;
 			contexts[i].tuple.local_port = local_port;
 			context = &contexts[i];
+			context_hash_add(context);
 			break;
 		}
 	}
@@ -225,6 +535,13 @@ void net_context_put(struct net_context *context)
 	}
 #endif
 
+	context_hash_remove(context);
+#ifdef CONFIG_NETWORKING_WITH_TCP
+	if (context->tuple.ip_proto == IPPROTO_TCP) {
+		context->conn = NULL;
+	}
+#endif
+
 	memset(&context->tuple, 0, sizeof(context->tuple));
 	memset(&context->udp, 0, sizeof(context->udp));
 	context->receiver_registered = false;
@@ -524,6 +841,16 @@ void net_context_init(void)
 		nano_fifo_init(&contexts[i].rx_queue);
 	}
 
+	for (i = 0; i < NET_CONTEXT_HASH_SIZE; i++) {
+		sys_slist_init(&port_hash[i]);
+		sys_slist_init(&demux_hash[i]);
+#ifdef CONFIG_NETWORKING_WITH_TCP
+		sys_slist_init(&conn_hash[i]);
+#endif
+	}
+
+	ephemeral_port = random_rand() | EPHEMERAL_PORT_MIN;
+
 	context_sem_give(&contexts_lock);
 }
 
@@ -619,8 +946,21 @@ void net_context_set_internal_connection(struct net_context *context,
 		return;
 	}
 
-	if (context->tuple.ip_proto == IPPROTO_TCP) {
+	if (context->tuple.ip_proto == IPPROTO_TCP &&
+	    context->conn != conn) {
+		unsigned int key = irq_lock();
+
+		if (context->conn) {
+			sys_slist_find_and_remove(&conn_hash[conn_hash_index(context->conn)],
+						  &context->conn_node);
+		}
+		if (conn) {
+			sys_slist_append(&conn_hash[conn_hash_index(conn)],
+					 &context->conn_node);
+		}
 		context->conn = conn;
+
+		irq_unlock(key);
 	}
 #endif
 }
@@ -630,11 +970,15 @@ struct net_context *net_context_find_internal_connection(void *conn)
 #if !defined(CONFIG_NETWORKING_WITH_TCP)
 	return NULL;
 #else
-	int i;
+	sys_snode_t *node;
 
-	for (i = 0; i < NET_MAX_CONTEXT; i++) {
-		if (contexts[i].conn == conn) {
-			return &contexts[i];
+	SYS_SLIST_FOR_EACH_NODE(&conn_hash[conn_hash_index(conn)], node) {
+		struct net_context *context = CONTAINER_OF(node,
+							   struct net_context,
+							   conn_node);
+
+		if (context->conn == conn) {
+			return context;
 		}
 	}
 
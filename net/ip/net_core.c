@@ -44,6 +44,7 @@
 #include "net_driver_slip.h"
 #include "net_driver_ethernet.h"
 #include "net_driver_bt.h"
+#include "net_queue.h"
 
 #include "contiki/os/sys/process.h"
 #include "contiki/os/sys/etimer.h"
@@ -99,16 +100,16 @@ extern uint8_t net_context_tcp_get_retry_count(struct net_context *context);
 static char __noinit __stack rx_fiber_stack[CONFIG_IP_RX_STACK_SIZE];
 static char __noinit __stack tx_fiber_stack[CONFIG_IP_TX_STACK_SIZE];
 static char __noinit __stack timer_fiber_stack[CONFIG_IP_TIMER_STACK_SIZE];
-static nano_thread_id_t timer_fiber_id, tx_fiber_id;
+static nano_thread_id_t timer_fiber_id;
 
 static uint8_t initialized;
 
 static struct net_dev {
 	/* Queue for incoming packets from driver */
-	struct nano_fifo rx_queue;
+	struct net_queue rx_queue;
 
 	/* Queue for outgoing packets from apps */
-	struct nano_fifo tx_queue;
+	struct net_queue tx_queue;
 
 	/* Registered network driver */
 	struct net_driver *drv;
@@ -191,10 +192,10 @@ int net_send(struct net_buf *buf)
 	}
 #endif
 
-	nano_fifo_put(&netdev.tx_queue, buf);
+	net_queue_put(&netdev.tx_queue, buf);
 
 	/* Tell the IP stack it can proceed with the packet */
-	fiber_wakeup(tx_fiber_id);
+	nano_sem_give(&netdev.tx_queue.sem);
 
 	return ret;
 }
@@ -542,6 +543,22 @@ int net_reply(struct net_context *context, struct net_buf *buf)
 	return ret;
 }
 
+/* ICMP carries the network control messages, like ND or RPL */
+static inline void classify_rx(struct net_buf *buf)
+{
+	if (ip_buf_len(buf) < UIP_LLH_LEN + UIP_IPH_LEN) {
+		return;
+	}
+
+#ifdef CONFIG_NETWORKING_WITH_IPV6
+	if (NET_BUF_IP(buf)->proto == UIP_PROTO_ICMP6) {
+#else
+	if (NET_BUF_IP(buf)->proto == UIP_PROTO_ICMP) {
+#endif
+		ip_buf_queue_class(buf) = NET_QUEUE_CONTROL;
+	}
+}
+
 /* Called by driver when an IP packet has been received */
 int net_recv(struct net_buf *buf)
 {
@@ -549,11 +566,34 @@ int net_recv(struct net_buf *buf)
 		return -ENODATA;
 	}
 
-	nano_fifo_put(&netdev.rx_queue, buf);
+	classify_rx(buf);
+	net_queue_put(&netdev.rx_queue, buf);
+	nano_sem_give(&netdev.rx_queue.sem);
 
 	return 0;
 }
 
+int net_recv_burst(struct net_buf **bufs, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (ip_buf_len(bufs[i]) == 0) {
+			break;
+		}
+
+		classify_rx(bufs[i]);
+		net_queue_put(&netdev.rx_queue, bufs[i]);
+	}
+
+	/* The RX fiber drains all the queued packets when woken up */
+	if (i) {
+		nano_sem_give(&netdev.rx_queue.sem);
+	}
+
+	return i;
+}
+
 static void udp_packet_receive(struct simple_udp_connection *c,
 			       const uip_ipaddr_t *source_addr,
 			       uint16_t source_port,
@@ -840,35 +880,39 @@ static void net_tx_fiber(void)
 		struct net_buf *buf;
 		int ret;
 
-		/* Get next packet from application - wait if necessary */
-		buf = nano_fifo_get(&netdev.tx_queue, TICKS_UNLIMITED);
+		/* Wait for packets from applications */
+		nano_sem_take(&netdev.tx_queue.sem, TICKS_UNLIMITED);
 
-		NET_DBG("Sending (buf %p, len %u) to IP stack\n",
-			buf, buf->len);
+		while ((buf = net_queue_get(&netdev.tx_queue))) {
+			NET_DBG("Sending (buf %p, len %u) to IP stack\n",
+				buf, buf->len);
 
-		/* What to do with the buffer:
-		 *  <0: error, release the buffer
-		 *   0: message was discarded by uIP, release the buffer here
-		 *  >0: message was sent ok, buffer released already
-		 */
-		ret = check_and_send_packet(buf);
-		if (ret < 0) {
-			ip_buf_unref(buf);
-			goto wait_next;
-		} else if (ret > 0) {
-			goto wait_next;
-		}
+			/* What to do with the buffer:
+			 *  <0: error, release the buffer
+			 *   0: message was discarded by uIP, release the
+			 *      buffer here
+			 *  >0: message was sent ok, buffer released already
+			 */
+			ret = check_and_send_packet(buf);
+			if (ret < 0) {
+				ip_buf_unref(buf);
+				continue;
+			} else if (ret > 0) {
+				continue;
+			}
 
-		NET_BUF_CHECK_IF_NOT_IN_USE(buf);
+			NET_BUF_CHECK_IF_NOT_IN_USE(buf);
 
-		/* Check for any events that we might need to process */
-		do {
-			ret = process_run(buf);
-		} while (ret > 0);
+			/* Check for any events that we might need to
+			 * process
+			 */
+			do {
+				ret = process_run(buf);
+			} while (ret > 0);
 
-		ip_buf_unref(buf);
+			ip_buf_unref(buf);
+		}
 
-	wait_next:
 		/* Check stack usage (no-op if not enabled) */
 		net_analyze_stack("TX fiber", tx_fiber_stack,
 				  sizeof(tx_fiber_stack));
@@ -885,21 +929,24 @@ static void net_rx_fiber(void)
 		sizeof(rx_fiber_stack));
 
 	while (1) {
-		buf = nano_fifo_get(&netdev.rx_queue, TICKS_UNLIMITED);
+		nano_sem_take(&netdev.rx_queue.sem, TICKS_UNLIMITED);
+
+		/* Handle everything the driver has handed over so far */
+		while ((buf = net_queue_get(&netdev.rx_queue))) {
+			NET_DBG("Received buf %p\n", buf);
+
+			if (!tcpip_input(buf)) {
+				ip_buf_unref(buf);
+			}
+			/* The buffer is on to its way to receiver at this
+			 * point. We must not remove it here.
+			 */
+		}
 
 		/* Check stack usage (no-op if not enabled) */
 		net_analyze_stack("RX fiber", rx_fiber_stack,
 				  sizeof(rx_fiber_stack));
 
-		NET_DBG("Received buf %p\n", buf);
-
-		if (!tcpip_input(buf)) {
-			ip_buf_unref(buf);
-		}
-		/* The buffer is on to its way to receiver at this
-		 * point. We must not remove it here.
-		 */
-
 		net_print_statistics();
 	}
 }
@@ -963,7 +1010,7 @@ static void net_timer_fiber(void)
 
 static void init_rx_queue(void)
 {
-	nano_fifo_init(&netdev.rx_queue);
+	net_queue_init(&netdev.rx_queue);
 
 	fiber_start(rx_fiber_stack, sizeof(rx_fiber_stack),
 		    (nano_fiber_entry_t)net_rx_fiber, 0, 0, 7, 0);
@@ -971,11 +1018,10 @@ static void init_rx_queue(void)
 
 static void init_tx_queue(void)
 {
-	nano_fifo_init(&netdev.tx_queue);
+	net_queue_init(&netdev.tx_queue);
 
-	tx_fiber_id = fiber_start(tx_fiber_stack, sizeof(tx_fiber_stack),
-				  (nano_fiber_entry_t)net_tx_fiber,
-				  0, 0, 7, 0);
+	fiber_start(tx_fiber_stack, sizeof(tx_fiber_stack),
+		    (nano_fiber_entry_t)net_tx_fiber, 0, 0, 7, 0);
 }
 
 static void init_timer_fiber(void)
@@ -54,9 +54,19 @@
 #endif
 static char __noinit __stack rx_fiber_stack[CONFIG_15_4_RX_STACK_SIZE];
 
+#ifndef CONFIG_15_4_RX_BURST
+#define CONFIG_15_4_RX_BURST 4
+#endif
+
 /* Queue for incoming packets from hw driver */
 static struct nano_fifo rx_queue;
 
+/* IP packets out of the frames taken in one go by the RX fiber, passed
+ * to the IP stack together.
+ */
+static struct net_buf *rx_burst[CONFIG_15_4_RX_BURST];
+static int rx_burst_len;
+
 static int net_driver_15_4_open(void)
 {
 	return 0;
@@ -94,12 +104,39 @@ static int net_driver_15_4_send(struct net_buf *buf)
 	return 1;
 }
 
-static void net_rx_15_4_fiber(void)
+static void rx_burst_flush(void)
 {
-	struct net_buf *buf;
+	int i;
+
+	i = net_recv_burst(rx_burst, rx_burst_len);
+	for (; i < rx_burst_len; i++) {
+		NET_DBG("input to IP stack failed\n");
+		ip_buf_unref(rx_burst[i]);
+	}
+
+	rx_burst_len = 0;
+}
+
+static void rx_frame(struct net_buf *buf)
+{
+#if NET_MAC_CONF_STATS
+	int byte_count = uip_pkt_buflen(buf);
+#endif
+
+	if (!NETSTACK_RDC.input(buf)) {
+		NET_DBG("802.15.4 RDC input failed, "
+			"buf %p discarded\n", buf);
+		l2_buf_unref(buf);
+	} else {
 #if NET_MAC_CONF_STATS
-	int byte_count;
+		net_mac_stats.bytes_received += byte_count;
 #endif
+	}
+}
+
+static void net_rx_15_4_fiber(void)
+{
+	struct net_buf *buf;
 
 	NET_DBG("Starting 15.4 RX fiber (stack %d bytes)\n",
 		sizeof(rx_fiber_stack));
@@ -108,18 +145,16 @@ static void net_rx_15_4_fiber(void)
 		/* Wait next packet from 15.4 stack */
 		buf = nano_fifo_get(&rx_queue, TICKS_UNLIMITED);
 
-#if NET_MAC_CONF_STATS
-		byte_count = uip_pkt_buflen(buf);
-#endif
-		if (!NETSTACK_RDC.input(buf)) {
-			NET_DBG("802.15.4 RDC input failed, "
-				"buf %p discarded\n", buf);
-			l2_buf_unref(buf);
-		} else {
-#if NET_MAC_CONF_STATS
-			net_mac_stats.bytes_received += byte_count;
-#endif
-		}
+		/* Then take the frames already waiting, the IP packets they
+		 * carry being passed to the IP stack together. A frame gives
+		 * at most one IP packet.
+		 */
+		do {
+			rx_frame(buf);
+		} while (rx_burst_len < CONFIG_15_4_RX_BURST &&
+			 (buf = nano_fifo_get(&rx_queue, TICKS_NONE)));
+
+		rx_burst_flush();
 
 		net_analyze_stack("802.15.4 RX", rx_fiber_stack,
 				  sizeof(rx_fiber_stack));
@@ -162,11 +197,18 @@ int net_driver_15_4_recv(struct net_buf *buf)
 		}
 	}
 
-	if (net_recv(buf) < 0) {
+	if (ip_buf_len(buf) == 0) {
 		NET_DBG("input to IP stack failed\n");
 		return -EINVAL;
 	}
 
+	/* Called from the RX fiber, which passes the packet on later */
+	if (rx_burst_len == CONFIG_15_4_RX_BURST) {
+		rx_burst_flush();
+	}
+
+	rx_burst[rx_burst_len++] = buf;
+
 	return 0;
 }
 
@@ -0,0 +1,91 @@
+/** @file
+ * @brief Queues of the packets waiting for the RX and TX fibers
+ *
+ * Each queue keeps one FIFO per queueing class of the packets.
+ */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nanokernel.h>
+
+#include <net/ip_buf.h>
+
+#include "net_queue.h"
+
+static const uint8_t bulk_weight[NET_QUEUE_CLASSES] = {
+	[NET_QUEUE_BULK_HIGH] = CONFIG_NET_QUEUE_BULK_HIGH_WEIGHT,
+	[NET_QUEUE_BULK] = 1,
+};
+
+void net_queue_init(struct net_queue *queue)
+{
+	int i;
+
+	for (i = 0; i < NET_QUEUE_CLASSES; i++) {
+		nano_fifo_init(&queue->fifo[i]);
+	}
+
+	nano_sem_init(&queue->sem);
+
+	queue->bulk = NET_QUEUE_BULK_HIGH;
+	queue->credit = bulk_weight[NET_QUEUE_BULK_HIGH];
+}
+
+void net_queue_put(struct net_queue *queue, struct net_buf *buf)
+{
+	uint8_t class = ip_buf_queue_class(buf);
+
+	if (class >= NET_QUEUE_CLASSES) {
+		class = NET_QUEUE_BULK;
+	}
+
+	nano_fifo_put(&queue->fifo[class], buf);
+}
+
+struct net_buf *net_queue_get(struct net_queue *queue)
+{
+	struct net_buf *buf;
+	int i;
+
+	/* Control traffic is not held up by bulk data */
+	buf = nano_fifo_get(&queue->fifo[NET_QUEUE_CONTROL], TICKS_NONE);
+	if (buf) {
+		return buf;
+	}
+
+	/* Bulk classes take turns, each sending up to its weight in packets.
+	 * A class with nothing to send loses the rest of its turn.
+	 */
+	for (i = NET_QUEUE_BULK_HIGH; i <= NET_QUEUE_CLASSES; i++) {
+		if (queue->credit) {
+			buf = nano_fifo_get(&queue->fifo[queue->bulk],
+					    TICKS_NONE);
+			if (buf) {
+				queue->credit--;
+				return buf;
+			}
+		}
+
+		if (++queue->bulk == NET_QUEUE_CLASSES) {
+			queue->bulk = NET_QUEUE_BULK_HIGH;
+		}
+
+		queue->credit = bulk_weight[queue->bulk];
+	}
+
+	return NULL;
+}
@@ -0,0 +1,71 @@
+/** @file
+ * @brief Queues of the packets waiting for the RX and TX fibers
+ */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __NET_QUEUE_H
+#define __NET_QUEUE_H
+
+#include <nanokernel.h>
+
+#include <net/ip_buf.h>
+
+/* Packets waiting for the RX or TX fiber, by queueing class */
+struct net_queue {
+	struct nano_fifo fifo[NET_QUEUE_CLASSES];
+
+	/* Given when packets have been added to the FIFOs */
+	struct nano_sem sem;
+
+	/* Bulk class being served, and packets it may still send */
+	uint8_t bulk;
+	uint8_t credit;
+};
+
+/**
+ * @brief Initialize a packet queue.
+ *
+ * @param queue Queue to initialize.
+ */
+void net_queue_init(struct net_queue *queue);
+
+/**
+ * @brief Queue a packet in the FIFO of its class.
+ *
+ * @details The semaphore of the queue is not given, so that several
+ * packets can be queued for a single wakeup.
+ *
+ * @param queue Queue to add the packet to.
+ * @param buf Packet, of the class set by ip_buf_queue_class().
+ */
+void net_queue_put(struct net_queue *queue, struct net_buf *buf);
+
+/**
+ * @brief Take the next packet to handle from a queue.
+ *
+ * @details Control packets come first. The bulk classes then take turns,
+ * the high priority one taking CONFIG_NET_QUEUE_BULK_HIGH_WEIGHT packets
+ * for each packet of the default one.
+ *
+ * @param queue Queue to take the packet from.
+ *
+ * @return Packet, or NULL if the queue is empty.
+ */
+struct net_buf *net_queue_get(struct net_queue *queue);
+
+#endif /* __NET_QUEUE_H */
@@ -337,20 +337,94 @@ void summary_data_printer(void)
 }
 
 
+/**
+ * @brief Process a kernel event message
+ *
+ * @param event_id     Event ID of the message.
+ * @param data         Data of the message.
+ * @param data_length  Size of the data in 32-bit words.
+ *
+ * @return No return value.
+ */
+static void process_event(uint16_t event_id, uint32_t *data,
+			  uint8_t data_length)
+{
+	switch (event_id) {
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+	case KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID:
+		if (data_length != 2) {
+			PRINTF("\x1b[13;1HError in context switch message. "
+				"event_id = %d, Expected %d, received %d\n",
+				event_id, 2, data_length);
+		} else {
+			register_context_switch_data(data[0], data[1]);
+		}
+		break;
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
+	case KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID:
+		if (data_length != 2) {
+			PRINTF("\x1b[13;1HError in interrupt message. "
+				"event_id = %d, Expected %d, received %d\n",
+				event_id, 2, data_length);
+		} else {
+			register_interrupt_event_data(data[0], data[1]);
+		}
+		break;
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
+	case KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID:
+		if (data_length != 3) {
+			PRINTF("\x1b[13;1HError in sleep message. "
+				"event_id = %d, Expected %d, received %d\n",
+				event_id, 3, data_length);
+		} else {
+			register_sleep_event_data(data[0], data[1], data[2]);
+		}
+		break;
+#endif
+#ifdef CONFIG_MICROKERNEL
+	case KERNEL_EVENT_LOGGER_TASK_MON_TASK_STATE_CHANGE_EVENT_ID:
+	case KERNEL_EVENT_LOGGER_TASK_MON_CMD_PACKET_EVENT_ID:
+		if (data_length != 3) {
+			PRINTF("\x1b[13;1HError in task monitor message. "
+				"event_id = %d, Expected 3, received %d\n",
+				event_id, data_length);
+		} else {
+			register_tmon_data(event_id, data[0], data[1], data[2]);
+		}
+		break;
+
+	case KERNEL_EVENT_LOGGER_TASK_MON_KEVENT_EVENT_ID:
+		if (data_length != 2) {
+			PRINTF("\x1b[13;1HError in task monitor message. "
+				"event_id = %d, Expected 2, received %d\n",
+				event_id, data_length);
+		} else {
+			register_tmon_data(event_id, data[0], -1, data[1]);
+		}
+		break;
+#endif
+	default:
+		PRINTF("unrecognized event id %d", event_id);
+	}
+}
+
+
 /**
  * @brief Kernel event data collector fiber
  *
- * @details Collect the kernel event messages and process them depending
- * the kind of event received.
+ * @details Collect the kernel event messages in batches and process them
+ * depending the kind of event received.
  *
  * @return No return value.
  */
 void profiling_data_collector(void)
 {
 	int res;
-	uint32_t data[4];
-	uint8_t dropped_count;
-	uint16_t event_id;
+	int i;
+	uint32_t events[64];
+	uint32_t header;
 
 	/* We register the fiber as collector to avoid this fiber generating a
 	 * context switch event every time it collects the data
@@ -358,83 +432,27 @@ void profiling_data_collector(void)
 	sys_k_event_logger_register_as_collector();
 
 	while (1) {
-		/* collect the data */
-		uint8_t data_length = SIZE32_OF(data);
-
-		res = sys_k_event_logger_get_wait(&event_id, &dropped_count, data,
-					    &data_length);
-		if (res > 0) {
-			/* Register the amount of droppped events occurred */
-			if (dropped_count) {
-				total_dropped_counter += dropped_count;
-			}
-
-			/* process the data */
-			switch (event_id) {
-#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
-			case KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID:
-				if (data_length != 2) {
-					PRINTF("\x1b[13;1HError in context switch message. "
-						"event_id = %d, Expected %d, received %d\n",
-						event_id, 2, data_length);
-				} else {
-					register_context_switch_data(data[0], data[1]);
-				}
-				break;
-#endif
-#ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
-			case KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID:
-				if (data_length != 2) {
-					PRINTF("\x1b[13;1HError in interrupt message. "
-						"event_id = %d, Expected %d, received %d\n",
-						event_id, 2, data_length);
-				} else {
-					register_interrupt_event_data(data[0], data[1]);
-				}
-				break;
-#endif
-#ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
-			case KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID:
-				if (data_length != 3) {
-					PRINTF("\x1b[13;1HError in sleep message. "
-						"event_id = %d, Expected %d, received %d\n",
-						event_id, 3, data_length);
-				} else {
-					register_sleep_event_data(data[0], data[1], data[2]);
-				}
-				break;
-#endif
-#ifdef CONFIG_MICROKERNEL
-			case KERNEL_EVENT_LOGGER_TASK_MON_TASK_STATE_CHANGE_EVENT_ID:
-			case KERNEL_EVENT_LOGGER_TASK_MON_CMD_PACKET_EVENT_ID:
-				if (data_length != 3) {
-					PRINTF("\x1b[13;1HError in task monitor message. "
-						"event_id = %d, Expected 3, received %d\n",
-						event_id, data_length);
-				} else {
-					register_tmon_data(event_id, data[0], data[1], data[2]);
-				}
-				break;
-
-			case KERNEL_EVENT_LOGGER_TASK_MON_KEVENT_EVENT_ID:
-				if (data_length != 2) {
-					PRINTF("\x1b[13;1HError in task monitor message. "
-						"event_id = %d, Expected 2, received %d\n",
-						event_id, data_length);
-				} else {
-					register_tmon_data(event_id, data[0], -1, data[1]);
-				}
-				break;
-#endif
-			default:
-				PRINTF("unrecognized event id %d", event_id);
-			}
-		} else {
+		/* collect all the available data with a single copy */
+		res = sys_k_event_logger_drain_wait(events, ARRAY_SIZE(events));
+		if (res < 0) {
 			/* This error should never happen */
 			if (res == -EMSGSIZE) {
 				PRINTF("FATAL ERROR. The buffer provided to collect the "
 					"profiling events is too small\n");
 			}
+			continue;
+		}
+
+		for (i = 0; i < res; i += EVENT_HEADER_SIZE +
+			     EVENT_HEADER_LENGTH(events[i])) {
+			header = events[i];
+
+			/* Register the amount of droppped events occurred */
+			total_dropped_counter += EVENT_HEADER_DROPPED(header);
+
+			process_event(EVENT_HEADER_ID(header),
+				      &events[i + EVENT_HEADER_SIZE],
+				      EVENT_HEADER_LENGTH(header));
 		}
 	}
 }
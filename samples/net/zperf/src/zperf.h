@@ -26,6 +26,7 @@
 #define CMD_STR_UDP_DOWNLOAD "udp.download"
 #define CMD_STR_TCP_UPLOAD "tcp.upload"
 #define CMD_STR_TCP_DOWNLOAD "tcp.download"
+#define CMD_STR_CHKSUM "chksum"
 
 typedef struct zperf_results {
 	uint32_t nb_packets_sent;
@@ -40,6 +41,14 @@ typedef struct zperf_results {
 	uint32_t nb_packets_errors;
 } zperf_results;
 
+typedef struct zperf_chksum_results {
+	uint32_t nb_packets;
+	uint32_t packet_size;
+	uint32_t bytewise_time_in_us;
+	uint32_t word_time_in_us;
+	uint32_t update_time_in_us;
+} zperf_chksum_results;
+
 typedef void (*zperf_callback)(int status, zperf_results*);
 
 #define IPV4_STR_LEN_MAX 15
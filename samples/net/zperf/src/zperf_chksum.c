@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <misc/printk.h>
+#include <net/ip_buf.h>
+#include <zephyr.h>
+
+#include <contiki/ip/uip.h>
+
+#include "zperf.h"
+#include "zperf_internal.h"
+
+#define TAG CMD_STR_CHKSUM" "
+
+/* Offset of the rewritten 16-bit field, e.g. a port number */
+#define FIELD_OFFSET 2
+
+static uint8_t data[PACKET_SIZE_MAX];
+
+/* 16 bits per iteration, as the IP stack used to do */
+static uint16_t chksum_bytewise(uint16_t sum, const uint8_t *buf,
+		uint16_t len)
+{
+	const uint8_t *last_byte = buf + len - 1;
+	uint16_t t;
+
+	while (buf < last_byte) {
+		t = (buf[0] << 8) + buf[1];
+		sum += t;
+		if (sum < t) {
+			sum++;
+		}
+		buf += 2;
+	}
+
+	if (buf == last_byte) {
+		t = buf[0] << 8;
+		sum += t;
+		if (sum < t) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+void zperf_chksum(unsigned int packet_size, unsigned int count,
+		zperf_chksum_results *results)
+{
+	volatile uint16_t sum = 0;
+	uint16_t chksum, field;
+	uint32_t start_time;
+	unsigned int i;
+
+	if (packet_size > PACKET_SIZE_MAX) {
+		printk(TAG "WARNING! packet size too large! max size: %u\n",
+				PACKET_SIZE_MAX);
+		packet_size = PACKET_SIZE_MAX;
+	} else if (packet_size < FIELD_OFFSET + sizeof(field)) {
+		packet_size = FIELD_OFFSET + sizeof(field);
+	}
+
+	for (i = 0; i < packet_size; i++) {
+		data[i] = i * 7 + 1;
+	}
+
+	results->packet_size = packet_size;
+	results->nb_packets = count;
+
+	start_time = sys_cycle_get_32();
+	for (i = 0; i < count; i++) {
+		sum += chksum_bytewise(0, data, packet_size);
+	}
+	results->bytewise_time_in_us = HW_CYCLES_TO_USEC(
+			time_delta(start_time, sys_cycle_get_32()));
+
+	start_time = sys_cycle_get_32();
+	for (i = 0; i < count; i++) {
+		sum += uip_chksum_add(0, data, packet_size);
+	}
+	results->word_time_in_us = HW_CYCLES_TO_USEC(
+			time_delta(start_time, sys_cycle_get_32()));
+
+	/* Rewrite one header field per packet, and keep the checksum valid */
+	chksum = ~uip_chksum_add(0, data, packet_size);
+	start_time = sys_cycle_get_32();
+	for (i = 0; i < count; i++) {
+		field = (data[FIELD_OFFSET] << 8) | data[FIELD_OFFSET + 1];
+		data[FIELD_OFFSET] = i >> 8;
+		data[FIELD_OFFSET + 1] = i;
+		chksum = uip_chksum_update16(chksum, field, i & 0xffff);
+	}
+	results->update_time_in_us = HW_CYCLES_TO_USEC(
+			time_delta(start_time, sys_cycle_get_32()));
+
+	if ((uint16_t)~chksum != uip_chksum_add(0, data, packet_size)) {
+		printk(TAG "ERROR! Updated checksum 0x%04x is not valid\n",
+				chksum);
+	}
+}
@@ -95,5 +95,7 @@ extern void zperf_tcp_upload(struct net_context *net_context,
 		unsigned int duration_in_ms, unsigned int packet_size,
 		zperf_results *results);
 #endif
+extern void zperf_chksum(unsigned int packet_size, unsigned int count,
+		zperf_chksum_results *results);
 extern void connect_ap(char *ssid);
 #endif /* __ZPERF_INTERNAL_H */
@@ -420,6 +420,58 @@ static int shell_cmd_tcp_download(int argc, char *argv[])
 	return 0;
 }
 
+static uint32_t chksum_rate_in_kbps(zperf_chksum_results *results,
+		uint32_t time_in_us)
+{
+	if (time_in_us == 0) {
+		return 0;
+	}
+
+	return (uint32_t) (((uint64_t) results->nb_packets
+			* (uint64_t) results->packet_size * (uint64_t) 8
+			* (uint64_t) USEC_PER_SEC)
+			/ ((uint64_t) time_in_us * 1024));
+}
+
+static int shell_cmd_chksum(int argc, char *argv[])
+{
+	zperf_chksum_results results = { 0 };
+	unsigned int packet_size, count;
+
+	if (argc > 1)
+		packet_size = parse_number(argv[1], K, K_UNIT);
+	else
+		packet_size = PACKET_SIZE_MAX;
+
+	if (argc > 2)
+		count = strtoul(argv[2], NULL, 10);
+	else
+		count = 1000;
+
+	zperf_chksum(packet_size, count, &results);
+
+	printk("[%s] packet size:\t%u bytes\n", CMD_STR_CHKSUM,
+			results.packet_size);
+	printk("[%s] nb packets:\t%u\n", CMD_STR_CHKSUM, results.nb_packets);
+
+	printk("[%s] byte-wise:\t", CMD_STR_CHKSUM);
+	print_number(chksum_rate_in_kbps(&results,
+			results.bytewise_time_in_us), KBPS, KBPS_UNIT);
+	printk("\n");
+
+	printk("[%s] word-wise:\t", CMD_STR_CHKSUM);
+	print_number(chksum_rate_in_kbps(&results,
+			results.word_time_in_us), KBPS, KBPS_UNIT);
+	printk("\n");
+
+	printk("[%s] incremental:\t", CMD_STR_CHKSUM);
+	print_number(chksum_rate_in_kbps(&results,
+			results.update_time_in_us), KBPS, KBPS_UNIT);
+	printk("\n");
+
+	return 0;
+}
+
 static int shell_cmd_version(int argc, char *argv[])
 {
 	printk("\nzperf [%s]: %s config: %s\n", CMD_STR_VERSION, VERSION, CONFIG);
@@ -438,6 +490,7 @@ struct shell_cmd commands[] = {
 		{ CMD_STR_VERSION, shell_cmd_version },
 		{ CMD_STR_UDP_UPLOAD, shell_cmd_upload },
 		{ CMD_STR_UDP_DOWNLOAD, shell_cmd_udp_download },
+		{ CMD_STR_CHKSUM, shell_cmd_chksum },
 #ifdef CONFIG_NETWORKING_WITH_TCP
 		{ CMD_STR_TCP_UPLOAD, shell_cmd_upload },
 		{ CMD_STR_TCP_DOWNLOAD, shell_cmd_tcp_download },
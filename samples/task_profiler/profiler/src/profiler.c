@@ -31,7 +31,7 @@
 #endif
 
 #define PROF_HEADER_SIZE_U8 4
-#define PROF_MAX_EVENT_SIZE_U32 4
+#define PROF_DRAIN_SIZE_U32 64
 #define PROFILER_SLEEP_MS 5000
 #define PROFILER_SLEEPTICKS (PROFILER_SLEEP_MS * sys_clock_ticks_per_sec / 1000)
 /*
@@ -252,12 +252,12 @@ void prof_flush(void)
 	irq_unlock(key);
 #else
 	int res;
-	uint32_t data[PROF_MAX_EVENT_SIZE_U32];
-	uint8_t data_length = SIZE32_OF(data);
-	uint8_t dropped_count;
-	uint16_t event_id;
+	uint32_t events[PROF_DRAIN_SIZE_U32];
+	uint32_t header;
+	uint8_t data_length;
 	static int dropped;
 	int key;
+	int j;
 
 	if (!prof_initialized)
 		prof_init();
@@ -283,15 +283,8 @@ void prof_flush(void)
 #endif
 
 	while (1) {
-		event_id = 0;
-		data_length = SIZE32_OF(data);
-		dropped_count = 0;
-
-		/* collect the data */
-		res = sys_k_event_logger_get(&event_id, &dropped_count, data,
-					    &data_length);
-
-		dropped += dropped_count;
+		/* collect as much data as possible with a single copy */
+		res = sys_k_event_logger_drain(events, ARRAY_SIZE(events));
 
 		if (res == 0) {
 			if (dropped > 0) {
@@ -318,24 +311,31 @@ void prof_flush(void)
 			return;
 		} else if (res < 0) {
 			PRINT("#Error: %d\n", res);
-		} else {
-			if (event_id != 0) {
-				key = irq_lock();
-				/*PRINT("Event %x(%x): %x %x\n", event_id, data_length,
-				 *				 data[0], data[1]);
-				 */
-				out(DLE);
-				/* NOTE: event ID is 16-bit but we only send 8-bits LSB */
-				out(event_id & 0xff);
-				out(data_length);
-				for (i = 0; i < data_length; i++) {
-					out((data[i] & 0x000000ff));
-					out(((data[i] & 0x0000ff00) >> 8));
-					out(((data[i] & 0x00ff0000) >> 16));
-					out(((data[i] & 0xff000000) >> 24));
-				}
-				irq_unlock(key);
+			return;
+		}
+
+		for (i = 0; i < res; i += EVENT_HEADER_SIZE + data_length) {
+			header = events[i];
+			data_length = EVENT_HEADER_LENGTH(header);
+			dropped += EVENT_HEADER_DROPPED(header);
+
+			if (EVENT_HEADER_ID(header) == 0) {
+				continue;
 			}
+
+			key = irq_lock();
+			out(DLE);
+			/* NOTE: event ID is 16-bit but we only send 8-bits LSB */
+			out(EVENT_HEADER_ID(header) & 0xff);
+			out(data_length);
+			for (j = i + EVENT_HEADER_SIZE;
+			     j < i + EVENT_HEADER_SIZE + data_length; j++) {
+				out((events[j] & 0x000000ff));
+				out(((events[j] & 0x0000ff00) >> 8));
+				out(((events[j] & 0x00ff0000) >> 16));
+				out(((events[j] & 0xff000000) >> 24));
+			}
+			irq_unlock(key);
 		}
 	}
 #endif /* ! PROF_UART_TESTMODE */
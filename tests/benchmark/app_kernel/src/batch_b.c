@@ -0,0 +1,88 @@
+/* batch_b.c */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "master.h"
+
+#ifdef BATCH_BENCH
+
+static uint32_t batch_cmds[NR_OF_BATCH_CMDS];
+
+static const int batch_sizes[] = { 1, 4, 16, NR_OF_BATCH_CMDS };
+
+/**
+ *
+ * @brief Command batch test
+ *
+ * Submits batches of event signals or semaphore gives and displays the
+ * average time per command, including building and committing the batch.
+ *
+ * @return N/A
+ *
+ * @param size   Number of commands per batch.
+ * @param sema   Give semaphores if non-zero, signal events otherwise.
+ */
+static void batch_run_test(int size, int sema)
+{
+	struct k_cmd_batch batch;
+	uint32_t et; /* elapsed time */
+	int i, j;
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_BATCH_RUNS; i++) {
+		task_cmd_batch_begin(&batch, batch_cmds, size);
+		for (j = 0; j < size; j++) {
+			if (sema) {
+				task_cmd_batch_sem_give(&batch, SEM0);
+			} else {
+				task_cmd_batch_event_send(&batch, TEST_EVENT);
+			}
+		}
+		task_cmd_batch_commit(&batch);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	snprintf(Msg, MAX_MSG, "%s, batch of %d",
+			 sema ? "signal semaphore" : "signal event", size);
+	PRINT_F(output_file, FORMAT, Msg,
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_BATCH_RUNS * size));
+}
+
+/**
+ *
+ * @brief Command batch benchmark
+ *
+ * @return N/A
+ */
+void batch_test(void)
+{
+	int i;
+
+	PRINT_STRING(dashline, output_file);
+	for (i = 0; i < ARRAY_SIZE(batch_sizes); i++) {
+		batch_run_test(batch_sizes[i], 0);
+	}
+	for (i = 0; i < ARRAY_SIZE(batch_sizes); i++) {
+		batch_run_test(batch_sizes[i], 1);
+	}
+
+	task_event_recv(TEST_EVENT, TICKS_NONE);
+	task_sem_reset(SEM0);
+}
+
+#endif /* BATCH_BENCH */
@@ -49,4 +49,10 @@
 /* flag for performing the Event benchmark */
 #define EVENT_BENCH
 
+/* flag for performing the Timer benchmark */
+#define TIMER_BENCH
+
+/* flag for performing the Command Batch benchmark */
+#define BATCH_BENCH
+
 #endif /* _CONFIG_H */
@@ -36,6 +36,15 @@ static struct k_msg Message;
 	     "| message overhead:  %10.3f     usec/packet                   "\
 	     "            |\n", EmptyMsgPutTime / 1000.0)
 
+#define PRINT_BLOCK_HEADER()                                                 \
+	PRINT_STRING                                                             \
+	   ("|   size(B) | copy (usec) | zero-copy (usec)|  copy MB/sec  |"   \
+	    " zero-copy MB/sec|\n", output_file);
+#define PRINT_BLOCK_RESULT()                                                 \
+	PRINT_F(output_file, "|%11lu|%13.3f|%17.3f|%15f|%17f|\n", putsize,     \
+	     copytime / 1000.0, handofftime / 1000.0,                           \
+	     (1000.0 * putsize) / copytime, (1000.0 * putsize) / handofftime)
+
 #define PRINT_XFER_RATE()                                                     \
 	double NettoTransferRate;                                                 \
 	NettoTransferRate = 1000.0 * (putsize >> 1) / (puttime - EmptyMsgPutTime);\
@@ -58,6 +67,16 @@ static struct k_msg Message;
 	     "| message overhead:  %10u     nsec/packet                     "\
 	     "          |\n", EmptyMsgPutTime)
 
+#define PRINT_BLOCK_HEADER()                                                 \
+	PRINT_STRING                                                             \
+	   ("|   size(B) | copy (nsec) | zero-copy (nsec)|  copy KB/sec  |"   \
+	    " zero-copy KB/sec|\n", output_file);
+#define PRINT_BLOCK_RESULT()                                                 \
+	PRINT_F(output_file, "|%11lu|%13lu|%17lu|%15lu|%17lu|\n", putsize,     \
+	     copytime, handofftime,                                             \
+	     (uint32_t)((1000000 * (uint64_t)putsize) / copytime),              \
+	     (uint32_t)((1000000 * (uint64_t)putsize) / handofftime))
+
 #define PRINT_XFER_RATE()                                                    \
 	PRINT_F(output_file, "| raw transfer rate:     %10lu KB/sec (without" \
 	     " overhead)                 |\n",                               \
@@ -71,6 +90,8 @@ static struct k_msg Message;
  * Function prototypes.
  */
 void mailbox_put(uint32_t size, int count, uint32_t *time);
+void mailbox_copy_put(void *data, uint32_t size, int count, uint32_t *time);
+void mailbox_handoff_put(uint32_t size, int count, uint32_t *time);
 
 /*
  * Function declarations.
@@ -88,6 +109,9 @@ void mailbox_test(void)
 	uint32_t puttime;
 	int putcount;
 	unsigned int EmptyMsgPutTime;
+	uint32_t copytime;
+	uint32_t handofftime;
+	struct k_block block;
 	GetInfo getinfo;
 
 	PRINT_STRING(dashline, output_file);
@@ -123,6 +147,30 @@ void mailbox_test(void)
 	PRINT_STRING(dashline, output_file);
 	PRINT_OVERHEAD();
 	PRINT_XFER_RATE();
+
+	PRINT_STRING(dashline, output_file);
+	PRINT_STRING("| Send memory pool block data to waiting high priority "
+				 "task: copied into the  |\n", output_file);
+	PRINT_STRING("| receiver's buffer, or block handed over without "
+				 "copying (zero-copy)         |\n", output_file);
+	PRINT_STRING(dashline, output_file);
+	PRINT_BLOCK_HEADER();
+	PRINT_STRING(dashline, output_file);
+
+	task_mem_pool_alloc(&block, MBOXPOOL, MESSAGE_SIZE_BLOCK,
+			    TICKS_UNLIMITED);
+	for (putsize = MESSAGE_SIZE_BLOCK_MIN; putsize <= MESSAGE_SIZE_BLOCK;
+	     putsize <<= 1) {
+		mailbox_copy_put(block.pointer_to_data, putsize, putcount,
+				 &copytime);
+		/* waiting for ack */
+		task_fifo_get(MB_COMM, &getinfo, TICKS_UNLIMITED);
+		mailbox_handoff_put(putsize, putcount, &handofftime);
+		/* waiting for ack */
+		task_fifo_get(MB_COMM, &getinfo, TICKS_UNLIMITED);
+		PRINT_BLOCK_RESULT();
+	}
+	task_mem_pool_free(&block);
 }
 
 
@@ -156,4 +204,72 @@ void mailbox_put(uint32_t size, int count, uint32_t *time)
 	check_result();
 }
 
+/**
+ *
+ * @brief Send data chunks held in a buffer through the mailbox
+ *
+ * The receiver gets a copy of the data.
+ *
+ * @param data    The buffer holding the data chunk.
+ * @param size    The size of the data chunk.
+ * @param count   Number of data chunks.
+ * @param time    The total time.
+ *
+ * @return N/A
+ */
+void mailbox_copy_put(void *data, uint32_t size, int count, uint32_t *time)
+{
+	int i;
+	unsigned int t;
+
+	Message.rx_task = ANYTASK;
+	Message.tx_data = data;
+
+	/* first sync with the receiver */
+	task_sem_give(SEM0);
+	t = BENCH_START();
+	for (i = 0; i < count; i++) {
+		Message.size = size;
+		task_mbox_put(MAILB1, 1, &Message, TICKS_UNLIMITED);
+	}
+	t = TIME_STAMP_DELTA_GET(t);
+	*time = SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, count);
+	check_result();
+}
+
+
+/**
+ *
+ * @brief Hand memory pool blocks over through the mailbox
+ *
+ * Each data chunk is placed in a newly allocated block, which the receiver
+ * takes over and frees, so that the time includes the block allocation.
+ *
+ * @param size    The size of the data chunk.
+ * @param count   Number of data chunks.
+ * @param time    The total time.
+ *
+ * @return N/A
+ */
+void mailbox_handoff_put(uint32_t size, int count, uint32_t *time)
+{
+	int i;
+	unsigned int t;
+
+	Message.rx_task = ANYTASK;
+
+	/* first sync with the receiver */
+	task_sem_give(SEM0);
+	t = BENCH_START();
+	for (i = 0; i < count; i++) {
+		task_mem_pool_alloc(&Message.tx_block, MBOXPOOL, size,
+				    TICKS_UNLIMITED);
+		Message.size = size;
+		task_mbox_handoff_put(MAILB1, 1, &Message, TICKS_UNLIMITED);
+	}
+	t = TIME_STAMP_DELTA_GET(t);
+	*time = SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, count);
+	check_result();
+}
+
 #endif /* MAILBOX_BENCH */
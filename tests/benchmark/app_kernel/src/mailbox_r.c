@@ -24,7 +24,10 @@
 /*
  * Function prototypes.
  */
-int mailbox_get(kmbox_t mailbox,int size,int count,unsigned int* time);
+int mailbox_get(kmbox_t mailbox, void *data, int size, int count,
+		unsigned int *time);
+int mailbox_handoff_get(kmbox_t mailbox, int size, int count,
+			unsigned int *time);
 
 /*
  * Function declarations.
@@ -43,12 +46,13 @@ void mailrecvtask(void)
 	int getsize;
 	unsigned int gettime;
 	int getcount;
+	struct k_block block;
 	GetInfo getinfo;
 
 	getcount = NR_OF_MBOX_RUNS;
 
 	getsize = 0;
-	mailbox_get(MAILB1, getsize, getcount, &gettime);
+	mailbox_get(MAILB1, data_recv, getsize, getcount, &gettime);
 	getinfo.time = gettime;
 	getinfo.size = getsize;
 	getinfo.count = getcount;
@@ -56,13 +60,34 @@ void mailrecvtask(void)
 	task_fifo_put(MB_COMM, &getinfo, TICKS_UNLIMITED);
 
 	for (getsize = 8; getsize <= MESSAGE_SIZE; getsize <<= 1) {
-		mailbox_get(MAILB1, getsize, getcount, &gettime);
+		mailbox_get(MAILB1, data_recv, getsize, getcount, &gettime);
 		getinfo.time = gettime;
 		getinfo.size = getsize;
 		getinfo.count = getcount;
 		/* acknowledge to master */
 		task_fifo_put(MB_COMM, &getinfo, TICKS_UNLIMITED);
 	}
+
+	task_mem_pool_alloc(&block, MBOXPOOL, MESSAGE_SIZE_BLOCK,
+			    TICKS_UNLIMITED);
+	for (getsize = MESSAGE_SIZE_BLOCK_MIN; getsize <= MESSAGE_SIZE_BLOCK;
+	     getsize <<= 1) {
+		mailbox_get(MAILB1, block.pointer_to_data, getsize, getcount,
+			    &gettime);
+		getinfo.time = gettime;
+		getinfo.size = getsize;
+		getinfo.count = getcount;
+		/* acknowledge to master */
+		task_fifo_put(MB_COMM, &getinfo, TICKS_UNLIMITED);
+
+		mailbox_handoff_get(MAILB1, getsize, getcount, &gettime);
+		getinfo.time = gettime;
+		getinfo.size = getsize;
+		getinfo.count = getcount;
+		/* acknowledge to master */
+		task_fifo_put(MB_COMM, &getinfo, TICKS_UNLIMITED);
+	}
+	task_mem_pool_free(&block);
 }
 
 
@@ -73,18 +98,20 @@ void mailrecvtask(void)
  * @return 0
  *
  * @param mailbox   The mailbox to read data from.
+ * @param data      Buffer receiving the data.
  * @param size      Size of each data portion.
  * @param count     Number of data portions.
  * @param time      Resulting time.
  */
-int mailbox_get(kmbox_t mailbox, int size, int count, unsigned int* time)
+int mailbox_get(kmbox_t mailbox, void *data, int size, int count,
+		unsigned int *time)
 {
 	int i;
 	unsigned int t;
 	struct k_msg Message;
 
 	Message.tx_task = ANYTASK;
-	Message.rx_data = data_recv;
+	Message.rx_data = data;
 	Message.size = size;
 
 	/* sync with the sender */
@@ -102,4 +129,46 @@ int mailbox_get(kmbox_t mailbox, int size, int count, unsigned int* time)
 	return 0;
 }
 
+
+/**
+ *
+ * @brief Take over memory pool blocks from the specified mailbox
+ *
+ * Each block received is freed right away.
+ *
+ * @return 0
+ *
+ * @param mailbox   The mailbox to read data from.
+ * @param size      Size of each data portion.
+ * @param count     Number of data portions.
+ * @param time      Resulting time.
+ */
+int mailbox_handoff_get(kmbox_t mailbox, int size, int count,
+			unsigned int *time)
+{
+	int i;
+	unsigned int t;
+	struct k_msg Message;
+	struct k_block block;
+
+	Message.tx_task = ANYTASK;
+
+	/* sync with the sender */
+	task_sem_take(SEM0, TICKS_UNLIMITED);
+	t = BENCH_START();
+	for (i = 0; i < count; i++) {
+		Message.size = size;
+		task_mbox_handoff_get(mailbox, &Message, &block, MBOXPOOL,
+				      TICKS_UNLIMITED);
+		task_mem_pool_free(&block);
+	}
+
+	t = TIME_STAMP_DELTA_GET(t);
+	*time = SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, count);
+	if (bench_test_end() < 0) {
+		PRINT_OVERFLOW_ERROR();
+	}
+	return 0;
+}
+
 #endif /* MAILBOX_BENCH */
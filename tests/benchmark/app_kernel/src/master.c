@@ -122,6 +122,8 @@ void BenchTask(void)
 		memorymap_test();
 		mempool_test();
 		event_test();
+		timer_test();
+		batch_test();
 		mailbox_test();
 		pipe_test();
 		PRINT_STRING("|         END OF TESTS                     "
@@ -51,10 +51,15 @@
 #define NR_OF_SEMA_RUNS 500
 #define NR_OF_MUTEX_RUNS 1000
 #define NR_OF_POOL_RUNS 1000
+#define NR_OF_FRAG_BLOCKS 32
 #define NR_OF_MAP_RUNS 1000
 #define NR_OF_EVENT_RUNS  1000
 #define NR_OF_MBOX_RUNS 128
 #define NR_OF_PIPE_RUNS 256
+#define NR_OF_TIMER_RUNS 1000
+#define NR_OF_BENCH_TIMERS 256
+#define NR_OF_BATCH_RUNS 100
+#define NR_OF_BATCH_CMDS 64
 #define SEMA_WAIT_TIME (5 * sys_clock_ticks_per_sec)
 /* global data */
 extern char Msg[MAX_MSG];
@@ -124,6 +129,18 @@ extern void event_test(void);
 #define event_test dummy_test
 #endif
 
+#ifdef TIMER_BENCH
+extern void timer_test(void);
+#else
+#define timer_test dummy_test
+#endif
+
+#ifdef BATCH_BENCH
+extern void batch_test(void);
+#else
+#define batch_test dummy_test
+#endif
+
 /* PRINT_STRING
  * Macro to print an ASCII NULL terminated string. fprintf is used
  * so output can go to console.
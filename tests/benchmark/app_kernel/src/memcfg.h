@@ -22,4 +22,8 @@
 #define MESSAGE_SIZE        8192
 #define MESSAGE_SIZE_PIPE   4096	/* must be smaller than MESSAGE_SIZE */
 
+/* message sizes of the mailbox block transfer test */
+#define MESSAGE_SIZE_BLOCK_MIN 1024
+#define MESSAGE_SIZE_BLOCK     65536
+
 #endif
@@ -20,6 +20,96 @@
 
 #ifdef MEMPOOL_BENCH
 
+/* number of largest blocks of FRAGPOOL, as defined in prj.mdef */
+#define FRAGPOOL_MAX_BLOCKS 4
+#define FRAGPOOL_MAX_SIZE 4096
+
+static struct k_block frag_blocks[NR_OF_FRAG_BLOCKS];
+
+/**
+ *
+ * @brief Memory pool fragmentation test
+ *
+ * Measures the allocation of the smallest block of a pool whose blocks are
+ * all merged, which splits a largest block down to the smallest size and
+ * merges it back when freed. Then keeps a set of blocks of mixed sizes
+ * allocated, replacing one of them at each run, and checks that all largest
+ * blocks are available again once everything has been freed.
+ *
+ * @return N/A
+ */
+static void mempool_frag_test(void)
+{
+	uint32_t et; /* elapsed time */
+	uint32_t seed = 1;
+	int failures = 0;
+	int available = 0;
+	int i, j;
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_POOL_RUNS; i++) {
+		task_mem_pool_alloc(&frag_blocks[0], FRAGPOOL, 16,
+				    TICKS_UNLIMITED);
+		task_mem_pool_free(&frag_blocks[0]);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	PRINT_F(output_file, FORMAT,
+		"alloc and dealloc smallest block split from largest",
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_POOL_RUNS)));
+
+	for (i = 0; i < NR_OF_FRAG_BLOCKS; i++) {
+		frag_blocks[i].address_in_pool = NULL;
+	}
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_POOL_RUNS; i++) {
+		j = i % NR_OF_FRAG_BLOCKS;
+		if (frag_blocks[j].address_in_pool != NULL) {
+			task_mem_pool_free(&frag_blocks[j]);
+		}
+
+		/* request sizes of 16 up to 1024 bytes */
+		seed = seed * 1103515245 + 12345;
+		if (task_mem_pool_alloc(&frag_blocks[j], FRAGPOOL,
+					16 << (2 * ((seed >> 16) & 3)),
+					TICKS_NONE) != RC_OK) {
+			frag_blocks[j].address_in_pool = NULL;
+			failures++;
+		}
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	for (i = 0; i < NR_OF_FRAG_BLOCKS; i++) {
+		if (frag_blocks[i].address_in_pool != NULL) {
+			task_mem_pool_free(&frag_blocks[i]);
+		}
+	}
+
+	PRINT_F(output_file, FORMAT,
+		"average alloc and dealloc mixed size memory pool blocks",
+		SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_POOL_RUNS)));
+	PRINT_F(output_file, FORMAT,
+		"failed mixed size allocations", (unsigned long)failures);
+
+	for (i = 0; i < FRAGPOOL_MAX_BLOCKS; i++) {
+		if (task_mem_pool_alloc(&frag_blocks[i], FRAGPOOL,
+					FRAGPOOL_MAX_SIZE,
+					TICKS_NONE) == RC_OK) {
+			available++;
+		}
+	}
+	for (i = 0; i < available; i++) {
+		task_mem_pool_free(&frag_blocks[i]);
+	}
+
+	PRINT_F(output_file, FORMAT,
+		"largest blocks available after mixed size allocations",
+		(unsigned long)available);
+}
+
 /**
  *
  * @brief Memory pool get/free test
@@ -44,6 +134,8 @@ void mempool_test(void)
 	PRINT_F(output_file, FORMAT,
 			"average alloc and dealloc memory pool block",
 			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, (2 * NR_OF_POOL_RUNS)));
+
+	mempool_frag_test();
 }
 
 #endif /* MEMPOOL_BENCH */
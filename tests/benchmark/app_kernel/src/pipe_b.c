@@ -83,11 +83,37 @@
 	     (uint32_t)((1000000 * (uint64_t)putsize) / puttime[2]));
 #endif /* FLOAT */
 
+#ifdef FLOAT
+#define PRINT_IN_PLACE_HEADER()                                           \
+	PRINT_STRING("|   size(B) |   put/get (MB/sec)  |  put_iov (MB/sec)   "\
+		  "|  in place (MB/sec)  |\n", output_file);
+
+#define PRINT_IN_PLACE()                                              \
+	PRINT_F(output_file, "|%11lu|%21.3f|%21.3f|%21.3f|\n", putsize, \
+	     (1000.0 * putsize) / puttime[0],                         \
+	     (1000.0 * putsize) / puttime[1],                         \
+	     (1000.0 * putsize) / puttime[2])
+#else
+#define PRINT_IN_PLACE_HEADER()                                           \
+	PRINT_STRING("|   size(B) |   put/get (KB/sec)  |  put_iov (KB/sec)   "\
+		  "|  in place (KB/sec)  |\n", output_file);
+
+#define PRINT_IN_PLACE()                                              \
+	PRINT_F(output_file, "|%11lu|%21lu|%21lu|%21lu|\n", putsize,    \
+	     (uint32_t)((1000000 * (uint64_t)putsize) / puttime[0]),   \
+	     (uint32_t)((1000000 * (uint64_t)putsize) / puttime[1]),   \
+	     (uint32_t)((1000000 * (uint64_t)putsize) / puttime[2]))
+#endif /* FLOAT */
+
+/* number of segments of the scatter-gather writes */
+#define NR_OF_PIPE_IOV 4
+
 /*
  * Function prototypes.
  */
 int pipeput(kpipe_t pipe, K_PIPE_OPTION
 		 option, int size, int count, uint32_t *time);
+void pipe_in_place_test(void);
 
 /*
  * Function declarations.
@@ -184,6 +210,99 @@ void pipe_test(void)
 		PRINT_STRING(dashline, output_file);
 		task_priority_set(task_id_get(), TaskPrio);
 	}
+
+	pipe_in_place_test();
+}
+
+
+/**
+ *
+ * @brief Write data into a buffered pipe and read it back
+ *
+ * @return N/A
+ *
+ * @param size     Data chunk size.
+ * @param method   0: task_pipe_put() and task_pipe_get(),
+ *                 1: task_pipe_put_iov() and task_pipe_get(),
+ *                 2: task_pipe_put_reserve() and task_pipe_get_peek().
+ * @param time     Resulting time per chunk, in nsec.
+ */
+static void pipe_in_place_run(int size, int method, uint32_t *time)
+{
+	struct k_pipe_iov iov[NR_OF_PIPE_IOV];
+	struct k_pipe_span span;
+	unsigned int t;
+	int sizexferd;
+	int done;
+	int i;
+
+	for (i = 0; i < NR_OF_PIPE_IOV; i++) {
+		iov[i].data = data_bench + i * (size / NR_OF_PIPE_IOV);
+		iov[i].size = size / NR_OF_PIPE_IOV;
+	}
+
+	t = BENCH_START();
+	for (i = 0; i < NR_OF_PIPE_RUNS; i++) {
+		switch (method) {
+		case 0:
+			task_pipe_put(PIPE_BIGBUFF, data_bench, size,
+				      &sizexferd, _ALL_N, TICKS_NONE);
+			task_pipe_get(PIPE_BIGBUFF, data_bench, size,
+				      &sizexferd, _ALL_N, TICKS_NONE);
+			break;
+		case 1:
+			task_pipe_put_iov(PIPE_BIGBUFF, iov, NR_OF_PIPE_IOV,
+					  &sizexferd, _ALL_N, TICKS_NONE);
+			task_pipe_get(PIPE_BIGBUFF, data_bench, size,
+				      &sizexferd, _ALL_N, TICKS_NONE);
+			break;
+		default:
+			/* the data may wrap around the end of the buffer */
+			for (done = 0; done < size; done += span.size) {
+				task_pipe_put_reserve(PIPE_BIGBUFF, &span,
+						      size - done);
+				memcpy(span.data, data_bench + done, span.size);
+				task_pipe_put_commit(PIPE_BIGBUFF, &span);
+			}
+			for (done = 0; done < size; done += span.size) {
+				task_pipe_get_peek(PIPE_BIGBUFF, &span,
+						   size - done);
+				task_pipe_get_consume(PIPE_BIGBUFF, &span);
+			}
+			break;
+		}
+	}
+	t = TIME_STAMP_DELTA_GET(t);
+	*time = SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, NR_OF_PIPE_RUNS);
+	check_result();
+}
+
+
+/**
+ *
+ * @brief Compare copying and in-place access to a pipe buffer
+ *
+ * @return N/A
+ */
+void pipe_in_place_test(void)
+{
+	uint32_t putsize;
+	uint32_t puttime[3];
+	int method;
+
+	PRINT_STRING("| Write data into a buffered pipe and read it"
+		     " back in the same task           |\n", output_file);
+	PRINT_STRING(dashline, output_file);
+	PRINT_IN_PLACE_HEADER();
+	PRINT_STRING(dashline, output_file);
+
+	for (putsize = 8; putsize <= MESSAGE_SIZE_PIPE; putsize <<= 1) {
+		for (method = 0; method < 3; method++) {
+			pipe_in_place_run(putsize, method, &puttime[method]);
+		}
+		PRINT_IN_PLACE();
+	}
+	PRINT_STRING(dashline, output_file);
 }
 
 
@@ -43,6 +43,16 @@ void sema_test(void)
 	PRINT_F(output_file, FORMAT, "signal semaphore",
 			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_SEMA_RUNS));
 
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_SEMA_RUNS; i++) {
+		task_sem_take(SEM0, TICKS_NONE);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	PRINT_F(output_file, FORMAT, "take signalled semaphore",
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_SEMA_RUNS));
+
 	task_sem_reset(SEM1);
 	task_sem_give(STARTRCV);
 
@@ -0,0 +1,157 @@
+/* timer_b.c */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "master.h"
+
+#ifdef TIMER_BENCH
+
+/* duration of the timers that must not expire during a measurement */
+#define TIMER_LONG_TICKS 1000
+
+static ktimer_t bench_timers[NR_OF_BENCH_TIMERS];
+
+static const int timer_counts[] = { 1, 16, 64, NR_OF_BENCH_TIMERS };
+
+/**
+ *
+ * @brief Timer start/stop test with a number of timers already active
+ *
+ * The timer being started expires after all the other active timers, which
+ * is the worst case for a sorted timer list.
+ *
+ * @return N/A
+ *
+ * @param count   Number of active timers, including the one being measured.
+ */
+static void timer_start_stop_test(int count)
+{
+	uint32_t et; /* elapsed time */
+	int i;
+
+	for (i = 0; i < count - 1; i++) {
+		task_timer_start(bench_timers[i], TIMER_LONG_TICKS + i, 0,
+				 TIMERSEM);
+	}
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_TIMER_RUNS; i++) {
+		task_timer_start(bench_timers[count - 1],
+				 TIMER_LONG_TICKS + count, 0, TIMERSEM);
+		task_timer_stop(bench_timers[count - 1]);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+
+	for (i = 0; i < count - 1; i++) {
+		task_timer_stop(bench_timers[i]);
+	}
+	check_result();
+
+	snprintf(Msg, MAX_MSG, "start & stop timer, %d active timer(s)", count);
+	PRINT_F(output_file, FORMAT, Msg,
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_TIMER_RUNS));
+}
+
+/**
+ *
+ * @brief Wait for the next tick
+ *
+ * Returns once the task sees the tick counter change, i.e. after the tick
+ * has been handled.
+ *
+ * @return N/A
+ */
+static void tick_sync(void)
+{
+	int32_t tick = sys_tick_get_32();
+
+	while (sys_tick_get_32() == tick) {
+	}
+}
+
+/**
+ *
+ * @brief Timer expiry test
+ *
+ * Starts a number of timers right after a tick, so that they all expire on
+ * the next one, and waits until each of them has signalled the semaphore.
+ * The same interval is measured with no timer, from a tick until the task
+ * sees the next one, and is removed from the measurement. This leaves the
+ * cost of starting, expiring and signalling each timer, whatever the time
+ * taken to handle a tick and to get back to the task.
+ *
+ * @return N/A
+ *
+ * @param count   Number of timers expiring on the same tick.
+ */
+static void timer_expire_test(int count)
+{
+	uint32_t et; /* elapsed time */
+	uint32_t tick_et; /* elapsed time with no timer */
+	int i;
+
+	tick_sync();
+	tick_et = TIME_STAMP_DELTA_GET(0);
+	tick_sync();
+	tick_et = TIME_STAMP_DELTA_GET(tick_et);
+
+	tick_sync();
+	et = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < count; i++) {
+		task_timer_start(bench_timers[i], 1, 0, TIMERSEM);
+	}
+	for (i = 0; i < count; i++) {
+		task_sem_take(TIMERSEM, TICKS_UNLIMITED);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+
+	et = (et > tick_et) ? (et - tick_et) : 0;
+
+	snprintf(Msg, MAX_MSG, "start & expire timer, %d timer(s) per tick",
+			 count);
+	PRINT_F(output_file, FORMAT, Msg,
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, count));
+}
+
+/**
+ *
+ * @brief Timer scalability test
+ *
+ * @return N/A
+ */
+void timer_test(void)
+{
+	int i;
+
+	for (i = 0; i < NR_OF_BENCH_TIMERS; i++) {
+		bench_timers[i] = task_timer_alloc();
+	}
+
+	PRINT_STRING(dashline, output_file);
+	for (i = 0; i < ARRAY_SIZE(timer_counts); i++) {
+		timer_start_stop_test(timer_counts[i]);
+	}
+	for (i = 0; i < ARRAY_SIZE(timer_counts); i++) {
+		timer_expire_test(timer_counts[i]);
+	}
+
+	for (i = 0; i < NR_OF_BENCH_TIMERS; i++) {
+		task_timer_free(bench_timers[i]);
+	}
+}
+
+#endif /* TIMER_BENCH */
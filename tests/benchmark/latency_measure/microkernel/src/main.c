@@ -55,6 +55,14 @@ void nanoTest(void)
 
 	nanoIntLockUnlock();
 	printDashLine();
+
+#ifdef CONFIG_NANO_TIMERS
+	nanoTimeoutQueue();
+	printDashLine();
+#endif
+
+	nanoSpscFifo();
+	printDashLine();
 }
 
 #ifdef CONFIG_NANOKERNEL
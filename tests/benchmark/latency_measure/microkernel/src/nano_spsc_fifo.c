@@ -0,0 +1,225 @@
+/* nano_spsc_fifo.c - compare passing items from ISR through FIFO and ring */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This file contains the test that compares passing items from an interrupt
+ * handler to a fiber through a nanokernel FIFO, which locks interrupts for
+ * each item, and through a nanokernel SPSC ring, which does not.
+ *
+ * The interrupt handler puts a burst of items, which a fiber then gets; the
+ * average put and get times per item are displayed. Then a fiber waits on
+ * the empty object and the time from the put in the interrupt handler to
+ * the fiber running is measured.
+ */
+
+#include "timestamp.h"
+#include "utils.h"
+
+#include <arch/cpu.h>
+#include <irq_offload.h>
+
+#ifndef STACKSIZE
+#define STACKSIZE 512
+#endif
+
+/* number of items in a burst */
+#define NITEMS 64
+
+/* FIFO items need room for the link to the next item */
+struct item {
+	void *link;
+	uint32_t value;
+};
+
+static struct item items[NITEMS];
+
+static struct nano_fifo testFifo;
+static struct nano_spsc testRing;
+static void *testRingBuf[NITEMS];
+
+static char __stack fiberStack[STACKSIZE];
+
+static uint32_t timestamp;
+
+/**
+ *
+ * @brief Put a burst of items into the FIFO
+ *
+ * @return N/A
+ */
+static void fifoPutIsr(void *unused)
+{
+	int i;
+
+	ARG_UNUSED(unused);
+
+	timestamp = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < NITEMS; i++) {
+		nano_isr_fifo_put(&testFifo, &items[i]);
+	}
+	timestamp = TIME_STAMP_DELTA_GET(timestamp);
+}
+
+/**
+ *
+ * @brief Put a burst of items into the ring
+ *
+ * @return N/A
+ */
+static void ringPutIsr(void *unused)
+{
+	int i;
+
+	ARG_UNUSED(unused);
+
+	timestamp = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < NITEMS; i++) {
+		nano_isr_spsc_put(&testRing, &items[i]);
+	}
+	timestamp = TIME_STAMP_DELTA_GET(timestamp);
+}
+
+/**
+ *
+ * @brief Put a single item into the FIFO a fiber is waiting on
+ *
+ * @return N/A
+ */
+static void fifoWakeIsr(void *unused)
+{
+	ARG_UNUSED(unused);
+
+	timestamp = TIME_STAMP_DELTA_GET(0);
+	nano_isr_fifo_put(&testFifo, &items[0]);
+}
+
+/**
+ *
+ * @brief Put a single item into the ring a fiber is waiting on
+ *
+ * @return N/A
+ */
+static void ringWakeIsr(void *unused)
+{
+	ARG_UNUSED(unused);
+
+	timestamp = TIME_STAMP_DELTA_GET(0);
+	nano_isr_spsc_put(&testRing, &items[0]);
+}
+
+/**
+ *
+ * @brief Get a burst of items from the FIFO, or the ring
+ *
+ * @param useRing  Non-zero to use the ring.
+ * @param unused   Not used.
+ *
+ * @return N/A
+ */
+static void fiberGetBurst(int useRing, int unused)
+{
+	int i;
+
+	ARG_UNUSED(unused);
+
+	timestamp = TIME_STAMP_DELTA_GET(0);
+	for (i = 0; i < NITEMS; i++) {
+		if (useRing) {
+			nano_fiber_spsc_get(&testRing, TICKS_NONE);
+		} else {
+			nano_fiber_fifo_get(&testFifo, TICKS_NONE);
+		}
+	}
+	timestamp = TIME_STAMP_DELTA_GET(timestamp);
+}
+
+/**
+ *
+ * @brief Wait on the FIFO, or the ring, and measure the time to wake up
+ *
+ * @param useRing  Non-zero to use the ring.
+ * @param unused   Not used.
+ *
+ * @return N/A
+ */
+static void fiberWaiter(int useRing, int unused)
+{
+	ARG_UNUSED(unused);
+
+	if (useRing) {
+		nano_fiber_spsc_get(&testRing, TICKS_UNLIMITED);
+	} else {
+		nano_fiber_fifo_get(&testFifo, TICKS_UNLIMITED);
+	}
+	timestamp = TIME_STAMP_DELTA_GET(timestamp);
+}
+
+/**
+ *
+ * @brief Measure one of the objects
+ *
+ * @param useRing  Non-zero to use the ring.
+ *
+ * @return N/A
+ */
+static void passItemsMeasure(int useRing)
+{
+	uint32_t putTime;
+	uint32_t getTime;
+
+	irq_offload(useRing ? ringPutIsr : fifoPutIsr, NULL);
+	putTime = timestamp;
+
+	task_fiber_start(fiberStack, STACKSIZE,
+			 (nano_fiber_entry_t)fiberGetBurst, useRing, 0, 6, 0);
+	getTime = timestamp;
+
+	PRINT_FORMAT(" %s: put %lu tcs, get %lu tcs per item",
+		     useRing ? "SPSC ring" : "FIFO     ",
+		     putTime / NITEMS, getTime / NITEMS);
+
+	TICK_SYNCH();
+	task_fiber_start(fiberStack, STACKSIZE,
+			 (nano_fiber_entry_t)fiberWaiter, useRing, 0, 6, 0);
+	irq_offload(useRing ? ringWakeIsr : fifoWakeIsr, NULL);
+
+	PRINT_FORMAT(" %s: ISR put to waiting fiber is %lu tcs = %lu nsec",
+		     useRing ? "SPSC ring" : "FIFO     ",
+		     timestamp, SYS_CLOCK_HW_CYCLES_TO_NS(timestamp));
+}
+
+/**
+ *
+ * @brief The test main function
+ *
+ * @return 0 on success
+ */
+int nanoSpscFifo(void)
+{
+	PRINT_FORMAT(" 7- Measure passing items from ISR to fiber, FIFO versus "
+		     "SPSC ring");
+
+	nano_fifo_init(&testFifo);
+	nano_spsc_init(&testRing, testRingBuf, NITEMS);
+
+	passItemsMeasure(0);
+	passItemsMeasure(1);
+
+	return 0;
+}
@@ -0,0 +1,190 @@
+/* nano_timeout_q.c - measure interrupt lock time of the timeout queue */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This file contains the test that measures how long interrupts stay locked
+ * while a nanokernel timer is added to and removed from the timeout queue,
+ * depending on the number of timeouts already pending. The timer being
+ * started expires after all the pending ones, which is the worst case for a
+ * sorted timeout queue. The worst and average cases are displayed.
+ *
+ * It then measures the expiry of as many timeouts on the same tick, which is
+ * where the timeout queue keeps interrupts locked the longest. The task polls
+ * the timestamp while the timeouts expire: the longest gap between two
+ * readings is the time the tick interrupt kept the task from running. When
+ * CONFIG_INT_LATENCY_BENCHMARK is enabled, the longest time interrupts stayed
+ * locked meanwhile is displayed as well.
+ */
+
+#include "timestamp.h"
+#include "utils.h"
+
+#include <arch/cpu.h>
+#include <misc/util.h>
+
+#ifdef CONFIG_NANO_TIMERS
+
+/* number of start/stop cycles for each number of pending timeouts */
+#define NTESTS 100
+
+/* maximum number of pending timeouts */
+#define NTIMEOUTS 256
+
+/* timeout of the pending timers, long enough not to expire during the test */
+#define LONG_TICKS 100000
+
+/* timeout of the timers of the expiry measurement */
+#define EXPIRY_TICKS 1
+
+static struct nano_timer timers[NTIMEOUTS];
+
+static const int timeout_counts[] = { 1, 16, 64, NTIMEOUTS };
+
+/**
+ *
+ * @brief Measure timer start and stop with a number of pending timeouts
+ *
+ * @return N/A
+ *
+ * @param count   Number of pending timeouts, including the measured timer.
+ */
+static void timeoutQueueMeasure(int count)
+{
+	struct nano_timer *probe = &timers[count - 1];
+	uint32_t start_max = 0, start_sum = 0;
+	uint32_t stop_max = 0, stop_sum = 0;
+	uint32_t t;
+	unsigned int key;
+	int i;
+
+	for (i = 0; i < count - 1; i++) {
+		nano_timer_start(&timers[i], LONG_TICKS + i);
+	}
+
+	for (i = 0; i < NTESTS; i++) {
+		key = irq_lock();
+
+		t = TIME_STAMP_DELTA_GET(0);
+		nano_timer_start(probe, LONG_TICKS + count);
+		t = TIME_STAMP_DELTA_GET(t);
+		start_max = max(start_max, t);
+		start_sum += t;
+
+		t = TIME_STAMP_DELTA_GET(0);
+		nano_timer_stop(probe);
+		t = TIME_STAMP_DELTA_GET(t);
+		stop_max = max(stop_max, t);
+		stop_sum += t;
+
+		irq_unlock(key);
+	}
+
+	for (i = 0; i < count - 1; i++) {
+		nano_timer_stop(&timers[i]);
+	}
+
+	PRINT_FORMAT(" %3d timeouts: start max %lu avg %lu tcs, "
+		     "stop max %lu avg %lu tcs", count,
+		     start_max, start_sum / NTESTS,
+		     stop_max, stop_sum / NTESTS);
+}
+
+#ifdef CONFIG_INT_LATENCY_BENCHMARK
+extern void int_latency_init(void);
+extern void int_latency_show(void);
+#endif
+
+/**
+ *
+ * @brief Measure the expiry of a number of timeouts on the same tick
+ *
+ * @return N/A
+ *
+ * @param count   Number of timeouts expiring.
+ */
+static void timeoutExpiryMeasure(int count)
+{
+	uint32_t gap_max = 0;
+	uint32_t last, now;
+	int32_t tick;
+	int done;
+	int i;
+
+	/* start right after a tick, so that all the timers expire together */
+	tick = sys_tick_get_32();
+	while (sys_tick_get_32() == tick) {
+	}
+	tick += 1 + EXPIRY_TICKS;
+
+	for (i = 0; i < count; i++) {
+		nano_timer_start(&timers[i], EXPIRY_TICKS);
+	}
+
+#ifdef CONFIG_INT_LATENCY_BENCHMARK
+	/* restart the interrupt lock statistics */
+	int_latency_init();
+#endif
+
+	last = TIME_STAMP_DELTA_GET(0);
+	do {
+		done = (sys_tick_get_32() - tick) >= 0;
+		now = TIME_STAMP_DELTA_GET(0);
+		gap_max = max(gap_max, now - last);
+		last = now;
+	} while (!done);
+
+	PRINT_FORMAT(" %3d timeouts expiring: task held off max %lu tcs",
+		     count, gap_max);
+
+#ifdef CONFIG_INT_LATENCY_BENCHMARK
+	int_latency_show();
+#endif
+}
+
+/**
+ *
+ * @brief The test main function
+ *
+ * @return 0 on success
+ */
+int nanoTimeoutQueue(void)
+{
+	int i;
+
+	PRINT_FORMAT(" 6- Measure interrupt lock time of timeout queue insert "
+		     "and remove");
+
+	for (i = 0; i < NTIMEOUTS; i++) {
+		nano_timer_init(&timers[i], NULL);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(timeout_counts); i++) {
+		timeoutQueueMeasure(timeout_counts[i]);
+	}
+
+	PRINT_FORMAT(" 6.1- Measure expiry of timeouts on the same tick");
+
+	for (i = 0; i < ARRAY_SIZE(timeout_counts); i++) {
+		timeoutExpiryMeasure(timeout_counts[i]);
+	}
+
+	return 0;
+}
+
+#endif /* CONFIG_NANO_TIMERS */
@@ -93,6 +93,8 @@ int nanoIntToFiber(void);
 int nanoIntToFiberSem(void);
 int nanoCtxSwitch(void);
 int nanoIntLockUnlock(void);
+int nanoTimeoutQueue(void);
+int nanoSpscFifo(void);
 
 /* pointer to the ISR */
 typedef void (*ptestIsr) (void *unused);
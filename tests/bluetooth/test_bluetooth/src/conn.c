@@ -0,0 +1,772 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the Bluetooth connection TX scheduler
+ *
+ * A fake controller answers the HCI commands of the host, creates several
+ * LE connections and counts the ACL packets it receives for each of them,
+ * returning its buffers to the host with Number of Completed Packets events.
+ *
+ * Scenario #1
+ * Packets are queued on all connections at once, one connection having twice
+ * the weight of the others. The order in which the controller receives them
+ * must follow the weights at any time, and the throughput is displayed.
+ *
+ * Scenario #2
+ * Packets larger than the controller ACL MTU are queued. The controller must
+ * receive them in fragments carrying the original data, and the throughput
+ * is displayed.
+ *
+ * Scenario #3
+ * All the peers subscribe to a characteristic, which is then notified to all
+ * of them at once. Each connection must get the same notification, although
+ * the controller consumes the packets it receives like the H4 driver used to.
+ *
+ * Scenario #4
+ * The controller keeps its buffers while a packet needing more fragments than
+ * it has buffers is sent on one connection. The first buffer it returns must
+ * go to a packet queued on another connection meanwhile, not to the next
+ * fragment.
+ *
+ * Scenario #5
+ * The controller keeps its buffers while packets are queued, then all the
+ * connections are disconnected. The host must get its controller buffers
+ * and all queued packets back.
+ */
+
+#include <zephyr.h>
+
+#include <errno.h>
+#include <string.h>
+#include <atomic.h>
+#include <tc_util.h>
+#include <misc/byteorder.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/driver.h>
+
+#include "hci_core.h"
+#include "conn_internal.h"
+#include "l2cap_internal.h"
+
+#include "ctlr.h"
+
+#define FIBER_STACKSIZE    1024
+#define QUEUE_PRIORITY     5
+
+#define NUM_CONNS          CONFIG_BLUETOOTH_MAX_CONN
+#define DATA_LEN           16
+#define DATA_CID           0x0040
+#define NUM_ROUNDS         16
+#define NUM_DISCONN_PKTS   4
+#define NOTIFY_LEN         20
+#define BIG_LEN            200
+#define NUM_BIG_PKTS       8
+/* ACL fragments needed for a big packet and its L2CAP header */
+#define BIG_FRAGS          ((BIG_LEN + 4 + CTLR_ACL_MTU - 1) / CTLR_ACL_MTU)
+
+/* Enough buffers for all the packets queued in scenario #1 */
+#define NUM_DATA_BUFS      ((NUM_CONNS + HEAVY_WEIGHT - 1) * NUM_ROUNDS)
+#define NUM_TX_LOG         NUM_DATA_BUFS
+
+/* Weight of the first connection, the others have weight 1 */
+#define HEAVY_WEIGHT       2
+
+#define TIMEOUT            (sys_clock_ticks_per_sec * 2)
+
+static char __stack queue_stack[FIBER_STACKSIZE];
+
+/* Set to keep the controller buffers, as if the peers stopped listening */
+static bool ctlr_hold;
+
+/* Handles of the ACL packets received by the controller, in order */
+static uint16_t tx_log[NUM_TX_LOG];
+/* Last ACL packet received by the controller, with its header */
+static uint8_t tx_data[4 + CTLR_ACL_MTU];
+static uint16_t tx_len;
+/* Last ACL packet received for each connection */
+static uint8_t conn_tx_data[NUM_CONNS][sizeof(tx_data)];
+static uint16_t conn_tx_len[NUM_CONNS];
+
+/* Payload of all the ACL packets received, while reassembling */
+static uint8_t rx_data[NUM_BIG_PKTS * (4 + BIG_LEN)];
+static int rx_len;
+static bool ctlr_reassemble;
+static int tx_count;
+static int tx_expected;
+static struct nano_sem tx_done;
+
+static struct bt_conn *conns[NUM_CONNS];
+static struct nano_sem conn_sem;
+
+static struct nano_fifo data_fifo;
+static int data_freed;
+
+static void data_destroy(struct net_buf *buf)
+{
+	data_freed++;
+	nano_fifo_put(buf->free, buf);
+}
+
+static NET_BUF_POOL(data_pool, NUM_DATA_BUFS, BT_L2CAP_BUF_SIZE(DATA_LEN),
+		    &data_fifo, data_destroy, BT_BUF_USER_DATA_MIN);
+
+static struct nano_fifo big_fifo;
+static NET_BUF_POOL(big_pool, NUM_BIG_PKTS, BT_L2CAP_BUF_SIZE(BIG_LEN),
+		    &big_fifo, NULL, BT_BUF_USER_DATA_MIN);
+
+static void ctlr_num_completed(uint16_t handle, uint16_t count)
+{
+	struct bt_hci_evt_num_completed_packets *ev;
+	struct net_buf *buf;
+
+	buf = bt_buf_get_evt();
+	ev = ctlr_evt_add(buf, BT_HCI_EVT_NUM_COMPLETED_PACKETS,
+			  sizeof(*ev) + sizeof(ev->h[0]));
+	ev->num_handles = 1;
+	ev->h[0].handle = sys_cpu_to_le16(handle);
+	ev->h[0].count = sys_cpu_to_le16(count);
+
+	bt_recv(buf);
+}
+
+static int conn_index(uint16_t handle)
+{
+	return handle - 1;
+}
+
+static void ctlr_acl(struct net_buf *acl)
+{
+	struct bt_hci_acl_hdr *hdr = (void *)acl->data;
+	uint16_t handle = bt_acl_handle(sys_le16_to_cpu(hdr->handle));
+	struct net_buf *frag;
+	uint8_t byte;
+	int i;
+
+	if (tx_count < NUM_TX_LOG) {
+		tx_log[tx_count] = handle;
+	}
+
+	/* The payload may be in fragments of the buffer. Pull the bytes out
+	 * of them, so that a fragment shared with a packet not sent yet shows
+	 * up as missing data in that packet.
+	 */
+	tx_len = 0;
+	for (frag = acl; frag; frag = frag->frags) {
+		while (frag->len) {
+			byte = net_buf_pull_u8(frag);
+			if (tx_len < sizeof(tx_data)) {
+				tx_data[tx_len++] = byte;
+			}
+		}
+	}
+
+	i = conn_index(handle);
+	if (i >= 0 && i < NUM_CONNS) {
+		memcpy(conn_tx_data[i], tx_data, tx_len);
+		conn_tx_len[i] = tx_len;
+	}
+
+	if (ctlr_reassemble && tx_len > sizeof(*hdr) &&
+	    rx_len + tx_len - sizeof(*hdr) <= sizeof(rx_data)) {
+		memcpy(&rx_data[rx_len], &tx_data[sizeof(*hdr)],
+		       tx_len - sizeof(*hdr));
+		rx_len += tx_len - sizeof(*hdr);
+	}
+
+	if (++tx_count == tx_expected) {
+		nano_fiber_sem_give(&tx_done);
+	}
+
+	if (ctlr_hold) {
+		return;
+	}
+
+	ctlr_num_completed(handle, 1);
+}
+
+static const struct ctlr_hooks hooks = {
+	.acl = ctlr_acl,
+};
+
+static void ctlr_conn_complete(uint16_t handle)
+{
+	struct bt_hci_evt_le_meta_event *meta;
+	struct bt_hci_evt_le_conn_complete *evt;
+	struct net_buf *buf;
+
+	buf = bt_buf_get_evt();
+	meta = ctlr_evt_add(buf, BT_HCI_EVT_LE_META_EVENT,
+			    sizeof(*meta) + sizeof(*evt));
+	meta->subevent = BT_HCI_EVT_LE_CONN_COMPLETE;
+
+	evt = (void *)(meta + 1);
+	memset(evt, 0, sizeof(*evt));
+	evt->handle = sys_cpu_to_le16(handle);
+	evt->role = BT_HCI_ROLE_SLAVE;
+	evt->peer_addr.type = BT_ADDR_LE_PUBLIC;
+	memset(&evt->peer_addr.a, handle, sizeof(evt->peer_addr.a));
+	/* Within the initial parameters, so no update is requested */
+	evt->interval = sys_cpu_to_le16(BT_GAP_INIT_CONN_INT_MIN);
+	evt->supv_timeout = sys_cpu_to_le16(42);
+
+	bt_recv(buf);
+}
+
+static void ctlr_disconn_complete(uint16_t handle)
+{
+	struct bt_hci_evt_disconn_complete *evt;
+	struct net_buf *buf;
+
+	buf = bt_buf_get_evt();
+	evt = ctlr_evt_add(buf, BT_HCI_EVT_DISCONN_COMPLETE, sizeof(*evt));
+	evt->status = 0;
+	evt->handle = sys_cpu_to_le16(handle);
+	evt->reason = BT_HCI_ERR_REMOTE_USER_TERM_CONN;
+
+	bt_recv(buf);
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	int i;
+
+	if (err) {
+		return;
+	}
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		if (!conns[i]) {
+			conns[i] = bt_conn_ref(conn);
+			nano_fiber_sem_give(&conn_sem);
+			return;
+		}
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	int i;
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		if (conns[i] == conn) {
+			bt_conn_unref(conns[i]);
+			conns[i] = NULL;
+			nano_fiber_sem_give(&conn_sem);
+			return;
+		}
+	}
+}
+
+static struct bt_conn_cb conn_callbacks = {
+	.connected = connected,
+	.disconnected = disconnected,
+};
+
+static struct bt_gatt_ccc_cfg ccc_cfg[NUM_CONNS] = {};
+
+static void ccc_changed(uint16_t value)
+{
+}
+
+static struct bt_gatt_attr attrs[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_HRS),
+	BT_GATT_CHARACTERISTIC(BT_UUID_HRS_MEASUREMENT, BT_GATT_CHRC_NOTIFY),
+	BT_GATT_DESCRIPTOR(BT_UUID_HRS_MEASUREMENT, BT_GATT_PERM_READ, NULL,
+			   NULL, NULL),
+	BT_GATT_CCC(ccc_cfg, ccc_changed),
+};
+
+static int conn_weight(int i)
+{
+	return i ? 1 : HEAVY_WEIGHT;
+}
+
+/**
+ *
+ * @brief Fiber queueing packets on all connections
+ *
+ * Being a fiber, it queues all the packets before the TX scheduler runs.
+ *
+ * @param rounds Number of packets per unit of weight.
+ * @param unused Not used.
+ *
+ * @return N/A
+ */
+static void queue_fiber(int rounds, int unused)
+{
+	struct net_buf *buf;
+	int i, j;
+
+	ARG_UNUSED(unused);
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		for (j = 0; j < rounds * conn_weight(i); j++) {
+			buf = bt_conn_create_pdu(&data_fifo, 0);
+			net_buf_add_le16(buf, DATA_LEN);
+			net_buf_add_le16(buf, DATA_CID);
+			memset(net_buf_add(buf, DATA_LEN), j, DATA_LEN);
+
+			bt_conn_send(conns[i], buf);
+		}
+	}
+}
+
+/**
+ *
+ * @brief Create the connections
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_connect(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		ctlr_conn_complete(i + 1);
+
+		if (!nano_task_sem_take(&conn_sem, TIMEOUT)) {
+			TC_ERROR("connection %d not established\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		if (bt_conn_set_tx_weight(conns[i], conn_weight(i))) {
+			TC_ERROR("unable to set the weight of connection %d\n",
+				 i);
+			return TC_FAIL;
+		}
+	}
+
+	if (!bt_conn_set_tx_weight(conns[0], 0)) {
+		TC_ERROR("weight 0 accepted\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Check that the connections share the controller by their weights
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_weighted_share(void)
+{
+	int count[NUM_CONNS] = { 0 };
+	int total_weight = 0;
+	uint32_t cycles;
+	uint32_t ms;
+	int i, k;
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		total_weight += conn_weight(i);
+	}
+
+	tx_count = 0;
+	tx_expected = total_weight * NUM_ROUNDS;
+
+	cycles = sys_cycle_get_32();
+	task_fiber_start(queue_stack, FIBER_STACKSIZE,
+			 (nano_fiber_entry_t)queue_fiber, NUM_ROUNDS, 0,
+			 QUEUE_PRIORITY, 0);
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("only %d of %d packets sent\n", tx_count,
+			 tx_expected);
+		return TC_FAIL;
+	}
+	cycles = sys_cycle_get_32() - cycles;
+
+	/* At any time, each connection has had its share of the packets sent
+	 * so far, give or take one round.
+	 */
+	for (k = 0; k < tx_count; k++) {
+		i = conn_index(tx_log[k]);
+		if (i < 0 || i >= NUM_CONNS) {
+			TC_ERROR("packet %d for unknown handle %u\n", k,
+				 tx_log[k]);
+			return TC_FAIL;
+		}
+
+		count[i]++;
+
+		for (i = 0; i < NUM_CONNS; i++) {
+			int share = (k + 1) * conn_weight(i) / total_weight;
+
+			if (count[i] > share + conn_weight(i) + 1 ||
+			    count[i] + conn_weight(i) + 1 < share) {
+				TC_ERROR("connection %d sent %d of %d packets, "
+					 "share %d\n", i, count[i], k + 1,
+					 share);
+				return TC_FAIL;
+			}
+		}
+	}
+
+	ms = (uint32_t)((uint64_t)cycles * 1000 / sys_clock_hw_cycles_per_sec);
+	TC_PRINT("%d connections, %d packets in %u ms (%u cycles/packet)\n",
+		 NUM_CONNS, tx_count, ms, cycles / tx_count);
+	for (i = 0; i < NUM_CONNS; i++) {
+		TC_PRINT(" connection %d: weight %d, %d packets\n", i,
+			 conn_weight(i), count[i]);
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Send packets larger than the controller ACL MTU
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_fragment(void)
+{
+	struct net_buf *buf;
+	uint32_t cycles;
+	uint32_t ms;
+	int i, j;
+
+	tx_count = 0;
+	tx_expected = NUM_BIG_PKTS * BIG_FRAGS;
+	rx_len = 0;
+	ctlr_reassemble = true;
+
+	cycles = sys_cycle_get_32();
+	for (i = 0; i < NUM_BIG_PKTS; i++) {
+		buf = bt_conn_create_pdu(&big_fifo, 0);
+		net_buf_add_le16(buf, BIG_LEN);
+		net_buf_add_le16(buf, DATA_CID);
+		for (j = 0; j < BIG_LEN; j++) {
+			net_buf_add_u8(buf, i + j);
+		}
+
+		bt_conn_send(conns[0], buf);
+	}
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("only %d of %d fragments sent\n", tx_count,
+			 tx_expected);
+		return TC_FAIL;
+	}
+	cycles = sys_cycle_get_32() - cycles;
+
+	ctlr_reassemble = false;
+
+	if (rx_len != sizeof(rx_data)) {
+		TC_ERROR("%d of %d bytes received\n", rx_len,
+			 sizeof(rx_data));
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < NUM_BIG_PKTS; i++) {
+		uint8_t *pkt = &rx_data[i * (4 + BIG_LEN)];
+
+		if (sys_le16_to_cpu(UNALIGNED_GET((uint16_t *)pkt)) !=
+		    BIG_LEN ||
+		    sys_le16_to_cpu(UNALIGNED_GET((uint16_t *)(pkt + 2))) !=
+		    DATA_CID) {
+			TC_ERROR("wrong L2CAP header in packet %d\n", i);
+			return TC_FAIL;
+		}
+
+		for (j = 0; j < BIG_LEN; j++) {
+			if (pkt[4 + j] != (uint8_t)(i + j)) {
+				TC_ERROR("wrong byte %d in packet %d\n", j, i);
+				return TC_FAIL;
+			}
+		}
+	}
+
+	ms = (uint32_t)((uint64_t)cycles * 1000 / sys_clock_hw_cycles_per_sec);
+	TC_PRINT("%d bytes in %d fragments in %u ms (%u cycles/byte)\n",
+		 rx_len, tx_count, ms, cycles / rx_len);
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Notify a characteristic all the connections subscribed to
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_notify(void)
+{
+	uint16_t value = sys_cpu_to_le16(BT_GATT_CCC_NOTIFY);
+	uint8_t data[NOTIFY_LEN];
+	uint8_t last[CTLR_ACL_MTU];
+	int count[NUM_CONNS] = { 0 };
+	uint32_t cycles;
+	int i, k;
+
+	if (bt_gatt_register(attrs, ARRAY_SIZE(attrs))) {
+		TC_ERROR("unable to register the attributes\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		if (bt_gatt_attr_write_ccc(conns[i], &attrs[3], &value,
+					   sizeof(value), 0) != sizeof(value)) {
+			TC_ERROR("connection %d unable to subscribe\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+
+	tx_count = 0;
+	tx_expected = NUM_CONNS;
+
+	cycles = sys_cycle_get_32();
+	if (bt_gatt_notify(NULL, &attrs[2], data, sizeof(data))) {
+		TC_ERROR("unable to notify\n");
+		return TC_FAIL;
+	}
+	cycles = sys_cycle_get_32() - cycles;
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("only %d of %d notifications sent\n", tx_count,
+			 tx_expected);
+		return TC_FAIL;
+	}
+
+	for (k = 0; k < tx_count; k++) {
+		i = conn_index(tx_log[k]);
+		if (i < 0 || i >= NUM_CONNS || count[i]++) {
+			TC_ERROR("unexpected notification for handle %u\n",
+				 tx_log[k]);
+			return TC_FAIL;
+		}
+	}
+
+	/* ACL and L2CAP headers, ATT opcode and handle, then the value */
+	for (i = 0; i < NUM_CONNS; i++) {
+		if (conn_tx_len[i] != 4 + 4 + 3 + sizeof(data) ||
+		    memcmp(&conn_tx_data[i][4 + 4 + 3], data, sizeof(data))) {
+			TC_ERROR("wrong notification PDU for connection %d\n",
+				 i);
+			return TC_FAIL;
+		}
+	}
+
+	memcpy(last, tx_data, tx_len);
+
+	/* Each connection gets a copy of the same PDU */
+	tx_count = 0;
+	tx_expected = 1;
+	if (bt_gatt_notify(conns[0], &attrs[2], data, sizeof(data)) ||
+	    !nano_task_sem_take(&tx_done, TIMEOUT) ||
+	    memcmp(last, tx_data, tx_len)) {
+		TC_ERROR("notification differs from the one to all peers\n");
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%d peers notified in %u cycles\n", NUM_CONNS, cycles);
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Check that a fragmented packet does not hold up other connections
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_fragment_stall(void)
+{
+	struct net_buf *buf;
+	int j;
+
+	ctlr_hold = true;
+	tx_count = 0;
+	tx_expected = CTLR_ACL_PKTS;
+
+	buf = bt_conn_create_pdu(&big_fifo, 0);
+	net_buf_add_le16(buf, BIG_LEN);
+	net_buf_add_le16(buf, DATA_CID);
+	for (j = 0; j < BIG_LEN; j++) {
+		net_buf_add_u8(buf, j);
+	}
+
+	bt_conn_send(conns[0], buf);
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("controller buffers not used\n");
+		return TC_FAIL;
+	}
+
+	/* The rest of the big packet now waits for controller buffers */
+	tx_expected = CTLR_ACL_PKTS + 1;
+
+	buf = bt_conn_create_pdu(&data_fifo, 0);
+	net_buf_add_le16(buf, DATA_LEN);
+	net_buf_add_le16(buf, DATA_CID);
+	memset(net_buf_add(buf, DATA_LEN), 0, DATA_LEN);
+
+	bt_conn_send(conns[1], buf);
+
+	ctlr_num_completed(conns[0]->handle, 1);
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("returned controller buffer not used\n");
+		return TC_FAIL;
+	}
+
+	if (tx_log[CTLR_ACL_PKTS] != conns[1]->handle) {
+		TC_ERROR("handle %u sent instead of %u\n",
+			 tx_log[CTLR_ACL_PKTS], conns[1]->handle);
+		return TC_FAIL;
+	}
+
+	/* Let the rest of the big packet through */
+	tx_expected = BIG_FRAGS + 1;
+	ctlr_hold = false;
+
+	ctlr_num_completed(conns[0]->handle, CTLR_ACL_PKTS - 1);
+	ctlr_num_completed(conns[1]->handle, 1);
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("only %d of %d packets sent\n", tx_count,
+			 tx_expected);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Disconnect with packets queued and buffers held by the controller
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_disconnect(void)
+{
+	int i;
+
+	ctlr_hold = true;
+	tx_count = 0;
+	tx_expected = CTLR_ACL_PKTS;
+	data_freed = 0;
+
+	task_fiber_start(queue_stack, FIBER_STACKSIZE,
+			 (nano_fiber_entry_t)queue_fiber, NUM_DISCONN_PKTS, 0,
+			 QUEUE_PRIORITY, 0);
+
+	if (!nano_task_sem_take(&tx_done, TIMEOUT)) {
+		TC_ERROR("controller buffers not used\n");
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < NUM_CONNS; i++) {
+		ctlr_disconn_complete(i + 1);
+
+		if (!nano_task_sem_take(&conn_sem, TIMEOUT)) {
+			TC_ERROR("connection %d not disconnected\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	if (bt_conn_tx_credits_get(BT_CONN_TYPE_LE) != CTLR_ACL_PKTS) {
+		TC_ERROR("%d of %d controller buffers returned\n",
+			 bt_conn_tx_credits_get(BT_CONN_TYPE_LE),
+			 CTLR_ACL_PKTS);
+		return TC_FAIL;
+	}
+
+	if (data_freed != NUM_DISCONN_PKTS * (NUM_CONNS + HEAVY_WEIGHT - 1)) {
+		TC_ERROR("%d queued packets not freed\n",
+			 NUM_DISCONN_PKTS * (NUM_CONNS + HEAVY_WEIGHT - 1) -
+			 data_freed);
+		return TC_FAIL;
+	}
+
+	ctlr_hold = false;
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test Bluetooth connection TX scheduler");
+
+	nano_sem_init(&tx_done);
+	nano_sem_init(&conn_sem);
+	net_buf_pool_init(data_pool);
+	net_buf_pool_init(big_pool);
+
+	ctlr_init(&hooks);
+
+	rv = bt_enable(NULL);
+	if (rv) {
+		TC_ERROR("Bluetooth init failed (err %d)\n", rv);
+		rv = TC_FAIL;
+		goto exit;
+	}
+
+	bt_conn_cb_register(&conn_callbacks);
+
+	TC_PRINT("Test connecting\n");
+	rv = test_connect();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test weighted sharing of the controller buffers\n");
+	rv = test_weighted_share();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test fragmenting packets to the controller ACL MTU\n");
+	rv = test_fragment();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test notifying all subscribed peers\n");
+	rv = test_notify();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test fragmenting with few controller buffers\n");
+	rv = test_fragment_stall();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test disconnecting with queued packets\n");
+	rv = test_disconnect();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
@@ -0,0 +1,162 @@
+/* ctlr.c - Fake Bluetooth controller for the host tests */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * The controller fiber answers all the HCI commands of the host with a
+ * Command Complete event, filling the return parameters every test needs,
+ * and hands the other ones and the ACL packets over to the test.
+ */
+
+#include <zephyr.h>
+
+#include <string.h>
+#include <misc/byteorder.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/driver.h>
+
+#include "ctlr.h"
+
+#define FIBER_STACKSIZE    1024
+#define CTLR_PRIORITY      7
+
+/* Largest return parameters, the ones of Read Local Supported Commands */
+#define CTLR_RP_LEN        65
+
+static char __stack ctlr_stack[FIBER_STACKSIZE];
+
+/* Buffers sent by the host, processed by the controller fiber */
+static struct nano_fifo ctlr_queue;
+
+static const struct ctlr_hooks *ctlr_hooks;
+
+void *ctlr_evt_add(struct net_buf *buf, uint8_t evt, uint8_t len)
+{
+	struct bt_hci_evt_hdr *hdr;
+
+	hdr = net_buf_add(buf, sizeof(*hdr));
+	hdr->evt = evt;
+	hdr->len = len;
+
+	return net_buf_add(buf, len);
+}
+
+/* Command Complete with room for the largest return parameters. Unused
+ * parameters are left zeroed.
+ */
+static void ctlr_cmd(struct net_buf *cmd)
+{
+	struct bt_hci_cmd_hdr *hdr = (void *)cmd->data;
+	uint16_t opcode = sys_le16_to_cpu(hdr->opcode);
+	struct hci_evt_cmd_complete *cc;
+	struct net_buf *buf;
+	uint8_t *rp;
+
+	buf = bt_buf_get_evt();
+	cc = ctlr_evt_add(buf, BT_HCI_EVT_CMD_COMPLETE,
+			  sizeof(*cc) + CTLR_RP_LEN);
+	cc->ncmd = 1;
+	cc->opcode = sys_cpu_to_le16(opcode);
+
+	rp = (uint8_t *)(cc + 1);
+	memset(rp, 0, CTLR_RP_LEN);
+
+	switch (opcode) {
+	case BT_HCI_OP_READ_LOCAL_FEATURES:
+		((struct bt_hci_rp_read_local_features *)rp)->features[4] =
+			BT_LMP_LE | BT_LMP_NO_BREDR;
+		break;
+	case BT_HCI_OP_READ_BD_ADDR:
+		memset(&((struct bt_hci_rp_read_bd_addr *)rp)->bdaddr, 0x11,
+		       sizeof(bt_addr_t));
+		break;
+	case BT_HCI_OP_LE_READ_BUFFER_SIZE:
+		((struct bt_hci_rp_le_read_buffer_size *)rp)->le_max_len =
+			sys_cpu_to_le16(CTLR_ACL_MTU);
+		((struct bt_hci_rp_le_read_buffer_size *)rp)->le_max_num =
+			CTLR_ACL_PKTS;
+		break;
+	default:
+		break;
+	}
+
+	if (ctlr_hooks->cmd) {
+		ctlr_hooks->cmd(opcode, rp);
+	}
+
+	bt_recv(buf);
+}
+
+static void ctlr_fiber(int arg1, int arg2)
+{
+	struct net_buf *buf;
+
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	while (1) {
+		buf = nano_fiber_fifo_get(&ctlr_queue, TICKS_UNLIMITED);
+
+		switch (bt_buf_get_type(buf)) {
+		case BT_BUF_CMD:
+			ctlr_cmd(buf);
+			break;
+		case BT_BUF_ACL_OUT:
+			if (ctlr_hooks->acl) {
+				ctlr_hooks->acl(buf);
+			}
+			break;
+		default:
+			break;
+		}
+
+		net_buf_unref(buf);
+	}
+}
+
+static int driver_open(void)
+{
+	return 0;
+}
+
+static int driver_send(struct net_buf *buf)
+{
+	nano_fifo_put(&ctlr_queue, buf);
+	return 0;
+}
+
+static struct bt_driver drv = {
+	.name         = "test",
+	.bus          = BT_DRIVER_BUS_VIRTUAL,
+	.open         = driver_open,
+	.send         = driver_send,
+};
+
+void ctlr_init(const struct ctlr_hooks *hooks)
+{
+	ctlr_hooks = hooks;
+
+	nano_fifo_init(&ctlr_queue);
+
+	task_fiber_start(ctlr_stack, FIBER_STACKSIZE, ctlr_fiber, 0, 0,
+			 CTLR_PRIORITY, 0);
+
+	bt_driver_register(&drv);
+}
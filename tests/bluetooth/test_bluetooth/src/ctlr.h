@@ -0,0 +1,59 @@
+/* ctlr.h - Fake Bluetooth controller for the host tests */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <net/buf.h>
+
+/* ACL buffers of the controller */
+#define CTLR_ACL_MTU       27
+#define CTLR_ACL_PKTS      2
+
+/* Hooks of a test into the fake controller */
+struct ctlr_hooks {
+	/* Fill the return parameters of a command, rp being zeroed or set
+	 * for the commands every test needs. May be NULL.
+	 */
+	void (*cmd)(uint16_t opcode, uint8_t *rp);
+
+	/* Process an ACL packet sent by the host. May be NULL. */
+	void (*acl)(struct net_buf *buf);
+};
+
+/**
+ *
+ * @brief Start the fake controller and register it as Bluetooth driver
+ *
+ * Must be called from the test task before bt_enable().
+ *
+ * @param hooks Hooks of the test.
+ *
+ * @return N/A
+ */
+void ctlr_init(const struct ctlr_hooks *hooks);
+
+/**
+ *
+ * @brief Add an event header to a buffer
+ *
+ * @param buf Event buffer.
+ * @param evt Event code.
+ * @param len Length of the event parameters.
+ *
+ * @return Pointer to the event parameters
+ */
+void *ctlr_evt_add(struct net_buf *buf, uint8_t evt, uint8_t len);
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * @file
+ * @brief Test the GATT attribute indexes
+ *
+ * Attribute tables are registered one at a time, some with holes in their
+ * handles, until there are more tables than the handle index holds and more
+ * declarations than the type index holds. After each registration, the
+ * lookups by handle and by type must give the same attributes as walking
+ * the whole database, for every attribute type and for ranges starting and
+ * ending around each handle.
+ */
+
+#include <zephyr.h>
+
+#include <errno.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/gatt.h>
+
+#include "gatt_internal.h"
+
+#define MAX_ATTRS          64
+#define MAX_RANGE          8
+
+/* Vendor service, characteristic and descriptor UUIDs */
+#define UUID_SVC    BT_UUID_DECLARE_128(0xf0, 0xde, 0xbc, 0x9a, 0x78, 0x56, \
+					0x34, 0x12, 0x78, 0x56, 0x34, 0x12, \
+					0x01, 0x00, 0x00, 0x00)
+#define UUID_VALUE  BT_UUID_DECLARE_128(0xf0, 0xde, 0xbc, 0x9a, 0x78, 0x56, \
+					0x34, 0x12, 0x78, 0x56, 0x34, 0x12, \
+					0x02, 0x00, 0x00, 0x00)
+#define UUID_DESC   BT_UUID_DECLARE_16(0x2901)
+
+/* Characteristic declaration UUID in its 128-bit form */
+#define UUID_CHRC_128 BT_UUID_DECLARE_128(0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, \
+					  0x00, 0x80, 0x00, 0x10, 0x00, 0x00, \
+					  0x03, 0x28, 0x00, 0x00)
+
+static struct bt_gatt_ccc_cfg ccc_cfg[5][1] = {};
+
+static void ccc_changed(uint16_t value)
+{
+}
+
+#define CHRC_128							\
+{									\
+	.uuid = UUID_CHRC_128,						\
+	.perm = BT_GATT_PERM_READ,					\
+	.read = bt_gatt_attr_read_chrc,					\
+	.user_data = (&(struct bt_gatt_chrc) { .uuid = UUID_VALUE,	\
+					       .properties =		\
+						BT_GATT_CHRC_READ, }),	\
+}
+
+#define VALUE(_uuid)							\
+	BT_GATT_DESCRIPTOR(_uuid, BT_GATT_PERM_READ, NULL, NULL, NULL)
+
+static struct bt_gatt_attr attrs_0[] = {
+	BT_GATT_PRIMARY_SERVICE(UUID_SVC),
+	BT_GATT_CHARACTERISTIC(UUID_VALUE, BT_GATT_CHRC_NOTIFY),
+	VALUE(UUID_VALUE),
+	BT_GATT_CCC(ccc_cfg[0], ccc_changed),
+	VALUE(UUID_DESC),
+	BT_GATT_SECONDARY_SERVICE(BT_UUID_BAS),
+	BT_GATT_CHARACTERISTIC(BT_UUID_BAS_BATTERY_LEVEL, BT_GATT_CHRC_READ),
+	VALUE(BT_UUID_BAS_BATTERY_LEVEL),
+};
+
+static struct bt_gatt_attr attrs_1[] = {
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_HRS),
+	BT_GATT_INCLUDE_SERVICE(NULL),
+	BT_GATT_CHARACTERISTIC(BT_UUID_HRS_MEASUREMENT, BT_GATT_CHRC_NOTIFY),
+	VALUE(BT_UUID_HRS_MEASUREMENT),
+	BT_GATT_CCC(ccc_cfg[1], ccc_changed),
+	CHRC_128,
+	VALUE(UUID_VALUE),
+};
+
+/* Registered with a hole before it, and one in the middle */
+static struct bt_gatt_attr attrs_2[] = {
+	BT_GATT_PRIMARY_SERVICE(UUID_SVC),
+	CHRC_128,
+	VALUE(UUID_VALUE),
+	VALUE(UUID_DESC),
+	BT_GATT_CHARACTERISTIC(UUID_VALUE, BT_GATT_CHRC_NOTIFY),
+	VALUE(UUID_VALUE),
+	BT_GATT_CCC(ccc_cfg[2], ccc_changed),
+};
+
+static struct bt_gatt_attr attrs_3[] = {
+	BT_GATT_SECONDARY_SERVICE(UUID_SVC),
+	BT_GATT_CHARACTERISTIC(UUID_VALUE, BT_GATT_CHRC_NOTIFY),
+	VALUE(UUID_VALUE),
+	BT_GATT_CCC(ccc_cfg[3], ccc_changed),
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DIS),
+	BT_GATT_INCLUDE_SERVICE(NULL),
+	BT_GATT_CHARACTERISTIC(UUID_VALUE, BT_GATT_CHRC_READ),
+	VALUE(UUID_VALUE),
+};
+
+static struct bt_gatt_attr attrs_4[] = {
+	BT_GATT_PRIMARY_SERVICE(UUID_SVC),
+	BT_GATT_CHARACTERISTIC(UUID_VALUE, BT_GATT_CHRC_NOTIFY),
+	VALUE(UUID_VALUE),
+	BT_GATT_CCC(ccc_cfg[4], ccc_changed),
+	CHRC_128,
+	VALUE(UUID_VALUE),
+	VALUE(UUID_DESC),
+};
+
+static struct {
+	struct bt_gatt_attr *attrs;
+	size_t count;
+	uint16_t first_handle;
+	uint16_t hole_index;
+	uint16_t hole_handle;
+} tables[] = {
+	{ attrs_0, ARRAY_SIZE(attrs_0) },
+	{ attrs_1, ARRAY_SIZE(attrs_1) },
+	{ attrs_2, ARRAY_SIZE(attrs_2), 0x0100, 3, 0x0180 },
+	{ attrs_3, ARRAY_SIZE(attrs_3) },
+	{ attrs_4, ARRAY_SIZE(attrs_4), 0x0200, 5, 0x0300 },
+};
+
+/* Attribute types looked up, the ones in the type index first */
+#define INDEXED_TYPES      5
+static const struct bt_uuid *types[] = {
+	BT_UUID_GATT_PRIMARY,
+	BT_UUID_GATT_SECONDARY,
+	BT_UUID_GATT_INCLUDE,
+	BT_UUID_GATT_CHRC,
+	BT_UUID_GATT_CCC,
+	UUID_VALUE,
+	UUID_DESC,
+};
+
+/* Attributes visited by an iteration */
+struct visit {
+	const struct bt_gatt_attr *attrs[MAX_ATTRS];
+	int count;
+	int max;
+};
+
+static uint8_t visit_cb(const struct bt_gatt_attr *attr, void *user_data)
+{
+	struct visit *visit = user_data;
+
+	if (visit->count < MAX_ATTRS) {
+		visit->attrs[visit->count] = attr;
+	}
+
+	if (++visit->count == visit->max) {
+		return BT_GATT_ITER_STOP;
+	}
+
+	return BT_GATT_ITER_CONTINUE;
+}
+
+/* Walk the whole database from its first attribute */
+static void linear_foreach(uint16_t start_handle, uint16_t end_handle,
+			   const struct bt_uuid *uuid, struct visit *visit)
+{
+	const struct bt_gatt_attr *attr;
+
+	for (attr = attrs_0; attr; attr = bt_gatt_attr_next(attr)) {
+		if (attr->handle < start_handle || attr->handle > end_handle ||
+		    (uuid && bt_uuid_cmp(attr->uuid, uuid))) {
+			continue;
+		}
+
+		if (visit_cb(attr, visit) == BT_GATT_ITER_STOP) {
+			break;
+		}
+	}
+}
+
+static uint16_t linear_service_end(const struct bt_gatt_attr *attr,
+				   uint16_t end_handle)
+{
+	const struct bt_gatt_attr *next;
+	uint16_t end = attr->handle;
+
+	for (next = bt_gatt_attr_next(attr); next && next->handle <= end_handle;
+	     next = bt_gatt_attr_next(next)) {
+		if (!bt_uuid_cmp(next->uuid, BT_UUID_GATT_PRIMARY) ||
+		    !bt_uuid_cmp(next->uuid, BT_UUID_GATT_SECONDARY)) {
+			break;
+		}
+
+		end = next->handle;
+	}
+
+	return end;
+}
+
+static int visit_cmp(const struct visit *v1, const struct visit *v2)
+{
+	if (v1->count != v2->count || v1->count > MAX_ATTRS) {
+		return -1;
+	}
+
+	return memcmp(v1->attrs, v2->attrs, v1->count * sizeof(v1->attrs[0]));
+}
+
+/**
+ *
+ * @brief Compare the lookups of a range with a walk of the database
+ *
+ * @param start_handle First handle of the range.
+ * @param end_handle Last handle of the range.
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int check_range(uint16_t start_handle, uint16_t end_handle)
+{
+	struct visit indexed, linear;
+	int i, max;
+
+	/* Unbounded, and stopping at the first attribute */
+	for (max = 0; max < 2; max++) {
+		memset(&indexed, 0, sizeof(indexed));
+		memset(&linear, 0, sizeof(linear));
+		indexed.max = linear.max = max;
+
+		bt_gatt_foreach_attr(start_handle, end_handle, visit_cb,
+				     &indexed);
+		linear_foreach(start_handle, end_handle, NULL, &linear);
+
+		if (visit_cmp(&indexed, &linear)) {
+			TC_ERROR("range 0x%04x-0x%04x: %d attributes, %d "
+				 "expected\n", start_handle, end_handle,
+				 indexed.count, linear.count);
+			return TC_FAIL;
+		}
+
+		for (i = 0; i < ARRAY_SIZE(types); i++) {
+			memset(&indexed, 0, sizeof(indexed));
+			memset(&linear, 0, sizeof(linear));
+			indexed.max = linear.max = max;
+
+			bt_gatt_foreach_attr_type(start_handle, end_handle,
+						  types[i], visit_cb,
+						  &indexed);
+			linear_foreach(start_handle, end_handle, types[i],
+				       &linear);
+
+			if (visit_cmp(&indexed, &linear)) {
+				TC_ERROR("range 0x%04x-0x%04x type %d: %d "
+					 "attributes, %d expected\n",
+					 start_handle, end_handle, i,
+					 indexed.count, linear.count);
+				return TC_FAIL;
+			}
+		}
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Compare all lookups with walks of the database
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int check_lookups(void)
+{
+	const struct bt_gatt_attr *attr;
+	uint16_t start, end, d;
+	int i;
+
+	if (check_range(0x0000, 0xffff) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	for (attr = attrs_0; attr; attr = bt_gatt_attr_next(attr)) {
+		/* Ranges starting at, just after and just before it */
+		for (i = -1; i <= 1; i++) {
+			start = attr->handle + i;
+
+			for (d = 0; d < MAX_RANGE; d++) {
+				if (check_range(start, start + d) != TC_PASS) {
+					return TC_FAIL;
+				}
+			}
+
+			if (check_range(start, 0xffff) != TC_PASS) {
+				return TC_FAIL;
+			}
+		}
+
+		if (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_PRIMARY) &&
+		    bt_uuid_cmp(attr->uuid, BT_UUID_GATT_SECONDARY)) {
+			continue;
+		}
+
+		for (end = attr->handle; end < attr->handle + MAX_RANGE;
+		     end++) {
+			if (bt_gatt_service_end(attr, end) !=
+			    linear_service_end(attr, end)) {
+				TC_ERROR("service 0x%04x ends at 0x%04x, "
+					 "0x%04x expected\n", attr->handle,
+					 bt_gatt_service_end(attr, end),
+					 linear_service_end(attr, end));
+				return TC_FAIL;
+			}
+		}
+
+		if (bt_gatt_service_end(attr, 0xffff) !=
+		    linear_service_end(attr, 0xffff)) {
+			TC_ERROR("service 0x%04x ends at 0x%04x, 0x%04x "
+				 "expected\n", attr->handle,
+				 bt_gatt_service_end(attr, 0xffff),
+				 linear_service_end(attr, 0xffff));
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Register the tables one at a time, checking the lookups each time
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_register(void)
+{
+	const struct bt_gatt_attr *attr;
+	int declarations = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tables); i++) {
+		tables[i].attrs[0].handle = tables[i].first_handle;
+		if (tables[i].hole_index) {
+			tables[i].attrs[tables[i].hole_index].handle =
+				tables[i].hole_handle;
+		}
+
+		if (bt_gatt_register(tables[i].attrs, tables[i].count)) {
+			TC_ERROR("unable to register table %d\n", i);
+			return TC_FAIL;
+		}
+
+		if (check_lookups() != TC_PASS) {
+			TC_ERROR("lookups differ after registering table %d\n",
+				 i);
+			return TC_FAIL;
+		}
+	}
+
+	/* Check that the bounds of both indexes have been exceeded */
+	for (attr = attrs_0; attr; attr = bt_gatt_attr_next(attr)) {
+		for (i = 0; i < INDEXED_TYPES; i++) {
+			if (!bt_uuid_cmp(attr->uuid, types[i])) {
+				declarations++;
+			}
+		}
+	}
+
+	if (declarations <= CONFIG_BLUETOOTH_GATT_INDEX_SIZE ||
+	    ARRAY_SIZE(tables) <= CONFIG_BLUETOOTH_GATT_DYNAMIC_DB_TABLES) {
+		TC_ERROR("%d declarations in %d tables, indexes not filled\n",
+			 declarations, ARRAY_SIZE(tables));
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%d declarations in %d tables checked\n", declarations,
+		 ARRAY_SIZE(tables));
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test Bluetooth GATT indexes");
+
+	TC_PRINT("Test registering attribute tables\n");
+	rv = test_register();
+
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
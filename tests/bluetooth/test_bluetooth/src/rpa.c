@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the resolution of Resolvable Private Addresses
+ *
+ * A fake controller answers the HCI commands of the host, which knows the
+ * IRKs of many paired devices, and floods it with advertising reports.
+ *
+ * Scenario #1
+ * Half of the advertisers use an RPA of a paired device, the others an RPA
+ * none of the IRKs resolves. The scan callback must get the identity address
+ * of the paired devices and the RPA of the others. The time per report is
+ * displayed while the RPAs are first resolved and once they are cached,
+ * along with the time resolving an RPA one IRK after the other takes.
+ *
+ * Scenario #2
+ * The controller supports address resolution. The paired devices are added
+ * to its resolving list until it is full, and the reports of the devices it
+ * resolves must get to the scan callback with their identity address.
+ */
+
+#include <zephyr.h>
+
+#include <errno.h>
+#include <string.h>
+#include <atomic.h>
+#include <tc_util.h>
+#include <misc/byteorder.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/driver.h>
+
+#include "hci_core.h"
+#include "keys.h"
+#include "smp.h"
+
+#include "ctlr.h"
+
+#define NUM_BONDS          CONFIG_BLUETOOTH_MAX_PAIRED
+#define NUM_KNOWN          8
+#define NUM_UNKNOWN        8
+#define NUM_PEERS          (NUM_KNOWN + NUM_UNKNOWN)
+#define REPORTS_PER_EVT    4
+#define NUM_ROUNDS         16
+#define CTLR_RL_SIZE       8
+
+#define TIMEOUT            (sys_clock_ticks_per_sec * 2)
+
+static int ctlr_rl_adds;
+static int ctlr_rl_removes;
+
+/* Identity addresses and IRKs of the paired devices */
+static bt_addr_le_t bonds[NUM_BONDS];
+static uint8_t irks[NUM_BONDS][16];
+
+/* Addresses advertised, and the ones the scan callback must get */
+static bt_addr_le_t peers[NUM_PEERS];
+static const bt_addr_le_t *expected[NUM_PEERS];
+
+static int reports;
+static int reports_expected;
+static int mismatches;
+static struct nano_sem reports_done;
+
+static void ctlr_cmd(uint16_t opcode, uint8_t *rp)
+{
+	switch (opcode) {
+	case BT_HCI_OP_LE_READ_LOCAL_FEATURES:
+		((struct bt_hci_rp_le_read_local_features *)rp)->features[0] =
+			BT_HCI_LE_PRIVACY;
+		break;
+	case BT_HCI_OP_LE_READ_RL_SIZE:
+		((struct bt_hci_rp_le_read_rl_size *)rp)->rl_size =
+			CTLR_RL_SIZE;
+		break;
+	case BT_HCI_OP_LE_ADD_DEV_TO_RL:
+		ctlr_rl_adds++;
+		break;
+	case BT_HCI_OP_LE_REM_DEV_FROM_RL:
+		ctlr_rl_removes++;
+		break;
+	default:
+		break;
+	}
+}
+
+static const struct ctlr_hooks hooks = {
+	.cmd = ctlr_cmd,
+};
+
+static void ctlr_adv_reports(const bt_addr_le_t *addrs, uint8_t count)
+{
+	struct bt_hci_evt_le_meta_event *meta;
+	struct bt_hci_ev_le_advertising_info *info;
+	struct net_buf *buf;
+	uint8_t *data;
+	int i;
+
+	buf = bt_buf_get_evt();
+	meta = ctlr_evt_add(buf, BT_HCI_EVT_LE_META_EVENT,
+			    sizeof(*meta) + 1 + count * (sizeof(*info) + 1));
+	meta->subevent = BT_HCI_EVT_LE_ADVERTISING_REPORT;
+
+	data = (uint8_t *)(meta + 1);
+	*data++ = count;
+
+	for (i = 0; i < count; i++) {
+		info = (void *)data;
+		info->evt_type = BT_LE_ADV_NONCONN_IND;
+		bt_addr_le_copy(&info->addr, &addrs[i]);
+		info->length = 0;
+		/* RSSI */
+		info->data[0] = -50;
+
+		data += sizeof(*info) + 1;
+	}
+
+	bt_recv(buf);
+}
+
+/**
+ *
+ * @brief Flood the host with reports from all the peers
+ *
+ * @param rounds Number of reports per peer.
+ *
+ * @return Number of cycles taken per report
+ */
+static uint32_t ctlr_adv_flood(int rounds)
+{
+	uint32_t cycles;
+	int i, j;
+
+	reports_expected = reports + rounds * NUM_PEERS;
+
+	cycles = sys_cycle_get_32();
+	for (i = 0; i < rounds; i++) {
+		for (j = 0; j < NUM_PEERS; j += REPORTS_PER_EVT) {
+			ctlr_adv_reports(&peers[j], REPORTS_PER_EVT);
+		}
+	}
+
+	if (!nano_task_sem_take(&reports_done, TIMEOUT)) {
+		TC_ERROR("%d reports missing\n", reports_expected - reports);
+		return 0;
+	}
+
+	cycles = sys_cycle_get_32() - cycles;
+
+	return cycles / (rounds * NUM_PEERS);
+}
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi,
+			 uint8_t adv_type, const uint8_t *adv_data,
+			 uint8_t len)
+{
+	if (bt_addr_le_cmp(addr, expected[reports % NUM_PEERS])) {
+		mismatches++;
+	}
+
+	if (++reports == reports_expected) {
+		nano_fiber_sem_give(&reports_done);
+	}
+}
+
+/**
+ *
+ * @brief Pair with the devices, each one getting its own IRK
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_bond(void)
+{
+	struct bt_keys *keys;
+	int i;
+
+	for (i = 0; i < NUM_BONDS; i++) {
+		bonds[i].type = BT_ADDR_LE_PUBLIC;
+		memset(&bonds[i].a, i + 1, sizeof(bonds[i].a));
+		memset(irks[i], i + 1, sizeof(irks[i]));
+
+		keys = bt_keys_get_type(BT_KEYS_IRK, &bonds[i]);
+		if (!keys) {
+			TC_ERROR("unable to get keys for bond %d\n", i);
+			return TC_FAIL;
+		}
+
+		bt_keys_set_irk(keys, irks[i]);
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Resolve the RPAs of a flood of advertising reports
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_resolve(void)
+{
+	uint32_t cycles, cold, warm;
+	uint8_t irk[16];
+	int i;
+
+	/* RPAs of paired devices spread over the pool of keys */
+	for (i = 0; i < NUM_KNOWN; i++) {
+		peers[i].type = BT_ADDR_LE_RANDOM;
+		bt_smp_create_rpa(irks[i * NUM_BONDS / NUM_KNOWN], &peers[i].a);
+		expected[i] = &bonds[i * NUM_BONDS / NUM_KNOWN];
+	}
+
+	/* RPAs of devices which are not paired */
+	for (i = NUM_KNOWN; i < NUM_PEERS; i++) {
+		memset(irk, 0xa0 + i, sizeof(irk));
+		peers[i].type = BT_ADDR_LE_RANDOM;
+		bt_smp_create_rpa(irk, &peers[i].a);
+		expected[i] = &peers[i];
+	}
+
+	if (bt_le_scan_start(BT_LE_SCAN_PARAM(BT_HCI_LE_SCAN_PASSIVE,
+					      BT_HCI_LE_SCAN_FILTER_DUP_DISABLE,
+					      BT_GAP_SCAN_FAST_INTERVAL,
+					      BT_GAP_SCAN_FAST_WINDOW),
+			     device_found)) {
+		TC_ERROR("unable to start scanning\n");
+		return TC_FAIL;
+	}
+
+	cold = ctlr_adv_flood(1);
+	warm = ctlr_adv_flood(NUM_ROUNDS);
+
+	if (!cold || !warm) {
+		return TC_FAIL;
+	}
+
+	if (mismatches) {
+		TC_ERROR("%d reports with a wrong address\n", mismatches);
+		return TC_FAIL;
+	}
+
+	/* What a report of a device which is not paired used to cost */
+	cycles = sys_cycle_get_32();
+	for (i = 0; i < NUM_BONDS; i++) {
+		bt_smp_irk_matches(irks[i], &peers[NUM_KNOWN].a);
+	}
+	cycles = sys_cycle_get_32() - cycles;
+
+	TC_PRINT("%d IRKs, %d reports from %d devices, %d of them paired\n",
+		 NUM_BONDS, reports, NUM_PEERS, NUM_KNOWN);
+	TC_PRINT(" first reports: %u cycles/report\n", cold);
+	TC_PRINT(" cached RPAs: %u cycles/report\n", warm);
+	TC_PRINT(" unresolved RPA, key expanded per IRK: %u cycles\n", cycles);
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Offload the resolution to the controller resolving list
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_resolving_list(void)
+{
+	struct bt_keys *keys;
+	int added = 0;
+	int i;
+
+	for (i = 0; i < NUM_BONDS; i++) {
+		keys = bt_keys_find(BT_KEYS_IRK, &bonds[i]);
+		if (!bt_le_rl_add(keys)) {
+			added++;
+		}
+	}
+
+	if (added != CTLR_RL_SIZE || ctlr_rl_adds != CTLR_RL_SIZE) {
+		TC_ERROR("%d devices added to a resolving list of %d\n",
+			 ctlr_rl_adds, CTLR_RL_SIZE);
+		return TC_FAIL;
+	}
+
+	/* The controller reports the identity of the devices it resolved */
+	for (i = 0; i < NUM_PEERS; i++) {
+		bt_addr_le_copy(&peers[i], &bonds[i % CTLR_RL_SIZE]);
+		peers[i].type = BT_ADDR_LE_PUBLIC_ID;
+		expected[i] = &bonds[i % CTLR_RL_SIZE];
+	}
+
+	mismatches = 0;
+	if (!ctlr_adv_flood(1)) {
+		return TC_FAIL;
+	}
+
+	if (mismatches) {
+		TC_ERROR("%d reports with a wrong address\n", mismatches);
+		return TC_FAIL;
+	}
+
+	/* Unpairing makes room for another device */
+	keys = bt_keys_find(BT_KEYS_IRK, &bonds[0]);
+	bt_keys_clear(keys, BT_KEYS_ALL);
+
+	keys = bt_keys_find(BT_KEYS_IRK, &bonds[CTLR_RL_SIZE]);
+	if (ctlr_rl_removes != 1 || bt_le_rl_add(keys)) {
+		TC_ERROR("resolving list entry not released\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Entry point to RPA resolution tests
+ *
+ * @return N/A
+ */
+void main(void)
+{
+	int rv;
+
+	TC_START("Test Bluetooth RPA resolution");
+
+	nano_sem_init(&reports_done);
+
+	ctlr_init(&hooks);
+
+	rv = bt_enable(NULL);
+	if (rv) {
+		TC_ERROR("Bluetooth init failed (err %d)\n", rv);
+		rv = TC_FAIL;
+		goto exit;
+	}
+
+	TC_PRINT("Test pairing with %d devices\n", NUM_BONDS);
+	rv = test_bond();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test resolving a flood of advertising reports\n");
+	rv = test_resolve();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test controller resolving list\n");
+	rv = test_resolving_list();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
@@ -39,6 +39,7 @@
   - AES128 NIST encryption test
   - AES128 NIST fixed-key and variable-text
   - AES128 NIST variable-key and fixed-text
+  - AES128 multiple blocks encryption, and encryption speed
 */
 
 #include <tinycrypt/aes.h>
@@ -52,9 +53,12 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <misc/printk.h>
+#include <zephyr.h>
 
 #define NUM_OF_NIST_KEYS 16
 #define NUM_OF_FIXED_KEYS 128
+#define NUM_OF_BLOCKS 7
+#define NUM_OF_SPEED_ROUNDS 64
 
 /*
  * NIST test key schedule.
@@ -2032,6 +2036,70 @@ uint32_t test_4(void)
         return result;
 }
 
+/*
+ * Encryption of several blocks in one call, compared with the encryption of
+ * each block on its own. An odd number of blocks is used, so implementations
+ * working on pairs of blocks also encrypt a lone one.
+ */
+uint32_t test_5(void)
+{
+        const uint8_t nist_key[NUM_OF_NIST_KEYS] = {
+                0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+        };
+        struct tc_aes_key_sched_struct s;
+        uint8_t in[NUM_OF_BLOCKS * TC_AES_BLOCK_SIZE];
+        uint8_t expected[NUM_OF_BLOCKS * TC_AES_BLOCK_SIZE];
+        uint8_t out[NUM_OF_BLOCKS * TC_AES_BLOCK_SIZE];
+        uint32_t result = TC_PASS;
+        uint32_t cycles;
+        uint32_t i;
+
+        TC_PRINT("AES128 %s (multiple blocks encryption):\n", __func__);
+        (void)tc_aes128_set_encrypt_key(&s, nist_key);
+
+        for (i = 0; i < sizeof(in); ++i) {
+                in[i] = (uint8_t)(i * 7 + 1);
+        }
+        for (i = 0; i < NUM_OF_BLOCKS; ++i) {
+                (void)tc_aes_encrypt(&expected[i * TC_AES_BLOCK_SIZE],
+                                     &in[i * TC_AES_BLOCK_SIZE], &s);
+        }
+
+        if (tc_aes_encrypt_blocks(out, in, NUM_OF_BLOCKS, &s) == 0) {
+                TC_ERROR("AES128 %s (multiple blocks encryption) failed.\n",
+                         __func__);
+                result = TC_FAIL;
+                goto exitTest5;
+        }
+        result = check_result(5, expected, sizeof(expected),
+                              out, sizeof(out), 1);
+        if (result == TC_FAIL) {
+                goto exitTest5;
+        }
+
+        /* in place */
+        (void)memcpy(out, in, sizeof(out));
+        (void)tc_aes_encrypt_blocks(out, out, NUM_OF_BLOCKS, &s);
+        result = check_result(5, expected, sizeof(expected),
+                              out, sizeof(out), 1);
+        if (result == TC_FAIL) {
+                goto exitTest5;
+        }
+
+        cycles = sys_cycle_get_32();
+        for (i = 0; i < NUM_OF_SPEED_ROUNDS; ++i) {
+                (void)tc_aes_encrypt_blocks(out, out, NUM_OF_BLOCKS, &s);
+        }
+        cycles = sys_cycle_get_32() - cycles;
+        TC_PRINT("\t%u cycles/byte\n",
+                 cycles / (NUM_OF_SPEED_ROUNDS * (uint32_t)sizeof(out)));
+
+ exitTest5:
+        TC_END_RESULT(result);
+        return result;
+}
+
 /*
  * Main task to test AES
  */
@@ -2066,6 +2134,11 @@ void main(void)
                 TC_ERROR("AES128 test #4 (NIST variable-key and fixed-text) failed.\n");
                 goto exitTest;
         }
+        result = test_5();
+        if (result == TC_FAIL) { /* terminate test */
+                TC_ERROR("AES128 test #5 (multiple blocks encryption) failed.\n");
+                goto exitTest;
+        }
 
         TC_PRINT("All AES128 tests succeeded!\n");
 
@@ -0,0 +1,295 @@
+/* test_ecc_dh.c - TinyCrypt implementation of some ECC-DH tests */
+
+/*
+ *  Copyright (C) 2016 by Intel Corporation, All Rights Reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *    - Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *    - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ *    - Neither the name of Intel Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+  DESCRIPTION
+  This module tests the following ECC-DH routines:
+
+  Scenarios tested include:
+  - ECC-DH key generation (Bluetooth LE Secure Connections debug key)
+  - ECC-DH shared secret (NIST CAVS test vector)
+  - ECC-DH agreement of random key pairs
+  - ECC-DH key generation and shared secret speed
+*/
+
+#include <tinycrypt/ecc_dh.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+#include <drivers/rand32.h>
+#include <zephyr.h>
+
+#include <string.h>
+
+#define NUM_OF_RANDOM_KEYS 4
+
+/*
+ * Bluetooth Core Specification 4.2, Vol 3, Part H, 2.3.5.6.1: debug key pair.
+ */
+uint32_t test_1(void)
+{
+        uint8_t private[NUM_ECC_BYTES] = {
+                0x3f, 0x49, 0xf6, 0xd4, 0xa3, 0xc5, 0x5f, 0x38,
+                0x74, 0xc9, 0xb3, 0xe3, 0xd2, 0x10, 0x3f, 0x50,
+                0x4a, 0xff, 0x60, 0x7b, 0xeb, 0x40, 0xb7, 0x99,
+                0x58, 0x99, 0xb8, 0xa6, 0xcd, 0x3c, 0x1a, 0xbd
+        };
+        const uint8_t expected_x[NUM_ECC_BYTES] = {
+                0x20, 0xb0, 0x03, 0xd2, 0xf2, 0x97, 0xbe, 0x2c,
+                0x5e, 0x2c, 0x83, 0xa7, 0xe9, 0xf9, 0xa5, 0xb9,
+                0xef, 0xf4, 0x91, 0x11, 0xac, 0xf4, 0xfd, 0xdb,
+                0xcc, 0x03, 0x01, 0x48, 0x0e, 0x35, 0x9d, 0xe6
+        };
+        const uint8_t expected_y[NUM_ECC_BYTES] = {
+                0xdc, 0x80, 0x9c, 0x49, 0x65, 0x2a, 0xeb, 0x6d,
+                0x63, 0x32, 0x9a, 0xbf, 0x5a, 0x52, 0x15, 0x5c,
+                0x76, 0x63, 0x45, 0xc2, 0x8f, 0xed, 0x30, 0x24,
+                0x74, 0x1c, 0x8e, 0xd0, 0x15, 0x89, 0xd2, 0x8b
+        };
+        uint32_t random[NUM_ECC_DIGITS];
+        uint32_t private_key[NUM_ECC_DIGITS];
+        uint8_t out[NUM_ECC_BYTES];
+        EccPoint public_key;
+        uint32_t result = TC_PASS;
+
+        TC_PRINT("ECC-DH %s (key generation, Bluetooth debug key):\n",
+                 __func__);
+
+        ecc_bytes2native(random, private);
+        if (ecc_make_key(&public_key, private_key, random) == TC_CRYPTO_FAIL) {
+                TC_ERROR("ecc_make_key failed in %s.\n", __func__);
+                result = TC_FAIL;
+                goto exitTest1;
+        }
+
+        ecc_native2bytes(out, public_key.x);
+        result = check_result(1, expected_x, sizeof(expected_x),
+                              out, sizeof(out), 1);
+        if (result == TC_FAIL) {
+                goto exitTest1;
+        }
+
+        ecc_native2bytes(out, public_key.y);
+        result = check_result(1, expected_y, sizeof(expected_y),
+                              out, sizeof(out), 1);
+
+ exitTest1:
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * NIST CAVS ECC CDH primitive test vector (P-256, COUNT = 0).
+ */
+uint32_t test_2(void)
+{
+        uint8_t remote_x[NUM_ECC_BYTES] = {
+                0x70, 0x0c, 0x48, 0xf7, 0x7f, 0x56, 0x58, 0x4c,
+                0x5c, 0xc6, 0x32, 0xca, 0x65, 0x64, 0x0d, 0xb9,
+                0x1b, 0x6b, 0xac, 0xce, 0x3a, 0x4d, 0xf6, 0xb4,
+                0x2c, 0xe7, 0xcc, 0x83, 0x88, 0x33, 0xd2, 0x87
+        };
+        uint8_t remote_y[NUM_ECC_BYTES] = {
+                0xdb, 0x71, 0xe5, 0x09, 0xe3, 0xfd, 0x9b, 0x06,
+                0x0d, 0xdb, 0x20, 0xba, 0x5c, 0x51, 0xdc, 0xc5,
+                0x94, 0x8d, 0x46, 0xfb, 0xf6, 0x40, 0xdf, 0xe0,
+                0x44, 0x17, 0x82, 0xca, 0xb8, 0x5f, 0xa4, 0xac
+        };
+        uint8_t private[NUM_ECC_BYTES] = {
+                0x7d, 0x7d, 0xc5, 0xf7, 0x1e, 0xb2, 0x9d, 0xda,
+                0xf8, 0x0d, 0x62, 0x14, 0x63, 0x2e, 0xea, 0xe0,
+                0x3d, 0x90, 0x58, 0xaf, 0x1f, 0xb6, 0xd2, 0x2e,
+                0xd8, 0x0b, 0xad, 0xb6, 0x2b, 0xc1, 0xa5, 0x34
+        };
+        const uint8_t expected[NUM_ECC_BYTES] = {
+                0x46, 0xfc, 0x62, 0x10, 0x64, 0x20, 0xff, 0x01,
+                0x2e, 0x54, 0xa4, 0x34, 0xfb, 0xdd, 0x2d, 0x25,
+                0xcc, 0xc5, 0x85, 0x20, 0x60, 0x56, 0x1e, 0x68,
+                0x04, 0x0d, 0xd7, 0x77, 0x89, 0x97, 0xbd, 0x7b
+        };
+        uint32_t private_key[NUM_ECC_DIGITS];
+        uint32_t secret[NUM_ECC_DIGITS];
+        uint8_t out[NUM_ECC_BYTES];
+        EccPoint remote;
+        uint32_t result = TC_PASS;
+
+        TC_PRINT("ECC-DH %s (shared secret, NIST CAVS test vector):\n",
+                 __func__);
+
+        ecc_bytes2native(remote.x, remote_x);
+        ecc_bytes2native(remote.y, remote_y);
+        ecc_bytes2native(private_key, private);
+
+        if (ecc_valid_public_key(&remote) != 0) {
+                TC_ERROR("ecc_valid_public_key failed in %s.\n", __func__);
+                result = TC_FAIL;
+                goto exitTest2;
+        }
+
+        if (ecdh_shared_secret(secret, &remote, private_key) == TC_CRYPTO_FAIL) {
+                TC_ERROR("ecdh_shared_secret failed in %s.\n", __func__);
+                result = TC_FAIL;
+                goto exitTest2;
+        }
+
+        ecc_native2bytes(out, secret);
+        result = check_result(2, expected, sizeof(expected),
+                              out, sizeof(out), 1);
+
+ exitTest2:
+        TC_END_RESULT(result);
+        return result;
+}
+
+static void random_key(uint32_t *random)
+{
+        uint32_t i;
+
+        for (i = 0; i < NUM_ECC_DIGITS; ++i) {
+                random[i] = sys_rand32_get();
+        }
+}
+
+/*
+ * Both sides of key agreements with random key pairs compute the same secret.
+ */
+uint32_t test_3(void)
+{
+        uint32_t random[NUM_ECC_DIGITS];
+        uint32_t private_a[NUM_ECC_DIGITS];
+        uint32_t private_b[NUM_ECC_DIGITS];
+        uint32_t secret_a[NUM_ECC_DIGITS];
+        uint32_t secret_b[NUM_ECC_DIGITS];
+        EccPoint public_a;
+        EccPoint public_b;
+        uint32_t result = TC_PASS;
+        uint32_t i;
+
+        TC_PRINT("ECC-DH %s (random key pairs agreement):\n", __func__);
+
+        for (i = 0; i < NUM_OF_RANDOM_KEYS; ++i) {
+                random_key(random);
+                (void)ecc_make_key(&public_a, private_a, random);
+                random_key(random);
+                (void)ecc_make_key(&public_b, private_b, random);
+
+                if (ecc_valid_public_key(&public_a) != 0 ||
+                    ecc_valid_public_key(&public_b) != 0) {
+                        TC_ERROR("invalid public key in %s.\n", __func__);
+                        result = TC_FAIL;
+                        break;
+                }
+
+                (void)ecdh_shared_secret(secret_a, &public_b, private_a);
+                (void)ecdh_shared_secret(secret_b, &public_a, private_b);
+
+                result = check_result(3, secret_a, sizeof(secret_a),
+                                      secret_b, sizeof(secret_b), 1);
+                if (result == TC_FAIL) {
+                        break;
+                }
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Speed of the key generation (fixed-base multiplication) and of the shared
+ * secret computation (variable-base multiplication).
+ */
+uint32_t test_4(void)
+{
+        uint32_t random[NUM_ECC_DIGITS];
+        uint32_t private_a[NUM_ECC_DIGITS];
+        uint32_t private_b[NUM_ECC_DIGITS];
+        uint32_t secret[NUM_ECC_DIGITS];
+        EccPoint public_a;
+        EccPoint public_b;
+        uint32_t cycles;
+
+        TC_PRINT("ECC-DH %s (speed):\n", __func__);
+
+        random_key(random);
+        (void)ecc_make_key(&public_b, private_b, random);
+
+        random_key(random);
+        cycles = sys_cycle_get_32();
+        (void)ecc_make_key(&public_a, private_a, random);
+        cycles = sys_cycle_get_32() - cycles;
+        TC_PRINT("\tecc_make_key: %u cycles\n", cycles);
+
+        cycles = sys_cycle_get_32();
+        (void)ecdh_shared_secret(secret, &public_b, private_a);
+        cycles = sys_cycle_get_32() - cycles;
+        TC_PRINT("\tecdh_shared_secret: %u cycles\n", cycles);
+
+        TC_END_RESULT(TC_PASS);
+        return TC_PASS;
+}
+
+/*
+ * Main task to test ECC-DH
+ */
+
+#ifdef CONFIG_MICROKERNEL
+void mainloop(void)
+#else
+void main(void)
+#endif
+{
+        uint32_t result = TC_PASS;
+
+        TC_START("Performing ECC-DH tests:");
+
+        result = test_1();
+        if (result == TC_FAIL) { /* terminate test */
+                TC_ERROR("ECC-DH test #1 (key generation) failed.\n");
+                goto exitTest;
+        }
+        result = test_2();
+        if (result == TC_FAIL) { /* terminate test */
+                TC_ERROR("ECC-DH test #2 (shared secret) failed.\n");
+                goto exitTest;
+        }
+        result = test_3();
+        if (result == TC_FAIL) { /* terminate test */
+                TC_ERROR("ECC-DH test #3 (random key pairs agreement) failed.\n");
+                goto exitTest;
+        }
+        result = test_4();
+
+        TC_PRINT("All ECC-DH tests succeeded!\n");
+
+ exitTest:
+        TC_END_RESULT(result);
+        TC_END_REPORT(result);
+}
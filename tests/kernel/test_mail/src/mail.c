@@ -26,6 +26,9 @@
  *    task_mbox_data_get
  *    task_mbox_data_block_get
  *
+ *    task_mbox_handoff_put
+ *    task_mbox_handoff_get
+ *
  * The module does NOT test the following mailbox APIs:
  *
  *    task_mbox_block_put
@@ -74,6 +77,8 @@ DEFINE_MAILBOX(noRcvrMbox);
 extern kmemory_pool_t testPool;
 extern kmemory_pool_t smallBlkszPool;
 
+static void *handoffData; /* data of the block handed over by the sender */
+
 /**
  *
  * @brief Sets various fields in the message for the sender
@@ -157,7 +162,7 @@ static void setMsg_RecvBuf(struct k_msg *inMsg, char *inBuffer, uint32_t inBuffe
  *
  * @brief Task that tests sending of mailbox messages
  *
- * This routine exercises the task_mbox_put() API.
+ * This routine exercises the task_mbox_put() and task_mbox_handoff_put() APIs.
  *
  * @return TC_PASS or TC_FAIL
  */
@@ -351,6 +356,47 @@ int MsgSenderTask(void)
 	TC_PRINT("%s: task_mbox_put(timeout) for long-duration receive test is OK\n",
 		__func__);
 
+	/* Hand a memory pool block over to the receiver */
+
+	retValue = task_mem_pool_alloc(&MSTmsg.tx_block, testPool, MSGSIZE,
+				       TICKS_UNLIMITED);
+	if (RC_OK != retValue) {
+		TC_ERROR("task_mem_pool_alloc for handoff test returned %d\n",
+			retValue);
+		return TC_FAIL;
+	}
+	memcpy(MSTmsg.tx_block.pointer_to_data, myData4, MSGSIZE);
+	handoffData = MSTmsg.tx_block.pointer_to_data;
+
+	setMsg_Sender(&MSTmsg, myMbox, msgRcvrTask, NULL, MSGSIZE, MSG_INFO1);
+	retValue = task_mbox_handoff_put(myMbox, XFER_PRIO, &MSTmsg,
+					 TICKS_UNLIMITED);
+	if (RC_OK != retValue) {
+		TC_ERROR("task_mbox_handoff_put returned %d\n", retValue);
+		return TC_FAIL;
+	}
+	if (MSTmsg.size != MSGSIZE) {
+		TC_ERROR("task_mbox_handoff_put got wrong size (%d)\n",
+			MSTmsg.size);
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%s: task_mbox_handoff_put(TICKS_UNLIMITED) of block is OK\n",
+		__func__);
+
+	/* Send message used in copying handoff receive test */
+
+	setMsg_Sender(&MSTmsg, myMbox, msgRcvrTask, myData1, MSGSIZE, MSG_INFO2);
+	retValue = task_mbox_put(myMbox, XFER_PRIO, &MSTmsg, TICKS_UNLIMITED);
+	if (RC_OK != retValue) {
+		TC_ERROR("task_mbox_put for copying handoff receive test returned %d\n",
+			retValue);
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%s: task_mbox_put(TICKS_UNLIMITED) for copying handoff receive test is OK\n",
+		__func__);
+
 	return TC_PASS;
 }
 
@@ -678,5 +724,53 @@ int MsgRcvrTask(void)
 			__func__);
 	TC_PRINT("%s: task_mbox_data_get of message data #3 is OK\n", __func__);
 
+	/* Receive block handed over by the sender */
+
+	setMsg_Receiver(&MRTmsg, myMbox, msgSenderTask, NULL, MSGSIZE);
+	retValue = task_mbox_handoff_get(myMbox, &MRTmsg, &MRTblock, testPool,
+					 TICKS_UNLIMITED);
+	if (RC_OK != retValue) {
+		TC_ERROR("task_mbox_handoff_get of block returned %d\n", retValue);
+		return TC_FAIL;
+	}
+	if (MRTblock.pointer_to_data != handoffData) {
+		TC_ERROR("task_mbox_handoff_get did not get the sender's block\n");
+		return TC_FAIL;
+	}
+	if (MRTmsg.info != MSG_INFO1) {
+		TC_ERROR("task_mbox_handoff_get of block got wrong info (%d)\n",
+			MRTmsg.info);
+		return TC_FAIL;
+	}
+	if (strcmp(MRTblock.pointer_to_data, myData4) != 0) {
+		TC_ERROR("task_mbox_handoff_get of block got wrong data (%s)\n",
+			MRTblock.pointer_to_data);
+		return TC_FAIL;
+	}
+	task_mem_pool_free(&MRTblock);
+
+	TC_PRINT("%s: task_mbox_handoff_get(TICKS_UNLIMITED) of block is OK\n",
+		__func__);
+
+	/* Receive message sent from a buffer into a block */
+
+	setMsg_Receiver(&MRTmsg, myMbox, msgSenderTask, NULL, MSGSIZE);
+	retValue = task_mbox_handoff_get(myMbox, &MRTmsg, &MRTblock, testPool,
+					 TICKS_UNLIMITED);
+	if (RC_OK != retValue) {
+		TC_ERROR("task_mbox_handoff_get of copied message returned %d\n",
+			retValue);
+		return TC_FAIL;
+	}
+	if (strcmp(MRTblock.pointer_to_data, myData1) != 0) {
+		TC_ERROR("task_mbox_handoff_get of copied message got wrong data (%s)\n",
+			MRTblock.pointer_to_data);
+		return TC_FAIL;
+	}
+	task_mem_pool_free(&MRTblock);
+
+	TC_PRINT("%s: task_mbox_handoff_get(TICKS_UNLIMITED) of copied message is OK\n",
+		__func__);
+
 	return TC_PASS;
 }
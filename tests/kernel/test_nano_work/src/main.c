@@ -34,6 +34,10 @@
 
 #define FIBER_STACK_SIZE	1024
 
+#define WORKER_PRIORITY		10
+#define NUM_WORKERS		4
+#define NUM_BENCH_ITEMS		64
+
 struct test_item {
 	int key;
 	struct nano_delayed_work work;
@@ -46,6 +50,22 @@ static struct test_item tests[NUM_TEST_ITEMS];
 static int results[NUM_TEST_ITEMS];
 static int num_results;
 
+static char __stack worker_stacks[NUM_WORKERS][FIBER_STACK_SIZE];
+
+static struct nano_workqueue single_wq;
+static struct nano_workqueue multi_wq;
+static struct nano_workqueue sibling_wq;
+
+struct bench_item {
+	struct nano_work work;
+	uint32_t submitted;
+};
+
+static struct bench_item bench_items[NUM_BENCH_ITEMS];
+static struct nano_sem bench_sem;
+static uint32_t bench_latency;
+static int bench_done;
+
 static void work_handler(struct nano_work *work)
 {
 	struct test_item *ti = CONTAINER_OF(work, struct test_item, work);
@@ -347,6 +367,144 @@ static int test_delayed(void)
 	return check_results(NUM_TEST_ITEMS);
 }
 
+static const struct fiber_config *worker_config(int i)
+{
+	static struct fiber_config configs[NUM_WORKERS];
+
+	configs[i].stack = worker_stacks[i];
+	configs[i].stack_size = FIBER_STACK_SIZE;
+	configs[i].prio = WORKER_PRIORITY;
+
+	return &configs[i];
+}
+
+static void short_work_handler(struct nano_work *work)
+{
+	struct test_item *ti = CONTAINER_OF(work, struct test_item, work);
+
+	TC_PRINT(" - Running short test item %d\n", ti->key);
+
+	results[num_results++] = ti->key;
+}
+
+static void test_item_init(int i, int key, work_handler_t handler)
+{
+	tests[i].key = key;
+	nano_work_init(&tests[i].work.work, handler);
+}
+
+static int test_priority(void)
+{
+	TC_PRINT("Starting priority test\n");
+
+	nano_task_workqueue_start(&single_wq, worker_config(0));
+
+	test_item_init(0, 1, work_handler);
+	test_item_init(1, 3, short_work_handler);
+	test_item_init(2, 2, short_work_handler);
+	nano_work_priority_set(&tests[2].work.work, NANO_WORK_PRIO_HIGHEST);
+
+	/* The worker starts the first item, the others wait behind it */
+	TC_PRINT(" - Submitting low then high priority work\n");
+	nano_work_submit_to_queue(&single_wq, &tests[0].work.work);
+	nano_work_submit_to_queue(&single_wq, &tests[1].work.work);
+	nano_work_submit_to_queue(&single_wq, &tests[2].work.work);
+
+	TC_PRINT(" - Waiting for work to finish\n");
+	task_sleep(2 * WORK_ITEM_WAIT);
+
+	TC_PRINT(" - Checking results\n");
+	return check_results(3);
+}
+
+static int test_workers(void)
+{
+	TC_PRINT("Starting multiple workers test\n");
+
+	nano_task_workqueue_start(&multi_wq, worker_config(1));
+	nano_workqueue_worker_add(&multi_wq, worker_config(2));
+
+	test_item_init(0, 2, work_handler);
+	test_item_init(1, 1, short_work_handler);
+
+	/* The short item must not wait for the long one */
+	TC_PRINT(" - Submitting long then short work\n");
+	nano_work_submit_to_queue(&multi_wq, &tests[0].work.work);
+	nano_work_submit_to_queue(&multi_wq, &tests[1].work.work);
+
+	TC_PRINT(" - Waiting for work to finish\n");
+	task_sleep(2 * WORK_ITEM_WAIT);
+
+	TC_PRINT(" - Checking results\n");
+	return check_results(2);
+}
+
+static int test_stealing(void)
+{
+	TC_PRINT("Starting work stealing test\n");
+
+	nano_task_workqueue_start(&sibling_wq, worker_config(3));
+	nano_workqueue_sibling_add(&single_wq, &sibling_wq);
+
+	test_item_init(0, 2, work_handler);
+	test_item_init(1, 1, short_work_handler);
+
+	/* The worker of the sibling takes the short item */
+	TC_PRINT(" - Submitting long then short work\n");
+	nano_work_submit_to_queue(&single_wq, &tests[0].work.work);
+	nano_work_submit_to_queue(&single_wq, &tests[1].work.work);
+
+	TC_PRINT(" - Waiting for work to finish\n");
+	task_sleep(2 * WORK_ITEM_WAIT);
+
+	TC_PRINT(" - Checking results\n");
+	return check_results(2);
+}
+
+static void bench_work_handler(struct nano_work *work)
+{
+	struct bench_item *item = CONTAINER_OF(work, struct bench_item, work);
+
+	bench_latency += sys_cycle_get_32() - item->submitted;
+
+	if (++bench_done == NUM_BENCH_ITEMS) {
+		nano_fiber_sem_give(&bench_sem);
+	}
+}
+
+static int test_throughput(void)
+{
+	uint32_t start, cycles;
+	int i;
+
+	TC_PRINT("Starting throughput test\n");
+
+	nano_sem_init(&bench_sem);
+	bench_latency = 0;
+	bench_done = 0;
+
+	start = sys_cycle_get_32();
+
+	for (i = 0; i < NUM_BENCH_ITEMS; i++) {
+		nano_work_init(&bench_items[i].work, bench_work_handler);
+		bench_items[i].submitted = sys_cycle_get_32();
+		nano_work_submit_to_queue(&multi_wq, &bench_items[i].work);
+	}
+
+	if (!nano_task_sem_take(&bench_sem, sys_clock_ticks_per_sec)) {
+		TC_ERROR("*** work items finished: %d (expected: %d)\n",
+			 bench_done, NUM_BENCH_ITEMS);
+		return TC_FAIL;
+	}
+
+	cycles = sys_cycle_get_32() - start;
+
+	TC_PRINT(" - %d work items in %u cycles, %u cycles latency\n",
+		 NUM_BENCH_ITEMS, cycles, bench_latency / NUM_BENCH_ITEMS);
+
+	return TC_PASS;
+}
+
 void main(void)
 {
 	int status = TC_FAIL;
@@ -385,6 +543,28 @@ void main(void)
 		goto end;
 	}
 
+	reset_results();
+
+	if (test_priority() != TC_PASS) {
+		goto end;
+	}
+
+	reset_results();
+
+	if (test_workers() != TC_PASS) {
+		goto end;
+	}
+
+	reset_results();
+
+	if (test_stealing() != TC_PASS) {
+		goto end;
+	}
+
+	if (test_throughput() != TC_PASS) {
+		goto end;
+	}
+
 	status = TC_PASS;
 
 end:
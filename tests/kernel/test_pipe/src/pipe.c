@@ -22,6 +22,11 @@
  *
  *    task_pipe_put()
  *    task_pipe_get()
+ *    task_pipe_put_iov()
+ *    task_pipe_put_reserve()
+ *    task_pipe_put_commit()
+ *    task_pipe_get_peek()
+ *    task_pipe_get_consume()
  *
  * The following target pipe routine does not yet have a test case:
  *    task_pipe_block_put()
@@ -30,6 +35,7 @@
 #include <zephyr.h>
 #include <tc_util.h>
 #include <misc/util.h>
+#include <string.h>
 
 #define  ONE_SECOND     (sys_clock_ticks_per_sec)
 
@@ -944,6 +950,188 @@ int pipeGetTimeoutTest(void)
 	return TC_PASS;
 }
 
+/**
+ *
+ * @brief Routine to test task_pipe_put_iov(TICKS_NONE)
+ *
+ * This routine writes segmented data into the empty pipe, reads it back and
+ * checks that the segments were written in order.  An _ALL_N request for
+ * more data than the pipe can hold must not write anything.
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+
+int pipePutIovTest(void)
+{
+	struct k_pipe_iov  iov[3];
+	int  rv;            /* return code from task_pipe_XXX() */
+	int  bytesWritten;  /* # of bytes written by task_pipe_put_iov() */
+	int  bytesRead;     /* # of bytes read from task_pipe_get() */
+
+	/* segments fitting in the pipe buffer */
+	iov[0].data = txBuffer;
+	iov[0].size = 1;
+	iov[1].data = txBuffer + 1;
+	iov[1].size = PIPE_SIZE / 2 - 1;
+	iov[2].data = txBuffer + PIPE_SIZE / 2;
+	iov[2].size = PIPE_SIZE / 2;
+
+	rv = task_pipe_put_iov(pipeId, iov, 3, &bytesWritten,
+			       _ALL_N, TICKS_NONE);
+	if ((rv != RC_OK) || (bytesWritten != PIPE_SIZE)) {
+		TC_ERROR("Expected return code %d, got %d\n"
+				 "Expected <bytesWritten> %d, got %d\n",
+				 RC_OK, rv, PIPE_SIZE, bytesWritten);
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_get(pipeId, rxBuffer, PIPE_SIZE, &bytesRead,
+					   _ALL_N, TICKS_NONE);
+	if ((rv != RC_OK) ||
+		(receiveBufferCheck(rxBuffer, PIPE_SIZE) != PIPE_SIZE)) {
+		TC_ERROR("Segmented data not read back correctly\n");
+		return TC_FAIL;
+	}
+
+	/* segments exceeding the pipe buffer */
+	iov[0].data = txBuffer;
+	iov[0].size = PIPE_SIZE / 2;
+	iov[1].data = txBuffer + PIPE_SIZE / 2;
+	iov[1].size = PIPE_SIZE / 2 + 1;
+
+	rv = task_pipe_put_iov(pipeId, iov, 2, &bytesWritten,
+			       _ALL_N, TICKS_NONE);
+	if ((rv != RC_FAIL) || (bytesWritten != 0)) {
+		TC_ERROR("Expected return code %d, got %d\n"
+				 "Expected <bytesWritten> %d, got %d\n",
+				 RC_FAIL, rv, 0, bytesWritten);
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_get(pipeId, rxBuffer, PIPE_SIZE, &bytesRead,
+					   _0_TO_N, TICKS_NONE);
+	if ((rv != RC_OK) || (bytesRead != 0)) {
+		TC_ERROR("Data written by a failed _ALL_N request\n");
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_put_iov(pipeId, iov, 2, &bytesWritten,
+			       _1_TO_N, TICKS_NONE);
+	if ((rv != RC_OK) || (bytesWritten != PIPE_SIZE)) {
+		TC_ERROR("Expected return code %d, got %d\n"
+				 "Expected <bytesWritten> %d, got %d\n",
+				 RC_OK, rv, PIPE_SIZE, bytesWritten);
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_get(pipeId, rxBuffer, PIPE_SIZE, &bytesRead,
+					   _ALL_N, TICKS_NONE);
+	if ((rv != RC_OK) ||
+		(receiveBufferCheck(rxBuffer, PIPE_SIZE) != PIPE_SIZE)) {
+		TC_ERROR("Segmented data not read back correctly\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Routine to test in place access to the pipe buffer
+ *
+ * This routine tests task_pipe_put_reserve(), task_pipe_put_commit(),
+ * task_pipe_get_peek() and task_pipe_get_consume().  The reserved and peeked
+ * areas may be smaller than requested when they would wrap around the end of
+ * the pipe buffer, so each transfer is done in a loop.
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+
+int pipeInPlaceTest(void)
+{
+	struct k_pipe_span  span;
+	int  rv;            /* return code from task_pipe_XXX() */
+	int  bytesWritten;  /* # of bytes written by task_pipe_put() */
+	int  bytesRead;     /* # of bytes read from task_pipe_get() */
+	int  done;          /* # of bytes transferred so far */
+
+	rv = task_pipe_get_peek(pipeId, &span, PIPE_SIZE);
+	if (rv != RC_FAIL) {
+		TC_ERROR("Expected return code %d, not %d\n", RC_FAIL, rv);
+		return TC_FAIL;
+	}
+
+	/* data being written in place is not visible to readers */
+	rv = task_pipe_put_reserve(pipeId, &span, PIPE_SIZE / 2);
+	if ((rv != RC_OK) || (span.size <= 0) || (span.size > PIPE_SIZE / 2)) {
+		TC_ERROR("Failed to reserve pipe buffer space\n");
+		return TC_FAIL;
+	}
+	memcpy(span.data, txBuffer, span.size);
+
+	rv = task_pipe_get(pipeId, rxBuffer, 1, &bytesRead,
+					   _1_TO_N, TICKS_NONE);
+	if (rv != RC_FAIL) {
+		TC_ERROR("Expected return code %d, not %d\n", RC_FAIL, rv);
+		return TC_FAIL;
+	}
+
+	task_pipe_put_commit(pipeId, &span);
+	done = span.size;
+
+	while (done < PIPE_SIZE / 2) {
+		rv = task_pipe_put_reserve(pipeId, &span, PIPE_SIZE / 2 - done);
+		if (rv != RC_OK) {
+			TC_ERROR("Failed to reserve pipe buffer space\n");
+			return TC_FAIL;
+		}
+		memcpy(span.data, txBuffer + done, span.size);
+		task_pipe_put_commit(pipeId, &span);
+		done += span.size;
+	}
+
+	/* parse the data in place */
+	for (done = 0; done < PIPE_SIZE / 2; done += span.size) {
+		rv = task_pipe_get_peek(pipeId, &span, PIPE_SIZE);
+		if ((rv != RC_OK) || (span.size > PIPE_SIZE / 2 - done) ||
+			(memcmp(span.data, txBuffer + done, span.size) != 0)) {
+			TC_ERROR("Data accessed in place is incorrect\n");
+			return TC_FAIL;
+		}
+		task_pipe_get_consume(pipeId, &span);
+	}
+
+	rv = task_pipe_get_peek(pipeId, &span, PIPE_SIZE);
+	if (rv != RC_FAIL) {
+		TC_ERROR("Expected return code %d, not %d\n", RC_FAIL, rv);
+		return TC_FAIL;
+	}
+
+	/* no space can be reserved in a full pipe */
+	rv = task_pipe_put(pipeId, txBuffer, PIPE_SIZE, &bytesWritten,
+					   _ALL_N, TICKS_NONE);
+	if (rv != RC_OK) {
+		TC_ERROR("Expected return code %d, not %d\n", RC_OK, rv);
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_put_reserve(pipeId, &span, 1);
+	if (rv != RC_FAIL) {
+		TC_ERROR("Expected return code %d, not %d\n", RC_FAIL, rv);
+		return TC_FAIL;
+	}
+
+	rv = task_pipe_get(pipeId, rxBuffer, PIPE_SIZE, &bytesRead,
+					   _ALL_N, TICKS_NONE);
+	if ((rv != RC_OK) ||
+		(receiveBufferCheck(rxBuffer, PIPE_SIZE) != PIPE_SIZE)) {
+		TC_ERROR("Data not read back correctly\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
 /**
  *
  * @brief Alternate task in the test suite
@@ -1042,5 +1230,17 @@ int RegressionTask(void)
 		return TC_FAIL;
 	}
 
+	TC_PRINT("Testing task_pipe_put_iov(TICKS_NONE) ...\n");
+	tcRC = pipePutIovTest();
+	if (tcRC != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	TC_PRINT("Testing in place pipe buffer access ...\n");
+	tcRC = pipeInPlaceTest();
+	if (tcRC != TC_PASS) {
+		return TC_FAIL;
+	}
+
 	return TC_PASS;
 }
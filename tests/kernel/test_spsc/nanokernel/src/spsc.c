@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test nanokernel SPSC ring APIs
+ *
+ * This module tests the following SPSC ring routines:
+ *
+ * nano_fiber_spsc_get, nano_fiber_spsc_put
+ * nano_task_spsc_get, nano_task_spsc_put
+ * nano_isr_spsc_get, nano_isr_spsc_put
+ *
+ * Scenario #1
+ * Task fills a ring, checks that it refuses more items, then empties it and
+ * checks the order of the items. This is repeated so the indexes wrap.
+ *
+ * Scenario #2
+ * A fiber waits on an empty ring. An ISR puts an item into the ring, which
+ * wakes the fiber up; the fiber returns the item to the task through a
+ * second ring, on which the task waits.
+ *
+ * Scenario #3
+ * Task puts items into a ring, an ISR gets them back.
+ *
+ * Scenario #4
+ * Task streams items to a waiting fiber through a small ring.
+ *
+ * Scenario #5
+ * Timeouts of fibers and tasks waiting on an empty ring.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+#include <irq_offload.h>
+
+#include <util_test_common.h>
+
+#define FIBER_STACKSIZE    384
+#define FIBER_PRIORITY     5
+#define RING_SIZE          8
+#define NUM_STREAM_ITEMS   1000
+#define TIMEOUT_TICKS      5
+
+struct isr_spsc_info {
+	struct nano_spsc *spsc;  /* ring */
+	void *data;              /* data put or got */
+};
+
+static char __stack fiber_stack[FIBER_STACKSIZE];
+
+static struct nano_spsc ring1;
+static struct nano_spsc ring2;
+static void *ring1_buf[RING_SIZE];
+static void *ring2_buf[RING_SIZE];
+
+static struct nano_sem fiber_done;
+
+/* items are identified by their address */
+static char items[NUM_STREAM_ITEMS];
+
+static struct isr_spsc_info isr_info;
+
+static int fiber_result;
+
+static void isr_spsc_put(void *parameter)
+{
+	struct isr_spsc_info *info = parameter;
+
+	if (!nano_isr_spsc_put(info->spsc, info->data)) {
+		info->data = NULL;
+	}
+}
+
+static void isr_spsc_get(void *parameter)
+{
+	struct isr_spsc_info *info = parameter;
+
+	info->data = nano_isr_spsc_get(info->spsc, TICKS_NONE);
+}
+
+/**
+ *
+ * @brief Fill and empty a ring from a task
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_task_fill(void)
+{
+	int round;
+	int i;
+
+	for (round = 0; round < 3; round++) {
+		for (i = 0; i < RING_SIZE; i++) {
+			if (!nano_task_spsc_put(&ring1, &items[round + i])) {
+				TC_ERROR("ring full after %d items\n", i);
+				return TC_FAIL;
+			}
+		}
+
+		if (nano_task_spsc_put(&ring1, &items[0])) {
+			TC_ERROR("full ring accepted an item\n");
+			return TC_FAIL;
+		}
+
+		for (i = 0; i < RING_SIZE; i++) {
+			if (nano_task_spsc_get(&ring1, TICKS_NONE) !=
+			    &items[round + i]) {
+				TC_ERROR("wrong item %d in round %d\n",
+					 i, round);
+				return TC_FAIL;
+			}
+		}
+
+		if (nano_task_spsc_get(&ring1, TICKS_NONE)) {
+			TC_ERROR("empty ring returned an item\n");
+			return TC_FAIL;
+		}
+
+		/* leave one item behind so the indexes move on */
+		nano_task_spsc_put(&ring1, &items[0]);
+		nano_task_spsc_get(&ring1, TICKS_NONE);
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Fiber returning the items it gets from ring1 through ring2
+ *
+ * @param count Number of items to pass on.
+ * @param unused Not used.
+ *
+ * @return N/A
+ */
+static void fiber_echo(int count, int unused)
+{
+	void *data;
+
+	ARG_UNUSED(unused);
+
+	while (count--) {
+		data = nano_fiber_spsc_get(&ring1, TICKS_UNLIMITED);
+		if (!data) {
+			fiber_result = TC_FAIL;
+			break;
+		}
+		nano_fiber_spsc_put(&ring2, data);
+	}
+
+	nano_fiber_sem_give(&fiber_done);
+}
+
+/**
+ *
+ * @brief Wake a fiber waiting on a ring from an ISR
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_isr_to_fiber(void)
+{
+	void *data;
+
+	fiber_result = TC_PASS;
+	task_fiber_start(fiber_stack, FIBER_STACKSIZE,
+			 (nano_fiber_entry_t)fiber_echo, 1, 0,
+			 FIBER_PRIORITY, 0);
+
+	/* the fiber is now waiting on ring1 */
+	isr_info.spsc = &ring1;
+	isr_info.data = &items[1];
+	irq_offload(isr_spsc_put, &isr_info);
+	if (!isr_info.data) {
+		TC_ERROR("ISR could not put an item\n");
+		return TC_FAIL;
+	}
+
+	data = nano_task_spsc_get(&ring2, TICKS_UNLIMITED);
+	nano_task_sem_take(&fiber_done, TICKS_UNLIMITED);
+
+	if ((fiber_result != TC_PASS) || (data != &items[1])) {
+		TC_ERROR("fiber did not pass on the item put by the ISR\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Get items from a ring in an ISR
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_task_to_isr(void)
+{
+	int i;
+
+	for (i = 0; i < RING_SIZE; i++) {
+		nano_task_spsc_put(&ring1, &items[i]);
+	}
+
+	isr_info.spsc = &ring1;
+	for (i = 0; i < RING_SIZE; i++) {
+		irq_offload(isr_spsc_get, &isr_info);
+		if (isr_info.data != &items[i]) {
+			TC_ERROR("ISR got wrong item %d\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	irq_offload(isr_spsc_get, &isr_info);
+	if (isr_info.data) {
+		TC_ERROR("ISR got an item from an empty ring\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Stream items from a task to a waiting fiber
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_stream(void)
+{
+	int i;
+
+	fiber_result = TC_PASS;
+	task_fiber_start(fiber_stack, FIBER_STACKSIZE,
+			 (nano_fiber_entry_t)fiber_echo, NUM_STREAM_ITEMS, 0,
+			 FIBER_PRIORITY, 0);
+
+	for (i = 0; i < NUM_STREAM_ITEMS; i++) {
+		if (!nano_task_spsc_put(&ring1, &items[i])) {
+			TC_ERROR("ring full at item %d\n", i);
+			return TC_FAIL;
+		}
+		/* the fiber has run, and passed the item on */
+		if (nano_task_spsc_get(&ring2, TICKS_NONE) != &items[i]) {
+			TC_ERROR("item %d not passed on in order\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	nano_task_sem_take(&fiber_done, TICKS_UNLIMITED);
+
+	return fiber_result;
+}
+
+/**
+ *
+ * @brief Fiber checking that getting from an empty ring times out
+ *
+ * @param timeout Timeout, in ticks.
+ * @param unused Not used.
+ *
+ * @return N/A
+ */
+static void fiber_timeout(int timeout, int unused)
+{
+	int64_t orig_ticks = sys_tick_get();
+
+	ARG_UNUSED(unused);
+
+	if (nano_fiber_spsc_get(&ring1, timeout) ||
+	    (sys_tick_delta(&orig_ticks) < timeout)) {
+		fiber_result = TC_FAIL;
+	}
+
+	nano_fiber_sem_give(&fiber_done);
+}
+
+/**
+ *
+ * @brief Test timeouts waiting on an empty ring
+ *
+ * @return TC_PASS on success, TC_FAIL on failure
+ */
+static int test_timeout(void)
+{
+	int64_t orig_ticks;
+
+	fiber_result = TC_PASS;
+	task_fiber_start(fiber_stack, FIBER_STACKSIZE,
+			 (nano_fiber_entry_t)fiber_timeout, TIMEOUT_TICKS, 0,
+			 FIBER_PRIORITY, 0);
+	nano_task_sem_take(&fiber_done, TICKS_UNLIMITED);
+	if (fiber_result != TC_PASS) {
+		TC_ERROR("fiber wait on empty ring did not time out\n");
+		return TC_FAIL;
+	}
+
+	orig_ticks = sys_tick_get();
+	if (nano_task_spsc_get(&ring1, TIMEOUT_TICKS) ||
+	    (sys_tick_delta(&orig_ticks) < TIMEOUT_TICKS)) {
+		TC_ERROR("task wait on empty ring did not time out\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/**
+ *
+ * @brief Entry point to SPSC ring tests
+ *
+ * @return N/A
+ */
+void main(void)
+{
+	int rv = TC_PASS;
+
+	TC_START("Test Nanokernel SPSC ring");
+
+	nano_spsc_init(&ring1, ring1_buf, RING_SIZE);
+	nano_spsc_init(&ring2, ring2_buf, RING_SIZE);
+	nano_sem_init(&fiber_done);
+
+	TC_PRINT("Test task fill and empty\n");
+	rv = test_task_fill();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test ISR put to waiting fiber\n");
+	rv = test_isr_to_fiber();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test task put to ISR get\n");
+	rv = test_task_to_isr();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test task streaming to fiber\n");
+	rv = test_stream();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	TC_PRINT("Test timeouts\n");
+	rv = test_timeout();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the reassembly of 6LoWPAN fragments
+ *
+ * The fragments of a datagram are received in order, out of order, twice,
+ * with a hole, overlapping or too slowly. The datagram must be delivered
+ * once all its bytes are received, and only then, and the L2 buffers of
+ * the fragments must be released in every case.
+ *
+ * Each case is run with the IPv6 header uncompressed, and with an IPHC
+ * header that grows by 37 bytes when it is uncompressed.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <net/net_core.h>
+
+/* The reassembly is built into the test, and the datagrams that it
+ * completes are kept here instead of going up to the IP stack.
+ */
+#define net_driver_15_4_recv test_recv
+#define sicslowpan_fragmentation test_fragmentation
+#include "contiki/sicslowpan/sicslowpan_fragmentation.c"
+
+#define STACKSIZE 2048
+
+/* The datagram is sent in NUM_FRAGS fragments, fragment i holding the
+ * bytes from frag_start[i] to frag_start[i + 1]. The first fragment
+ * holds the IP header.
+ */
+#define DATAGRAM_LEN 300
+#define NUM_FRAGS 5
+
+static const uint16_t frag_start[NUM_FRAGS + 1] = {
+	0, 64, 128, 192, 256, DATAGRAM_LEN
+};
+
+static uint8_t datagram[DATAGRAM_LEN];
+
+/* The IP header as sent in the first fragment, and the length that it
+ * replaces at the start of the datagram.
+ */
+struct header {
+	const char *name;
+	uint8_t data[3];
+	uint8_t len;
+	uint8_t uncomp_len;
+};
+
+static const struct header headers[] = {
+	/* The IPv6 dispatch, before the uncompressed header */
+	{ "IPv6", { SICSLOWPAN_DISPATCH_IPV6 }, 1, 0 },
+	/* All the fields are elided but the next header */
+	{ "IPHC", { 0x79, 0x33, UIP_PROTO_ICMP6 }, 3, UIP_IPH_LEN },
+};
+
+static const struct header *hdr;
+static uint16_t tag;
+
+static linkaddr_t sender;
+static linkaddr_t receiver;
+
+static struct net_buf *delivered;
+static int delivered_count;
+
+static char __stack test_stack[STACKSIZE];
+static struct nano_sem test_done;
+static int test_result;
+
+int test_recv(struct net_buf *buf)
+{
+	if (delivered) {
+		ip_buf_unref(delivered);
+	}
+
+	delivered = buf;
+	delivered_count++;
+
+	return 0;
+}
+
+/* Receive the bytes of the datagram from start to end in a fragment,
+ * the way the 802.15.4 RX fiber does. Returns whether the reassembly
+ * kept the fragment.
+ */
+static int recv_frag_at(uint16_t start, uint16_t end)
+{
+	struct net_buf *mbuf;
+	uint8_t frame[SICSLOWPAN_FRAGN_HDR_LEN + 64];
+	int len;
+
+	if (start == 0) {
+		frame[0] = SICSLOWPAN_DISPATCH_FRAG1;
+		len = SICSLOWPAN_FRAG1_HDR_LEN;
+		memcpy(frame + len, hdr->data, hdr->len);
+		len += hdr->len;
+		start = hdr->uncomp_len;
+	} else {
+		frame[0] = SICSLOWPAN_DISPATCH_FRAGN;
+		frame[PACKETBUF_FRAG_OFFSET] = start >> 3;
+		len = SICSLOWPAN_FRAGN_HDR_LEN;
+	}
+
+	frame[0] |= DATAGRAM_LEN >> 8;
+	frame[1] = DATAGRAM_LEN & 0xff;
+	frame[PACKETBUF_FRAG_TAG] = tag >> 8;
+	frame[PACKETBUF_FRAG_TAG + 1] = tag & 0xff;
+
+	memcpy(frame + len, datagram + start, end - start);
+	len += end - start;
+
+	mbuf = l2_buf_get_reserve(0);
+	packetbuf_copyfrom(mbuf, frame, len);
+	packetbuf_set_datalen(mbuf, len);
+	packetbuf_set_addr(mbuf, PACKETBUF_ADDR_SENDER, &sender);
+	packetbuf_set_addr(mbuf, PACKETBUF_ADDR_RECEIVER, &receiver);
+
+	if (!test_fragmentation.reassemble(mbuf)) {
+		l2_buf_unref(mbuf);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int recv_frag(int i)
+{
+	return recv_frag_at(frag_start[i], frag_start[i + 1]);
+}
+
+/* Check the number of datagrams delivered, and the last one as the IP
+ * stack gets it, before its header is uncompressed.
+ */
+static int check_delivered(int count)
+{
+	uint8_t *data;
+	uint16_t start;
+
+	if (delivered_count != count) {
+		TC_ERROR("%s: %d datagrams delivered instead of %d\n",
+			 hdr->name, delivered_count, count);
+		return TC_FAIL;
+	}
+
+	if (!count) {
+		return TC_PASS;
+	}
+
+	if (uip_len(delivered) != DATAGRAM_LEN) {
+		TC_ERROR("%s: datagram of %u bytes delivered instead of %u\n",
+			 hdr->name, uip_len(delivered), DATAGRAM_LEN);
+		return TC_FAIL;
+	}
+
+	/* The first fragment is copied as received, but the dispatch */
+	data = uip_buf(delivered);
+	start = hdr->uncomp_len;
+	if (start) {
+		if (memcmp(data, hdr->data, hdr->len) ||
+		    memcmp(data + hdr->len, datagram + start,
+			   frag_start[1] - start)) {
+			TC_ERROR("%s: wrong first fragment\n", hdr->name);
+			return TC_FAIL;
+		}
+		start = frag_start[1];
+	}
+
+	if (memcmp(data + start, datagram + start, DATAGRAM_LEN - start)) {
+		TC_ERROR("%s: wrong datagram delivered\n", hdr->name);
+		return TC_FAIL;
+	}
+
+	if (uip_uncompressed(delivered) != !hdr->uncomp_len) {
+		TC_ERROR("%s: wrong uncompressed flag\n", hdr->name);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/* Check the number of fragments held by the reassembly contexts */
+static int check_held(int count)
+{
+	int i, used = 0;
+
+	for (i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+		if (frag_info[i].len) {
+			used++;
+		}
+	}
+
+	if (frag_count != count || (count && used != 1) ||
+	    (!count && used)) {
+		TC_ERROR("%s: %d fragments in %d contexts, expected %d\n",
+			 hdr->name, frag_count, used, count);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+/* Start a new datagram from the same sender */
+static void next_datagram(void)
+{
+	tag++;
+	delivered_count = 0;
+}
+
+static int wait_timeout(void)
+{
+	fiber_sleep(sys_clock_ticks_per_sec *
+		    (SICSLOWPAN_REASS_MAXAGE / 16 + 1));
+
+	return check_held(0);
+}
+
+static int test_in_order(void)
+{
+	int i;
+
+	next_datagram();
+
+	for (i = 0; i < NUM_FRAGS; i++) {
+		if (check_delivered(0) != TC_PASS || check_held(i) != TC_PASS) {
+			return TC_FAIL;
+		}
+
+		if (!recv_frag(i)) {
+			TC_ERROR("%s: fragment %d dropped\n", hdr->name, i);
+			return TC_FAIL;
+		}
+	}
+
+	if (check_delivered(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_held(0);
+}
+
+static int test_reordered(void)
+{
+	static const int order[NUM_FRAGS] = { 4, 2, 0, 3, 1 };
+	int i;
+
+	next_datagram();
+
+	for (i = 0; i < NUM_FRAGS; i++) {
+		if (check_delivered(0) != TC_PASS || check_held(i) != TC_PASS) {
+			return TC_FAIL;
+		}
+
+		if (!recv_frag(order[i])) {
+			TC_ERROR("%s: fragment %d dropped\n", hdr->name,
+				 order[i]);
+			return TC_FAIL;
+		}
+	}
+
+	if (check_delivered(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_held(0);
+}
+
+static int test_hole(void)
+{
+	int i;
+
+	next_datagram();
+
+	/* Nothing tells where the first fragment ends but its header, so
+	 * the missing second fragment must not go unnoticed.
+	 */
+	recv_frag(0);
+	for (i = 2; i < NUM_FRAGS; i++) {
+		recv_frag(i);
+	}
+
+	if (check_delivered(0) != TC_PASS ||
+	    check_held(NUM_FRAGS - 1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	recv_frag(1);
+
+	if (check_delivered(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_held(0);
+}
+
+static int test_duplicate(void)
+{
+	int i;
+
+	next_datagram();
+
+	for (i = 0; i < NUM_FRAGS - 1; i++) {
+		recv_frag(i);
+		if (recv_frag(i)) {
+			TC_ERROR("%s: duplicate fragment %d kept\n",
+				 hdr->name, i);
+			return TC_FAIL;
+		}
+
+		if (check_held(i + 1) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	recv_frag(NUM_FRAGS - 1);
+
+	if (check_delivered(1) != TC_PASS || check_held(0) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* A fragment received after the datagram is delivered opens a new
+	 * reassembly, which times out.
+	 */
+	recv_frag(NUM_FRAGS - 1);
+
+	if (check_delivered(1) != TC_PASS || check_held(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return wait_timeout();
+}
+
+static int test_timeout(void)
+{
+	int i;
+
+	next_datagram();
+
+	for (i = 0; i < NUM_FRAGS - 2; i++) {
+		recv_frag(i);
+	}
+
+	if (check_held(NUM_FRAGS - 2) != TC_PASS ||
+	    wait_timeout() != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* The remaining fragments cannot complete the datagram anymore */
+	for (; i < NUM_FRAGS; i++) {
+		recv_frag(i);
+	}
+
+	if (check_delivered(0) != TC_PASS || check_held(2) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return wait_timeout();
+}
+
+static int test_overlap(void)
+{
+	int i;
+
+	next_datagram();
+
+	recv_frag(0);
+	recv_frag(1);
+
+	/* Fragments that overlap the received ones discard them, and a new
+	 * reassembly starts with the last one, whether it starts or ends
+	 * inside a received fragment.
+	 */
+	recv_frag_at(frag_start[1] + 32, frag_start[2] + 32);
+	if (check_held(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	recv_frag_at(frag_start[1], frag_start[1] + 40);
+	if (check_held(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	/* The second fragment overlaps again, then the others complete the
+	 * datagram.
+	 */
+	for (i = 1; i < NUM_FRAGS; i++) {
+		recv_frag(i);
+	}
+
+	if (check_delivered(0) != TC_PASS ||
+	    check_held(NUM_FRAGS - 1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	recv_frag(0);
+
+	if (check_delivered(1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_held(0);
+}
+
+static int (*const tests[])(void) = {
+	test_in_order,
+	test_reordered,
+	test_hole,
+	test_duplicate,
+	test_timeout,
+	test_overlap,
+};
+
+static void test_fiber(int arg1, int arg2)
+{
+	int i, j;
+
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+
+	for (i = 0; i < ARRAY_SIZE(headers); i++) {
+		hdr = &headers[i];
+
+		for (j = 0; j < ARRAY_SIZE(tests); j++) {
+			test_result = tests[j]();
+			if (test_result != TC_PASS) {
+				TC_ERROR("%s: test %d failed\n", hdr->name, j);
+				goto done;
+			}
+		}
+	}
+
+done:
+	nano_fiber_sem_give(&test_done);
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("Test 6LoWPAN fragment reassembly");
+
+	net_init();
+
+	for (i = 0; i < DATAGRAM_LEN; i++) {
+		datagram[i] = i * 7;
+	}
+
+	sender.u8[LINKADDR_SIZE - 1] = 1;
+	receiver.u8[LINKADDR_SIZE - 1] = 2;
+
+	/* The reassembly runs in a fiber, as in the 802.15.4 RX fiber, so
+	 * that its timers do not preempt it.
+	 */
+	nano_sem_init(&test_done);
+	task_fiber_start(test_stack, STACKSIZE, test_fiber, 0, 0, 7, 0);
+	nano_task_sem_take(&test_done, TICKS_UNLIMITED);
+
+	TC_END_RESULT(test_result);
+	TC_END_REPORT(test_result);
+}
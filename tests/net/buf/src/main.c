@@ -44,11 +44,88 @@ static void buf_destroy(struct net_buf *buf)
 	if (buf->free != &bufs_fifo) {
 		printk("Invalid free pointer in buffer!\n");
 	}
+
+	nano_fifo_put(buf->free, buf);
 }
 
 static NET_BUF_POOL(bufs_pool, 22, 74, &bufs_fifo, buf_destroy,
 		    sizeof(struct bt_data));
 
+static struct nano_fifo slices_fifo;
+static NET_BUF_SLICE_POOL(slices_pool, 4, &slices_fifo);
+
+static int frags_test(void)
+{
+	struct net_buf *buf, *head, *slice;
+	uint8_t *data;
+	int i;
+
+	destroy_called = 0;
+
+	buf = net_buf_get_timeout(&bufs_fifo, 0, TICKS_NONE);
+	head = net_buf_get_timeout(&bufs_fifo, 0, TICKS_NONE);
+	if (!buf || !head) {
+		printk("Failed to get buffers!\n");
+		return -1;
+	}
+
+	data = net_buf_add(buf, 40);
+	for (i = 0; i < 40; i++) {
+		data[i] = i;
+	}
+
+	net_buf_add_le16(head, 0x1234);
+
+	/* Slicing part of the data leaves the buffer untouched */
+	slice = net_buf_slice_at(&slices_fifo, buf, 10, 5);
+	if (!slice || slice->len != 5 || slice->data != &data[10] ||
+	    buf->len != 40 || buf->data != data) {
+		printk("Invalid slice at offset!\n");
+		return -1;
+	}
+
+	net_buf_unref(slice);
+
+	/* Slice the data in two fragments of the head buffer */
+	for (i = 0; i < 2; i++) {
+		slice = net_buf_slice(&slices_fifo, buf, 20);
+		if (!slice || slice->len != 20 || slice->data != &data[i * 20]) {
+			printk("Invalid slice!\n");
+			return -1;
+		}
+
+		net_buf_frag_add(head, slice);
+	}
+
+	if (buf->len || net_buf_frags_len(head) != 42 ||
+	    net_buf_frag_last(head) != slice) {
+		printk("Invalid fragments!\n");
+		return -1;
+	}
+
+	/* The sliced buffer is kept until the slices are freed */
+	net_buf_unref(buf);
+	if (destroy_called) {
+		printk("Sliced buffer freed too early!\n");
+		return -1;
+	}
+
+	net_buf_unref(head);
+	if (destroy_called != 2) {
+		printk("Fragments not freed: %d\n", destroy_called);
+		return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(slices_pool); i++) {
+		if (!net_buf_get_timeout(&slices_fifo, 0, TICKS_NONE)) {
+			printk("Slices not freed!\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 #ifdef CONFIG_MICROKERNEL
 void mainloop(void)
 #else
@@ -62,6 +139,7 @@ void main(void)
 	printk("sizeof(bufs_pool)      = %u\n", sizeof(bufs_pool));
 
 	net_buf_pool_init(bufs_pool);
+	net_buf_pool_init(slices_pool);
 
 	for (i = 0; i < ARRAY_SIZE(bufs_pool); i++) {
 		struct net_buf *buf;
@@ -85,5 +163,9 @@ void main(void)
 		return;
 	}
 
+	if (frags_test()) {
+		return;
+	}
+
 	printk("Buffer tests passed\n");
 }
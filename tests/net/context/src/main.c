@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the bind conflicts of network contexts
+ *
+ * Several UDP contexts are bound to the same local address and port. They
+ * must be accepted as long as their remote endpoints differ, like the
+ * unicast and multicast contexts of the echo client, while a context with
+ * the same 5-tuple as another one must be refused. Only one context may
+ * have a wildcard remote endpoint.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <net/net_core.h>
+#include <net/net_socket.h>
+
+#define MY_PORT 4242
+#define PEER_PORT 4243
+
+#define IN6ADDR(last) { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, \
+			    0, 0, 0, 0, 0, 0, 0, last } } }
+
+static const struct in6_addr in6addr_my = IN6ADDR(1);
+static const struct in6_addr in6addr_peer = IN6ADDR(2);
+static const struct in6_addr in6addr_other = IN6ADDR(3);
+static const struct in6_addr in6addr_mcast = { { { 0xff, 0x84, 0, 0, 0, 0,
+						    0, 0, 0, 0, 0, 0, 0, 0,
+						    0, 0x2 } } };
+static const struct in6_addr in6addr_any = IN6ADDR_ANY_INIT;
+
+static struct net_addr my_addr;
+static struct net_addr peer_addr;
+static struct net_addr other_addr;
+static struct net_addr mcast_addr;
+static struct net_addr any_addr;
+
+static void set_addr(struct net_addr *addr, const struct in6_addr *in6_addr)
+{
+	addr->in6_addr = *in6_addr;
+	addr->family = AF_INET6;
+}
+
+static struct net_context *get(const struct net_addr *remote_addr,
+			       uint16_t remote_port)
+{
+	return net_context_get(IPPROTO_UDP, remote_addr, remote_port,
+			       &my_addr, MY_PORT);
+}
+
+static int test_remote_endpoints(void)
+{
+	struct net_context *unicast, *multicast, *other_port, *dup;
+	int rv = TC_FAIL;
+
+	unicast = get(&peer_addr, PEER_PORT);
+	if (!unicast) {
+		TC_ERROR("cannot bind the unicast context\n");
+		return TC_FAIL;
+	}
+
+	/* Same local endpoint, other remote address */
+	multicast = get(&mcast_addr, PEER_PORT);
+	if (!multicast) {
+		TC_ERROR("cannot bind the multicast context\n");
+		goto put_unicast;
+	}
+
+	/* Same local endpoint, other remote port */
+	other_port = get(&peer_addr, PEER_PORT + 1);
+	if (!other_port) {
+		TC_ERROR("cannot bind a context to another remote port\n");
+		goto put_multicast;
+	}
+
+	dup = get(&peer_addr, PEER_PORT);
+	if (dup) {
+		TC_ERROR("context with the same 5-tuple accepted\n");
+		net_context_put(dup);
+		goto put_other_port;
+	}
+
+	/* The 5-tuple can be bound again once released */
+	net_context_put(unicast);
+	unicast = get(&peer_addr, PEER_PORT);
+	if (!unicast) {
+		TC_ERROR("cannot bind the released 5-tuple again\n");
+		goto put_other_port;
+	}
+
+	rv = TC_PASS;
+
+put_other_port:
+	net_context_put(other_port);
+put_multicast:
+	net_context_put(multicast);
+put_unicast:
+	net_context_put(unicast);
+
+	return rv;
+}
+
+static int test_wildcard(void)
+{
+	struct net_context *wildcard, *unicast, *dup;
+	int rv = TC_FAIL;
+
+	wildcard = get(&any_addr, 0);
+	if (!wildcard) {
+		TC_ERROR("cannot bind the wildcard context\n");
+		return TC_FAIL;
+	}
+
+	unicast = get(&other_addr, PEER_PORT);
+	if (!unicast) {
+		TC_ERROR("cannot bind a context next to the wildcard one\n");
+		goto put_wildcard;
+	}
+
+	/* Any unspecified remote address or port is a wildcard */
+	dup = get(&other_addr, 0);
+	if (!dup) {
+		dup = get(&any_addr, PEER_PORT);
+	}
+
+	if (dup) {
+		TC_ERROR("second wildcard context accepted\n");
+		net_context_put(dup);
+		goto put_unicast;
+	}
+
+	rv = TC_PASS;
+
+put_unicast:
+	net_context_put(unicast);
+put_wildcard:
+	net_context_put(wildcard);
+
+	return rv;
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test network context bind conflicts");
+
+	net_init();
+
+	set_addr(&my_addr, &in6addr_my);
+	set_addr(&peer_addr, &in6addr_peer);
+	set_addr(&other_addr, &in6addr_other);
+	set_addr(&mcast_addr, &in6addr_mcast);
+	set_addr(&any_addr, &in6addr_any);
+
+	rv = test_remote_endpoints();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_wildcard();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
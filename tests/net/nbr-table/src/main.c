@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the link-layer address hash of the neighbor table
+ *
+ * Neighbors whose addresses hash to the same couple of slots are added
+ * over and over, so that the table keeps evicting neighbors and the hash
+ * keeps moving keys back into emptied slots. Every neighbor in the table
+ * must be found at any time, and only those.
+ *
+ * The least recently looked up neighbor must be the one evicted, a locked
+ * neighbor must never be, and the single neighbor without address must be
+ * found under linkaddr_null.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <net/net_core.h>
+
+/* The neighbor table is built into the test, so that its state is not
+ * shared with the tables of the IP stack.
+ */
+#define nbr_table_register test_nbr_table_register
+#define nbr_table_head test_nbr_table_head
+#define nbr_table_next test_nbr_table_next
+#define nbr_table_add_lladdr test_nbr_table_add_lladdr
+#define nbr_table_get_from_lladdr test_nbr_table_get_from_lladdr
+#define nbr_table_remove test_nbr_table_remove
+#define nbr_table_lock test_nbr_table_lock
+#define nbr_table_unlock test_nbr_table_unlock
+#define nbr_table_get_lladdr test_nbr_table_get_lladdr
+#include "contiki/nbr-table.c"
+
+#define NUM_NBRS NBR_TABLE_MAX_NEIGHBORS
+
+/* Colliding addresses, several times as many as the table can hold */
+#define NUM_ADDRS (3 * NUM_NBRS)
+#define ROUNDS 8
+
+struct nbr {
+	uint32_t id;
+};
+
+NBR_TABLE(struct nbr, nbrs);
+
+static linkaddr_t addrs[NUM_ADDRS];
+static int evicted;
+
+static void nbr_evicted(nbr_table_item_t *item)
+{
+	evicted++;
+}
+
+/* Find addresses whose home slot is one of two neighboring slots, so
+ * that their probe sequences overlap.
+ */
+static void collide_addrs(void)
+{
+	linkaddr_t addr;
+	int home = -1;
+	int slot;
+	int i, n;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.u8[0] = 0x02;
+
+	for (i = 0, n = 0; n < NUM_ADDRS; i++) {
+		addr.u8[LINKADDR_SIZE - 2] = i >> 8;
+		addr.u8[LINKADDR_SIZE - 1] = i;
+
+		slot = hash_slot(&addr);
+		if (home < 0) {
+			home = slot;
+		}
+
+		if (slot == home || slot == (home + 1) % NBR_TABLE_HASH_SIZE) {
+			linkaddr_copy(&addrs[n++], &addr);
+		}
+	}
+}
+
+/* Look up without refreshing the neighbor, not to change the eviction
+ * order.
+ */
+static bool in_table(const linkaddr_t *lladdr)
+{
+	int index = index_from_lladdr(lladdr);
+
+	return index != -1 && nbr_get_bit(used_map, nbrs,
+					  item_from_index(nbrs, index));
+}
+
+/* Every key of the list must be found in the hash, and the hash must
+ * hold no other key.
+ */
+static int check_hash(void)
+{
+	nbr_table_key_t *key;
+	int keys = 0;
+	int slots = 0;
+	int i;
+
+	for (key = list_head(nbr_table_keys); key; key = list_item_next(key)) {
+		if (index_from_lladdr(&key->lladdr) != index_from_key(key)) {
+			TC_ERROR("neighbor %d not found in the hash\n",
+				 index_from_key(key));
+			return TC_FAIL;
+		}
+
+		keys++;
+	}
+
+	for (i = 0; i < NBR_TABLE_HASH_SIZE; i++) {
+		if (lladdr_hash[i]) {
+			slots++;
+		}
+	}
+
+	if (slots != keys) {
+		TC_ERROR("%d slots used for %d neighbors\n", slots, keys);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static struct nbr *add(const linkaddr_t *lladdr, uint32_t id)
+{
+	struct nbr *nbr;
+
+	nbr = nbr_table_add_lladdr(nbrs, lladdr);
+	if (nbr) {
+		nbr->id = id;
+	}
+
+	return nbr;
+}
+
+/* Remove all the neighbors, which are then evicted first */
+static void clear_table(void)
+{
+	struct nbr *nbr;
+
+	while ((nbr = nbr_table_head(nbrs))) {
+		nbr_table_remove(nbrs, nbr);
+	}
+}
+
+static int test_collisions(void)
+{
+	int i, j, k;
+
+	/* Without lookups, the oldest neighbor is evicted each time, so the
+	 * table holds the last NUM_NBRS neighbors added.
+	 */
+	for (i = 0; i < ROUNDS * NUM_ADDRS; i++) {
+		if (!add(&addrs[i % NUM_ADDRS], i)) {
+			TC_ERROR("cannot add neighbor %d\n", i);
+			return TC_FAIL;
+		}
+
+		for (j = 0; j < NUM_ADDRS; j++) {
+			/* Number of neighbors added since this one */
+			k = (i - j) % NUM_ADDRS;
+
+			if (j > i || k >= NUM_NBRS) {
+				if (in_table(&addrs[j])) {
+					TC_ERROR("address %d found after %d "
+						 "adds\n", j, i + 1);
+					return TC_FAIL;
+				}
+			} else if (!in_table(&addrs[j])) {
+				TC_ERROR("address %d not found after %d "
+					 "adds\n", j, i + 1);
+				return TC_FAIL;
+			}
+		}
+
+		if (check_hash() != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	/* The neighbors found are the ones last added */
+	for (i = ROUNDS * NUM_ADDRS - NUM_NBRS; i < ROUNDS * NUM_ADDRS; i++) {
+		struct nbr *nbr;
+
+		nbr = nbr_table_get_from_lladdr(nbrs, &addrs[i % NUM_ADDRS]);
+		if (!nbr || nbr->id != i) {
+			TC_ERROR("wrong neighbor for address %d\n",
+				 i % NUM_ADDRS);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static int test_lru(void)
+{
+	int i;
+
+	clear_table();
+
+	for (i = 0; i < NUM_NBRS; i++) {
+		add(&addrs[i], i);
+	}
+
+	/* The first neighbor added is looked up, so the second one is now
+	 * the least recently used.
+	 */
+	nbr_table_get_from_lladdr(nbrs, &addrs[0]);
+
+	evicted = 0;
+	if (!add(&addrs[NUM_NBRS], NUM_NBRS) || evicted != 1) {
+		TC_ERROR("%d neighbors evicted\n", evicted);
+		return TC_FAIL;
+	}
+
+	if (!in_table(&addrs[0]) || in_table(&addrs[1])) {
+		TC_ERROR("least recently used neighbor not evicted\n");
+		return TC_FAIL;
+	}
+
+	return check_hash();
+}
+
+static int test_locked(void)
+{
+	struct nbr *nbr;
+	int i;
+
+	clear_table();
+
+	/* Lock all neighbors but the last one */
+	for (i = 0; i < NUM_NBRS; i++) {
+		nbr = add(&addrs[i], i);
+		if (i < NUM_NBRS - 1) {
+			nbr_table_lock(nbrs, nbr);
+		}
+	}
+
+	/* The locked neighbors are the least recently used ones, still only
+	 * the unlocked one can be evicted.
+	 */
+	for (i = NUM_NBRS; i < NUM_ADDRS; i++) {
+		if (!add(&addrs[i], i)) {
+			TC_ERROR("cannot add neighbor %d\n", i);
+			return TC_FAIL;
+		}
+
+		if (in_table(&addrs[i - 1])) {
+			TC_ERROR("unlocked neighbor %d not evicted\n", i - 1);
+			return TC_FAIL;
+		}
+	}
+
+	for (i = 0; i < NUM_NBRS - 1; i++) {
+		if (!in_table(&addrs[i])) {
+			TC_ERROR("locked neighbor %d evicted\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	/* Once all of them are locked, no neighbor can be added */
+	nbr_table_lock(nbrs, nbr_table_get_from_lladdr(nbrs,
+						       &addrs[NUM_ADDRS - 1]));
+	if (add(&addrs[NUM_NBRS - 1], 0)) {
+		TC_ERROR("neighbor added to a table of locked neighbors\n");
+		return TC_FAIL;
+	}
+
+	for (nbr = nbr_table_head(nbrs); nbr; nbr = nbr_table_next(nbrs, nbr)) {
+		nbr_table_unlock(nbrs, nbr);
+	}
+
+	return check_hash();
+}
+
+static int test_null(void)
+{
+	struct nbr *nbr;
+	int i;
+
+	clear_table();
+
+	nbr = add(NULL, 42);
+	if (!nbr) {
+		TC_ERROR("cannot add the neighbor without address\n");
+		return TC_FAIL;
+	}
+
+	if (nbr_table_get_from_lladdr(nbrs, &linkaddr_null) != nbr ||
+	    nbr_table_get_from_lladdr(nbrs, NULL) != nbr ||
+	    !linkaddr_cmp(nbr_table_get_lladdr(nbrs, nbr), &linkaddr_null)) {
+		TC_ERROR("neighbor without address not found\n");
+		return TC_FAIL;
+	}
+
+	/* There is only one neighbor without address */
+	if (add(NULL, 43) != nbr) {
+		TC_ERROR("second neighbor without address\n");
+		return TC_FAIL;
+	}
+
+	/* It stays found while colliding neighbors come and go */
+	nbr_table_lock(nbrs, nbr);
+	for (i = 0; i < NUM_ADDRS; i++) {
+		add(&addrs[i], i);
+	}
+
+	nbr = nbr_table_get_from_lladdr(nbrs, &linkaddr_null);
+	if (!nbr || nbr->id != 43) {
+		TC_ERROR("neighbor without address lost\n");
+		return TC_FAIL;
+	}
+
+	nbr_table_unlock(nbrs, nbr);
+
+	return check_hash();
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test neighbor table hash");
+
+	nbr_table_register(nbrs, nbr_evicted);
+	collide_addrs();
+
+	rv = test_collisions();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_lru();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_locked();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_null();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
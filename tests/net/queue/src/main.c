@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test the queueing classes of the RX and TX fibers
+ *
+ * Control packets must be taken before any bulk packet, also when they
+ * are queued after it. While both bulk classes have packets waiting, the
+ * high priority one must get CONFIG_NET_QUEUE_BULK_HIGH_WEIGHT packets
+ * for each packet of the default one. The packets of a class must keep
+ * their order.
+ *
+ * Build with prj_round_robin.conf to test a weight of 1.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <net/buf.h>
+#include <net/ip_buf.h>
+
+#include "net_queue.h"
+
+#define WEIGHT CONFIG_NET_QUEUE_BULK_HIGH_WEIGHT
+
+/* Both bulk classes have packets waiting for ROUNDS turns */
+#define ROUNDS 4
+#define NUM_BULK_HIGH (ROUNDS * WEIGHT)
+#define NUM_BULK (ROUNDS + 2)
+#define NUM_CONTROL 2
+#define NUM_BUFS (NUM_BULK_HIGH + NUM_BULK + NUM_CONTROL)
+
+static struct nano_fifo free_bufs;
+static NET_BUF_POOL(bufs_pool, NUM_BUFS, 1, &free_bufs, NULL,
+		    sizeof(struct ip_buf));
+
+static struct net_queue queue;
+
+/* Sequence numbers of the packets queued and taken, by class */
+static uint8_t put_seq[NET_QUEUE_CLASSES];
+static uint8_t get_seq[NET_QUEUE_CLASSES];
+
+static void reset_queue(void)
+{
+	net_queue_init(&queue);
+
+	memset(put_seq, 0, sizeof(put_seq));
+	memset(get_seq, 0, sizeof(get_seq));
+}
+
+static void put(enum net_queue_class class, int count)
+{
+	struct net_buf *buf;
+
+	while (count--) {
+		buf = net_buf_get(&free_bufs, 0);
+		ip_buf_queue_class(buf) = class;
+		net_buf_add_u8(buf, put_seq[class]++);
+
+		net_queue_put(&queue, buf);
+	}
+}
+
+/* Take the next packets, which must be the next ones of the class */
+static int get(enum net_queue_class class, int count)
+{
+	struct net_buf *buf;
+	int rv = TC_PASS;
+
+	while (count-- && rv == TC_PASS) {
+		buf = net_queue_get(&queue);
+		if (!buf) {
+			TC_ERROR("no packet, expected packet %u of class %d\n",
+				 get_seq[class], class);
+			return TC_FAIL;
+		}
+
+		if (ip_buf_queue_class(buf) != class ||
+		    buf->data[0] != get_seq[class]) {
+			TC_ERROR("packet %u of class %u, expected packet %u "
+				 "of class %d\n", buf->data[0],
+				 ip_buf_queue_class(buf), get_seq[class],
+				 class);
+			rv = TC_FAIL;
+		}
+
+		get_seq[class]++;
+		net_buf_unref(buf);
+	}
+
+	return rv;
+}
+
+static int check_empty(void)
+{
+	struct net_buf *buf;
+
+	buf = net_queue_get(&queue);
+	if (buf) {
+		TC_ERROR("packet of class %u left in the queue\n",
+			 ip_buf_queue_class(buf));
+		net_buf_unref(buf);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_control_first(void)
+{
+	reset_queue();
+
+	put(NET_QUEUE_BULK, 1);
+	put(NET_QUEUE_BULK_HIGH, 1);
+	put(NET_QUEUE_CONTROL, NUM_CONTROL);
+
+	if (get(NET_QUEUE_CONTROL, NUM_CONTROL) != TC_PASS ||
+	    get(NET_QUEUE_BULK_HIGH, 1) != TC_PASS ||
+	    get(NET_QUEUE_BULK, 1) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_empty();
+}
+
+static int test_weight(void)
+{
+	int i;
+
+	reset_queue();
+
+	put(NET_QUEUE_BULK, NUM_BULK);
+	put(NET_QUEUE_BULK_HIGH, NUM_BULK_HIGH);
+
+	for (i = 0; i < ROUNDS; i++) {
+		if (get(NET_QUEUE_BULK_HIGH, 1) != TC_PASS) {
+			return TC_FAIL;
+		}
+
+		/* Control packets queued in the middle of a turn come first,
+		 * then the turn goes on.
+		 */
+		if (i == 1) {
+			put(NET_QUEUE_CONTROL, NUM_CONTROL);
+			if (get(NET_QUEUE_CONTROL, NUM_CONTROL) != TC_PASS) {
+				return TC_FAIL;
+			}
+		}
+
+		if (get(NET_QUEUE_BULK_HIGH, WEIGHT - 1) != TC_PASS ||
+		    get(NET_QUEUE_BULK, 1) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	/* The default class gets all the turns once the other is empty */
+	if (get(NET_QUEUE_BULK, NUM_BULK - ROUNDS) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_empty();
+}
+
+static int test_single_class(void)
+{
+	reset_queue();
+
+	/* A class alone in the queue is not held back by its weight */
+	put(NET_QUEUE_BULK, NUM_BULK);
+	if (get(NET_QUEUE_BULK, NUM_BULK) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	put(NET_QUEUE_BULK_HIGH, NUM_BULK_HIGH);
+	if (get(NET_QUEUE_BULK_HIGH, NUM_BULK_HIGH) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	return check_empty();
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test IP stack queueing classes");
+
+	net_buf_pool_init(bufs_pool);
+
+	rv = test_control_first();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_weight();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = test_single_class();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file
+ * @brief Test and benchmark the IPv6 routing table lookups
+ *
+ * A /64 route and NUM_ROUTES host routes inside it are added through a
+ * single neighbor, as on a RPL root holding the downward routes of its
+ * network. Every host route must then be found for its address, and the
+ * /64 route for the other addresses of the prefix, also after half of the
+ * host routes are removed.
+ *
+ * The number of lookups per second is printed. Build with prj_linear.conf
+ * to compare with the linear scan of the routing table.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <tc_util.h>
+
+#include <net/net_core.h>
+
+#include "contiki/ipv6/uip-ds6.h"
+#include "contiki/ipv6/uip-ds6-route.h"
+
+#define NUM_ROUTES 500
+#define ROUNDS 10
+
+static uip_ds6_route_t *routes[NUM_ROUTES];
+static uip_ipaddr_t addrs[NUM_ROUTES];
+static uip_ipaddr_t nexthop;
+static uip_ipaddr_t prefix;
+
+/* Host address number i of the prefix, with a scattered interface id */
+static void host_addr(uip_ipaddr_t *addr, uint32_t i)
+{
+	uint32_t iid = i * 2654435761u;
+
+	uip_ip6addr(addr, 0xaaaa, 0, 0, 0, 0x0200, (iid >> 16) & 0xff,
+		    iid & 0xffff, i);
+}
+
+static int add_routes(void)
+{
+	uip_lladdr_t lladdr;
+	uip_ipaddr_t addr;
+	uint32_t start, cycles;
+	int i;
+
+	memset(&lladdr, 0, sizeof(lladdr));
+	lladdr.addr[sizeof(lladdr.addr) - 1] = 1;
+	uip_ip6addr(&nexthop, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	if (!uip_ds6_nbr_add(&nexthop, &lladdr, 1, NBR_REACHABLE)) {
+		TC_ERROR("cannot add the next hop neighbor\n");
+		return TC_FAIL;
+	}
+
+	uip_ip6addr(&prefix, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+	if (!uip_ds6_route_add(&prefix, 64, &nexthop)) {
+		TC_ERROR("cannot add the /64 route\n");
+		return TC_FAIL;
+	}
+
+	start = sys_cycle_get_32();
+	for (i = 0; i < NUM_ROUTES; i++) {
+		host_addr(&addr, i);
+		routes[i] = uip_ds6_route_add(&addr, 128, &nexthop);
+		if (!routes[i]) {
+			TC_ERROR("cannot add route %d\n", i);
+			return TC_FAIL;
+		}
+	}
+	cycles = sys_cycle_get_32() - start;
+
+	if (uip_ds6_route_num_routes() != NUM_ROUTES + 1) {
+		TC_ERROR("%d routes in the table\n",
+			 uip_ds6_route_num_routes());
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%d routes added in %u cycles\n", NUM_ROUTES, cycles);
+
+	return TC_PASS;
+}
+
+static int check_routes(void)
+{
+	uip_ds6_route_t *expected;
+	uip_ipaddr_t addr;
+	int i;
+
+	for (i = 0; i < NUM_ROUTES; i++) {
+		host_addr(&addr, i);
+		expected = routes[i];
+		if (!expected) {
+			expected = uip_ds6_route_lookup(&prefix);
+		}
+		if (uip_ds6_route_lookup(&addr) != expected) {
+			TC_ERROR("wrong route for address %d\n", i);
+			return TC_FAIL;
+		}
+
+		/* Not a host route, the /64 route must be found */
+		host_addr(&addr, i + NUM_ROUTES);
+		expected = uip_ds6_route_lookup(&prefix);
+		if (!expected || expected->length != 64 ||
+		    uip_ds6_route_lookup(&addr) != expected) {
+			TC_ERROR("/64 route not found for address %d\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	uip_ip6addr(&addr, 0xbbbb, 0, 0, 0, 0, 0, 0, 1);
+	if (uip_ds6_route_lookup(&addr)) {
+		TC_ERROR("route found outside of the prefix\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static void bench_lookups(void)
+{
+	uint32_t start, cycles;
+	uint64_t rate;
+	int round, i;
+
+	for (i = 0; i < NUM_ROUTES; i++) {
+		host_addr(&addrs[i], i);
+	}
+
+	start = sys_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < NUM_ROUTES; i++) {
+			uip_ds6_route_lookup(&addrs[i]);
+		}
+	}
+	cycles = sys_cycle_get_32() - start;
+
+	rate = (uint64_t)ROUNDS * NUM_ROUTES * sys_clock_hw_cycles_per_sec /
+	       cycles;
+	TC_PRINT("%d lookups in %u cycles, %u lookups per second\n",
+		 ROUNDS * NUM_ROUTES, cycles, (uint32_t)rate);
+}
+
+void main(void)
+{
+	int rv;
+	int i;
+
+	TC_START("Test IPv6 routing table");
+
+	net_init();
+
+	rv = add_routes();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	rv = check_routes();
+	if (rv != TC_PASS) {
+		goto exit;
+	}
+
+	bench_lookups();
+
+	for (i = 0; i < NUM_ROUTES; i += 2) {
+		uip_ds6_route_rm(routes[i]);
+		routes[i] = NULL;
+	}
+
+	rv = check_routes();
+
+exit:
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}